@@ -0,0 +1,165 @@
+/*******************************************************************************
+ The block below describes the properties of this PIP. A PIP is a short snippet
+ of code that can be read by the Projucer and used to generate a JUCE project.
+
+ BEGIN_JUCE_PIP_METADATA
+
+  name:             EditPlaybackBenchmarks
+  version:          0.0.1
+  vendor:           Tracktion
+  website:          www.tracktion.com
+  description:      Runs the Edit playback benchmarks and writes the results as JSON.
+
+  dependencies:     juce_audio_basics, juce_audio_devices, juce_audio_formats, juce_audio_processors, juce_audio_utils,
+                    juce_core, juce_data_structures, juce_dsp, juce_events, juce_graphics,
+                    juce_gui_basics, juce_gui_extra, juce_osc, tracktion_engine
+  exporters:        linux_make, vs2017, xcode_mac
+
+  moduleFlags:      JUCE_STRICT_REFCOUNTEDPOINTER=1
+  defines:          TRACKTION_UNIT_TESTS=1
+
+  type:             Console
+  mainClass:        EditPlaybackBenchmarks
+
+ END_JUCE_PIP_METADATA
+
+*******************************************************************************/
+
+#pragma once
+
+using namespace tracktion_engine;
+
+//==============================================================================
+//==============================================================================
+class BenchmarkUIBehaviour : public UIBehaviour
+{
+public:
+    BenchmarkUIBehaviour() = default;
+
+    void runTaskWithProgressBar (ThreadPoolJobWithProgress& t) override
+    {
+        TaskRunner runner (t);
+
+        while (runner.isThreadRunning())
+            if (! MessageManager::getInstance()->runDispatchLoopUntil (10))
+                break;
+    }
+
+private:
+    //==============================================================================
+    struct TaskRunner  : public Thread
+    {
+        TaskRunner (ThreadPoolJobWithProgress& t)
+            : Thread (t.getJobName()), task (t)
+        {
+            startThread();
+        }
+
+        ~TaskRunner()
+        {
+            task.signalJobShouldExit();
+            waitForThreadToExit (10000);
+        }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+                if (task.runJob() == ThreadPoolJob::jobHasFinished)
+                    break;
+        }
+
+        ThreadPoolJobWithProgress& task;
+    };
+};
+
+
+//==============================================================================
+//==============================================================================
+class BenchmarkEngineBehaviour : public EngineBehaviour
+{
+public:
+    BenchmarkEngineBehaviour() = default;
+
+    bool autoInitialiseDeviceManager() override
+    {
+        return false;
+    }
+};
+
+
+//==============================================================================
+//==============================================================================
+/**
+    Prints the log to the console and collects any lines that are benchmark results.
+*/
+struct BenchmarkLogger : public Logger
+{
+    void logMessage (const String& message) override
+    {
+        std::cout << message << "\n";
+
+        if (message.startsWithChar ('{'))
+        {
+            auto result = JSON::parse (message);
+
+            if (result.hasProperty ("benchmark"))
+                results.add (result);
+        }
+    }
+
+    Array<var> results;
+};
+
+
+//==============================================================================
+//==============================================================================
+namespace EditPlaybackBenchmarks
+{
+    int runBenchmarks (const File& resultsFile)
+    {
+        BenchmarkLogger logger;
+        Logger::setCurrentLogger (&logger);
+
+        int numFailues = 0;
+
+        {
+            tracktion_engine::Engine engine { ProjectInfo::projectName, std::make_unique<BenchmarkUIBehaviour>(), std::make_unique<BenchmarkEngineBehaviour>() };
+
+            UnitTestRunner testRunner;
+            testRunner.setAssertOnFailure (false);
+            testRunner.runTests (UnitTest::getTestsInCategory ("Tracktion:Benchmarks"));
+
+            for (int i = 0; i <= testRunner.getNumResults(); ++i)
+                if (auto result = testRunner.getResult (i))
+                    numFailues += result->failures;
+        }
+
+        if (resultsFile != File())
+        {
+            if (resultsFile.replaceWithText (JSON::toString (logger.results)))
+                Logger::writeToLog ("Wrote benchmark results to: " + resultsFile.getFullPathName());
+            else
+                Logger::writeToLog ("Unable to write to file at: " + resultsFile.getFullPathName());
+        }
+
+        Logger::setCurrentLogger (nullptr);
+
+        return numFailues > 0 ? 1 : 0;
+    }
+}
+
+
+//==============================================================================
+//==============================================================================
+int main (int argv, char** argc)
+{
+    File resultsFile;
+
+    for (int i = 1; i < argv; ++i)
+        if (String (argc[i]) == "--json-file")
+            if ((i + 1) < argv)
+                resultsFile = String (argc[i + 1]);
+
+    ScopedJuceInitialiser_GUI init;
+    return EditPlaybackBenchmarks::runBenchmarks (resultsFile);
+}
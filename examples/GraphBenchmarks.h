@@ -0,0 +1,102 @@
+/*******************************************************************************
+ The block below describes the properties of this PIP. A PIP is a short snippet
+ of code that can be read by the Projucer and used to generate a JUCE project.
+
+ BEGIN_JUCE_PIP_METADATA
+
+  name:             GraphBenchmarks
+  version:          0.0.1
+  vendor:           Tracktion
+  website:          www.tracktion.com
+  description:      Runs the tracktion_graph benchmarks and writes the results as JSON.
+
+  dependencies:     juce_audio_basics, juce_audio_devices, juce_audio_formats, juce_audio_processors, juce_audio_utils,
+                    juce_core, juce_data_structures, juce_dsp, juce_events, juce_graphics,
+                    juce_gui_basics, juce_gui_extra, juce_osc, tracktion_engine, tracktion_graph
+  exporters:        linux_make, vs2017, xcode_mac
+
+  moduleFlags:      JUCE_STRICT_REFCOUNTEDPOINTER=1
+  defines:          ENABLE_EXPERIMENTAL_TRACKTION_GRAPH=1
+
+  type:             Console
+  mainClass:        GraphBenchmarks
+
+ END_JUCE_PIP_METADATA
+
+*******************************************************************************/
+
+#pragma once
+
+
+//==============================================================================
+//==============================================================================
+/**
+    Prints the log to the console and collects any lines that are benchmark results.
+*/
+struct BenchmarkLogger : public Logger
+{
+    void logMessage (const String& message) override
+    {
+        std::cout << message << "\n";
+
+        if (message.startsWithChar ('{'))
+        {
+            auto result = JSON::parse (message);
+
+            if (result.hasProperty ("benchmark"))
+                results.add (result);
+        }
+    }
+
+    Array<var> results;
+};
+
+
+//==============================================================================
+//==============================================================================
+namespace GraphBenchmarks
+{
+    int runBenchmarks (const File& resultsFile)
+    {
+        BenchmarkLogger logger;
+        Logger::setCurrentLogger (&logger);
+
+        UnitTestRunner testRunner;
+        testRunner.setAssertOnFailure (false);
+        testRunner.runTests (UnitTest::getTestsInCategory ("tracktion_graph:Benchmarks"));
+
+        int numFailues = 0;
+
+        for (int i = 0; i <= testRunner.getNumResults(); ++i)
+            if (auto result = testRunner.getResult (i))
+                numFailues += result->failures;
+
+        if (resultsFile != File())
+        {
+            if (resultsFile.replaceWithText (JSON::toString (logger.results)))
+                Logger::writeToLog ("Wrote benchmark results to: " + resultsFile.getFullPathName());
+            else
+                Logger::writeToLog ("Unable to write to file at: " + resultsFile.getFullPathName());
+        }
+
+        Logger::setCurrentLogger (nullptr);
+
+        return numFailues > 0 ? 1 : 0;
+    }
+}
+
+
+//==============================================================================
+//==============================================================================
+int main (int argv, char** argc)
+{
+    File resultsFile;
+
+    for (int i = 1; i < argv; ++i)
+        if (String (argc[i]) == "--json-file")
+            if ((i + 1) < argv)
+                resultsFile = String (argc[i + 1]);
+
+    ScopedJuceInitialiser_GUI init;
+    return GraphBenchmarks::runBenchmarks (resultsFile);
+}
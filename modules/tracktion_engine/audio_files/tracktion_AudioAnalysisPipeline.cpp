@@ -0,0 +1,685 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+class AudioAnalysisPipeline::FileJob  : public ThreadPoolJob
+{
+public:
+    FileJob (AudioAnalysisPipeline& p, const AudioFile& f, int prio)
+        : ThreadPoolJob ("Audio Analysis"), pipeline (p), file (f), priority (prio)
+    {
+    }
+
+    struct Entry
+    {
+        int analyserID = 0;
+        std::unique_ptr<Analyser> analyser;
+        Callback callback;
+        std::atomic<bool> cancelled { false };
+    };
+
+    JobStatus runJob() override
+    {
+        CRASH_TRACER
+
+        // The entries can only be cancelled once the job's started, not added or removed
+        Array<Analyser*> analysers;
+
+        for (auto e : entries)
+            analysers.add (e->analyser.get());
+
+        bool completed = false;
+
+        if (std::unique_ptr<AudioFormatReader> reader { AudioFileUtils::createReaderFor (pipeline.engine, file.getFile()) })
+            completed = processReader (*reader, analysers, this);
+
+        // If this was stopped, either everything's been cancelled or the pipeline's being deleted
+        if (! shouldExit())
+            for (auto e : entries)
+                if (! e->cancelled && e->callback)
+                    e->callback (*e->analyser, completed);
+
+        pipeline.jobFinished (*this);
+        return jobHasFinished;
+    }
+
+    Entry* findEntry (int analyserID) const
+    {
+        for (auto e : entries)
+            if (e->analyserID == analyserID)
+                return e;
+
+        return {};
+    }
+
+    bool areAllCancelled() const
+    {
+        for (auto e : entries)
+            if (! e->cancelled)
+                return false;
+
+        return true;
+    }
+
+    AudioAnalysisPipeline& pipeline;
+    const AudioFile file;
+    OwnedArray<Entry> entries;
+    int priority;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FileJob)
+};
+
+//==============================================================================
+static int getNumAnalysisThreads()
+{
+    return jlimit (1, 4, SystemStats::getNumCpus() - 1);
+}
+
+AudioAnalysisPipeline::AudioAnalysisPipeline (Engine& e)
+    : engine (e), pool (getNumAnalysisThreads()), maxRunningJobs (getNumAnalysisThreads())
+{
+}
+
+AudioAnalysisPipeline::~AudioAnalysisPipeline()
+{
+    {
+        const ScopedLock sl (lock);
+        waitingJobs.clear();
+    }
+
+    pool.removeAllJobs (true, 10000);
+}
+
+int AudioAnalysisPipeline::addAnalyser (const AudioFile& file, std::unique_ptr<Analyser> analyser,
+                                        Callback callback, int priority)
+{
+    const ScopedLock sl (lock);
+    auto analyserID = addEntry (file, std::move (analyser), std::move (callback), priority);
+    startWaitingJobs();
+
+    return analyserID;
+}
+
+bool AudioAnalysisPipeline::runAnalysers (const AudioFile& file, const Array<Analyser*>& analysers,
+                                          ThreadPoolJob* jobToCheck, std::atomic<float>* progress, int priority)
+{
+    CRASH_TRACER
+    jassert (dynamic_cast<FileJob*> (ThreadPoolJob::getCurrentThreadPoolJob()) == nullptr);
+
+    if (analysers.isEmpty())
+        return true;
+
+    // The analysers belong to the caller, so these stop passing anything to them once it's
+    // given up waiting, in case the pass is still running
+    struct Waiter
+    {
+        CriticalSection lock;
+        bool detached = false, failed = false;
+        std::atomic<int> numRemaining { 0 };
+        std::atomic<float> progress { 0.0f };
+        WaitableEvent finished;
+    };
+
+    struct ForwardingAnalyser  : public Analyser
+    {
+        ForwardingAnalyser (std::shared_ptr<Waiter> w, Analyser& t, bool tracksProgress)
+            : waiter (std::move (w)), target (t), reportsProgress (tracksProgress) {}
+
+        void prepare (int numChannels, double sampleRate, int64 lengthInSamples) override
+        {
+            length = lengthInSamples;
+            const ScopedLock sl (waiter->lock);
+
+            if (! waiter->detached)
+                target.prepare (numChannels, sampleRate, lengthInSamples);
+        }
+
+        void process (const AudioBuffer<float>& block, int64 startSample, int numSamples) override
+        {
+            {
+                const ScopedLock sl (waiter->lock);
+
+                if (! waiter->detached)
+                    target.process (block, startSample, numSamples);
+            }
+
+            if (reportsProgress && length > 0)
+                waiter->progress = (float) ((startSample + numSamples) / (double) length);
+        }
+
+        void finish() override
+        {
+            const ScopedLock sl (waiter->lock);
+
+            if (! waiter->detached)
+                target.finish();
+        }
+
+        std::shared_ptr<Waiter> waiter;
+        Analyser& target;
+        const bool reportsProgress;
+        int64 length = 0;
+    };
+
+    auto waiter = std::make_shared<Waiter>();
+    waiter->numRemaining = analysers.size();
+    Array<int> analyserIDs;
+
+    {
+        const ScopedLock sl (lock);
+
+        for (auto a : analysers)
+        {
+            analyserIDs.add (addEntry (file, std::make_unique<ForwardingAnalyser> (waiter, *a, analyserIDs.isEmpty()),
+                                       [waiter] (Analyser&, bool completed)
+                                       {
+                                           if (! completed)
+                                               waiter->failed = true;
+
+                                           if (--waiter->numRemaining == 0)
+                                               waiter->finished.signal();
+                                       },
+                                       priority));
+        }
+
+        startWaitingJobs();
+    }
+
+    while (waiter->numRemaining.load() > 0)
+    {
+        waiter->finished.wait (50);
+
+        if (progress != nullptr)
+            *progress = waiter->progress.load();
+
+        if (jobToCheck != nullptr && jobToCheck->shouldExit())
+        {
+            for (auto analyserID : analyserIDs)
+                cancel (analyserID);
+
+            const ScopedLock sl (waiter->lock);
+            waiter->detached = true;
+            return false;
+        }
+    }
+
+    return ! waiter->failed;
+}
+
+int AudioAnalysisPipeline::addEntry (const AudioFile& file, std::unique_ptr<Analyser> analyser,
+                                     Callback callback, int priority)
+{
+    jassert (analyser != nullptr);
+    auto job = findWaitingJob (file.getHash());
+
+    if (job == nullptr)
+        job = waitingJobs.add (new FileJob (*this, file, priority));
+    else
+        job->priority = std::max (job->priority, priority);
+
+    auto entry = job->entries.add (new FileJob::Entry());
+    entry->analyserID = ++lastAnalyserID;
+    entry->analyser = std::move (analyser);
+    entry->callback = std::move (callback);
+
+    return entry->analyserID;
+}
+
+void AudioAnalysisPipeline::cancel (int analyserID)
+{
+    const ScopedLock sl (lock);
+
+    for (int i = waitingJobs.size(); --i >= 0;)
+    {
+        auto job = waitingJobs.getUnchecked (i);
+
+        if (auto e = job->findEntry (analyserID))
+        {
+            job->entries.removeObject (e);
+
+            if (job->entries.isEmpty())
+                waitingJobs.remove (i);
+
+            return;
+        }
+    }
+
+    for (auto job : runningJobs)
+    {
+        if (auto e = job->findEntry (analyserID))
+        {
+            e->cancelled = true;
+
+            if (job->areAllCancelled())
+                job->signalJobShouldExit();
+
+            return;
+        }
+    }
+}
+
+void AudioAnalysisPipeline::setPriority (const AudioFile& file, int priority)
+{
+    const ScopedLock sl (lock);
+
+    if (auto job = findWaitingJob (file.getHash()))
+        job->priority = std::max (job->priority, priority);
+}
+
+bool AudioAnalysisPipeline::isAnalysing (const AudioFile& file) const
+{
+    const auto hash = file.getHash();
+    const ScopedLock sl (lock);
+
+    if (findWaitingJob (hash) != nullptr)
+        return true;
+
+    for (auto job : runningJobs)
+        if (job->file.getHash() == hash)
+            return true;
+
+    return false;
+}
+
+AudioAnalysisPipeline::FileJob* AudioAnalysisPipeline::findWaitingJob (int64 hash) const
+{
+    for (auto job : waitingJobs)
+        if (job->file.getHash() == hash)
+            return job;
+
+    return {};
+}
+
+void AudioAnalysisPipeline::startWaitingJobs()
+{
+    while (runningJobs.size() < maxRunningJobs && ! waitingJobs.isEmpty())
+    {
+        // Equal priorities are started in the order they were added
+        int best = 0;
+
+        for (int i = 1; i < waitingJobs.size(); ++i)
+            if (waitingJobs.getUnchecked (i)->priority > waitingJobs.getUnchecked (best)->priority)
+                best = i;
+
+        auto job = waitingJobs.removeAndReturn (best);
+        runningJobs.add (job);
+        pool.addJob (job, true);
+    }
+}
+
+void AudioAnalysisPipeline::jobFinished (FileJob& job)
+{
+    const ScopedLock sl (lock);
+    runningJobs.removeFirstMatchingValue (&job);
+    startWaitingJobs();
+}
+
+//==============================================================================
+bool AudioAnalysisPipeline::processReader (AudioFormatReader& reader, const Array<Analyser*>& analysers,
+                                           ThreadPoolJob* jobToCheck, std::atomic<float>* progress)
+{
+    CRASH_TRACER
+    const int numChannels = (int) reader.numChannels;
+    const auto length = reader.lengthInSamples;
+
+    if (numChannels <= 0 || length <= 0 || reader.sampleRate <= 0)
+        return false;
+
+    for (auto a : analysers)
+        a->prepare (numChannels, reader.sampleRate, length);
+
+    const int blockSize = 65536;
+    AudioBuffer<float> buffer (numChannels, blockSize);
+
+    for (int64 pos = 0; pos < length; pos += blockSize)
+    {
+        if (jobToCheck != nullptr && jobToCheck->shouldExit())
+            return false;
+
+        const int numThisTime = (int) std::min ((int64) blockSize, length - pos);
+        reader.read (&buffer, 0, numThisTime, pos, true, true);
+
+        for (auto a : analysers)
+            a->process (buffer, pos, numThisTime);
+
+        if (progress != nullptr)
+            *progress = (float) ((pos + numThisTime) / (double) length);
+    }
+
+    for (auto a : analysers)
+        a->finish();
+
+    return true;
+}
+
+//==============================================================================
+TempoAnalyser::TempoAnalyser() {}
+TempoAnalyser::~TempoAnalyser() {}
+
+void TempoAnalyser::prepare (int numChannels, double sampleRate, int64)
+{
+    detector = std::make_unique<TempoDetect> (numChannels, sampleRate);
+    bpm = -1.0f;
+}
+
+void TempoAnalyser::process (const AudioBuffer<float>& block, int64, int numSamples)
+{
+    detector->processSection (block.getArrayOfReadPointers(), numSamples);
+}
+
+void TempoAnalyser::finish()
+{
+    bpm = detector->finishAndDetect();
+}
+
+//==============================================================================
+BeatAnalyser::BeatAnalyser (float sens)  : sensitivity (sens) {}
+BeatAnalyser::~BeatAnalyser() {}
+
+void BeatAnalyser::prepare (int numChannels, double sampleRate, int64 lengthInSamples)
+{
+    detector = std::make_unique<BeatDetect>();
+    detector->setSensitivity (sensitivity);
+    detector->setSampleRate (sampleRate);
+
+    pending.setSize (numChannels, detector->getBlockSize());
+    numPending = 0;
+    beats.clearQuick();
+
+    // Less than a second doesn't give the detector enough history to work with
+    isLongEnough = lengthInSamples / sampleRate >= 1.0;
+}
+
+void BeatAnalyser::process (const AudioBuffer<float>& block, int64, int numSamples)
+{
+    if (! isLongEnough)
+        return;
+
+    // The detector has to be given blocks of exactly its own size
+    const int blockSize = pending.getNumSamples();
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int numToCopy = std::min (numSamples - pos, blockSize - numPending);
+
+        for (int chan = 0; chan < pending.getNumChannels(); ++chan)
+            pending.copyFrom (chan, numPending, block, chan, pos, numToCopy);
+
+        numPending += numToCopy;
+        pos += numToCopy;
+
+        if (numPending == blockSize)
+        {
+            detector->audioProcess (pending.getArrayOfReadPointers(), pending.getNumChannels());
+            numPending = 0;
+        }
+    }
+}
+
+void BeatAnalyser::finish()
+{
+    for (int i = 0; i < detector->getNumBeats(); ++i)
+        beats.add (detector->getBeat (i));
+}
+
+//==============================================================================
+SilenceAnalyser::SilenceAnalyser (float maxZeroLevelDb)
+    : threshold (2.0f * dbToGain (maxZeroLevelDb))
+{
+}
+
+Range<int64> SilenceAnalyser::getNonSilentRange() const noexcept
+{
+    if (firstNonZero < 0)
+        return {};
+
+    return { firstNonZero, lastNonZero };
+}
+
+void SilenceAnalyser::prepare (int, double, int64)
+{
+    firstNonZero = lastNonZero = -1;
+}
+
+void SilenceAnalyser::process (const AudioBuffer<float>& block, int64 startSample, int numSamples)
+{
+    for (int chan = 0; chan < block.getNumChannels(); ++chan)
+    {
+        auto* data = block.getReadPointer (chan);
+
+        // Only the part before any earlier find needs checking for the start..
+        if (firstNonZero < 0 || firstNonZero > startSample)
+        {
+            const int limit = firstNonZero < 0 ? numSamples : (int) (firstNonZero - startSample);
+
+            for (int i = 0; i < limit; ++i)
+            {
+                if (std::abs (data[i]) > threshold)
+                {
+                    firstNonZero = startSample + i;
+                    break;
+                }
+            }
+        }
+
+        // ..and the end is found by searching backwards
+        for (int i = numSamples; --i >= 0 && startSample + i > lastNonZero;)
+        {
+            if (std::abs (data[i]) > threshold)
+            {
+                lastNonZero = startSample + i;
+                break;
+            }
+        }
+    }
+}
+
+//==============================================================================
+float LoudnessAnalyser::getPeakDb() const noexcept
+{
+    return gainToDb (peak);
+}
+
+float LoudnessAnalyser::getRmsDb() const noexcept
+{
+    return gainToDb (numValues > 0 ? (float) std::sqrt (sumSquares / (double) numValues) : 0.0f);
+}
+
+void LoudnessAnalyser::prepare (int, double, int64)
+{
+    peak = 0.0f;
+    sumSquares = 0.0;
+    numValues = 0;
+}
+
+void LoudnessAnalyser::process (const AudioBuffer<float>& block, int64, int numSamples)
+{
+    for (int chan = 0; chan < block.getNumChannels(); ++chan)
+    {
+        auto range = FloatVectorOperations::findMinAndMax (block.getReadPointer (chan), numSamples);
+        peak = jmax (peak, -range.getStart(), range.getEnd());
+
+        auto rms = (double) block.getRMSLevel (chan, 0, numSamples);
+        sumSquares += rms * rms * numSamples;
+        numValues += numSamples;
+    }
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class AudioAnalysisPipelineTests  : public juce::UnitTest
+{
+public:
+    AudioAnalysisPipelineTests()
+        : juce::UnitTest ("AudioAnalysisPipeline", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+        const double sampleRate = 44100.0;
+        const int length = 200000;
+        const Range<int> soundRange (50000, 150000);
+
+        // This counts how many times the file gets opened and read
+        auto& counter = CountingWavFormat::getInstance (engine);
+        TemporaryFile tempFile (CountingWavFormat::extension);
+        expect (writeTestFile (tempFile.getFile(), sampleRate, length, soundRange));
+        const AudioFile file (engine, tempFile.getFile());
+
+        beginTest ("One pass feeds every analyser");
+        {
+            counter.reset();
+
+            SilenceAnalyser silence (-60.0f);
+            LoudnessAnalyser loudness;
+            BlockRecorder recorder1, recorder2;
+            std::atomic<float> progress { 0.0f };
+
+            expect (engine.getAudioFileManager().analysisPipeline
+                      .runAnalysers (file, { &silence, &loudness, &recorder1, &recorder2 }, nullptr, &progress));
+
+            expectEquals (progress.load(), 1.0f);
+            expect (recorder1.numBlocks > 0);
+            expect (recorder1.numSamples == length && recorder2.numSamples == length);
+            expectEquals (counter.numReadersCreated.load(), 1, "The file should only have been opened once");
+            expectEquals (counter.numReads.load(), recorder1.numBlocks, "Each block should only have been read once");
+            expectEquals (recorder2.numBlocks, recorder1.numBlocks);
+
+            expectEquals (silence.getNonSilentRange().getStart(), (int64) soundRange.getStart());
+            expectEquals (silence.getNonSilentRange().getEnd(), (int64) soundRange.getEnd() - 1);
+            expectWithinAbsoluteError (loudness.getPeak(), 0.5f, 0.01f);
+        }
+
+        beginTest ("Missing files");
+        {
+            LoudnessAnalyser loudness;
+            const AudioFile missing (engine, tempFile.getFile().getSiblingFile ("missing.wav"));
+            expect (! engine.getAudioFileManager().analysisPipeline.runAnalysers (missing, { &loudness }));
+        }
+    }
+
+    //==============================================================================
+    struct BlockRecorder  : public AudioAnalysisPipeline::Analyser
+    {
+        void prepare (int, double, int64) override {}
+
+        void process (const AudioBuffer<float>&, int64, int num) override
+        {
+            ++numBlocks;
+            numSamples += num;
+        }
+
+        int numBlocks = 0;
+        int64 numSamples = 0;
+    };
+
+    /** Reads WAV files with their own extension, counting the readers it creates and the reads
+        made from them, so the tests can tell how many times a file's been decoded.
+    */
+    struct CountingWavFormat  : public WavAudioFormat
+    {
+        static constexpr const char* extension = ".countedwav";
+
+        static CountingWavFormat& getInstance (Engine& engine)
+        {
+            auto& manager = engine.getAudioFileFormatManager().readFormatManager;
+
+            for (auto f : manager)
+                if (auto counting = dynamic_cast<CountingWavFormat*> (f))
+                    return *counting;
+
+            auto counting = new CountingWavFormat();
+            manager.registerFormat (counting, false);
+            return *counting;
+        }
+
+        void reset()
+        {
+            numReadersCreated = 0;
+            numReads = 0;
+        }
+
+        StringArray getFileExtensions() const override         { return { extension }; }
+        bool canHandleFile (const File& f) override             { return f.hasFileExtension (extension); }
+
+        AudioFormatReader* createReaderFor (InputStream* in, bool deleteStreamIfOpeningFails) override
+        {
+            if (auto r = WavAudioFormat::createReaderFor (in, deleteStreamIfOpeningFails))
+            {
+                ++numReadersCreated;
+                return new CountingReader (r, numReads);
+            }
+
+            return {};
+        }
+
+        struct CountingReader  : public AudioFormatReader
+        {
+            CountingReader (AudioFormatReader* r, std::atomic<int>& reads)
+                : AudioFormatReader (nullptr, r->getFormatName()), source (r), numReads (reads)
+            {
+                sampleRate = source->sampleRate;
+                bitsPerSample = source->bitsPerSample;
+                lengthInSamples = source->lengthInSamples;
+                numChannels = source->numChannels;
+                usesFloatingPointData = source->usesFloatingPointData;
+            }
+
+            bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                              int64 startSampleInFile, int numSamples) override
+            {
+                ++numReads;
+                return source->readSamples (destSamples, numDestChannels, startOffsetInDestBuffer,
+                                            startSampleInFile, numSamples);
+            }
+
+            std::unique_ptr<AudioFormatReader> source;
+            std::atomic<int>& numReads;
+        };
+
+        std::atomic<int> numReadersCreated { 0 }, numReads { 0 };
+    };
+
+    static bool writeTestFile (const File& f, double sampleRate, int length, Range<int> soundRange)
+    {
+        AudioBuffer<float> buffer (1, length);
+        buffer.clear();
+
+        for (int i = soundRange.getStart(); i < soundRange.getEnd(); ++i)
+            buffer.setSample (0, i, 0.5f * (float) std::sin (i * MathConstants<double>::twoPi * 1000.0 / sampleRate));
+
+        // Make sure the sound starts and ends on a non-zero sample
+        buffer.setSample (0, soundRange.getStart(), 0.5f);
+        buffer.setSample (0, soundRange.getEnd() - 1, 0.5f);
+
+        std::unique_ptr<FileOutputStream> out (f.createOutputStream());
+
+        if (out == nullptr)
+            return false;
+
+        std::unique_ptr<AudioFormatWriter> writer (WavAudioFormat().createWriterFor (out.get(), sampleRate, 1, 32, {}, 0));
+
+        if (writer == nullptr)
+            return false;
+
+        out.release();
+        return writer->writeFromAudioSampleBuffer (buffer, 0, length);
+    }
+};
+
+static AudioAnalysisPipelineTests audioAnalysisPipelineTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
+} // namespace tracktion_engine
@@ -0,0 +1,207 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+class TempoDetect;
+struct BeatDetect;
+
+//==============================================================================
+/**
+    Runs analysers over audio files on a small pool of background threads.
+
+    Each file is decoded once, with every block being passed to all the analysers
+    that have been added for it. Any analysers added for a file that's still waiting
+    to start join the same pass, so e.g. building its peaks and detecting its tempo
+    only reads it once.
+
+    Files are started in order of their priority, with only a few being read at once.
+    Callers that block until their analysis has finished are given a higher priority than
+    background work such as building peaks, so they don't have to wait behind it.
+*/
+class AudioAnalysisPipeline
+{
+public:
+    //==============================================================================
+    /** Something that's fed the blocks of an audio file in order. */
+    class Analyser
+    {
+    public:
+        virtual ~Analyser() = default;
+
+        /** Called before the first block. */
+        virtual void prepare (int numChannels, double sampleRate, juce::int64 lengthInSamples) = 0;
+
+        /** Called with each block of the file, in order. */
+        virtual void process (const juce::AudioBuffer<float>& block, juce::int64 startSample, int numSamples) = 0;
+
+        /** Called after the last block. */
+        virtual void finish() {}
+    };
+
+    /** Called on one of the analysis threads when an analyser has seen the whole file,
+        or with completed = false if the file couldn't be read.
+    */
+    using Callback = std::function<void (Analyser&, bool completed)>;
+
+    /** The priorities used for the different kinds of work. */
+    enum Priority
+    {
+        backgroundPriority  = 0,    /**< Nothing's waiting for the result, e.g. peaks for files that aren't being shown. */
+        visiblePriority     = 1,    /**< The file is being shown. */
+        playingPriority     = 2,    /**< The file is being played. */
+        waitingPriority     = 3     /**< Something's blocking until the analysis has finished. */
+    };
+
+    //==============================================================================
+    AudioAnalysisPipeline (Engine&);
+    ~AudioAnalysisPipeline();
+
+    /** Queues an analyser to run on a file, files with higher priorities being started first.
+        @returns an ID that can be used to cancel it
+    */
+    int addAnalyser (const AudioFile&, std::unique_ptr<Analyser>, Callback, int priority = backgroundPriority);
+
+    /** Runs some analysers over a file in a single pass on the pipeline's threads, blocking
+        until they've all seen the whole file. They join any pass that's waiting for the same
+        file, so e.g. detecting a tempo while the file's peaks are queued only reads it once.
+        If a job is supplied and it should exit, the analysers are cancelled and this returns false.
+        This mustn't be called on one of the pipeline's own threads.
+        @returns true if the whole file was read
+    */
+    bool runAnalysers (const AudioFile&, const juce::Array<Analyser*>&,
+                       juce::ThreadPoolJob* jobToCheck = nullptr,
+                       std::atomic<float>* progress = nullptr,
+                       int priority = waitingPriority);
+
+    /** Stops an analyser, deleting it without calling its callback. */
+    void cancel (int analyserID);
+
+    /** Raises the priority of a file that's waiting to be analysed, e.g. because it's being
+        shown or played. This never lowers the priority so won't hold up anything that's waiting.
+    */
+    void setPriority (const AudioFile&, int priority);
+
+    /** Returns true if a file is waiting or being analysed. */
+    bool isAnalysing (const AudioFile&) const;
+
+    //==============================================================================
+    /** Reads a whole source on the calling thread, passing each block to the analysers.
+        If a job is supplied it's checked between blocks and this gives up if it should exit.
+        @returns true if the whole source was read
+    */
+    static bool processReader (juce::AudioFormatReader&, const juce::Array<Analyser*>&,
+                               juce::ThreadPoolJob* jobToCheck = nullptr,
+                               std::atomic<float>* progress = nullptr);
+
+private:
+    //==============================================================================
+    Engine& engine;
+    class FileJob;
+
+    juce::ThreadPool pool;
+    const int maxRunningJobs;
+    juce::OwnedArray<FileJob> waitingJobs;
+    juce::Array<FileJob*> runningJobs;
+    juce::CriticalSection lock;
+    int lastAnalyserID = 0;
+
+    FileJob* findWaitingJob (juce::int64 hash) const;
+    int addEntry (const AudioFile&, std::unique_ptr<Analyser>, Callback, int priority);
+    void startWaitingJobs();
+    void jobFinished (FileJob&);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioAnalysisPipeline)
+};
+
+//==============================================================================
+/** Detects the tempo of a file using TempoDetect. */
+class TempoAnalyser  : public AudioAnalysisPipeline::Analyser
+{
+public:
+    TempoAnalyser();
+    ~TempoAnalyser() override;
+
+    /** Returns the detected tempo, or a negative value if none was found. */
+    float getBpm() const noexcept                   { return bpm; }
+
+    void prepare (int, double, juce::int64) override;
+    void process (const juce::AudioBuffer<float>&, juce::int64, int) override;
+    void finish() override;
+
+private:
+    std::unique_ptr<TempoDetect> detector;
+    float bpm = -1.0f;
+};
+
+//==============================================================================
+/** Finds the positions of beats using BeatDetect. */
+class BeatAnalyser  : public AudioAnalysisPipeline::Analyser
+{
+public:
+    BeatAnalyser (float sensitivity);
+    ~BeatAnalyser() override;
+
+    /** Returns the sample positions of the beats that were found. */
+    const juce::Array<juce::int64>& getBeats() const noexcept     { return beats; }
+
+    void prepare (int, double, juce::int64) override;
+    void process (const juce::AudioBuffer<float>&, juce::int64, int) override;
+    void finish() override;
+
+private:
+    std::unique_ptr<BeatDetect> detector;
+    juce::AudioBuffer<float> pending;
+    juce::Array<juce::int64> beats;
+    const float sensitivity;
+    int numPending = 0;
+    bool isLongEnough = false;
+};
+
+//==============================================================================
+/** Finds the first and last samples that are above a level. */
+class SilenceAnalyser  : public AudioAnalysisPipeline::Analyser
+{
+public:
+    SilenceAnalyser (float maxZeroLevelDb);
+
+    /** Returns the range from the first to last non-silent sample, or an empty range if it's all silent. */
+    juce::Range<juce::int64> getNonSilentRange() const noexcept;
+
+    void prepare (int, double, juce::int64) override;
+    void process (const juce::AudioBuffer<float>&, juce::int64, int) override;
+
+private:
+    const float threshold;
+    juce::int64 firstNonZero = -1, lastNonZero = -1;
+};
+
+//==============================================================================
+/** Measures the peak and RMS levels of a file. */
+class LoudnessAnalyser  : public AudioAnalysisPipeline::Analyser
+{
+public:
+    LoudnessAnalyser() = default;
+
+    float getPeak() const noexcept                  { return peak; }
+    float getPeakDb() const noexcept;
+    float getRmsDb() const noexcept;
+
+    void prepare (int, double, juce::int64) override;
+    void process (const juce::AudioBuffer<float>&, juce::int64, int) override;
+
+private:
+    float peak = 0.0f;
+    double sumSquares = 0.0;
+    juce::int64 numValues = 0;
+};
+
+} // namespace tracktion_engine
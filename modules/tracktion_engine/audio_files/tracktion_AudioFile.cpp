@@ -211,17 +211,22 @@ bool AudioFileWriter::writeFromAudioReader (juce::AudioFormatReader& reader,
 AudioProxyGenerator::GeneratorJob::GeneratorJob (const AudioFile& p)
     : ThreadPoolJobWithProgress ("proxy"), proxy (p)
 {
+    setJobClass (BackgroundJobClass::playback);
 }
 
 AudioProxyGenerator::GeneratorJob::~GeneratorJob()
 {
     prepareForJobDeletion();
-    callBlocking ([this] { proxy.engine->getAudioFileManager().validateFile (proxy, false); });
+
+    // Jobs that were superseded before they ran haven't touched the file
+    if (hasStarted)
+        callBlocking ([this] { proxy.engine->getAudioFileManager().validateFile (proxy, false); });
 }
 
 juce::ThreadPoolJob::JobStatus AudioProxyGenerator::GeneratorJob::runJob()
 {
     CRASH_TRACER
+    hasStarted = true;
 
     auto& afm = proxy.engine->getAudioFileManager();
     juce::FloatVectorOperations::disableDenormalisedNumberSupport();
@@ -246,15 +251,15 @@ AudioProxyGenerator::AudioProxyGenerator()
 AudioProxyGenerator::~AudioProxyGenerator()
 {
     CRASH_TRACER
+    cancelPendingUpdate();
+
+    const juce::ScopedLock sl (jobListLock);
+    queuedJobs.clear();
 }
 
 AudioProxyGenerator::GeneratorJob* AudioProxyGenerator::findJob (const AudioFile& proxy) const noexcept
 {
-    for (auto j : activeJobs)
-        if (j->proxy == proxy)
-            return j;
-
-    return {};
+    return jobsByProxyHash[proxy.getHash()];
 }
 
 static bool checkProxyStatus (const AudioFile& f)
@@ -281,10 +286,95 @@ void AudioProxyGenerator::beginJob (GeneratorJob* j)
 
         if (findJob (job->proxy) == nullptr)
         {
-            job->proxy.engine->getBackgroundJobs().addJob (j, true);
-            activeJobs.add (job.release());
+            removeSupersededJobs (job->ownerID);
+
+            jobsByProxyHash.set (job->proxy.getHash(), job.get());
+            queuedJobs.add (job.release());
+            triggerAsyncUpdate();
+        }
+    }
+}
+
+void AudioProxyGenerator::removeSupersededJobs (const juce::String& ownerID)
+{
+    if (ownerID.isEmpty())
+        return;
+
+    for (int i = queuedJobs.size(); --i >= 0;)
+    {
+        if (queuedJobs.getUnchecked (i)->ownerID == ownerID)
+        {
+            jobsByProxyHash.remove (queuedJobs.getUnchecked (i)->proxy.getHash());
+            queuedJobs.remove (i);
         }
     }
+
+    // The running job will delete its partial file and call removeFinishedJob when it stops
+    for (auto j : runningJobs)
+        if (j->ownerID == ownerID)
+            j->signalJobShouldExit();
+}
+
+double AudioProxyGenerator::getPriorityForEditTime (Edit& edit, EditTimeRange time)
+{
+    auto& transport = edit.getTransport();
+    auto position = transport.getCurrentPosition();
+    double distance = 0.0;
+
+    if (position < time.getStart())
+        distance = time.getStart() - position;
+    else if (position > time.getEnd())
+        distance = (position - time.getEnd()) * (transport.isPlaying() ? 4.0 : 1.0); // the playhead's moving away from it
+
+    auto& ui = edit.engine.getUIBehaviour();
+    double tier = 0.0;
+
+    if (! ui.isEditVisibleOnScreen (edit))
+    {
+        tier = 2.0;
+    }
+    else
+    {
+        auto visibleRange = ui.getVisibleTimeRange (edit);
+
+        if (! visibleRange.isEmpty() && ! visibleRange.overlaps (time))
+            tier = 1.0;
+    }
+
+    // Each tier is always started after everything in the tier before it
+    return tier * 1.0e7 + distance;
+}
+
+void AudioProxyGenerator::handleAsyncUpdate()
+{
+    CRASH_TRACER
+    const juce::ScopedLock sl (jobListLock);
+
+    const int maxRunningJobs = juce::jlimit (1, 4, juce::SystemStats::getNumCpus() / 2);
+
+    if (queuedJobs.isEmpty() || runningJobs.size() >= maxRunningJobs)
+        return;
+
+    // Priorities change as the playhead moves so these are re-calculated each time a slot frees up
+    std::vector<std::pair<double, GeneratorJob*>> priorities;
+    priorities.reserve ((size_t) queuedJobs.size());
+
+    for (auto j : queuedJobs)
+        priorities.emplace_back (j->getSchedulingPriority(), j);
+
+    std::stable_sort (priorities.begin(), priorities.end(),
+                      [] (const auto& a, const auto& b) { return a.first < b.first; });
+
+    for (auto& p : priorities)
+    {
+        if (runningJobs.size() >= maxRunningJobs)
+            break;
+
+        auto j = p.second;
+        queuedJobs.removeObject (j, false);
+        runningJobs.add (j);
+        j->proxy.engine->getBackgroundJobs().addJob (j, true);
+    }
 }
 
 bool AudioProxyGenerator::isProxyBeingGenerated (const AudioFile& proxyFile) const noexcept
@@ -306,7 +396,12 @@ float AudioProxyGenerator::getProportionComplete (const AudioFile& proxyFile) co
 void AudioProxyGenerator::removeFinishedJob (GeneratorJob* j)
 {
     const juce::ScopedLock sl (jobListLock);
-    activeJobs.removeAllInstancesOf (j);
+    runningJobs.removeAllInstancesOf (j);
+
+    if (findJob (j->proxy) == j)
+        jobsByProxyHash.remove (j->proxy.getHash());
+
+    triggerAsyncUpdate();
 }
 
 void AudioProxyGenerator::deleteProxy (const AudioFile& proxyFile)
@@ -317,11 +412,29 @@ void AudioProxyGenerator::deleteProxy (const AudioFile& proxyFile)
     {
         const juce::ScopedLock sl (jobListLock);
         j = findJob (proxyFile);
+
+        if (j != nullptr && queuedJobs.contains (j))
+        {
+            jobsByProxyHash.remove (proxyFile.getHash());
+            queuedJobs.removeObject (j);
+            j = nullptr;
+        }
     }
 
     if (j != nullptr)
+    {
         proxyFile.engine->getBackgroundJobs().removeJob (j, true, 10000);
 
+        // If the pool removed the job before it started it won't have called removeFinishedJob
+        const juce::ScopedLock sl (jobListLock);
+        runningJobs.removeAllInstancesOf (j);
+
+        if (findJob (proxyFile) == j)
+            jobsByProxyHash.remove (proxyFile.getHash());
+
+        triggerAsyncUpdate();
+    }
+
     proxyFile.deleteFile();
 }
 
@@ -523,8 +636,26 @@ void SmartThumbnail::createThumbnailReader()
 
     if (enabled)
     {
-        setReader (AudioFileUtils::createReaderFor (engine, file.getFile()), file.getHash());
-        thumbnailIsInvalid = false;
+        auto& pyramids = engine.getAudioFileManager().peakPyramids;
+
+        if (auto pyramid = pyramids.getPyramid (file))
+        {
+            setPeakPyramid (pyramid, AudioFileUtils::createReaderFor (engine, file.getFile()), file.getHash());
+            thumbnailIsInvalid = false;
+        }
+        else if (pyramids.isBuilding (file))
+        {
+            // The timer will keep trying until the pyramid's ready
+            thumbnailIsInvalid = true;
+
+            if (component.isShowing())
+                engine.getAudioFileManager().analysisPipeline.setPriority (file, AudioAnalysisPipeline::visiblePriority);
+        }
+        else
+        {
+            setReader (AudioFileUtils::createReaderFor (engine, file.getFile()), file.getHash());
+            thumbnailIsInvalid = false;
+        }
     }
     else
     {
@@ -600,7 +731,7 @@ void SmartThumbnail::timerCallback()
 
 //==============================================================================
 AudioFileManager::AudioFileManager (Engine& e)
-    : engine (e), cache (e), thumbnailCache (new TracktionThumbnailCache (e))
+    : engine (e), cache (e), peakPyramids (e), onsetEnvelopes (e), analysisPipeline (e), thumbnailCache (new TracktionThumbnailCache (e))
 {
 }
 
@@ -734,6 +865,8 @@ void AudioFileManager::callListeners (const AudioFile& file)
     TRACKTION_ASSERT_MESSAGE_THREAD
 
     thumbnailCache->removeThumb (file.getHash());
+    peakPyramids.releasePyramid (file);
+    onsetEnvelopes.releaseFile (file);
 
     const juce::ScopedLock sl (activeThumbnailLock);
 
@@ -21,8 +21,8 @@ static void clearSetOfChannels (int** channels, int numChannels, int offset, int
 class AudioFileCache::CachedFile
 {
 public:
-    CachedFile (AudioFileCache& c, const AudioFile& f)
-        : cache (c), file (f), info (f.getInfo())
+    CachedFile (AudioFileCache& c, const AudioFile& f, bool useDecodedFile)
+        : cache (c), file (f), info (f.getInfo()), usesDecodedFile (useDecodedFile)
     {
        #if ! JUCE_64BIT
         if (info.lengthInSamples <= cache.cacheSizeSamples)
@@ -230,8 +230,11 @@ public:
 
     juce::MemoryMappedAudioFormatReader* createNewReader (const juce::Range<juce::int64>* range)
     {
+        // If the source has changed since it was decoded, this fails until the new version's ready
+        auto fileToMap = usesDecodedFile ? cache.getDecodedFile (file) : file.getFile();
+
         juce::AudioFormat* af;
-        std::unique_ptr<juce::MemoryMappedAudioFormatReader> r (AudioFileUtils::createMemoryMappedReader (cache.engine, file.getFile(), af));
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> r (AudioFileUtils::createMemoryMappedReader (cache.engine, fileToMap, af));
 
         if (r != nullptr
              && (range != nullptr ? r->mapSectionOfFile (*range)
@@ -436,6 +439,7 @@ public:
     AudioFileCache& cache;
     AudioFile file;
     AudioFileInfo info;
+    const bool usesDecodedFile;
 
     std::atomic<juce::uint32> lastReadTime { juce::Time::getApproximateMillisecondCounter() };
     juce::int64 totalBytesInUse = 0;
@@ -541,7 +545,203 @@ public:
 };
 
 //==============================================================================
-AudioFileCache::AudioFileCache (Engine& e)  : engine (e)
+/**
+    Transcodes files in formats that can't be memory-mapped to float WAVs in the temp
+    folder, so they can be read through the same mapped path as everything else rather
+    than all sharing one buffering thread.
+
+    The decoded files are much bigger than their sources, so once they take up more than
+    their share of the temp folder the least recently used ones are deleted.
+*/
+class AudioFileCache::Decoder
+{
+public:
+    Decoder (AudioFileCache& c)
+        : cache (c), engine (c.engine), pool (juce::jlimit (1, 4, juce::SystemStats::getNumCpus() - 1))
+    {
+    }
+
+    ~Decoder()
+    {
+        pool.removeAllJobs (true, 10000);
+    }
+
+    /** Returns the decoded version of a file if it's ready, otherwise this starts decoding it. */
+    juce::File getDecodedFile (const AudioFile& f)
+    {
+        auto destFile = getDestFile (f);
+
+        if (destFile.existsAsFile())
+        {
+            // This is what the least recently used files are found by
+            destFile.setLastAccessTime (juce::Time::getCurrentTime());
+            return destFile;
+        }
+
+        const juce::ScopedLock sl (lock);
+
+        // The job may have finished since the last check
+        if (destFile.existsAsFile())
+            return destFile;
+
+        if (! (pendingFiles.contains (destFile) || failedFiles.contains (destFile)
+                || engine.getTemporaryFileManager().isDiskSpaceDangerouslyLow()))
+        {
+            pendingFiles.add (destFile);
+            pool.addJob (new DecodeJob (*this, f.getFile(), destFile), true);
+        }
+
+        return {};
+    }
+
+    AudioFileCache& cache;
+    Engine& engine;
+
+private:
+    //==============================================================================
+    struct DecodeJob  : public juce::ThreadPoolJob
+    {
+        DecodeJob (Decoder& d, const juce::File& source, const juce::File& dest)
+            : juce::ThreadPoolJob ("Decode Audio"), decoder (d), sourceFile (source), destFile (dest)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            CRASH_TRACER
+            juce::FloatVectorOperations::disableDenormalisedNumberSupport();
+
+            const bool ok = decode();
+            decoder.jobFinished (destFile, ok || shouldExit());
+            return jobHasFinished;
+        }
+
+        bool decode()
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader (AudioFileUtils::createReaderFor (decoder.engine, sourceFile));
+
+            if (reader == nullptr || reader->numChannels == 0 || reader->lengthInSamples <= 0)
+                return false;
+
+            // This is written to a temporary first so a half-finished file can never be mapped
+            juce::TemporaryFile tempFile (destFile);
+
+            {
+                std::unique_ptr<juce::AudioFormatWriter> writer (AudioFileUtils::createWriterFor (decoder.engine.getAudioFileFormatManager().getWavFormat(),
+                                                                                                  tempFile.getFile(), reader->sampleRate,
+                                                                                                  reader->numChannels, 32, {}, 0));
+
+                if (writer == nullptr)
+                    return false;
+
+                const int blockSize = 65536;
+                juce::AudioBuffer<float> buffer ((int) reader->numChannels, blockSize);
+
+                for (juce::int64 pos = 0; pos < reader->lengthInSamples; pos += blockSize)
+                {
+                    if (shouldExit())
+                        return false;
+
+                    const int numThisTime = (int) std::min ((juce::int64) blockSize, reader->lengthInSamples - pos);
+                    reader->read (&buffer, 0, numThisTime, pos, true, true);
+
+                    if (! writer->writeFromAudioSampleBuffer (buffer, 0, numThisTime))
+                        return false;
+                }
+            }
+
+            return tempFile.overwriteTargetFileWithTemporary();
+        }
+
+        Decoder& decoder;
+        const juce::File sourceFile, destFile;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecodeJob)
+    };
+
+    juce::ThreadPool pool;
+    juce::Array<juce::File> pendingFiles, failedFiles;
+    juce::CriticalSection lock;
+
+    juce::File getDestFile (const AudioFile& f) const
+    {
+        // The modification time is part of the name so an edited source is never matched to an old decode
+        return engine.getTemporaryFileManager()
+                 .getTempFile ("decoded_" + f.getHashString()
+                                 + "_" + juce::String::toHexString (f.getFile().getLastModificationTime().toMilliseconds())
+                                 + ".wav");
+    }
+
+    void jobFinished (const juce::File& destFile, bool worthRetrying)
+    {
+        {
+            const juce::ScopedLock sl (lock);
+            pendingFiles.removeFirstMatchingValue (destFile);
+
+            if (! worthRetrying)
+                failedFiles.addIfNotAlreadyThere (destFile);
+        }
+
+        purgeOldFiles();
+    }
+
+    juce::Array<juce::File> getFilesInUse()
+    {
+        juce::Array<juce::File> filesInUse;
+        const juce::ScopedReadLock sl (cache.fileListLock);
+
+        for (auto f : cache.activeFiles)
+            if (f->usesDecodedFile)
+                filesInUse.add (getDestFile (f->file));
+
+        return filesInUse;
+    }
+
+    void purgeOldFiles()
+    {
+        CRASH_TRACER
+        auto& tempFileManager = engine.getTemporaryFileManager();
+        const auto maxBytes = tempFileManager.getMaxSpaceAllowedForTempFiles() / 2;
+
+        juce::Array<juce::File> files;
+        tempFileManager.getTempDirectory().findChildFiles (files, juce::File::findFiles, false, "decoded_*.wav");
+
+        juce::int64 totalBytes = 0;
+
+        for (auto& f : files)
+            totalBytes += f.getSize();
+
+        if (totalBytes <= maxBytes)
+            return;
+
+        std::sort (files.begin(), files.end(),
+                   [] (const juce::File& first, const juce::File& second)
+                   {
+                       return first.getLastAccessTime() < second.getLastAccessTime();
+                   });
+
+        auto filesInUse = getFilesInUse();
+
+        for (auto& f : files)
+        {
+            if (totalBytes <= maxBytes)
+                break;
+
+            if (filesInUse.contains (f))
+                continue;
+
+            const auto size = f.getSize();
+
+            if (f.deleteFile())
+                totalBytes -= size;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Decoder)
+};
+
+//==============================================================================
+AudioFileCache::AudioFileCache (Engine& e)  : engine (e), decoder (new Decoder (*this))
 {
     CRASH_TRACER
     const int defaultSize = 6 * 48000;
@@ -554,6 +754,7 @@ AudioFileCache::~AudioFileCache()
 {
     CRASH_TRACER
     stopThreads();
+    decoder.reset();
     purgeOrphanReaders();
     jassert (activeFiles.isEmpty());
     activeFiles.clear();
@@ -614,15 +815,31 @@ AudioFileCache::CachedFile* AudioFileCache::getOrCreateCachedFile (const AudioFi
     {
         if (af->canHandleFile (f.getFile()))
         {
-            auto fs = new CachedFile (*this, f);
+            auto fs = new CachedFile (*this, f, false);
             activeFiles.add (fs);
             return fs;
         }
     }
 
+    // Other formats are mapped once they've been decoded, until then they use a buffering reader
+    if (getDecodedFile (f).existsAsFile())
+    {
+        auto fs = new CachedFile (*this, f, true);
+        activeFiles.add (fs);
+        return fs;
+    }
+
     return {};
 }
 
+juce::File AudioFileCache::getDecodedFile (const AudioFile& f)
+{
+    if (decoder == nullptr || f.isNull())
+        return {};
+
+    return decoder->getDecodedFile (f);
+}
+
 void AudioFileCache::releaseFile (const AudioFile& file)
 {
     const juce::ScopedReadLock sl (fileListLock);
@@ -788,113 +1005,174 @@ void AudioFileCache::Reader::setLoopRange (juce::Range<juce::int64> newRange)
     loopLength = newRange.getLength();
 }
 
-bool AudioFileCache::Reader::readSamples (int numSamples,
-                                          juce::AudioBuffer<float>& destBuffer,
-                                          const juce::AudioChannelSet& destBufferChannels,
-                                          int startOffsetInDestBuffer,
-                                          const juce::AudioChannelSet& sourceBufferChannels,
-                                          int timeoutMs)
+namespace AudioFileCacheHelpers
 {
-    jassert (numSamples < CachedFile::readAheadSamples); // this method fails unless broken down into chunks smaller than this
-    const auto numDestChans = destBuffer.getNumChannels();
-
-    // This may need to deal with the generic surround case if destBuffer number of channels > channelsToUse.size()
-    if (cache.engine.getEngineBehaviour().isDescriptionOfWaveDevicesSupported())
+    static constexpr int maxNumChannels = 32;
+
+    /** Works out which source channel each destination channel comes from, or -1 if it's silent.
+        @returns the number of source channels that need to be read
+    */
+    static int getSourceChannelsForDest (bool useChannelDescriptions, int numFileChannels,
+                                         const juce::AudioChannelSet& destChannels,
+                                         const juce::AudioChannelSet& sourceChannels,
+                                         int numDestChans, int* sourceForDest) noexcept
     {
-        static constexpr int maxNumChannels = 32;
-        float* chans[maxNumChannels] = {};
-        auto numSourceChans = std::min (maxNumChannels, sourceBufferChannels.size());
-        int highestUsedSourceChan = 0;
+        if (useChannelDescriptions)
+        {
+            for (int destIndex = 0; destIndex < numDestChans; ++destIndex)
+            {
+                auto sourceIndex = sourceChannels.getChannelIndexForType (destChannels.getTypeOfChannel (destIndex));
+                sourceForDest[destIndex] = sourceIndex < maxNumChannels ? sourceIndex : -1;
+            }
+
+            return std::min (maxNumChannels, sourceChannels.size());
+        }
 
         for (int destIndex = 0; destIndex < numDestChans; ++destIndex)
-        {
-            auto destType = destBufferChannels.getTypeOfChannel (destIndex);
-            auto destData = destBuffer.getWritePointer (destIndex, startOffsetInDestBuffer);
-            auto sourceIndex = sourceBufferChannels.getChannelIndexForType (destType);
+            sourceForDest[destIndex] = -1;
+
+        const bool hasLeft  = sourceChannels.getChannelIndexForType (juce::AudioChannelSet::left) >= 0;
+        const bool hasRight = sourceChannels.getChannelIndexForType (juce::AudioChannelSet::right) >= 0;
 
-            if (sourceIndex >= 0 && sourceIndex < maxNumChannels)
+        // Only the first two channels are used, with a single one being copied to both sides
+        if (numDestChans > 1)
+        {
+            if (hasLeft && hasRight)
             {
-                chans[sourceIndex] = destData;
-                highestUsedSourceChan = std::max (highestUsedSourceChan, sourceIndex);
+                sourceForDest[0] = 0;
+                sourceForDest[1] = numFileChannels > 1 ? 1 : 0;
             }
             else
             {
-                juce::FloatVectorOperations::clear (destData, numSamples);
+                sourceForDest[0] = sourceForDest[1] = hasLeft ? 0 : 1;
             }
         }
-
-        if (readSamples ((int**) chans, numSourceChans, 0, numSamples, timeoutMs))
+        else if (numDestChans == 1)
         {
-            bool isFloatingPoint = (file != nullptr) ? static_cast<CachedFile*> (file)->info.isFloatingPoint
-                                                     : fallbackReader->usesFloatingPointData;
-
-            if (! isFloatingPoint)
-                for (int i = 0; i <= highestUsedSourceChan; ++i)
-                    if (auto chan = chans[i])
-                        juce::FloatVectorOperations::convertFixedToFloat (chan, (const int*) chan, 1.0f / 0x7fffffff, numSamples);
-
-            return true;
+            sourceForDest[0] = (hasLeft || numFileChannels < 2) ? 0 : 1;
         }
+
+        return 2;
     }
-    else
-    {
-        float* chans[2] = {};
-        bool dupeChannel = false;
 
-        if (numDestChans > 1)
+    /** Applies a gain to a channel as it's read, converting it from fixed-point if needed,
+        and either replacing or adding to the destination. The source and destination can be
+        the same when replacing.
+    */
+    static void applyGain (float* dest, const float* source, int numSamples,
+                           float gain, bool isFloatingPoint, bool addToDest) noexcept
+    {
+        if (isFloatingPoint)
         {
-            if (sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::left) >= 0
-                 && sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::right) >= 0)
-            {
-                chans[0] = destBuffer.getWritePointer (0, startOffsetInDestBuffer);
+            if (addToDest)
+                juce::FloatVectorOperations::addWithMultiply (dest, source, gain, numSamples);
+            else if (dest != source)
+                juce::FloatVectorOperations::multiply (dest, source, gain, numSamples);
+            else if (gain != 1.0f)
+                juce::FloatVectorOperations::multiply (dest, gain, numSamples);
+
+            return;
+        }
 
-                if (getNumChannels() > 1)
-                    chans[1] = destBuffer.getWritePointer (1, startOffsetInDestBuffer);
-                else
-                    dupeChannel = true;
-            }
-            else if (sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::left) >= 0)
-            {
-                chans[0] = destBuffer.getWritePointer (0, startOffsetInDestBuffer);
-                dupeChannel = true;
-            }
-            else
-            {
-                chans[1] = destBuffer.getWritePointer (1, startOffsetInDestBuffer);
-                dupeChannel = true;
-            }
+        // Folding the gain into the scale means the data's only touched once
+        const float scale = gain / (float) 0x7fffffff;
+        auto ints = reinterpret_cast<const int*> (source);
+
+        if (addToDest)
+        {
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] += (float) ints[i] * scale;
         }
         else
         {
-            if (sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::left) >= 0 || getNumChannels() < 2)
-                chans[0] = destBuffer.getWritePointer (0, startOffsetInDestBuffer);
-            else
-                chans[1] = destBuffer.getWritePointer (0, startOffsetInDestBuffer);
+            juce::FloatVectorOperations::convertFixedToFloat (dest, ints, scale, numSamples);
         }
+    }
+}
+
+bool AudioFileCache::Reader::readSamples (int numSamples,
+                                          juce::AudioBuffer<float>& destBuffer,
+                                          const juce::AudioChannelSet& destBufferChannels,
+                                          int startOffsetInDestBuffer,
+                                          const juce::AudioChannelSet& sourceBufferChannels,
+                                          int timeoutMs)
+{
+    return readSamples (numSamples, destBuffer, destBufferChannels, startOffsetInDestBuffer,
+                        sourceBufferChannels, 1.0f, 1.0f, false, timeoutMs);
+}
 
-        if (readSamples ((int**) chans, 2, 0, numSamples, timeoutMs))
+bool AudioFileCache::Reader::readSamples (int numSamples,
+                                          juce::AudioBuffer<float>& destBuffer,
+                                          const juce::AudioChannelSet& destBufferChannels,
+                                          int startOffsetInDestBuffer,
+                                          const juce::AudioChannelSet& sourceBufferChannels,
+                                          float leftGain, float rightGain,
+                                          bool addToDestination,
+                                          int timeoutMs)
+{
+    using namespace AudioFileCacheHelpers;
+    jassert (numSamples < CachedFile::readAheadSamples); // this method fails unless broken down into chunks smaller than this
+
+    const auto numDestChans = std::min (maxNumChannels, destBuffer.getNumChannels());
+    int sourceForDest[maxNumChannels];
+
+    // This may need to deal with the generic surround case if destBuffer number of channels > channelsToUse.size()
+    const auto numSourceChans = getSourceChannelsForDest (cache.engine.getEngineBehaviour().isDescriptionOfWaveDevicesSupported(),
+                                                          getNumChannels(), destBufferChannels, sourceBufferChannels,
+                                                          numDestChans, sourceForDest);
+
+    // When replacing, the raw data is read straight into the first destination channel
+    // that uses it, otherwise it goes into a scratch buffer to be added from
+    AudioScratchBuffer scratch (addToDestination ? numSourceChans : 0, numSamples);
+
+    float* chans[maxNumChannels] = {};
+    bool isReadTarget[maxNumChannels] = {};
+
+    for (int destIndex = 0; destIndex < numDestChans; ++destIndex)
+    {
+        const auto sourceIndex = sourceForDest[destIndex];
+
+        if (sourceIndex >= 0 && chans[sourceIndex] == nullptr)
         {
-            const bool isFloatingPoint = (file != nullptr) ? static_cast<CachedFile*> (file)->info.isFloatingPoint
-                                                           : fallbackReader->usesFloatingPointData;
+            chans[sourceIndex] = addToDestination ? scratch.buffer.getWritePointer (sourceIndex)
+                                                  : destBuffer.getWritePointer (destIndex, startOffsetInDestBuffer);
+            isReadTarget[destIndex] = ! addToDestination;
+        }
+    }
 
-            if (! isFloatingPoint)
-                for (int i = 0; i < 2; ++i)
-                    if (auto* chan = chans[i])
-                        juce::FloatVectorOperations::convertFixedToFloat (chan, (const int*) chan, 1.0f / 0x7fffffff, numSamples);
+    if (! readSamples ((int**) chans, numSourceChans, 0, numSamples, timeoutMs))
+        return false;
 
-            if (dupeChannel)
-            {
-                if (chans[0] == nullptr)
-                    juce::FloatVectorOperations::copy (destBuffer.getWritePointer (0), chans[1], numSamples);
-                else if (chans[1] == nullptr)
-                    juce::FloatVectorOperations::copy (destBuffer.getWritePointer (1), chans[0], numSamples);
-            }
+    const bool isFloatingPoint = (file != nullptr) ? static_cast<CachedFile*> (file)->info.isFloatingPoint
+                                                   : fallbackReader->usesFloatingPointData;
 
-            return true;
+    // Channels copied from another are done before that one's converted in place
+    for (int destIndex = 0; destIndex < destBuffer.getNumChannels(); ++destIndex)
+    {
+        const auto sourceIndex = destIndex < numDestChans ? sourceForDest[destIndex] : -1;
+
+        if (sourceIndex < 0)
+        {
+            if (! addToDestination)
+                destBuffer.clear (destIndex, startOffsetInDestBuffer, numSamples);
+        }
+        else if (! isReadTarget[destIndex])
+        {
+            applyGain (destBuffer.getWritePointer (destIndex, startOffsetInDestBuffer), chans[sourceIndex],
+                       numSamples, (destIndex & 1) == 0 ? leftGain : rightGain, isFloatingPoint, addToDestination);
         }
     }
 
-    return false;
+    for (int destIndex = 0; destIndex < numDestChans; ++destIndex)
+    {
+        if (isReadTarget[destIndex])
+        {
+            auto data = destBuffer.getWritePointer (destIndex, startOffsetInDestBuffer);
+            applyGain (data, data, numSamples, (destIndex & 1) == 0 ? leftGain : rightGain, isFloatingPoint, false);
+        }
+    }
+
+    return true;
 }
 
 bool AudioFileCache::Reader::readSamples (int** destSamples, int numDestChannels,
@@ -1037,4 +1315,86 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CacheAudioFormatReader)
 };
 
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class AudioFileCacheTests  : public juce::UnitTest
+{
+public:
+    AudioFileCacheTests()
+        : juce::UnitTest ("AudioFileCache", "Tracktion:Longer") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+        auto& cache = engine.getAudioFileManager().cache;
+
+        beginTest ("FLAC files are mapped once they've been decoded");
+        {
+            const int length = 44100;
+            juce::TemporaryFile tempFile (".flac");
+            expect (writeTestFile (engine, tempFile.getFile(), length));
+            const AudioFile file (engine, tempFile.getFile());
+
+            // The first reader starts the decode and has to buffer the file until it's done
+            auto firstReader = cache.createReader (file);
+            expect (firstReader != nullptr);
+
+            AudioFileCache::Reader::Ptr mappedReader;
+
+            for (int i = 0; i < 500 && mappedReader == nullptr; ++i)
+            {
+                if (auto r = cache.createReader (file))
+                    if (r->isMemoryMapped())
+                        mappedReader = r;
+
+                if (mappedReader == nullptr)
+                    juce::Thread::sleep (20);
+            }
+
+            expect (mappedReader != nullptr, "The decoded file should have been memory-mapped");
+
+            if (mappedReader != nullptr)
+            {
+                const int numToRead = 1000;
+                juce::AudioBuffer<float> buffer (1, numToRead);
+                mappedReader->setReadPosition (0);
+
+                expect (mappedReader->readSamples (numToRead, buffer, juce::AudioChannelSet::mono(), 0,
+                                                   juce::AudioChannelSet::mono(), 5000));
+
+                float maxError = 0.0f;
+
+                for (int i = 0; i < numToRead; ++i)
+                    maxError = std::max (maxError, std::abs (buffer.getSample (0, i) - getTestSample (i)));
+
+                expectLessThan (maxError, 0.001f);
+            }
+        }
+    }
+
+    static float getTestSample (int i)
+    {
+        return 0.5f * (float) std::sin (i * juce::MathConstants<double>::twoPi * 440.0 / 44100.0);
+    }
+
+    static bool writeTestFile (Engine& engine, const juce::File& f, int length)
+    {
+        juce::AudioBuffer<float> buffer (1, length);
+
+        for (int i = 0; i < length; ++i)
+            buffer.setSample (0, i, getTestSample (i));
+
+        std::unique_ptr<juce::AudioFormatWriter> writer (AudioFileUtils::createWriterFor (engine.getAudioFileFormatManager().getFlacFormat(),
+                                                                                          f, 44100.0, 1, 16, {}, 0));
+
+        return writer != nullptr && writer->writeFromAudioSampleBuffer (buffer, 0, length);
+    }
+};
+
+static AudioFileCacheTests audioFileCacheTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
 }
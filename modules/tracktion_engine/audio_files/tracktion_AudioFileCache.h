@@ -38,6 +38,20 @@ public:
                           const juce::AudioChannelSet& sourceBufferChannels,
                           int timeoutMs);
 
+        /** Reads samples into a buffer with a gain applied to the even and odd channels,
+            either replacing or adding to what's already there. Fixed-point data is converted
+            in the same pass, so each sample is only touched once after it's been read.
+            If this fails when adding, the buffer is left unchanged.
+        */
+        bool readSamples (int numSamples,
+                          juce::AudioBuffer<float>& destBuffer,
+                          const juce::AudioChannelSet& destBufferChannels,
+                          int startOffsetInDestBuffer,
+                          const juce::AudioChannelSet& sourceBufferChannels,
+                          float leftGain, float rightGain,
+                          bool addToDestination,
+                          int timeoutMs);
+
         bool readSamples (int** destSamples,
                           int numDestChannels,
                           int startOffsetInDestBuffer,
@@ -54,6 +68,11 @@ public:
         int getNumChannels() const noexcept;
         double getSampleRate() const noexcept;
 
+        /** Returns true if this reads a memory-mapped file, or false if it's using a
+            buffering reader, e.g. because the file's still being decoded.
+        */
+        bool isMemoryMapped() const noexcept            { return file != nullptr; }
+
     private:
         friend class AudioFileCache;
 
@@ -103,6 +122,10 @@ private:
 
     juce::TimeSliceThread backgroundReaderThread { "Preview Buffer" };
 
+    class Decoder;
+    std::unique_ptr<Decoder> decoder;
+    juce::File getDecodedFile (const AudioFile&);
+
     void stopThreads();
 
     void purgeOldFiles();
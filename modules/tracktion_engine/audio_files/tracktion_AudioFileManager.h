@@ -37,6 +37,9 @@ public:
     Engine& engine;
     AudioProxyGenerator proxyGenerator;
     AudioFileCache cache;
+    PeakPyramidCache peakPyramids;
+    OnsetEnvelopeCache onsetEnvelopes;
+    AudioAnalysisPipeline analysisPipeline; // (deleted first as its callbacks can use the other members)
 
 private:
     struct KnownFile;
@@ -90,82 +90,13 @@ juce::AudioFormatWriter* AudioFileUtils::createWriterFor (Engine& engine,
 
 juce::Range<juce::int64> AudioFileUtils::scanForNonZeroSamples (Engine& engine, const juce::File& file, float maxZeroLevelDb)
 {
-    std::unique_ptr<juce::AudioFormatReader> reader (createReaderFor (engine, file));
+    SilenceAnalyser analyser (maxZeroLevelDb);
 
-    if (reader == nullptr)
+    if (! engine.getAudioFileManager().analysisPipeline.runAnalysers (AudioFile (engine, file), { &analyser },
+                                                                      juce::ThreadPoolJob::getCurrentThreadPoolJob()))
         return {};
 
-    auto numChans = (int) reader->numChannels;
-
-    if (numChans == 0 || reader->lengthInSamples == 0)
-        return {};
-
-    const float floatMaxZeroLevel = 2.0f * dbToGain (maxZeroLevelDb);
-    const int intMaxZeroLevel = 1 + (int) (std::numeric_limits<int>::max() * (double) floatMaxZeroLevel);
-    const int sampsPerBlock = 32768;
-
-    juce::HeapBlock<int*> chans;
-    chans.calloc ((size_t) numChans + 2);
-
-    juce::HeapBlock<int> buffer ((size_t) numChans * sampsPerBlock);
-
-    for (int i = 0; i < numChans; ++i)
-        chans[i] = buffer + i * sampsPerBlock;
-
-    juce::int64 firstNonZero = 0, lastNonZero = 0, n = 0;
-    bool needFirst = true;
-
-    while (n < reader->lengthInSamples)
-    {
-        for (int j = numChans; --j >= 0;)
-            juce::zeromem (chans[j], sizeof (int) * sampsPerBlock);
-
-        reader->read (chans, numChans, n, sampsPerBlock, false);
-
-        for (int j = numChans; --j >= 0;)
-        {
-            if (reader->usesFloatingPointData)
-            {
-                const float* const chan = (const float*) chans[j];
-
-                for (int i = 0; i < sampsPerBlock; ++i)
-                {
-                    if (std::abs (chan[i]) > floatMaxZeroLevel)
-                    {
-                        if (needFirst)
-                        {
-                            firstNonZero = n + i;
-                            needFirst = false;
-                        }
-
-                        lastNonZero = std::max (lastNonZero, n + i);
-                    }
-                }
-            }
-            else
-            {
-                const int* const chan = chans[j];
-
-                for (int i = 0; i < sampsPerBlock; ++i)
-                {
-                    if (std::abs (chan[i]) > intMaxZeroLevel)
-                    {
-                        if (needFirst)
-                        {
-                            firstNonZero = n + i;
-                            needFirst = false;
-                        }
-
-                        lastNonZero = std::max (lastNonZero, n + i);
-                    }
-                }
-            }
-        }
-
-        n += sampsPerBlock;
-    }
-
-    return { firstNonZero, lastNonZero };
+    return analyser.getNonSilentRange();
 }
 
 static juce::int64 copySection (Engine& e, std::unique_ptr<juce::AudioFormatReader>& reader,
@@ -11,11 +11,17 @@
 namespace tracktion_engine
 {
 
-class AudioProxyGenerator
+/**
+    Renders proxy files on the BackgroundJobManager's threads.
+
+    Only a few jobs are run at once. The rest wait in a queue which is ordered so that
+    the proxies nearest the playhead, and those that are visible, are rendered first.
+*/
+class AudioProxyGenerator   : private juce::AsyncUpdater
 {
 public:
     AudioProxyGenerator();
-    ~AudioProxyGenerator();
+    ~AudioProxyGenerator() override;
 
     void deleteProxy (const AudioFile& proxyFile);
 
@@ -30,6 +36,12 @@ public:
 
         virtual bool render() = 0;
 
+        /** Returns a value used to decide which waiting jobs to start first, lower values
+            being started sooner. This is called on the message thread.
+            @see AudioProxyGenerator::getPriorityForEditTime
+        */
+        virtual double getSchedulingPriority()          { return 0.0; }
+
         float getCurrentTaskProgress() override         { return progress; }
 
         ThreadPoolJob::JobStatus runJob() override;
@@ -39,18 +51,36 @@ public:
         AudioFile proxy;
         std::atomic<float> progress { 0.0f };
 
+        /** Identifies what the proxy is being made for, e.g. a particular clip.
+            A new job with the same non-empty ID supersedes any older ones, so these are
+            removed if they haven't started yet, or stopped if they're already running.
+        */
+        juce::String ownerID;
+
     private:
+        bool hasStarted = false;
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GeneratorJob)
     };
 
     void beginJob (GeneratorJob*);
 
+    /** Returns a scheduling priority for a job rendering something that plays over the
+        given section of an Edit. Things that are visible and closest to the playhead
+        get the lowest values.
+    */
+    static double getPriorityForEditTime (Edit&, EditTimeRange);
+
 private:
-    juce::Array<GeneratorJob*> activeJobs;
+    juce::OwnedArray<GeneratorJob> queuedJobs;
+    juce::Array<GeneratorJob*> runningJobs;
+    juce::HashMap<juce::int64, GeneratorJob*> jobsByProxyHash;
     juce::CriticalSection jobListLock;
 
     GeneratorJob* findJob (const AudioFile&) const noexcept;
+    void removeSupersededJobs (const juce::String& ownerID);
     void removeFinishedJob (GeneratorJob*);
+    void handleAsyncUpdate() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProxyGenerator)
 };
@@ -0,0 +1,522 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+namespace OnsetEnvelopeHelpers
+{
+    struct Segment
+    {
+        std::unique_ptr<AudioFormatReader> reader;
+        int firstHop = 0, numHops = 0;
+        Array<Range<float>> channelRanges;
+    };
+
+    static void measureSegment (Segment& segment, double* energies, int hopSize, int64 lengthInSamples,
+                                const std::atomic<bool>& shouldStop, std::atomic<int>& numHopsDone)
+    {
+        auto& reader = *segment.reader;
+        const int numChannels = (int) reader.numChannels;
+        const int hopsPerBlock = 64;
+        AudioBuffer<float> buffer (numChannels, hopsPerBlock * hopSize);
+
+        segment.channelRanges.insertMultiple (0, {}, numChannels);
+        const int endHop = segment.firstHop + segment.numHops;
+
+        for (int hop = segment.firstHop; hop < endHop && ! shouldStop; hop += hopsPerBlock)
+        {
+            const int numHopsThisTime = std::min (hopsPerBlock, endHop - hop);
+            const int64 startSample = hop * (int64) hopSize;
+            const int numThisTime = (int) std::min ((int64) numHopsThisTime * hopSize, lengthInSamples - startSample);
+
+            reader.read (&buffer, 0, numThisTime, startSample, true, true);
+
+            for (int i = 0; i < numHopsThisTime; ++i)
+            {
+                const int offset = i * hopSize;
+                const int num = std::min (hopSize, numThisTime - offset);
+                double energy = 0;
+
+                for (int chan = 0; chan < numChannels; ++chan)
+                    energy += getSumOfSquares (buffer.getReadPointer (chan, offset), num);
+
+                energies[hop + i] = energy;
+            }
+
+            for (int chan = 0; chan < numChannels; ++chan)
+                segment.channelRanges.getReference (chan) = segment.channelRanges.getReference (chan)
+                                                              .getUnionWith (FloatVectorOperations::findMinAndMax (buffer.getReadPointer (chan), numThisTime));
+
+            numHopsDone += numHopsThisTime;
+        }
+    }
+}
+
+//==============================================================================
+OnsetEnvelope::Ptr OnsetEnvelope::analyse (Engine& engine, const File& file,
+                                           ThreadPoolJob* jobToCheck, std::atomic<float>* progress)
+{
+    return analyse ([&engine, file]() { return AudioFileUtils::createReaderFor (engine, file); },
+                    jobToCheck, progress);
+}
+
+OnsetEnvelope::Ptr OnsetEnvelope::analyse (std::function<AudioFormatReader*()> createReader,
+                                           ThreadPoolJob* jobToCheck, std::atomic<float>* progress)
+{
+    CRASH_TRACER
+    using namespace OnsetEnvelopeHelpers;
+
+    std::unique_ptr<AudioFormatReader> firstReader (createReader());
+
+    if (firstReader == nullptr
+         || firstReader->numChannels <= 0
+         || firstReader->lengthInSamples <= 0
+         || firstReader->sampleRate <= 0)
+        return {};
+
+    Ptr envelope (new OnsetEnvelope());
+    envelope->sampleRate = firstReader->sampleRate;
+    envelope->numSamples = firstReader->lengthInSamples;
+
+    BeatDetect detect;
+    detect.setSampleRate (envelope->sampleRate);
+    const int hopSize = envelope->hopSize = detect.getBlockSize();
+
+    if (hopSize <= 0)
+        return {};
+
+    // The last hop may be a partial one
+    const int numHops = (int) ((envelope->numSamples + hopSize - 1) / hopSize);
+    envelope->energies.resize ((size_t) numHops, 0.0);
+
+    // Sections of less than about ten seconds aren't worth the extra threads and readers
+    const int minHopsPerSegment = 430;
+    const int maxThreads = jlimit (1, 8, SystemStats::getNumCpus());
+    const int hopsPerSegment = std::max (minHopsPerSegment, (numHops + maxThreads - 1) / maxThreads);
+
+    OwnedArray<Segment> segments;
+
+    for (int hop = 0; hop < numHops; hop += hopsPerSegment)
+    {
+        auto s = segments.add (new Segment());
+        s->firstHop = hop;
+        s->numHops = std::min (hopsPerSegment, numHops - hop);
+        s->reader.reset (segments.size() == 1 ? firstReader.release() : createReader());
+
+        if (s->reader == nullptr)
+            return {};
+    }
+
+    std::atomic<bool> shouldStop { false };
+    std::atomic<int> numHopsDone { 0 };
+    auto energies = envelope->energies.data();
+    const auto length = envelope->numSamples;
+
+    // Short files are measured here, but longer ones always go on the pool so they can be stopped
+    if (numHops <= minHopsPerSegment)
+    {
+        measureSegment (*segments.getFirst(), energies, hopSize, length, shouldStop, numHopsDone);
+    }
+    else
+    {
+        ThreadPool pool (std::min (maxThreads, segments.size()));
+        std::atomic<int> numJobsRemaining { segments.size() };
+        WaitableEvent jobsFinished;
+
+        for (auto s : segments)
+        {
+            pool.addJob ([s, energies, hopSize, length, &shouldStop, &numHopsDone, &numJobsRemaining, &jobsFinished]
+                         {
+                             FloatVectorOperations::disableDenormalisedNumberSupport();
+                             measureSegment (*s, energies, hopSize, length, shouldStop, numHopsDone);
+
+                             if (--numJobsRemaining == 0)
+                                 jobsFinished.signal();
+                         });
+        }
+
+        while (numJobsRemaining.load() > 0)
+        {
+            jobsFinished.wait (50);
+
+            if (jobToCheck != nullptr && jobToCheck->shouldExit())
+                shouldStop = true;
+
+            if (progress != nullptr)
+                *progress = numHopsDone.load() / (float) numHops;
+        }
+    }
+
+    if (shouldStop || (jobToCheck != nullptr && jobToCheck->shouldExit()))
+        return {};
+
+    for (auto s : segments)
+    {
+        for (int chan = 0; chan < s->channelRanges.size(); ++chan)
+        {
+            if (chan < envelope->channelRanges.size())
+                envelope->channelRanges.getReference (chan) = envelope->channelRanges.getReference (chan)
+                                                                .getUnionWith (s->channelRanges.getReference (chan));
+            else
+                envelope->channelRanges.add (s->channelRanges.getReference (chan));
+        }
+    }
+
+    envelope->calculateOnsetStrengths();
+
+    if (progress != nullptr)
+        *progress = 1.0f;
+
+    return envelope;
+}
+
+void OnsetEnvelope::calculateOnsetStrengths()
+{
+    // This is done after the sections have been joined so the flux across their boundaries is
+    // the same as if the file had been read in one go. The floor stops silence giving huge jumps.
+    const double floorLevel = 1.0e-8 * hopSize;
+    double previous = std::log (floorLevel);
+
+    onsetStrengths.resize (energies.size());
+
+    for (size_t i = 0; i < energies.size(); ++i)
+    {
+        const double current = std::log (energies[i] + floorLevel);
+        onsetStrengths[i] = (float) std::max (0.0, current - previous);
+        previous = current;
+    }
+}
+
+Array<int64> OnsetEnvelope::findBeats (float sensitivity, Range<int64> sampleRange) const
+{
+    Array<int64> beats;
+
+    if (hopSize <= 0 || sampleRange.getLength() / sampleRate < 1.0)
+        return beats;
+
+    BeatDetect detect;
+    detect.setSensitivity (sensitivity);
+    detect.setSampleRate (sampleRate);
+    jassert (detect.getBlockSize() == hopSize);
+
+    // Only whole hops inside the range are used, as BeatDetect ignores any partial block at the end
+    const int firstHop = (int) ((std::max ((int64) 0, sampleRange.getStart()) + hopSize - 1) / hopSize);
+    const int lastHop = (int) std::min ((int64) getNumHops(), sampleRange.getEnd() / hopSize);
+
+    for (int i = firstHop; i < lastHop; ++i)
+        detect.pushEnergy (energies[(size_t) i]);
+
+    for (int i = 0; i < detect.getNumBeats(); ++i)
+        beats.add (detect.getBeat (i) + firstHop * (int64) hopSize);
+
+    return beats;
+}
+
+//==============================================================================
+void OnsetEnvelope::Builder::prepare (int numChannels, double sampleRate, int64 lengthInSamples)
+{
+    envelope = new OnsetEnvelope();
+    envelope->sampleRate = sampleRate;
+    envelope->numSamples = lengthInSamples;
+    result = nullptr;
+
+    BeatDetect detect;
+    detect.setSampleRate (sampleRate);
+    envelope->hopSize = detect.getBlockSize();
+
+    if (envelope->hopSize > 0)
+        envelope->energies.resize ((size_t) ((lengthInSamples + envelope->hopSize - 1) / envelope->hopSize), 0.0);
+
+    envelope->channelRanges.insertMultiple (0, {}, numChannels);
+}
+
+void OnsetEnvelope::Builder::process (const AudioBuffer<float>& block, int64 startSample, int numSamples)
+{
+    const auto hopSize = (int64) envelope->hopSize;
+
+    if (hopSize <= 0)
+        return;
+
+    for (int chan = 0; chan < block.getNumChannels(); ++chan)
+    {
+        auto data = block.getReadPointer (chan);
+        auto& range = envelope->channelRanges.getReference (chan);
+        range = range.getUnionWith (FloatVectorOperations::findMinAndMax (data, numSamples));
+
+        // The pipeline's blocks don't line up with the hops so each one can add to a hop that's already started
+        for (int i = 0; i < numSamples;)
+        {
+            const auto pos = startSample + i;
+            const auto hop = pos / hopSize;
+            const int numInHop = (int) std::min ((int64) (numSamples - i), (hop + 1) * hopSize - pos);
+
+            envelope->energies[(size_t) hop] += getSumOfSquares (data + i, numInHop);
+            i += numInHop;
+        }
+    }
+}
+
+void OnsetEnvelope::Builder::finish()
+{
+    if (envelope->hopSize <= 0)
+        return;
+
+    envelope->calculateOnsetStrengths();
+    result = envelope;
+}
+
+//==============================================================================
+OnsetEnvelopeCache::OnsetEnvelopeCache (Engine& e)  : engine (e)
+{
+}
+
+OnsetEnvelopeCache::~OnsetEnvelopeCache()
+{
+}
+
+const OnsetEnvelopeCache::Entry* OnsetEnvelopeCache::findEntry (const AudioFile& file) const
+{
+    auto found = entries.find (file.getHash());
+
+    if (found == entries.end() || found->second.modificationTime != file.getFile().getLastModificationTime())
+        return nullptr;
+
+    return &found->second;
+}
+
+OnsetEnvelopeCache::Entry& OnsetEnvelopeCache::getOrCreateEntry (const AudioFile& file)
+{
+    auto& entry = entries[file.getHash()];
+    const auto modificationTime = file.getFile().getLastModificationTime();
+
+    if (entry.modificationTime != modificationTime)
+    {
+        entry = Entry();
+        entry.modificationTime = modificationTime;
+    }
+
+    return entry;
+}
+
+OnsetEnvelope::Ptr OnsetEnvelopeCache::getEnvelope (const AudioFile& file, ThreadPoolJob* jobToCheck,
+                                                    std::atomic<float>* progress)
+{
+    if (file.isNull())
+        return {};
+
+    if (auto envelope = getCachedEnvelope (file))
+        return envelope;
+
+    // The lock isn't held while measuring so other files can still be looked up
+    auto& pipeline = engine.getAudioFileManager().analysisPipeline;
+    OnsetEnvelope::Ptr envelope;
+
+    // Long files are quicker to measure in sections on several threads, unless the pipeline's
+    // already going to read the file, in which case the envelope may as well share that pass
+    const double minLengthToMeasureInSections = 20.0;
+
+    if (SystemStats::getNumCpus() > 1
+         && file.getLength() >= minLengthToMeasureInSections
+         && ! pipeline.isAnalysing (file))
+    {
+        envelope = OnsetEnvelope::analyse (engine, file.getFile(), jobToCheck, progress);
+    }
+    else
+    {
+        OnsetEnvelope::Builder builder;
+
+        if (pipeline.runAnalysers (file, { &builder }, jobToCheck, progress))
+            envelope = builder.getEnvelope();
+    }
+
+    if (envelope != nullptr)
+    {
+        const ScopedLock sl (lock);
+        getOrCreateEntry (file).envelope = envelope;
+    }
+
+    return envelope;
+}
+
+OnsetEnvelope::Ptr OnsetEnvelopeCache::getCachedEnvelope (const AudioFile& file) const
+{
+    const ScopedLock sl (lock);
+
+    if (auto entry = findEntry (file))
+        return entry->envelope;
+
+    return {};
+}
+
+void OnsetEnvelopeCache::setCachedEnvelope (const AudioFile& file, OnsetEnvelope::Ptr envelope)
+{
+    if (file.isNull() || envelope == nullptr)
+        return;
+
+    const ScopedLock sl (lock);
+    getOrCreateEntry (file).envelope = envelope;
+}
+
+float OnsetEnvelopeCache::getCachedTempo (const AudioFile& file) const
+{
+    const ScopedLock sl (lock);
+
+    if (auto entry = findEntry (file))
+        return entry->bpm;
+
+    return -1.0f;
+}
+
+void OnsetEnvelopeCache::setCachedTempo (const AudioFile& file, float bpm)
+{
+    if (file.isNull())
+        return;
+
+    const ScopedLock sl (lock);
+    getOrCreateEntry (file).bpm = bpm;
+}
+
+void OnsetEnvelopeCache::releaseFile (const AudioFile& file)
+{
+    const ScopedLock sl (lock);
+    entries.erase (file.getHash());
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class OnsetEnvelopeTests  : public juce::UnitTest
+{
+public:
+    OnsetEnvelopeTests()
+        : juce::UnitTest ("OnsetEnvelope", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        // A minute of clicks every half second, long enough to be split into several sections
+        const double sampleRate = 44100.0;
+        const int64 length = (int64) (60 * sampleRate);
+
+        beginTest ("Measuring in sections");
+        auto envelope = OnsetEnvelope::analyse ([=]() { return new ClickReader (sampleRate, length); });
+        expect (envelope != nullptr);
+
+        if (envelope == nullptr)
+            return;
+
+        expectEquals (envelope->getNumSamples(), length);
+        expectEquals (envelope->getNumHops(), (int) ((length + envelope->getHopSize() - 1) / envelope->getHopSize()));
+        expectWithinAbsoluteError (envelope->getChannelRange (0).getEnd(), 1.0f, 0.0001f);
+
+        beginTest ("Beats match reading the whole file");
+        {
+            for (auto range : { Range<int64> (0, length), Range<int64> (0, length - 1000) })
+            {
+                const auto beats = envelope->findBeats (0.5f, range);
+                expect (beats.size() > 100);
+                expect (beats == getBeatsFromWholeFile (sampleRate, range.getEnd(), 0.5f));
+            }
+
+            expect (envelope->findBeats (0.5f, { 0, (int64) (sampleRate / 2) }).isEmpty());
+        }
+
+        beginTest ("Sections match a single pass");
+        {
+            ClickReader reader (sampleRate, length);
+            OnsetEnvelope::Builder builder;
+            Array<AudioAnalysisPipeline::Analyser*> analysers;
+            analysers.add (&builder);
+
+            expect (AudioAnalysisPipeline::processReader (reader, analysers));
+
+            if (auto singlePass = builder.getEnvelope())
+            {
+                expectEquals (singlePass->getNumHops(), envelope->getNumHops());
+
+                // The hops are summed in different sized pieces so can differ by rounding errors
+                float maxDifference = 0.0f;
+
+                for (int i = 0; i < std::min (singlePass->getNumHops(), envelope->getNumHops()); ++i)
+                    maxDifference = std::max (maxDifference, std::abs (singlePass->getOnsetStrengths()[(size_t) i]
+                                                                         - envelope->getOnsetStrengths()[(size_t) i]));
+
+                expectLessThan (maxDifference, 0.001f);
+            }
+            else
+            {
+                expect (false, "The single pass should have produced an envelope");
+            }
+        }
+
+        beginTest ("Onset strengths");
+        {
+            auto& strengths = envelope->getOnsetStrengths();
+            const int clickHop = (int) ((int64) (sampleRate * 10.0) / envelope->getHopSize());
+            expect (strengths[(size_t) clickHop] > 1.0f);
+            expectEquals (strengths[(size_t) clickHop + 1], 0.0f);
+        }
+    }
+
+    Array<int64> getBeatsFromWholeFile (double sampleRate, int64 length, float sensitivity)
+    {
+        ClickReader reader (sampleRate, length);
+        BeatAnalyser analyser (sensitivity);
+        Array<AudioAnalysisPipeline::Analyser*> analysers;
+        analysers.add (&analyser);
+
+        AudioAnalysisPipeline::processReader (reader, analysers);
+        return analyser.getBeats();
+    }
+
+    //==============================================================================
+    struct ClickReader  : public AudioFormatReader
+    {
+        ClickReader (double rate, int64 length)
+            : AudioFormatReader (nullptr, "Clicks")
+        {
+            sampleRate = rate;
+            lengthInSamples = length;
+            numChannels = 2;
+            bitsPerSample = 32;
+            usesFloatingPointData = true;
+        }
+
+        bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                          int64 startSampleInFile, int numSamples) override
+        {
+            const auto clickPeriod = (int64) (sampleRate / 2);
+
+            for (int chan = 0; chan < numDestChannels; ++chan)
+            {
+                if (auto dest = reinterpret_cast<float*> (destSamples[chan]))
+                {
+                    dest += startOffsetInDestBuffer;
+
+                    for (int i = 0; i < numSamples; ++i)
+                    {
+                        const auto posInClick = (startSampleInFile + i) % clickPeriod;
+                        dest[i] = posInClick < 100 ? (float) std::cos (posInClick * 0.3) * (1.0f - posInClick / 100.0f)
+                                                   : 0.0f;
+                    }
+                }
+            }
+
+            return true;
+        }
+    };
+};
+
+static OnsetEnvelopeTests onsetEnvelopeTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
+} // namespace tracktion_engine
@@ -0,0 +1,151 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+/**
+    The energy of an audio file measured over short hops, and the onset strength
+    derived from it.
+
+    The hops are the same size as BeatDetect's blocks, so beats can be found from the
+    envelope without reading the file again. Long files are split into sections that
+    are measured at the same time on a few threads and then joined back together.
+    @see OnsetEnvelopeCache
+*/
+class OnsetEnvelope  : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<OnsetEnvelope>;
+
+    /** Measures a file, returning nullptr if it couldn't be read or the job should exit. */
+    static Ptr analyse (Engine&, const juce::File&,
+                        juce::ThreadPoolJob* jobToCheck = nullptr,
+                        std::atomic<float>* progress = nullptr);
+
+    /** Measures a source, calling the function once for each reader it needs.
+        Each reader is only used by one thread, so these can read the same source at once.
+    */
+    static Ptr analyse (std::function<juce::AudioFormatReader*()> createReader,
+                        juce::ThreadPoolJob* jobToCheck = nullptr,
+                        std::atomic<float>* progress = nullptr);
+
+    //==============================================================================
+    double getSampleRate() const noexcept               { return sampleRate; }
+    int getHopSize() const noexcept                     { return hopSize; }
+    juce::int64 getNumSamples() const noexcept          { return numSamples; }
+    int getNumHops() const noexcept                     { return (int) energies.size(); }
+
+    /** Returns the sum of the squares of all the channels, for each hop. */
+    const std::vector<double>& getEnergies() const noexcept         { return energies; }
+
+    /** Returns how much the log energy rises into each hop, or 0 where it falls. */
+    const std::vector<float>& getOnsetStrengths() const noexcept    { return onsetStrengths; }
+
+    /** Returns the lowest and highest sample values of a channel. */
+    juce::Range<float> getChannelRange (int channel) const noexcept { return channelRanges[channel]; }
+
+    /** Finds beats in a range of the file in the same way as BeatDetect, returning their
+        sample positions. Nothing is found if the range is less than a second long.
+    */
+    juce::Array<juce::int64> findBeats (float sensitivity, juce::Range<juce::int64> sampleRange) const;
+
+    //==============================================================================
+    /** Measures an envelope from the blocks an AudioAnalysisPipeline reads, so it can share
+        the pass with the file's other analysers.
+    */
+    class Builder  : public AudioAnalysisPipeline::Analyser
+    {
+    public:
+        Builder() = default;
+
+        /** Returns the envelope once the whole file has been seen. */
+        Ptr getEnvelope() const noexcept            { return result; }
+
+        void prepare (int, double, juce::int64) override;
+        void process (const juce::AudioBuffer<float>&, juce::int64, int) override;
+        void finish() override;
+
+    private:
+        Ptr envelope, result;
+    };
+
+private:
+    //==============================================================================
+    double sampleRate = 0;
+    int hopSize = 0;
+    juce::int64 numSamples = 0;
+    std::vector<double> energies;
+    std::vector<float> onsetStrengths;
+    juce::Array<juce::Range<float>> channelRanges;
+
+    OnsetEnvelope() = default;
+    void calculateOnsetStrengths();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OnsetEnvelope)
+};
+
+//==============================================================================
+/**
+    Keeps the OnsetEnvelope and detected tempo of audio files so they only need to be
+    worked out once, however many clips use them.
+
+    Results are dropped if the file's been modified since they were measured.
+*/
+class OnsetEnvelopeCache
+{
+public:
+    OnsetEnvelopeCache (Engine&);
+    ~OnsetEnvelopeCache();
+
+    /** Returns the envelope for a file, measuring it if it isn't already known and waiting
+        for it on the calling thread. Long files are measured in sections with
+        OnsetEnvelope::analyse, and anything else in the AudioFileManager's analysis pipeline.
+        This returns nullptr if the file can't be read or the job should exit.
+    */
+    OnsetEnvelope::Ptr getEnvelope (const AudioFile&, juce::ThreadPoolJob* jobToCheck = nullptr,
+                                    std::atomic<float>* progress = nullptr);
+
+    /** Returns the envelope for a file if it's already been measured. */
+    OnsetEnvelope::Ptr getCachedEnvelope (const AudioFile&) const;
+
+    /** Stores an envelope that was measured alongside something else. */
+    void setCachedEnvelope (const AudioFile&, OnsetEnvelope::Ptr);
+
+    /** Returns the tempo that was detected for a file, or a negative value if it's not known. */
+    float getCachedTempo (const AudioFile&) const;
+
+    /** Stores the tempo detected for a file. */
+    void setCachedTempo (const AudioFile&, float bpm);
+
+    /** Forgets everything about a file, e.g. because it's changed. */
+    void releaseFile (const AudioFile&);
+
+private:
+    Engine& engine;
+
+    struct Entry
+    {
+        juce::Time modificationTime;
+        OnsetEnvelope::Ptr envelope;
+        float bpm = -1.0f;
+    };
+
+    std::map<juce::int64, Entry> entries;
+    juce::CriticalSection lock;
+
+    const Entry* findEntry (const AudioFile&) const;
+    Entry& getOrCreateEntry (const AudioFile&);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OnsetEnvelopeCache)
+};
+
+} // namespace tracktion_engine
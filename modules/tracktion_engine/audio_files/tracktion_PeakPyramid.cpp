@@ -0,0 +1,567 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+static_assert (sizeof (PeakPyramid::Peak) == 4, "Peaks are written straight to disk so must be packed");
+
+namespace PeakPyramidHelpers
+{
+    static const char magic[] = { 'T', 'P', 'Y', 'R' };
+    static constexpr int version = 1;
+    static constexpr int headerSize = 40;
+    static constexpr int levelHeaderSize = 16;
+
+    static PeakPyramid::Peak quantise (float minValue, float maxValue, float rms) noexcept
+    {
+        PeakPyramid::Peak p;
+        p.minValue = (int8) jlimit (-127, 127, roundToInt (minValue * 127.0f));
+        p.maxValue = (int8) jlimit (-127, 127, roundToInt (maxValue * 127.0f));
+        p.rms = (uint8) jlimit (0, 255, roundToInt (rms * 255.0f));
+
+        // Like the thumbnails, silent sections still get a line drawn
+        if (p.minValue == p.maxValue)
+        {
+            if (p.maxValue == 127)
+                --p.minValue;
+            else
+                ++p.maxValue;
+        }
+
+        return p;
+    }
+
+    static PeakPyramid::Peak combinePeaks (const PeakPyramid::Peak* peaks, int64 first, int64 last,
+                                           int numChannels, int channel) noexcept
+    {
+        if (last <= first)
+            return {};
+
+        int minValue = 127, maxValue = -127;
+        float sumSquares = 0.0f;
+
+        for (auto i = first; i < last; ++i)
+        {
+            auto& p = peaks[i * numChannels + channel];
+            minValue = jmin (minValue, (int) p.minValue);
+            maxValue = jmax (maxValue, (int) p.maxValue);
+
+            const float rms = p.rms / 255.0f;
+            sumSquares += rms * rms;
+        }
+
+        PeakPyramid::Peak result;
+        result.minValue = (int8) minValue;
+        result.maxValue = (int8) maxValue;
+        result.rms = (uint8) jlimit (0, 255, roundToInt (255.0f * std::sqrt (sumSquares / (float) (last - first))));
+        return result;
+    }
+}
+
+//==============================================================================
+PeakPyramid::Ptr PeakPyramid::load (const File& file)
+{
+    if (! file.existsAsFile())
+        return {};
+
+    Ptr p (new PeakPyramid());
+    p->mappedFile = std::make_unique<MemoryMappedFile> (file, MemoryMappedFile::readOnly);
+
+    if (p->mappedFile->getData() != nullptr
+         && p->parse (p->mappedFile->getData(), p->mappedFile->getSize()))
+        return p;
+
+    return {};
+}
+
+bool PeakPyramid::parse (const void* data, size_t numBytes)
+{
+    using namespace PeakPyramidHelpers;
+
+    if (numBytes < (size_t) headerSize || memcmp (data, magic, sizeof (magic)) != 0)
+        return false;
+
+    MemoryInputStream in (data, numBytes, false);
+    in.skipNextBytes (sizeof (magic));
+
+    if (in.readInt() != version)
+        return false;
+
+    numChannels = in.readInt();
+    const int numLevels = in.readInt();
+    sampleRate = in.readDouble();
+    numSamples = in.readInt64();
+
+    if (in.readInt() != baseSamplesPerPeak || in.readInt() != levelRatio)
+        return false;
+
+    if (numChannels <= 0 || numLevels <= 0 || numLevels > 32 || sampleRate <= 0 || numSamples <= 0
+         || numBytes < (size_t) (headerSize + numLevels * levelHeaderSize))
+        return false;
+
+    for (int i = 0; i < numLevels; ++i)
+    {
+        const auto offset = in.readInt64();
+        const auto numPeaks = in.readInt64();
+
+        if (offset < 0 || numPeaks <= 0
+             || (uint64) (offset + numPeaks * numChannels * (int64) sizeof (Peak)) > (uint64) numBytes)
+            return false;
+
+        levels.add (Level { static_cast<const Peak*> (addBytesToPointer (data, offset)), numPeaks });
+    }
+
+    return true;
+}
+
+PeakPyramid::Ptr PeakPyramid::build (AudioFormatReader& reader, const File& destFile,
+                                     ThreadPoolJob* job, std::atomic<float>& progress)
+{
+    Builder builder (destFile);
+    Array<AudioAnalysisPipeline::Analyser*> analysers;
+    analysers.add (&builder);
+
+    if (AudioAnalysisPipeline::processReader (reader, analysers, job, &progress))
+        return builder.getPyramid();
+
+    return {};
+}
+
+//==============================================================================
+PeakPyramid::Builder::Builder (const File& dest)  : destFile (dest)
+{
+}
+
+void PeakPyramid::Builder::prepare (int numChans, double rate, int64 length)
+{
+    numChannels = numChans;
+    sampleRate = rate;
+    numSamples = length;
+    numInPeak = 0;
+    result = nullptr;
+
+    firstLevel.clear();
+    firstLevel.reserve ((size_t) (((length + baseSamplesPerPeak - 1) / baseSamplesPerPeak) * numChans));
+    partialPeaks.assign ((size_t) numChans, PartialPeak());
+}
+
+void PeakPyramid::Builder::process (const AudioBuffer<float>& block, int64, int numToProcess)
+{
+    using namespace PeakPyramidHelpers;
+
+    // Blocks don't have to line up with the peaks, so a peak can be built up over several of them
+    for (int pos = 0; pos < numToProcess;)
+    {
+        const int num = std::min (numToProcess - pos, (int) baseSamplesPerPeak - numInPeak);
+
+        for (int chan = 0; chan < numChannels; ++chan)
+        {
+            auto* data = block.getReadPointer (chan, pos);
+            auto range = FloatVectorOperations::findMinAndMax (data, num);
+            auto& p = partialPeaks[(size_t) chan];
+
+            if (numInPeak == 0)
+            {
+                p.minValue = range.getStart();
+                p.maxValue = range.getEnd();
+                p.sumSquares = 0.0f;
+            }
+            else
+            {
+                p.minValue = jmin (p.minValue, range.getStart());
+                p.maxValue = jmax (p.maxValue, range.getEnd());
+            }
+
+            p.sumSquares += getSumOfSquares (data, num);
+        }
+
+        numInPeak += num;
+        pos += num;
+
+        if (numInPeak == baseSamplesPerPeak)
+            addPeaks();
+    }
+}
+
+void PeakPyramid::Builder::addPeaks()
+{
+    for (auto& p : partialPeaks)
+        firstLevel.push_back (PeakPyramidHelpers::quantise (p.minValue, p.maxValue, std::sqrt (p.sumSquares / numInPeak)));
+
+    numInPeak = 0;
+}
+
+void PeakPyramid::Builder::finish()
+{
+    CRASH_TRACER
+    using namespace PeakPyramidHelpers;
+
+    if (numInPeak > 0)
+        addPeaks();
+
+    if (numChannels <= 0 || firstLevel.empty())
+        return;
+
+    std::vector<std::vector<Peak>> levelData;
+    levelData.push_back (std::move (firstLevel));
+
+    // Each level is made by combining the peaks of the one below
+    for (;;)
+    {
+        const auto& below = levelData.back();
+        const auto numBelow = (int64) below.size() / numChannels;
+
+        if (numBelow <= 1)
+            break;
+
+        const auto numPeaks = (numBelow + levelRatio - 1) / levelRatio;
+        std::vector<Peak> level ((size_t) (numPeaks * numChannels));
+
+        for (int64 i = 0; i < numPeaks; ++i)
+            for (int chan = 0; chan < numChannels; ++chan)
+                level[(size_t) (i * numChannels + chan)] = combinePeaks (below.data(), i * levelRatio,
+                                                                         std::min (numBelow, (i + 1) * levelRatio),
+                                                                         numChannels, chan);
+
+        levelData.push_back (std::move (level));
+    }
+
+    firstLevel.clear();
+
+    if (write (levelData))
+        result = load (destFile);
+}
+
+bool PeakPyramid::Builder::write (const std::vector<std::vector<Peak>>& levelData) const
+{
+    using namespace PeakPyramidHelpers;
+
+    destFile.getParentDirectory().createDirectory();
+    TemporaryFile temp (destFile);
+
+    {
+        FileOutputStream out (temp.getFile());
+
+        if (! out.openedOk())
+            return false;
+
+        out.write (magic, sizeof (magic));
+        out.writeInt (version);
+        out.writeInt (numChannels);
+        out.writeInt ((int) levelData.size());
+        out.writeDouble (sampleRate);
+        out.writeInt64 (numSamples);
+        out.writeInt (baseSamplesPerPeak);
+        out.writeInt (levelRatio);
+
+        auto offset = (int64) (headerSize + (int) levelData.size() * levelHeaderSize);
+
+        for (auto& level : levelData)
+        {
+            out.writeInt64 (offset);
+            out.writeInt64 ((int64) level.size() / numChannels);
+            offset += (int64) (level.size() * sizeof (Peak));
+        }
+
+        for (auto& level : levelData)
+            out.write (level.data(), level.size() * sizeof (Peak));
+
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+//==============================================================================
+int64 PeakPyramid::getSamplesPerPeak (int level) const noexcept
+{
+    auto samplesPerPeak = (int64) baseSamplesPerPeak;
+
+    for (int i = 0; i < level; ++i)
+        samplesPerPeak *= levelRatio;
+
+    return samplesPerPeak;
+}
+
+int PeakPyramid::chooseLevel (double samplesPerPixel) const noexcept
+{
+    int level = 0;
+
+    while (level + 1 < levels.size() && getSamplesPerPeak (level + 1) <= samplesPerPixel)
+        ++level;
+
+    return level;
+}
+
+PeakPyramid::Peak PeakPyramid::combine (int level, int channel, int64 start, int64 end) const noexcept
+{
+    auto& l = levels.getReference (level);
+    return PeakPyramidHelpers::combinePeaks (l.peaks, jlimit ((int64) 0, l.numPeaks, start),
+                                             jlimit ((int64) 0, l.numPeaks, end),
+                                             numChannels, channel);
+}
+
+void PeakPyramid::getPeaks (int channel, double startSample, double samplesPerPixel,
+                            Peak* dest, int numPixels) const noexcept
+{
+    if (! isPositiveAndBelow (channel, numChannels) || samplesPerPixel <= 0)
+    {
+        std::fill (dest, dest + numPixels, Peak());
+        return;
+    }
+
+    const int level = chooseLevel (samplesPerPixel);
+    const auto samplesPerPeak = (double) getSamplesPerPeak (level);
+
+    for (int i = 0; i < numPixels; ++i)
+    {
+        const double pixelStart = startSample + i * samplesPerPixel;
+        const auto first = (int64) std::floor (pixelStart / samplesPerPeak);
+        const auto last = std::max (first + 1, (int64) std::ceil ((pixelStart + samplesPerPixel) / samplesPerPeak));
+
+        dest[i] = combine (level, channel, first, last);
+    }
+}
+
+PeakPyramid::Peak PeakPyramid::getPeak (int channel, Range<int64> sampleRange) const noexcept
+{
+    if (! isPositiveAndBelow (channel, numChannels) || sampleRange.isEmpty())
+        return {};
+
+    // Picking the level from the whole range means only a handful of peaks get combined
+    const int level = chooseLevel ((double) sampleRange.getLength());
+    const auto samplesPerPeak = getSamplesPerPeak (level);
+
+    return combine (level, channel, sampleRange.getStart() / samplesPerPeak,
+                    (sampleRange.getEnd() + samplesPerPeak - 1) / samplesPerPeak);
+}
+
+float PeakPyramid::getApproximatePeak() const noexcept
+{
+    if (levels.isEmpty())
+        return 0.0f;
+
+    const int top = levels.size() - 1;
+    int highest = 0;
+
+    for (int chan = 0; chan < numChannels; ++chan)
+    {
+        auto p = combine (top, chan, 0, levels.getReference (top).numPeaks);
+        highest = jmax (highest, std::abs ((int) p.minValue), std::abs ((int) p.maxValue));
+    }
+
+    return jlimit (0.0f, 1.0f, highest / 127.0f);
+}
+
+//==============================================================================
+PeakPyramidCache::PeakPyramidCache (Engine& e)  : engine (e)
+{
+}
+
+PeakPyramidCache::~PeakPyramidCache()
+{
+}
+
+File PeakPyramidCache::getPyramidFile (const AudioFile& file) const
+{
+    return engine.getTemporaryFileManager().getThumbnailsFolder()
+             .getChildFile ("peaks_" + String::toHexString (file.getHash())
+                              + "_" + String::toHexString (file.getFile().getLastModificationTime().toMilliseconds())
+                              + ".peaks");
+}
+
+PeakPyramid::Ptr PeakPyramidCache::getPyramid (const AudioFile& file)
+{
+    if (file.isNull())
+        return {};
+
+    const auto hash = file.getHash();
+    const ScopedLock sl (lock);
+
+    // A null entry means a build failed, so the caller should fall back to reading the file
+    auto found = pyramids.find (hash);
+
+    if (found != pyramids.end())
+        return found->second;
+
+    if (activeBuilds.find (hash) != activeBuilds.end())
+        return {};
+
+    auto pyramidFile = getPyramidFile (file);
+
+    if (auto p = PeakPyramid::load (pyramidFile))
+    {
+        pyramids[hash] = p;
+        return p;
+    }
+
+    auto builder = std::make_unique<PeakPyramid::Builder> (pyramidFile);
+    auto builderPtr = builder.get();
+
+    // This lock is held until the build's been added so the callback can't get in first
+    auto analyserID = engine.getAudioFileManager().analysisPipeline
+                        .addAnalyser (file, std::move (builder),
+                                      [this, hash] (AudioAnalysisPipeline::Analyser& a, bool completed)
+                                      {
+                                          buildFinished (hash, static_cast<PeakPyramid::Builder&> (a), completed);
+                                      });
+
+    activeBuilds[hash] = { analyserID, builderPtr };
+
+    return {};
+}
+
+bool PeakPyramidCache::isBuilding (const AudioFile& file) const
+{
+    const ScopedLock sl (lock);
+    return activeBuilds.find (file.getHash()) != activeBuilds.end();
+}
+
+void PeakPyramidCache::releasePyramid (const AudioFile& file)
+{
+    const auto hash = file.getHash();
+    const ScopedLock sl (lock);
+
+    pyramids.erase (hash);
+
+    auto found = activeBuilds.find (hash);
+
+    if (found != activeBuilds.end())
+    {
+        engine.getAudioFileManager().analysisPipeline.cancel (found->second.analyserID);
+        activeBuilds.erase (found);
+    }
+}
+
+void PeakPyramidCache::buildFinished (int64 hash, const PeakPyramid::Builder& builder, bool completed)
+{
+    const ScopedLock sl (lock);
+
+    // If the file was released while building, a newer build may have replaced this one
+    auto found = activeBuilds.find (hash);
+
+    if (found == activeBuilds.end() || found->second.builder != &builder)
+        return;
+
+    activeBuilds.erase (found);
+    pyramids[hash] = completed ? builder.getPyramid() : nullptr;
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class PeakPyramidTests  : public juce::UnitTest
+{
+public:
+    PeakPyramidTests()
+        : juce::UnitTest ("PeakPyramid", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        // Ten seconds of a half-level sine in the left channel and silence in the right
+        SineReader reader (44100.0, 441000, 0.5f);
+        TemporaryFile tempFile (".peaks");
+        std::atomic<float> progress { 0.0f };
+
+        beginTest ("Building");
+        auto pyramid = PeakPyramid::build (reader, tempFile.getFile(), nullptr, progress);
+        expect (pyramid != nullptr);
+
+        if (pyramid == nullptr)
+            return;
+
+        expectEquals (progress.load(), 1.0f);
+        expectEquals (pyramid->getNumChannels(), 2);
+        expectEquals (pyramid->getNumSamples(), (int64) 441000);
+        expect (pyramid->getSamplesPerPeak (pyramid->getNumLevels() - 1) >= pyramid->getNumSamples());
+        expectWithinAbsoluteError (pyramid->getApproximatePeak(), 0.5f, 0.01f);
+
+        beginTest ("Levels");
+        for (double samplesPerPixel : { 100.0, 256.0, 1000.0, 20000.0, 441000.0 })
+        {
+            const int numPixels = (int) std::ceil (441000 / samplesPerPixel);
+            std::vector<PeakPyramid::Peak> left ((size_t) numPixels), right ((size_t) numPixels);
+            pyramid->getPeaks (0, 0.0, samplesPerPixel, left.data(), numPixels);
+            pyramid->getPeaks (1, 0.0, samplesPerPixel, right.data(), numPixels);
+
+            // Each pixel covers at least one whole cycle of the 1KHz sine
+            if (samplesPerPixel >= 256.0)
+            {
+                expectWithinAbsoluteError ((int) left[0].maxValue, 64, 1);
+                expectWithinAbsoluteError ((int) left[0].minValue, -64, 1);
+                expectWithinAbsoluteError ((int) left[0].rms, roundToInt (255 * 0.5 / MathConstants<double>::sqrt2), 2);
+            }
+
+            expect (right[0].maxValue - right[0].minValue == 1);
+            expectEquals ((int) right[0].rms, 0);
+        }
+
+        beginTest ("Loading");
+        {
+            auto loaded = PeakPyramid::load (tempFile.getFile());
+            expect (loaded != nullptr);
+
+            if (loaded != nullptr)
+            {
+                expectEquals (loaded->getNumLevels(), pyramid->getNumLevels());
+                auto p1 = pyramid->getPeak (0, { 1000, 50000 });
+                auto p2 = loaded->getPeak (0, { 1000, 50000 });
+                expect (p1.minValue == p2.minValue && p1.maxValue == p2.maxValue && p1.rms == p2.rms);
+            }
+
+            expect (PeakPyramid::load (File()) == nullptr);
+        }
+    }
+
+    //==============================================================================
+    struct SineReader  : public AudioFormatReader
+    {
+        SineReader (double rate, int64 length, float level)
+            : AudioFormatReader (nullptr, "Sine"), gain (level)
+        {
+            sampleRate = rate;
+            lengthInSamples = length;
+            numChannels = 2;
+            bitsPerSample = 32;
+            usesFloatingPointData = true;
+        }
+
+        bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                          int64 startSampleInFile, int numSamples) override
+        {
+            for (int chan = 0; chan < numDestChannels; ++chan)
+            {
+                if (auto dest = reinterpret_cast<float*> (destSamples[chan]))
+                {
+                    dest += startOffsetInDestBuffer;
+
+                    for (int i = 0; i < numSamples; ++i)
+                        dest[i] = chan == 0 ? gain * (float) std::sin (MathConstants<double>::twoPi * 1000.0 * (startSampleInFile + i) / sampleRate)
+                                            : 0.0f;
+                }
+            }
+
+            return true;
+        }
+
+        const float gain;
+    };
+};
+
+static PeakPyramidTests peakPyramidTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
+} // namespace tracktion_engine
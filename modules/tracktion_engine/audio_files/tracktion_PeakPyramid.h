@@ -0,0 +1,174 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+/**
+    A multi-resolution store of the min, max and RMS levels of an audio file.
+
+    The first level holds a peak for every baseSamplesPerPeak samples and each level
+    above that combines levelRatio peaks of the one below. To draw any zoom level, the
+    coarsest level that still has at least one peak per pixel is used, so only a few
+    peaks ever need to be combined for each pixel.
+
+    These are built in a single pass over the file and saved in a format that can be
+    memory mapped, so opening one is cheap and the data is shared by everything using it.
+    @see PeakPyramidCache
+*/
+class PeakPyramid  : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<PeakPyramid>;
+
+    /** The levels of a section of one channel, with the min and max scaled to -127 to 127
+        and the RMS to 0 to 255.
+    */
+    struct Peak
+    {
+        juce::int8 minValue = 0, maxValue = 0;
+        juce::uint8 rms = 0, reserved = 0;
+    };
+
+    enum
+    {
+        baseSamplesPerPeak = 256,
+        levelRatio = 4
+    };
+
+    /** Opens a file previously created with build(), returning nullptr if it's not valid. */
+    static Ptr load (const juce::File&);
+
+    /** Reads the whole of a source, writes a pyramid for it to a file and returns it.
+        The job is checked periodically and if it should exit, this gives up and returns nullptr.
+    */
+    static Ptr build (juce::AudioFormatReader&, const juce::File& destFile,
+                      juce::ThreadPoolJob* job, std::atomic<float>& progress);
+
+    //==============================================================================
+    /** Builds a pyramid from the blocks of a file, writing it to disk when it's finished. */
+    class Builder  : public AudioAnalysisPipeline::Analyser
+    {
+    public:
+        Builder (const juce::File& destFile);
+
+        /** Returns the pyramid after the whole file has been processed, or nullptr if it couldn't be written. */
+        Ptr getPyramid() const                      { return result; }
+
+        void prepare (int numChannels, double sampleRate, juce::int64 lengthInSamples) override;
+        void process (const juce::AudioBuffer<float>&, juce::int64, int numSamples) override;
+        void finish() override;
+
+    private:
+        struct PartialPeak
+        {
+            float minValue = 0, maxValue = 0, sumSquares = 0;
+        };
+
+        const juce::File destFile;
+        std::vector<Peak> firstLevel;
+        std::vector<PartialPeak> partialPeaks;
+        int numChannels = 0, numInPeak = 0;
+        double sampleRate = 0;
+        juce::int64 numSamples = 0;
+        Ptr result;
+
+        void addPeaks();
+        bool write (const std::vector<std::vector<Peak>>&) const;
+    };
+
+    //==============================================================================
+    int getNumChannels() const noexcept                 { return numChannels; }
+    double getSampleRate() const noexcept               { return sampleRate; }
+    juce::int64 getNumSamples() const noexcept          { return numSamples; }
+    int getNumLevels() const noexcept                   { return levels.size(); }
+
+    /** Returns the number of source samples each peak at a level covers. */
+    juce::int64 getSamplesPerPeak (int level) const noexcept;
+
+    /** Fills one Peak per pixel, starting at a source sample position. */
+    void getPeaks (int channel, double startSample, double samplesPerPixel,
+                   Peak* dest, int numPixels) const noexcept;
+
+    /** Returns the combined levels of a range of source samples. */
+    Peak getPeak (int channel, juce::Range<juce::int64> sampleRange) const noexcept;
+
+    /** Returns the highest level in the whole file, from 0 to 1. */
+    float getApproximatePeak() const noexcept;
+
+private:
+    //==============================================================================
+    struct Level
+    {
+        const Peak* peaks;      // interleaved by channel
+        juce::int64 numPeaks;
+    };
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    juce::Array<Level> levels;
+    int numChannels = 0;
+    double sampleRate = 0;
+    juce::int64 numSamples = 0;
+
+    PeakPyramid() = default;
+    bool parse (const void* data, size_t numBytes);
+
+    int chooseLevel (double samplesPerPixel) const noexcept;
+    Peak combine (int level, int channel, juce::int64 start, juce::int64 end) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PeakPyramid)
+};
+
+//==============================================================================
+/**
+    Keeps the PeakPyramids for audio files, building them on the AudioAnalysisPipeline when needed.
+
+    The pyramid files are kept in the engine's thumbnail folder and named after the
+    source file and its modification time so they're shared by all Edits, and an
+    out-of-date one is never used.
+*/
+class PeakPyramidCache
+{
+public:
+    PeakPyramidCache (Engine&);
+    ~PeakPyramidCache();
+
+    /** Returns the pyramid for a file if it's been built, otherwise this starts building
+        it and returns nullptr. Call again later to check if it's ready.
+    */
+    PeakPyramid::Ptr getPyramid (const AudioFile&);
+
+    /** Returns true if a pyramid for the file is being built. */
+    bool isBuilding (const AudioFile&) const;
+
+    /** Forgets about any pyramid for a file, e.g. because it's changed. */
+    void releasePyramid (const AudioFile&);
+
+private:
+    Engine& engine;
+
+    struct ActiveBuild
+    {
+        int analyserID;
+        const AudioAnalysisPipeline::Analyser* builder;
+    };
+
+    std::map<juce::int64, PeakPyramid::Ptr> pyramids;
+    std::map<juce::int64, ActiveBuild> activeBuilds;
+    juce::CriticalSection lock;
+
+    juce::File getPyramidFile (const AudioFile&) const;
+    void buildFinished (juce::int64 hash, const PeakPyramid::Builder&, bool completed);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PeakPyramidCache)
+};
+
+} // namespace tracktion_engine
@@ -355,10 +355,11 @@ public:
     void drawChannel (juce::Graphics& g, juce::Rectangle<int> area, bool useHighRes,
                       EditTimeRange time, int channelNum, float verticalZoomFactor,
                       double rate, int numChans, int sampsPerThumbSample,
-                      LevelDataSource* levelData, const juce::OwnedArray<ThumbData>& chans)
+                      LevelDataSource* levelData, const PeakPyramid* pyramid,
+                      const juce::OwnedArray<ThumbData>& chans)
     {
         if (refillCache (area.getWidth(), time, rate,
-                         numChans, sampsPerThumbSample, levelData, chans)
+                         numChans, sampsPerThumbSample, levelData, pyramid, chans)
             && juce::isPositiveAndBelow (channelNum, numChannelsCached))
         {
             auto clip = g.getClipBounds().withTrimmedRight (useHighRes ? -1 : 0)
@@ -474,7 +475,8 @@ private:
 
     bool refillCache (int numSamples, EditTimeRange time,
                       double rate, int numChans, int sampsPerThumbSample,
-                      LevelDataSource* levelData, const juce::OwnedArray<ThumbData>& chans)
+                      LevelDataSource* levelData, const PeakPyramid* pyramid,
+                      const juce::OwnedArray<ThumbData>& chans)
     {
         auto timePerPixel = time.getLength() / numSamples;
 
@@ -549,6 +551,19 @@ private:
 
             numSamplesCached = i;
         }
+        else if (pyramid != nullptr)
+        {
+            juce::HeapBlock<PeakPyramid::Peak> peaks ((size_t) numSamples);
+
+            for (int channelNum = 0; channelNum < numChannelsCached; ++channelNum)
+            {
+                pyramid->getPeaks (channelNum, cachedStart * rate, timePerPixel * rate, peaks, numSamples);
+                MinMaxValue* cacheData = getData (channelNum, 0);
+
+                for (int i = 0; i < numSamples; ++i)
+                    cacheData[i].set (peaks[i].minValue, peaks[i].maxValue);
+            }
+        }
         else
         {
             jassert (chans.size() == numChannelsCached);
@@ -627,6 +642,7 @@ void TracktionThumbnail::clearChannelData()
     const juce::ScopedLock sl (lock);
     window->invalidate();
     channels.clear();
+    pyramid = nullptr;
     totalSamples = numSamplesFinished = 0;
     numChannels = 0;
     sampleRate = 0;
@@ -751,6 +767,40 @@ void TracktionThumbnail::setReader (juce::AudioFormatReader* newReader, juce::in
         setDataSource (new LevelDataSource (*this, newReader, hash));
 }
 
+void TracktionThumbnail::setPeakPyramid (PeakPyramid::Ptr newPyramid, juce::AudioFormatReader* newReader, juce::int64 hash)
+{
+    clear();
+
+    if (newPyramid == nullptr)
+    {
+        delete newReader;
+        return;
+    }
+
+    {
+        const juce::ScopedLock sl (sourceLock);
+
+        if (newReader != nullptr)
+        {
+            // The pyramid has all the levels so this source is only read from when zoomed right in
+            source.reset (new LevelDataSource (*this, newReader, hash));
+            source->lengthInSamples = newPyramid->getNumSamples();
+            source->sampleRate = newPyramid->getSampleRate();
+            source->numChannels = (unsigned int) newPyramid->getNumChannels();
+            source->numSamplesFinished = source->lengthInSamples;
+        }
+    }
+
+    const juce::ScopedLock sl (lock);
+    pyramid = newPyramid;
+    numChannels = (juce::int32) pyramid->getNumChannels();
+    sampleRate = pyramid->getSampleRate();
+    totalSamples = numSamplesFinished = pyramid->getNumSamples();
+
+    window->invalidate();
+    sendChangeMessage();
+}
+
 void TracktionThumbnail::releaseResources()
 {
     const juce::ScopedLock sl (sourceLock);
@@ -851,6 +901,10 @@ juce::int64 TracktionThumbnail::getNumSamplesFinished() const noexcept
 float TracktionThumbnail::getApproximatePeak() const
 {
     const juce::ScopedLock sl (lock);
+
+    if (pyramid != nullptr)
+        return pyramid->getApproximatePeak();
+
     int peak = 0;
 
     for (int i = channels.size(); --i >= 0;)
@@ -866,7 +920,13 @@ void TracktionThumbnail::getApproximateMinMax (double startTime, double endTime,
     MinMaxValue result;
     auto* data = channels[channelIndex];
 
-    if (data != nullptr && sampleRate > 0)
+    if (pyramid != nullptr && sampleRate > 0)
+    {
+        auto peak = pyramid->getPeak (channelIndex, { (juce::int64) (startTime * sampleRate),
+                                                      (juce::int64) std::ceil (endTime * sampleRate) });
+        result.set (peak.minValue, peak.maxValue);
+    }
+    else if (data != nullptr && sampleRate > 0)
     {
         auto firstThumbIndex = (int) ((startTime * sampleRate) / samplesPerThumbSample);
         auto lastThumbIndex  = (int) (((endTime * sampleRate) + samplesPerThumbSample - 1) / samplesPerThumbSample);
@@ -895,7 +955,7 @@ void TracktionThumbnail::drawChannel (juce::Graphics& g, juce::Rectangle<int> ar
     const juce::ScopedLock sl (lock);
 
     window->drawChannel (g, area, useHighRes, time, channelNum, verticalZoomFactor,
-                         sampleRate, numChannels, samplesPerThumbSample, source.get(), channels);
+                         sampleRate, numChannels, samplesPerThumbSample, source.get(), pyramid.get(), channels);
 }
 
 void TracktionThumbnail::drawChannels (juce::Graphics& g, juce::Rectangle<int> area, bool useHighRes,
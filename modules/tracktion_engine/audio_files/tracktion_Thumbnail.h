@@ -34,6 +34,11 @@ public:
     bool setSource (juce::InputSource*) override;
     void setReader (juce::AudioFormatReader*, juce::int64 hash) override;
 
+    /** Uses a PeakPyramid for the levels instead of scanning the file.
+        The reader is optional and only used when zoomed in closer than the pyramid's first level.
+    */
+    void setPeakPyramid (PeakPyramid::Ptr, juce::AudioFormatReader*, juce::int64 hash);
+
     void releaseResources();
 
     juce::int64 getHashCode() const override;
@@ -70,6 +75,7 @@ private:
     std::unique_ptr<LevelDataSource> source;
     std::unique_ptr<CachedWindow> window;
     juce::OwnedArray<ThumbData> channels;
+    PeakPyramid::Ptr pyramid;
 
     juce::int32 samplesPerThumbSample = 0;
     juce::int64 totalSamples = 0, numSamplesFinished = 0;
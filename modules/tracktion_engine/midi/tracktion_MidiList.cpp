@@ -1773,6 +1773,61 @@ void MidiList::importFromEditTimeSequenceWithNoteExpression (const juce::MidiMes
         importedName = TRANS("channel") + " " + juce::String (channelNumber);
 }
 
+//==============================================================================
+MidiList::PlaybackNotes::Ptr MidiList::getPlaybackNotes() const
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    jassert (noteList != nullptr);
+
+    auto& notes = getNotes();
+    auto firstChangedBeat = noteList->getAndResetFirstChangedBeat();
+
+    if (playbackNotes != nullptr && firstChangedBeat == std::numeric_limits<double>::max())
+    {
+        jassert (playbackNotes->size() == notes.size());
+        return playbackNotes;
+    }
+
+    PlaybackNotes::Ptr newNotes (new PlaybackNotes());
+    const auto numNotes = (size_t) notes.size();
+    size_t numUnchanged = 0;
+
+    if (playbackNotes != nullptr)
+    {
+        // Everything before the first change is still in the same place so can be copied
+        auto& oldBeats = playbackNotes->startBeats;
+        numUnchanged = std::min (numNotes, (size_t) std::distance (oldBeats.begin(),
+                                                                   std::lower_bound (oldBeats.begin(), oldBeats.end(), firstChangedBeat)));
+    }
+
+    newNotes->startBeats.reserve (numNotes);
+    newNotes->lengthBeats.reserve (numNotes);
+    newNotes->noteNumbers.reserve (numNotes);
+    newNotes->velocities.reserve (numNotes);
+
+    if (numUnchanged > 0)
+    {
+        auto& oldNotes = *playbackNotes;
+        newNotes->startBeats.assign (oldNotes.startBeats.begin(), oldNotes.startBeats.begin() + (std::ptrdiff_t) numUnchanged);
+        newNotes->lengthBeats.assign (oldNotes.lengthBeats.begin(), oldNotes.lengthBeats.begin() + (std::ptrdiff_t) numUnchanged);
+        newNotes->noteNumbers.assign (oldNotes.noteNumbers.begin(), oldNotes.noteNumbers.begin() + (std::ptrdiff_t) numUnchanged);
+        newNotes->velocities.assign (oldNotes.velocities.begin(), oldNotes.velocities.begin() + (std::ptrdiff_t) numUnchanged);
+    }
+
+    for (auto i = numUnchanged; i < numNotes; ++i)
+    {
+        auto& n = *notes.getUnchecked ((int) i);
+        newNotes->startBeats.push_back (n.getStartBeat());
+        newNotes->lengthBeats.push_back (n.getLengthBeats());
+        newNotes->noteNumbers.push_back ((juce::uint8) n.getNoteNumber());
+        newNotes->velocities.push_back ((juce::uint8) n.getVelocity());
+    }
+
+    playbackNotes = newNotes;
+
+    return newNotes;
+}
+
 //==============================================================================
 void MidiList::exportToPlaybackMidiSequence (juce::MidiMessageSequence& destSequence, MidiClip& clip, bool generateMPE) const
 {
@@ -1796,40 +1851,72 @@ void MidiList::exportToPlaybackMidiSequence (juce::MidiMessageSequence& destSequ
 
     if (! generateMPE)
     {
-        for (int i = 0; i < numNotes; ++i)
+        // The overlap checks only need the times and note numbers so use the flat arrays
+        // rather than dereferencing every subsequent note. A looped clip's list is thrown
+        // away whenever the clip changes, so there's nothing to gain from keeping a copy of
+        // its notes and they're gathered into temporary arrays instead
+        PlaybackNotes::Ptr playback;
+
+        if (this == &clip.getSequence())
         {
-            auto& note = *notes.getUnchecked (i);
+            playback = getPlaybackNotes();
+        }
+        else
+        {
+            playback = new PlaybackNotes();
+            playback->startBeats.reserve ((size_t) numNotes);
+            playback->lengthBeats.reserve ((size_t) numNotes);
+            playback->noteNumbers.reserve ((size_t) numNotes);
 
-            if (selectedEvents != nullptr && ! selectedEvents->isSelected (&note))
-                continue;
+            for (auto n : notes)
+            {
+                playback->startBeats.push_back (n->getStartBeat());
+                playback->lengthBeats.push_back (n->getLengthBeats());
+                playback->noteNumbers.push_back ((juce::uint8) n->getNoteNumber());
+            }
+        }
+
+        jassert (playback->size() == numNotes);
+        auto startBeats = playback->startBeats.data();
+        auto lengthBeats = playback->lengthBeats.data();
+        auto noteNumbers = playback->noteNumbers.data();
 
+        for (int i = 0; i < numNotes; ++i)
+        {
             // check for subsequent overlaps
-            auto thisNoteStart = note.getStartBeat();
+            auto thisNoteStart = startBeats[i];
 
             if (thisNoteStart >= lastNoteTime)
                 break;
 
-            auto thisNoteEnd = note.getEndBeat();
-            auto noteNum = note.getNoteNumber();
+            auto thisNoteEnd = thisNoteStart + lengthBeats[i];
+
+            if (thisNoteEnd <= firstNoteTime)
+                continue;
+
+            auto& note = *notes.getUnchecked (i);
+
+            if (selectedEvents != nullptr && ! selectedEvents->isSelected (&note))
+                continue;
+
+            auto noteNum = noteNumbers[i];
             bool useNoteUp = true;
 
             for (int j = i + 1; j < numNotes; ++j)
             {
-                const auto& note2 = *notes.getUnchecked (j);
-                const double s = note2.getStartBeat();
+                const double s = startBeats[j];
 
                 if (s >= lastNoteTime || s >= thisNoteEnd)
                     break;
 
-                if (note2.getNoteNumber() == noteNum)
+                if (noteNumbers[j] == noteNum)
                 {
                     useNoteUp = false;
                     break;
                 }
             }
 
-            if (thisNoteEnd > firstNoteTime)
-                addToSequence (destSequence, clip, note, channelNumber, useNoteUp, grooveTemplate);
+            addToSequence (destSequence, clip, note, channelNumber, useNoteUp, grooveTemplate);
         }
     }
     else
@@ -1885,4 +1972,76 @@ void MidiList::exportToPlaybackMidiSequence (juce::MidiMessageSequence& destSequ
     }
 }
 
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class MidiListTests : public juce::UnitTest
+{
+public:
+    MidiListTests() : juce::UnitTest ("MidiList", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        beginTest ("Incremental sorting");
+        {
+            juce::Random r (1234);
+            MidiList list;
+
+            for (int i = 0; i < 500; ++i)
+                list.addNote (r.nextInt (128), r.nextInt (64) * 0.25, 0.5, 100, 0, nullptr);
+
+            expectSortedAndMatchesPlaybackNotes (list);
+
+            for (int i = 0; i < 20; ++i)
+            {
+                auto note = list.getNote (r.nextInt (list.getNumNotes()));
+                note->setStartAndLength (r.nextInt (64) * 0.25, 1.0, nullptr);
+                note->setVelocity (r.nextInt (128), nullptr);
+            }
+
+            expectSortedAndMatchesPlaybackNotes (list);
+
+            for (int i = 0; i < 10; ++i)
+            {
+                list.removeNote (*list.getNote (r.nextInt (list.getNumNotes())), nullptr);
+                list.addNote (r.nextInt (128), r.nextInt (64) * 0.25, 0.25, 64, 0, nullptr);
+            }
+
+            expectSortedAndMatchesPlaybackNotes (list);
+            expectEquals (list.getNumNotes(), 500);
+
+            list.moveAllBeatPositions (1.0, nullptr);
+            expectSortedAndMatchesPlaybackNotes (list);
+
+            auto playbackNotes = list.getPlaybackNotes();
+            expect (list.getPlaybackNotes() == playbackNotes);
+        }
+    }
+
+    void expectSortedAndMatchesPlaybackNotes (MidiList& list)
+    {
+        auto& notes = list.getNotes();
+        auto playbackNotes = list.getPlaybackNotes();
+        expectEquals (playbackNotes->size(), notes.size());
+
+        for (int i = 0; i < notes.size(); ++i)
+        {
+            auto& n = *notes.getUnchecked (i);
+
+            if (i > 0)
+                expect (notes.getUnchecked (i - 1)->getStartBeat() <= n.getStartBeat());
+
+            expectEquals (playbackNotes->startBeats[(size_t) i], n.getStartBeat());
+            expectEquals (playbackNotes->lengthBeats[(size_t) i], n.getLengthBeats());
+            expectEquals ((int) playbackNotes->noteNumbers[(size_t) i], n.getNoteNumber());
+            expectEquals ((int) playbackNotes->velocities[(size_t) i], n.getVelocity());
+        }
+    }
+};
+
+static MidiListTests midiListTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
 }
@@ -130,6 +130,32 @@ public:
     // Add equivalent events to the sequence, for playback
     void exportToPlaybackMidiSequence (juce::MidiMessageSequence&, MidiClip&, bool generateMPE) const;
 
+    //==============================================================================
+    /** An immutable copy of the notes, sorted by time, with each property held in
+        its own contiguous array so they can be iterated quickly.
+        Once created this doesn't change, so it can be safely used on any thread.
+
+        This is kept up to date for a clip's own takes and used when exporting them for
+        playback. Playback itself still uses the exported sequence, as that's where the
+        groove, quantisation and MPE expression are applied.
+    */
+    struct PlaybackNotes  : public juce::ReferenceCountedObject
+    {
+        using Ptr = juce::ReferenceCountedObjectPtr<PlaybackNotes>;
+
+        int size() const noexcept                                   { return (int) startBeats.size(); }
+
+        std::vector<double> startBeats, lengthBeats;
+        std::vector<juce::uint8> noteNumbers, velocities;
+    };
+
+    /** Returns a PlaybackNotes for the current state of the list.
+        If the notes have changed since the last call, a new one is created which
+        copies the notes before the earliest change from the previous one and only
+        rebuilds the rest. This must be called on the message thread.
+    */
+    PlaybackNotes::Ptr getPlaybackNotes() const;
+
     //==============================================================================
     static bool looksLikeMPEData (const juce::File&);
 
@@ -172,6 +198,7 @@ private:
     juce::CachedValue<bool> isComp;
 
     juce::String importedName;
+    mutable PlaybackNotes::Ptr playbackNotes;
 
     void initialise (juce::UndoManager*);
 
@@ -210,21 +237,50 @@ private:
         bool isSuitableType (const juce::ValueTree& v) const override   { return EventDelegate<EventType>::isSuitableType (v); }
         EventType* createNewObject (const juce::ValueTree& v) override  { return new EventType (v); }
         void deleteObject (EventType* m) override                       { delete m; }
-        void newObjectAdded (EventType*) override                       { triggerSort(); }
-        void objectRemoved (EventType* m) override                      { EventDelegate<EventType>::removeFromSelection (m); triggerSort(); }
         void objectOrderChanged() override                              { triggerSort(); }
 
+        void newObjectAdded (EventType* e) override
+        {
+            const juce::ScopedLock sl (lock);
+            markChangedFrom (e->getBeatPosition());
+            removedEvents.removeFirstMatchingValue (e);
+            addChangedEvent (e);
+        }
+
+        void objectRemoved (EventType* m) override
+        {
+            EventDelegate<EventType>::removeFromSelection (m);
+
+            const juce::ScopedLock sl (lock);
+            markChangedFrom (m->getBeatPosition());
+            changedEvents.removeFirstMatchingValue (m);
+
+            if (! needsSorting)
+                removedEvents.addIfNotAlreadyThere (m);
+        }
+
         void valueTreePropertyChanged (juce::ValueTree& v, const juce::Identifier& i) override
         {
             if (auto e = getEventFor (v))
-                if (EventDelegate<EventType>::updateObject (*e, i))
-                    triggerSort();
+            {
+                auto oldBeat = e->getBeatPosition();
+                const bool orderMayHaveChanged = EventDelegate<EventType>::updateObject (*e, i);
+
+                const juce::ScopedLock sl (lock);
+                markChangedFrom (std::min (oldBeat, e->getBeatPosition()));
+
+                if (orderMayHaveChanged)
+                    addChangedEvent (e);
+            }
         }
 
         void triggerSort()
         {
             const juce::ScopedLock sl (lock);
             needsSorting = true;
+            changedEvents.clearQuick();
+            removedEvents.clearQuick();
+            markChangedFrom (std::numeric_limits<double>::lowest());
         }
 
         const juce::Array<EventType*>& getSortedList()
@@ -238,15 +294,114 @@ private:
                 needsSorting = false;
                 sortedEvents = ValueTreeObjectList<EventType>::objects;
                 sortMidiEventsByTime (sortedEvents);
+
+                sortedBeats.clear();
+                sortedBeats.reserve ((size_t) sortedEvents.size());
+
+                for (auto e : sortedEvents)
+                    sortedBeats.push_back (e->getBeatPosition());
+            }
+            else if (! (changedEvents.isEmpty() && removedEvents.isEmpty()))
+            {
+                mergeChangedEvents();
             }
 
             return sortedEvents;
         }
 
+        /** Returns the earliest beat affected by any change since this was last called. */
+        double getAndResetFirstChangedBeat()
+        {
+            const juce::ScopedLock sl (lock);
+            return std::exchange (firstChangedBeat, std::numeric_limits<double>::max());
+        }
+
+    private:
+        // Beyond this many changes it's quicker to just re-sort the whole list
+        static constexpr int maxNumIncrementalChanges = 256;
+
         bool needsSorting = true;
-        juce::Array<EventType*> sortedEvents;
+        juce::Array<EventType*> sortedEvents, changedEvents, removedEvents;
+        std::vector<double> sortedBeats; // the positions of sortedEvents when they were last sorted
+        double firstChangedBeat = std::numeric_limits<double>::lowest();
         juce::CriticalSection lock;
 
+        void markChangedFrom (double beat) noexcept
+        {
+            firstChangedBeat = std::min (firstChangedBeat, beat);
+        }
+
+        void addChangedEvent (EventType* e)
+        {
+            if (needsSorting)
+                return;
+
+            if (changedEvents.size() + removedEvents.size() >= maxNumIncrementalChanges)
+                triggerSort();
+            else
+                changedEvents.addIfNotAlreadyThere (e);
+        }
+
+        /** Removes the stale entries from the sorted list and merges the changed events
+            back in at their new positions. The unchanged events are compared using the
+            positions cached when they were sorted, so only the changed events are
+            dereferenced rather than re-sorting the whole list.
+            N.B. removed events have been deleted so must only be compared by address.
+        */
+        void mergeChangedEvents()
+        {
+            sortMidiEventsByTime (changedEvents);
+
+            std::vector<EventType*> staleEvents (changedEvents.begin(), changedEvents.end());
+            staleEvents.insert (staleEvents.end(), removedEvents.begin(), removedEvents.end());
+            std::sort (staleEvents.begin(), staleEvents.end());
+
+            std::vector<double> changedBeats;
+            changedBeats.reserve ((size_t) changedEvents.size());
+
+            for (auto e : changedEvents)
+                changedBeats.push_back (e->getBeatPosition());
+
+            juce::Array<EventType*> merged;
+            std::vector<double> mergedBeats;
+            merged.ensureStorageAllocated (sortedEvents.size() + changedEvents.size());
+            mergedBeats.reserve ((size_t) (sortedEvents.size() + changedEvents.size()));
+
+            const auto numChanged = changedBeats.size();
+            size_t nextChanged = 0;
+
+            auto addChanged = [&]
+            {
+                merged.add (changedEvents.getUnchecked ((int) nextChanged));
+                mergedBeats.push_back (changedBeats[nextChanged]);
+                ++nextChanged;
+            };
+
+            for (int i = 0; i < sortedEvents.size(); ++i)
+            {
+                auto e = sortedEvents.getUnchecked (i);
+
+                if (std::binary_search (staleEvents.begin(), staleEvents.end(), e))
+                    continue;
+
+                auto beat = sortedBeats[(size_t) i];
+
+                while (nextChanged < numChanged && changedBeats[nextChanged] < beat)
+                    addChanged();
+
+                merged.add (e);
+                mergedBeats.push_back (beat);
+            }
+
+            while (nextChanged < numChanged)
+                addChanged();
+
+            sortedEvents.swapWith (merged);
+            sortedBeats.swap (mergedBeats);
+            changedEvents.clearQuick();
+            removedEvents.clearQuick();
+        }
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EventList)
     };
 
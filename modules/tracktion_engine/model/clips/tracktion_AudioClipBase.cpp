@@ -245,6 +245,618 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimestretchingPreviewAudioNode)
 };
 
+//==============================================================================
+/**
+    Renders one segment of an AudioSegmentList, stretching it from the source file.
+    The output sample rate can differ from the file's, in which case the resampling
+    is done by the time-stretcher as part of the speed and pitch change.
+*/
+struct StretchSegment
+{
+    StretchSegment (Engine& engine, const AudioFile& file,
+                    const AudioClipBase::ProxyRenderingInfo& info,
+                    double outputSampleRate, const AudioSegmentList::Segment& s)
+        : segment (s),
+          fileInfo (file.getInfo()),
+          sampleRate (outputSampleRate),
+          fileSpeedRatio (fileInfo.sampleRate / outputSampleRate),
+          crossfadeSamples ((int) (sampleRate * info.audioSegmentList->getCrossfadeLength())),
+          fifo (jmax (1, fileInfo.numChannels), outputBufferSize)
+    {
+        CRASH_TRACER
+        reader = engine.getAudioFileManager().cache.createReader (file);
+
+        if (reader != nullptr)
+        {
+            if (! segment.isFollowedBySilence())
+                reader->setLoopRange (segment.getSampleRange());
+
+            timestretcher.initialise (sampleRate, outputBufferSize, fileInfo.numChannels,
+                                      info.mode, info.options, false);
+
+            setPosition (0.0);
+        }
+    }
+
+    /** Moves the segment to a time relative to the start of the segment list.
+        Rendering should then continue with blocks starting at this time.
+    */
+    void setPosition (double time)
+    {
+        if (reader == nullptr)
+            return;
+
+        auto outputPos = jmax ((int64) 0, (int64) ((time - segment.getRange().getStart()) * sampleRate));
+        auto sourceOffset = (int64) (outputPos * segment.getStretchRatio() * fileSpeedRatio);
+
+        if (segment.isFollowedBySilence())
+            reader->setReadPosition (segment.getSampleRange().getStart() + sourceOffset);
+        else
+            reader->setReadPosition (sourceOffset);
+
+        timestretcher.reset();
+        timestretcher.setSpeedAndPitch ((float) (1.0 / (segment.getStretchRatio() * fileSpeedRatio)),
+                                        segment.getTranspose() + (float) (12.0 * std::log2 (fileSpeedRatio)));
+
+        readySamplesStart = 0;
+        readySamplesEnd = 0;
+        readySampleOutputPos = outputPos;
+    }
+
+    void renderNextBlock (juce::AudioBuffer<float>& buffer, EditTimeRange editTime, int numSamples)
+    {
+        if (reader == nullptr)
+            return;
+
+        CRASH_TRACER
+
+        auto loopRange = segment.getRange();
+
+        if (! editTime.overlaps (loopRange))
+            return;
+
+        int start = 0;
+
+        if (loopRange.getEnd() < editTime.getEnd())
+            numSamples = jmax (0, (int) (numSamples * (loopRange.getEnd() - editTime.getStart()) / editTime.getLength()));
+
+        if (loopRange.getStart() > editTime.getStart())
+        {
+            int skip = jlimit (0, numSamples, (int) (numSamples * (loopRange.getStart() - editTime.getStart()) / editTime.getLength()));
+            start += skip;
+            numSamples -= skip;
+        }
+
+        while (numSamples > 0)
+        {
+            const int numReady = jmin (numSamples, readySamplesEnd - readySamplesStart);
+
+            if (numReady > 0)
+            {
+                for (int i = 0; i < buffer.getNumChannels(); ++i)
+                    buffer.addFrom (i, start, fifo, jmin (i, fifo.getNumChannels() - 1), readySamplesStart, numReady);
+
+                readySamplesStart += numReady;
+                start += numReady;
+                numSamples -= numReady;
+            }
+            else
+            {
+                fillNextBlock();
+                renderFades();
+
+                readySampleOutputPos += outputBufferSize;
+            }
+        }
+    }
+
+    void fillNextBlock()
+    {
+        CRASH_TRACER
+        float* outs[] = { fifo.getWritePointer (0),
+                          fileInfo.numChannels > 1 ? fifo.getWritePointer (1) : nullptr,
+                          nullptr };
+
+        const int needed = timestretcher.getFramesNeeded();
+
+        if (needed >= 0)
+        {
+            AudioScratchBuffer scratch (fileInfo.numChannels, needed);
+            const AudioChannelSet bufferChannels = AudioChannelSet::canonicalChannelSet (fileInfo.numChannels);
+            const AudioChannelSet channelsToUse = AudioChannelSet::stereo();
+
+            if (needed > 0)
+            {
+               #if JUCE_DEBUG
+                jassert (reader->readSamples (needed, scratch.buffer, bufferChannels, 0, channelsToUse, 5000));
+               #else
+                reader->readSamples (needed, scratch.buffer, bufferChannels, 0, channelsToUse, 5000);
+               #endif
+            }
+
+            const float* ins[] = { scratch.buffer.getReadPointer (0),
+                                   fileInfo.numChannels > 1 ? scratch.buffer.getReadPointer (1) : nullptr,
+                                   nullptr };
+
+            timestretcher.processData (ins, needed, outs);
+        }
+        else
+        {
+            jassert (needed == -1);
+            timestretcher.flush (outs);
+        }
+
+        readySamplesStart = 0;
+        readySamplesEnd = outputBufferSize;
+    }
+
+    void renderFades()
+    {
+        CRASH_TRACER
+        auto renderedEnd = readySampleOutputPos + outputBufferSize;
+
+        if (segment.hasFadeIn())
+            if (readySampleOutputPos < crossfadeSamples)
+                renderFade (0, crossfadeSamples, false);
+
+        if (segment.hasFadeOut())
+        {
+            auto fadeOutStart = (int64) (segment.getSampleRange().getLength() / (segment.getStretchRatio() * fileSpeedRatio)) - crossfadeSamples;
+
+            if (renderedEnd > fadeOutStart)
+                renderFade (fadeOutStart, fadeOutStart + crossfadeSamples + 2, true);
+        }
+    }
+
+    void renderFade (int64 start, int64 end, bool isFadeOut)
+    {
+        float alpha1 = 0.0f, alpha2 = 1.0f;
+        auto renderedEnd = readySampleOutputPos + outputBufferSize;
+
+        if (end > renderedEnd)
+        {
+            alpha2 = (renderedEnd - start) / (float) (end - start);
+            end = renderedEnd;
+        }
+
+        if (start < readySampleOutputPos)
+        {
+            alpha1 = alpha2 * (readySampleOutputPos - start) / (float) (end - start);
+            start = readySampleOutputPos;
+        }
+
+        if (end > start)
+        {
+            if (isFadeOut)
+            {
+                alpha1 = 1.0f - alpha1;
+                alpha2 = 1.0f - alpha2;
+            }
+
+            AudioFadeCurve::applyCrossfadeSection (fifo,
+                                                   (int) (start - readySampleOutputPos),
+                                                   (int) (end - start),
+                                                   AudioFadeCurve::convex, alpha1, alpha2);
+        }
+    }
+
+    const AudioSegmentList::Segment& segment;
+    TimeStretcher timestretcher;
+
+    AudioFileInfo fileInfo;
+    AudioFileCache::Reader::Ptr reader;
+
+    const double sampleRate, fileSpeedRatio;
+    const int outputBufferSize = 1024;
+    int readySamplesStart = 0, readySamplesEnd = 0;
+    int64 readySampleOutputPos = 0;
+    const int crossfadeSamples;
+    juce::AudioBuffer<float> fifo;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StretchSegment)
+};
+
+//==============================================================================
+/**
+    AudioNode that time-stretches a clip from its source file as it plays.
+
+    This renders the same segments as the clip's time-stretched proxy would, but does it
+    on a background thread a little ahead of the playhead. That means a clip can be heard
+    as soon as its tempo, warp or pitch settings change instead of having to wait for a
+    new proxy to be rendered.
+
+    The background thread follows the transport's loop so the FIFO stays full across the
+    loop point, switching to a second set of stretchers that have been pre-rolled up to the
+    loop start so there's no gap while they warm up. Any other jump in the playhead makes it start again from the new position,
+    and playback resumes as soon as it has rendered one block from there.
+*/
+class AudioClipBase::TimeStretchingAudioNode  : public AudioNode,
+                                                private TimeSliceClient
+{
+public:
+    TimeStretchingAudioNode (AudioClipBase& clip, LiveClipLevel level)
+        : engine (clip.edit.engine), file (clip.getAudioFile()),
+          fileInfo (file.getInfo()),
+          renderInfo (clip.createProxyRenderingInfo()),
+          clipLevel (level),
+          numChannels (jlimit (1, 2, fileInfo.numChannels))
+    {
+    }
+
+    ~TimeStretchingAudioNode() override
+    {
+        lookAheadThread->removeTimeSliceClient (this);
+    }
+
+    void getAudioNodeProperties (AudioNodeProperties& info) override
+    {
+        info.hasAudio           = true;
+        info.hasMidi            = false;
+        info.numberOfChannels   = numChannels;
+    }
+
+    void visitNodes (const VisitorFn& v) override
+    {
+        v (*this);
+    }
+
+    bool purgeSubNodes (bool keepAudio, bool /*keepMidi*/) override
+    {
+        return keepAudio;
+    }
+
+    void releaseAudioNodeResources() override
+    {
+        lookAheadThread->removeTimeSliceClient (this);
+    }
+
+    void prepareAudioNodeToPlay (const PlaybackInitialisationInfo& info) override
+    {
+        CRASH_TRACER
+        lookAheadThread->removeTimeSliceClient (this);
+
+        sampleRate = info.sampleRate;
+        streamLength = (int64) (renderInfo->clipTime.getLength() * sampleRate);
+        createSegments (segments);
+        createSegments (loopStartSegments);
+        preRollBuffer.setSize (numChannels, (int) (sampleRate * preRollSeconds));
+
+        const int fifoSize = jmax (info.blockSizeSamples * 4, (int) (sampleRate * lookAheadSeconds));
+        fifoBuffer.setSize (numChannels, fifoSize);
+        fifo.setTotalSize (fifoSize);
+        numSamplesNeededToStart = jmin (fifoSize, info.blockSizeSamples);
+
+        isRenderingSynchronously = false;
+        loopRange = {};
+        requestSeek (editTimeToStreamSample (info.startTime));
+
+        lookAheadThread->addTimeSliceClient (this);
+    }
+
+    bool isReadyToRender() override
+    {
+        return true;
+    }
+
+    void renderOver (const AudioRenderContext& rc) override
+    {
+        callRenderAdding (rc);
+    }
+
+    void renderAdding (const AudioRenderContext& rc) override
+    {
+        invokeSplitRender (rc, *this);
+    }
+
+    void renderSection (const AudioRenderContext& rc, EditTimeRange editTime)
+    {
+        if (rc.destBuffer == nullptr || rc.bufferNumSamples == 0
+             || editTime.getLength() <= 0.0 || segments.isEmpty())
+            return;
+
+        SCOPED_REALTIME_CHECK
+
+        float gains[2];
+
+        // For stereo, use the pan, otherwise ignore it
+        if (rc.destBuffer->getNumChannels() == 2)
+            clipLevel.getLeftAndRightGains (gains[0], gains[1]);
+        else
+            gains[0] = gains[1] = clipLevel.getGainIncludingMute();
+
+        if (rc.playhead.isUserDragging())
+        {
+            gains[0] *= 0.4f;
+            gains[1] *= 0.4f;
+        }
+
+        const auto start = editTimeToStreamSample (editTime.getStart());
+
+        if (rc.isRendering)
+            renderSynchronously (rc, start, gains);
+        else
+            renderFromFifo (rc, start, gains);
+    }
+
+private:
+    //==============================================================================
+    /** The thread shared by all the nodes to render their look-ahead. */
+    struct LookAheadThread  : public TimeSliceThread
+    {
+        LookAheadThread()  : TimeSliceThread ("Time-stretch Look-ahead")    { startThread (7); }
+        ~LookAheadThread() override                                         { stopThread (10000); }
+    };
+
+    SharedResourcePointer<LookAheadThread> lookAheadThread;
+
+    Engine& engine;
+    AudioFile file;
+    AudioFileInfo fileInfo;
+    std::unique_ptr<ProxyRenderingInfo> renderInfo;
+    LiveClipLevel clipLevel;
+    const int numChannels;
+
+    static constexpr double lookAheadSeconds = 0.5, preRollSeconds = 0.1;
+    static constexpr int renderBlockSize = 512, maxDriftSamples = 2;
+
+    double sampleRate = 44100.0;
+    int64 streamLength = 0;
+    int numSamplesNeededToStart = 0;
+    OwnedArray<StretchSegment> segments, loopStartSegments;
+
+    // The FIFO is written by the look-ahead thread and read by the audio thread.
+    // A seek bumps the requested generation and the audio thread then ignores the
+    // FIFO until the look-ahead thread has rendered a block for that generation.
+    juce::AudioBuffer<float> fifoBuffer;
+    AbstractFifo fifo { 1 };
+    std::atomic<int64> requestedPosition { 0 }, requestedLoopStart { 0 }, requestedLoopEnd { 0 };
+    std::atomic<int> requestedGeneration { 0 }, readyGeneration { -1 };
+
+    // Only used on the audio thread
+    int64 readPosition = 0;
+    Range<int64> loopRange;
+    bool isRenderingSynchronously = false;
+
+    // Only used on the look-ahead thread, or the render thread when rendering synchronously
+    int64 writePosition = 0;
+    Range<int64> workerLoopRange;
+    int renderedGeneration = -1;
+    juce::AudioBuffer<float> preRollBuffer;
+    bool loopStartSegmentsReady = false;
+
+    /** Stream samples are at the output sample rate, relative to the start of the clip. */
+    int64 editTimeToStreamSample (double editTime) const noexcept
+    {
+        return (int64) std::floor ((editTime - renderInfo->clipTime.getStart()) * sampleRate + 0.5);
+    }
+
+    //==============================================================================
+    void requestSeek (int64 position) noexcept
+    {
+        requestedPosition.store (position, std::memory_order_relaxed);
+        requestedLoopStart.store (loopRange.getStart(), std::memory_order_relaxed);
+        requestedLoopEnd.store (loopRange.getEnd(), std::memory_order_relaxed);
+        requestedGeneration.fetch_add (1, std::memory_order_release);
+        readPosition = position;
+    }
+
+    void updateLoopRange (const AudioRenderContext& rc, int64 start)
+    {
+        Range<int64> newLoopRange;
+
+        if (rc.playhead.isLooping())
+        {
+            auto loop = rc.playhead.getLoopTimes();
+            newLoopRange = { editTimeToStreamSample (loop.getStart()), editTimeToStreamSample (loop.getEnd()) };
+        }
+
+        if (newLoopRange != loopRange)
+        {
+            loopRange = newLoopRange;
+            requestSeek (start);
+        }
+    }
+
+    void renderFromFifo (const AudioRenderContext& rc, int64 start, const float* gains)
+    {
+        updateLoopRange (rc, start);
+
+        if (requestedGeneration.load (std::memory_order_relaxed) != readyGeneration.load (std::memory_order_acquire))
+            return; // still catching up after a seek
+
+        const int numSamples = rc.bufferNumSamples;
+        auto offset = start - readPosition;
+
+        if (std::abs (offset) <= maxDriftSamples)
+            offset = 0;
+
+        if (offset < 0 || offset + numSamples > fifo.getNumReady())
+        {
+            // Either the playhead has jumped or the look-ahead has fallen behind
+            requestSeek (start);
+            return;
+        }
+
+        if (offset > 0)
+            fifo.finishedRead ((int) offset);
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (numSamples, start1, size1, start2, size2);
+        addToDestination (rc, start1, rc.bufferStartSample, size1, gains);
+        addToDestination (rc, start2, rc.bufferStartSample + size1, size2, gains);
+        fifo.finishedRead (size1 + size2);
+
+        readPosition = start + numSamples;
+
+        // The look-ahead thread wraps exactly at the loop end, so skip anything left before it
+        if (! loopRange.isEmpty() && start < loopRange.getEnd()
+             && readPosition >= loopRange.getEnd() - maxDriftSamples)
+        {
+            auto numBeforeWrap = (int) (loopRange.getEnd() - readPosition);
+
+            if (numBeforeWrap > 0)
+                fifo.finishedRead (jmin (numBeforeWrap, fifo.getNumReady()));
+
+            readPosition = loopRange.getStart() + jmax ((int64) 0, readPosition - loopRange.getEnd());
+        }
+    }
+
+    void renderSynchronously (const AudioRenderContext& rc, int64 start, const float* gains)
+    {
+        if (! isRenderingSynchronously)
+        {
+            // Offline renders must never miss any audio so stop using the look-ahead thread
+            lookAheadThread->removeTimeSliceClient (this);
+            isRenderingSynchronously = true;
+            seekSegments (start);
+        }
+        else if (start != writePosition)
+        {
+            seekSegments (start);
+        }
+
+        const int numSamples = rc.bufferNumSamples;
+        AudioScratchBuffer scratch (numChannels, numSamples);
+        renderStream (segments, scratch.buffer, 0, start, numSamples);
+        writePosition = start + numSamples;
+
+        for (int i = 0; i < rc.destBuffer->getNumChannels(); ++i)
+            rc.destBuffer->addFrom (i, rc.bufferStartSample, scratch.buffer, jmin (i, numChannels - 1),
+                                    0, numSamples, gains[i & 1]);
+    }
+
+    void addToDestination (const AudioRenderContext& rc, int fifoStart, int destStart, int numSamples, const float* gains)
+    {
+        if (numSamples <= 0)
+            return;
+
+        for (int i = 0; i < rc.destBuffer->getNumChannels(); ++i)
+            rc.destBuffer->addFrom (i, destStart, fifoBuffer, jmin (i, numChannels - 1),
+                                    fifoStart, numSamples, gains[i & 1]);
+    }
+
+    //==============================================================================
+    int useTimeSlice() override
+    {
+        CRASH_TRACER
+        const int generation = requestedGeneration.load (std::memory_order_acquire);
+
+        if (generation != renderedGeneration)
+        {
+            fifo.reset();
+            workerLoopRange = { requestedLoopStart.load (std::memory_order_relaxed),
+                                requestedLoopEnd.load (std::memory_order_relaxed) };
+            seekSegments (requestedPosition.load (std::memory_order_relaxed));
+            loopStartSegmentsReady = false;
+            renderedGeneration = generation;
+        }
+
+        auto numToWrite = jmin (fifo.getFreeSpace(), renderBlockSize);
+
+        if (numToWrite > 0)
+        {
+            const bool wrapsAtLoopEnd = ! workerLoopRange.isEmpty() && writePosition < workerLoopRange.getEnd();
+
+            if (wrapsAtLoopEnd)
+                numToWrite = (int) jmin ((int64) numToWrite, workerLoopRange.getEnd() - writePosition);
+
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite (numToWrite, start1, size1, start2, size2);
+            renderStream (segments, fifoBuffer, start1, writePosition, size1);
+            renderStream (segments, fifoBuffer, start2, writePosition + size1, size2);
+            fifo.finishedWrite (size1 + size2);
+            writePosition += size1 + size2;
+
+            if (wrapsAtLoopEnd && writePosition == workerLoopRange.getEnd())
+                wrapToLoopStart();
+        }
+
+        // Let the audio thread start as soon as there's a block to play rather than waiting
+        // for the whole look-ahead, which keeps the gap after a seek to about one block
+        if (fifo.getNumReady() >= numSamplesNeededToStart)
+        {
+            readyGeneration.store (generation, std::memory_order_release);
+
+            // This is left until there's something to play so it doesn't delay the start
+            if (! loopStartSegmentsReady)
+                prepareLoopStartSegments();
+        }
+
+        return numToWrite > 0 ? 0 : 10;
+    }
+
+    void createSegments (OwnedArray<StretchSegment>& newSegments)
+    {
+        newSegments.clear();
+
+        if (fileInfo.sampleRate > 0.0)
+            for (auto& segment : renderInfo->audioSegmentList->getSegments())
+                newSegments.add (new StretchSegment (engine, file, *renderInfo, sampleRate, segment));
+    }
+
+    void seekSegments (int64 position)
+    {
+        writePosition = position;
+
+        for (auto s : segments)
+            s->setPosition (position / sampleRate);
+    }
+
+    /** Gets a second set of segments running from a little before the loop start so that
+        at the loop end they can be swapped in already warmed up, rather than resetting
+        the stretchers and restarting them from nothing on every pass.
+    */
+    void prepareLoopStartSegments()
+    {
+        loopStartSegmentsReady = ! workerLoopRange.isEmpty();
+
+        if (! loopStartSegmentsReady)
+            return;
+
+        const auto preRollStart = jmax ((int64) 0, workerLoopRange.getStart() - preRollBuffer.getNumSamples());
+
+        for (auto s : loopStartSegments)
+            s->setPosition (preRollStart / sampleRate);
+
+        renderStream (loopStartSegments, preRollBuffer, 0, preRollStart, (int) (workerLoopRange.getStart() - preRollStart));
+    }
+
+    void wrapToLoopStart()
+    {
+        if (! loopStartSegmentsReady)
+        {
+            seekSegments (workerLoopRange.getStart());
+            return;
+        }
+
+        segments.swapWith (loopStartSegments);
+        writePosition = workerLoopRange.getStart();
+        prepareLoopStartSegments();
+    }
+
+    /** Renders a section of the stretched clip, leaving silence outside the clip. */
+    void renderStream (OwnedArray<StretchSegment>& segmentsToUse, juce::AudioBuffer<float>& buffer,
+                       int startSample, int64 position, int numSamples)
+    {
+        if (numSamples <= 0)
+            return;
+
+        buffer.clear (startSample, numSamples);
+
+        if (position + numSamples <= 0 || position >= streamLength)
+            return;
+
+        juce::AudioBuffer<float> section (buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                          startSample, numSamples);
+        const EditTimeRange time (position / sampleRate, (position + numSamples) / sampleRate);
+
+        for (auto s : segmentsToUse)
+            s->renderNextBlock (section, time, numSamples);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimeStretchingAudioNode)
+};
+
 //==============================================================================
 /**
     Performs a tempo detection task on a background thread.
@@ -257,6 +869,7 @@ public:
         : ThreadPoolJobWithProgress (TRANS("Detecting tempo")),
           engine (e), sourceFile (file)
     {
+        setJobClass (BackgroundJobClass::analysis);
     }
 
     /** Returns the bpm after a successful detection. */
@@ -269,48 +882,32 @@ public:
     /** Performs the actual detection. */
     JobStatus runJob() override
     {
-        std::unique_ptr<AudioFormatReader> reader (AudioFileUtils::createReaderFor (engine, sourceFile));
-
-        if (reader == nullptr)
-            return jobHasFinished;
+        const AudioFile file (engine, sourceFile);
+        auto& onsetEnvelopes = engine.getAudioFileManager().onsetEnvelopes;
+        bpm = onsetEnvelopes.getCachedTempo (file);
 
-        auto numChannels = (int) reader->numChannels;
-        auto numSamples = reader->lengthInSamples;
-        auto sampleRate = reader->sampleRate;
-
-        if (numSamples <= 0)
-            return jobHasFinished;
-
-        // main detection loop
+        if (bpm <= 0)
         {
-            TempoDetect detector (numChannels, sampleRate);
-            const int blockSize = 65536;
-            const bool useRightChan = numChannels > 1;
-
-            // can't use an AudioScratchBuffer yet
-            AudioBuffer<float> buffer (numChannels, blockSize);
+            // The envelope's measured in the same pass so finding the beats later won't need another
+            TempoAnalyser detector;
+            OnsetEnvelope::Builder envelopeBuilder;
+            Array<AudioAnalysisPipeline::Analyser*> analysers;
+            analysers.add (&detector);
 
-            int64 numLeft = numSamples;
-            int64 startSample = 0;
+            if (onsetEnvelopes.getCachedEnvelope (file) == nullptr)
+                analysers.add (&envelopeBuilder);
 
-            while (numLeft > 0)
-            {
-                if (shouldExit())
-                    return jobHasFinished;
-
-                const int numThisTime = (int) jmin (numLeft, (int64) blockSize);
-                reader->read (&buffer, 0, numThisTime, startSample, true, useRightChan);
-                detector.processSection (buffer, numThisTime);
+            if (! engine.getAudioFileManager().analysisPipeline.runAnalysers (file, analysers, this, &progress))
+                return jobHasFinished;
 
-                startSample += numThisTime;
-                numLeft -= numThisTime;
-                progress = numLeft / (float) numSamples;
-            }
+            if (auto envelope = envelopeBuilder.getEnvelope())
+                onsetEnvelopes.setCachedEnvelope (file, envelope);
 
-            bpm = detector.finishAndDetect();
-            isSensible = bpm > 0;
+            bpm = detector.getBpm();
+            onsetEnvelopes.setCachedTempo (file, bpm);
         }
 
+        isSensible = bpm > 0;
         return jobHasFinished;
     }
 
@@ -321,7 +918,7 @@ private:
     //==============================================================================
     Engine& engine;
     File sourceFile;
-    float progress = 0;
+    std::atomic<float> progress { 0.0f };
     bool isSensible = false;
     float bpm = 12.0f;
 
@@ -335,16 +932,29 @@ class ProxyGeneratorJob  : public AudioProxyGenerator::GeneratorJob
 public:
     ProxyGeneratorJob (const AudioFile& o, const AudioFile& p,
                        AudioClipBase& acb, bool renderTimestretched)
-        : GeneratorJob (p), engine (acb.edit.engine), original (o)
+        : GeneratorJob (p), engine (acb.edit.engine), edit (&acb.edit), clipID (acb.itemID), original (o)
     {
         setName (TRANS("Creating Proxy") + ": " + acb.getName());
+        setJobOwner (&acb.edit);
+        ownerID = "proxy_" + String::toHexString ((pointer_sized_int) &acb.edit) + "_" + clipID.toString();
 
         if (renderTimestretched)
             proxyInfo = acb.createProxyRenderingInfo();
     }
 
+    double getSchedulingPriority() override
+    {
+        if (edit != nullptr)
+            if (auto clip = findClipForID (*edit, clipID))
+                return AudioProxyGenerator::getPriorityForEditTime (*edit, clip->getEditTimeRange());
+
+        return std::numeric_limits<double>::max();
+    }
+
 private:
     Engine& engine;
+    Edit::WeakRef edit;
+    EditItemID clipID;
     AudioFile original;
     std::unique_ptr<AudioClipBase::ProxyRenderingInfo> proxyInfo;
 
@@ -369,6 +979,21 @@ private:
         tempFile.deleteFile();
 
         engine.getAudioFileManager().releaseFile (proxy);
+
+        // Stretched clips play from the source until their proxy is ready, so swap over to it
+        if (ok && proxyInfo != nullptr)
+        {
+            MessageManager::callAsync ([editRef = edit, id = clipID, proxyFile = proxy]
+                                       {
+                                           proxyFile.engine->getAudioFileManager().checkFileForChanges (proxyFile);
+
+                                           // Only the clip's own track needs rebuilding
+                                           if (editRef != nullptr)
+                                               if (auto clip = findClipForID (*editRef, id))
+                                                   editRef->restartPlaybackForChange (clip->state);
+                                       });
+        }
+
         return ok;
     }
 
@@ -1386,51 +2011,16 @@ LoopInfo AudioClipBase::autoDetectBeatMarkers (const LoopInfo& current, bool aut
 
     if (autoBeat)
     {
-        if (auto reader = std::unique_ptr<AudioFormatReader> (AudioFileUtils::createReaderFor (edit.engine, getCurrentSourceFile())))
+        // The envelope is shared by every clip using the file so it's only measured once
+        const AudioFile file (edit.engine, getCurrentSourceFile());
+
+        if (auto envelope = edit.engine.getAudioFileManager().onsetEnvelopes.getEnvelope (file))
         {
-            int64 out = (loopInfo.getOutMarker() == -1) ? reader->lengthInSamples
+            int64 out = (loopInfo.getOutMarker() == -1) ? envelope->getNumSamples()
                                                         : loopInfo.getOutMarker();
-            int64 in = loopInfo.getInMarker();
-
-            BeatDetect detect;
-            detect.setSensitivity (sens);
-            detect.setSampleRate (reader->sampleRate);
-
-            int chans     = (int) reader->numChannels;
-            int blockSize = detect.getBlockSize();
-
-            HeapBlock<float*> buffers;
-            buffers.calloc ((size_t) chans + 2);
-
-            HeapBlock<float> buffer ((size_t) (blockSize * chans));
-            for (int i = 0; i < chans; ++i)
-                buffers[i] = buffer + i * blockSize;
-
-            int64 len = out - in;
-
-            if (len / reader->sampleRate >= 1)
-            {
-                int blocks = int (len / blockSize);
-
-                for (int i = 0; i < blocks; ++i)
-                {
-                    if (! reader->readSamples ((int**) buffers.getData(), chans, 0, in + i * blockSize, blockSize))
-                        break;
-
-                    if (! reader->usesFloatingPointData)
-                    {
-                        FloatVectorOperations::convertFixedToFloat (buffers[0], (const int*) buffers[0], 1.0f / 0x7fffffff, blockSize);
-
-                        if (chans > 1)
-                            FloatVectorOperations::convertFixedToFloat (buffers[1], (const int*) buffers[1], 1.0f / 0x7fffffff, blockSize);
-                    }
-
-                    detect.audioProcess (const_cast<const float**> (buffers.getData()), chans);
-                }
 
-                for (int i = 0; i < detect.getNumBeats(); ++i)
-                    res.addLoopPoint (detect.getBeat(i) + in, LoopInfo::LoopPointType::automatic);
-            }
+            for (auto beat : envelope->findBeats (sens, { loopInfo.getInMarker(), out }))
+                res.addLoopPoint (beat, LoopInfo::LoopPointType::automatic);
         }
     }
 
@@ -1931,6 +2521,11 @@ AudioNode* AudioClipBase::createNode (EditTimeRange editTime, LiveClipLevel lcl,
             return new TimestretchingPreviewAudioNode (*this);
     }
 
+    // Until the stretched proxy has been rendered, or if proxies can't be used, stretch the source as it plays
+    if (usesTimestretchedProxy && ! isUsingMelodyne() && original.isValid()
+         && (playFile == original || playFile.getSampleRate() <= 0.0))
+        return new TimeStretchingAudioNode (*this, lcl);
+
     if ((getFadeInBehaviour() == speedRamp && fadeIn > 0.0)
          || (getFadeOutBehaviour() == speedRamp && fadeOut > 0.0))
         return new SubSampleWaveAudioNode (edit.engine, playFile, editTime, nodeOffset,
@@ -2195,194 +2790,6 @@ AudioFile AudioClipBase::getProxyFileToCreate (bool renderTimestretched)
     return TemporaryFileManager::getFileForCachedFileRender (edit, getHash());
 }
 
-//==============================================================================
-struct StretchSegment
-{
-    StretchSegment (Engine& engine, const AudioFile& file,
-                    const AudioClipBase::ProxyRenderingInfo& info,
-                    double sampleRate, const AudioSegmentList::Segment& s)
-        : segment (s),
-          fileInfo (file.getInfo()),
-          crossfadeSamples ((int) (sampleRate * info.audioSegmentList->getCrossfadeLength())),
-          fifo (jmax (1, fileInfo.numChannels), outputBufferSize)
-    {
-        CRASH_TRACER
-        reader = engine.getAudioFileManager().cache.createReader (file);
-
-        if (reader != nullptr)
-        {
-            auto sampleRange = segment.getSampleRange();
-
-            if (segment.isFollowedBySilence())
-            {
-                reader->setReadPosition (sampleRange.getStart());
-            }
-            else
-            {
-                reader->setLoopRange (sampleRange);
-                reader->setReadPosition (0);
-            }
-
-            timestretcher.initialise (fileInfo.sampleRate, outputBufferSize, fileInfo.numChannels,
-                                      info.mode, info.options, false);
-
-            timestretcher.setSpeedAndPitch ((float) (1.0 / segment.getStretchRatio()),
-                                            segment.getTranspose());
-        }
-    }
-
-    void renderNextBlock (juce::AudioBuffer<float>& buffer, EditTimeRange editTime, int numSamples)
-    {
-        if (reader == nullptr)
-            return;
-
-        CRASH_TRACER
-
-        auto loopRange = segment.getRange();
-
-        if (! editTime.overlaps (loopRange))
-            return;
-
-        int start = 0;
-
-        if (loopRange.getEnd() < editTime.getEnd())
-            numSamples = jmax (0, (int) (numSamples * (loopRange.getEnd() - editTime.getStart()) / editTime.getLength()));
-
-        if (loopRange.getStart() > editTime.getStart())
-        {
-            int skip = jlimit (0, numSamples, (int) (numSamples * (loopRange.getStart() - editTime.getStart()) / editTime.getLength()));
-            start += skip;
-            numSamples -= skip;
-        }
-
-        while (numSamples > 0)
-        {
-            const int numReady = jmin (numSamples, readySamplesEnd - readySamplesStart);
-
-            if (numReady > 0)
-            {
-                for (int i = 0; i < buffer.getNumChannels(); ++i)
-                    buffer.addFrom (i, start, fifo, jmin (i, fifo.getNumChannels() - 1), readySamplesStart, numReady);
-
-                readySamplesStart += numReady;
-                start += numReady;
-                numSamples -= numReady;
-            }
-            else
-            {
-                fillNextBlock();
-                renderFades();
-
-                readySampleOutputPos += outputBufferSize;
-            }
-        }
-    }
-
-    void fillNextBlock()
-    {
-        CRASH_TRACER
-        float* outs[] = { fifo.getWritePointer (0),
-                          fileInfo.numChannels > 1 ? fifo.getWritePointer (1) : nullptr,
-                          nullptr };
-
-        const int needed = timestretcher.getFramesNeeded();
-
-        if (needed >= 0)
-        {
-            AudioScratchBuffer scratch (fileInfo.numChannels, needed);
-            const AudioChannelSet bufferChannels = AudioChannelSet::canonicalChannelSet (fileInfo.numChannels);
-            const AudioChannelSet channelsToUse = AudioChannelSet::stereo();
-
-            if (needed > 0)
-            {
-               #if JUCE_DEBUG
-                jassert (reader->readSamples (needed, scratch.buffer, bufferChannels, 0, channelsToUse, 5000));
-               #else
-                reader->readSamples (needed, scratch.buffer, bufferChannels, 0, channelsToUse, 5000);
-               #endif
-            }
-
-            const float* ins[] = { scratch.buffer.getReadPointer (0),
-                                   fileInfo.numChannels > 1 ? scratch.buffer.getReadPointer (1) : nullptr,
-                                   nullptr };
-
-            timestretcher.processData (ins, needed, outs);
-        }
-        else
-        {
-            jassert (needed == -1);
-            timestretcher.flush (outs);
-        }
-
-        readySamplesStart = 0;
-        readySamplesEnd = outputBufferSize;
-    }
-
-    void renderFades()
-    {
-        CRASH_TRACER
-        auto renderedEnd = readySampleOutputPos + outputBufferSize;
-
-        if (segment.hasFadeIn())
-            if (readySampleOutputPos < crossfadeSamples)
-                renderFade (0, crossfadeSamples, false);
-
-        if (segment.hasFadeOut())
-        {
-            auto fadeOutStart = (int64) (segment.getSampleRange().getLength() / segment.getStretchRatio()) - crossfadeSamples;
-
-            if (renderedEnd > fadeOutStart)
-                renderFade (fadeOutStart, fadeOutStart + crossfadeSamples + 2, true);
-        }
-    }
-
-    void renderFade (int64 start, int64 end, bool isFadeOut)
-    {
-        float alpha1 = 0.0f, alpha2 = 1.0f;
-        auto renderedEnd = readySampleOutputPos + outputBufferSize;
-
-        if (end > renderedEnd)
-        {
-            alpha2 = (renderedEnd - start) / (float) (end - start);
-            end = renderedEnd;
-        }
-
-        if (start < readySampleOutputPos)
-        {
-            alpha1 = alpha2 * (readySampleOutputPos - start) / (float) (end - start);
-            start = readySampleOutputPos;
-        }
-
-        if (end > start)
-        {
-            if (isFadeOut)
-            {
-                alpha1 = 1.0f - alpha1;
-                alpha2 = 1.0f - alpha2;
-            }
-
-            AudioFadeCurve::applyCrossfadeSection (fifo,
-                                                   (int) (start - readySampleOutputPos),
-                                                   (int) (end - start),
-                                                   AudioFadeCurve::convex, alpha1, alpha2);
-        }
-    }
-
-    const AudioSegmentList::Segment& segment;
-    TimeStretcher timestretcher;
-
-    AudioFileInfo fileInfo;
-    AudioFileCache::Reader::Ptr reader;
-
-    const int outputBufferSize = 1024;
-    int readySamplesStart = 0, readySamplesEnd = 0;
-    int64 readySampleOutputPos = 0;
-    const int crossfadeSamples;
-    juce::AudioBuffer<float> fifo;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StretchSegment)
-};
-
 //==============================================================================
 std::unique_ptr<AudioClipBase::ProxyRenderingInfo> AudioClipBase::createProxyRenderingInfo()
 {
@@ -2777,4 +3184,102 @@ void AudioClipBase::updateClipEffectsState()
     markAsDirty();
 }
 
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class TimeStretchingAudioNodeTests  : public juce::UnitTest
+{
+public:
+    TimeStretchingAudioNodeTests()
+        : juce::UnitTest ("TimeStretchingAudioNode", "Tracktion:Longer") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+
+        beginTest ("Stretching from the source matches the proxy");
+        {
+            if (! TimeStretcher::canProcessFor (TimeStretcher::defaultMode))
+            {
+                logMessage ("No time-stretcher available, skipping");
+                return;
+            }
+
+            auto sampleRate = engine.getDeviceManager().getSampleRate();
+            auto sinFile = createSinFile (engine, sampleRate);
+
+            auto edit = Edit::createSingleTrackEdit (engine);
+            edit->getMasterVolumePlugin()->setVolumeDb (0.0);
+            auto track = getAudioTracks (*edit)[0];
+
+            auto clip = track->insertWaveClip ("sin", sinFile->getFile(), {{ 0.0, 1.0 }}, false);
+            expect (clip != nullptr);
+            clip->setTimeStretchMode (TimeStretcher::defaultMode);
+            clip->setPitchChange (3.0f);
+            expect (clip->usesTimeStretchedProxy());
+
+            BigInteger tracksMask;
+            tracksMask.setBit (track->getIndexInEditTrackList());
+
+            // Without a proxy the clip is stretched from the source as it plays
+            clip->setUsesProxy (false);
+            expect (clip->getPlaybackFile() == clip->getAudioFile());
+            auto sourceStats = Renderer::measureStatistics ("Stretch Tests", *edit, { 0.0, 1.0 }, tracksMask, 512);
+
+            // Then render the proxy the same way the proxy generator does and play that instead
+            clip->setUsesProxy (true);
+            auto proxy = clip->getPlaybackFile();
+            expect (proxy != clip->getAudioFile());
+
+            {
+                AudioFileWriter writer (proxy, engine.getAudioFileFormatManager().getWavFormat(),
+                                        1, sampleRate, 32, {}, 0);
+                expect (writer.isOpen());
+
+                juce::ThreadPoolJob* job = nullptr;
+                std::atomic<float> progress { 0.0f };
+                expect (clip->createProxyRenderingInfo()->render (engine, clip->getAudioFile(), writer, job, progress));
+            }
+
+            engine.getAudioFileManager().checkFileForChanges (proxy);
+            expect (proxy.isValid());
+            auto proxyStats = Renderer::measureStatistics ("Stretch Tests", *edit, { 0.0, 1.0 }, tracksMask, 512);
+
+            logMessage ("Source peak " + String (sourceStats.peak) + ", avg " + String (sourceStats.average)
+                         + ", proxy peak " + String (proxyStats.peak) + ", avg " + String (proxyStats.average));
+
+            expect (sourceStats.peak > 0.5f, "Stretched clip should be audible from the start");
+            expectWithinAbsoluteError (sourceStats.peak, proxyStats.peak, 0.01f);
+            expectWithinAbsoluteError (sourceStats.average, proxyStats.average, 0.01f);
+
+            proxy.deleteFile();
+            engine.getAudioFileManager().releaseAllFiles();
+            edit->getTempDirectory (false).deleteRecursively();
+        }
+    }
+
+    static std::unique_ptr<TemporaryFile> createSinFile (Engine& engine, double sampleRate)
+    {
+        juce::AudioBuffer<float> buffer (1, (int) sampleRate);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample (0, i, std::sin (MathConstants<float>::twoPi * 220.0f * (float) (i / sampleRate)));
+
+        auto f = std::make_unique<TemporaryFile> (".wav");
+
+        {
+            AudioFileWriter writer (AudioFile (engine, f->getFile()), engine.getAudioFileFormatManager().getWavFormat(),
+                                    1, sampleRate, 32, {}, 0);
+            writer.appendBuffer (buffer, buffer.getNumSamples());
+        }
+
+        return f;
+    }
+};
+
+static TimeStretchingAudioNodeTests timeStretchingAudioNodeTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
 }
@@ -409,6 +409,7 @@ protected:
 private:
     //==============================================================================
     class TimestretchingPreviewAudioNode;
+    class TimeStretchingAudioNode;
     class TempoDetectTask;
     class BeatSensitivityComp;
 
@@ -1381,11 +1381,7 @@ struct NormaliseEffect::NormaliseRenderJob : public BlockBasedRenderJob
         {
             calculatedGain = true;
 
-            float lmin, lmax, rmin, rmax;
-            reader->readMaxLevels (0, sourceLengthSamples, lmin, lmax, rmin, rmax);
-
-            auto maxLevel = jmax (-lmin, lmax, -rmin, rmax);
-            gainFactor = dbToGain (float (maxGain)) / maxLevel;
+            gainFactor = dbToGain (float (maxGain)) / findMaxLevel();
         }
 
         auto todo = (int) jmin (32768ll, sourceLengthSamples - position);
@@ -1404,6 +1400,24 @@ struct NormaliseEffect::NormaliseRenderJob : public BlockBasedRenderJob
         return position >= sourceLengthSamples;
     }
 
+    float findMaxLevel()
+    {
+        // The whole file can be measured alongside its other analysis, e.g. building its peaks
+        if (sourceLengthSamples >= reader->lengthInSamples)
+        {
+            LoudnessAnalyser loudness;
+
+            if (engine.getAudioFileManager().analysisPipeline.runAnalysers (source, { &loudness },
+                                                                            ThreadPoolJob::getCurrentThreadPoolJob()))
+                return loudness.getPeak();
+        }
+
+        float lmin, lmax, rmin, rmax;
+        reader->readMaxLevels (0, sourceLengthSamples, lmin, lmax, rmin, rmax);
+
+        return jmax (-lmin, lmax, -rmin, rmax);
+    }
+
     const double maxGain = 1.0;
 
     bool calculatedGain = false;
@@ -1668,9 +1682,22 @@ struct AggregateJob  : public RenderManager::Job
         return true;
     }
 
+    Array<ThreadPoolJobWithProgress*> getJobsToWaitFor() override
+    {
+        Array<ThreadPoolJobWithProgress*> jobsToWaitFor;
+
+        for (auto j : engine.getRenderManager().getRenderJobsWithoutCreating (sourceFile))
+            if (j != this)
+                jobsToWaitFor.add (j);
+
+        return jobsToWaitFor;
+    }
+
     bool renderNextBlock() override
     {
         CRASH_TRACER
+        // Renders of the source are waited for before this starts, but it could still be
+        // being made by something else, e.g. a comp
         if (! sourceFile.isValid())
         {
             Thread::sleep (100);
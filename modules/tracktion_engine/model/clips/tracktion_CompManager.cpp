@@ -1140,14 +1140,26 @@ public:
     using Ptr = juce::ReferenceCountedObjectPtr<GeneratorJob>;
 
     CompGeneratorJob (WaveAudioClip& wc, const AudioFile& comp)
-        : GeneratorJob (comp), engine (wc.edit.engine), clipID (wc.itemID),
+        : GeneratorJob (comp), engine (wc.edit.engine), edit (&wc.edit), clipID (wc.itemID),
           context (wc.getCompManager().createRenderContext())
     {
         setName (TRANS("Creating Comp") + ": " + wc.getName());
+        setJobOwner (&wc.edit);
+        ownerID = "comp_" + String::toHexString ((pointer_sized_int) &wc.edit) + "_" + clipID.toString();
+    }
+
+    double getSchedulingPriority() override
+    {
+        if (edit != nullptr)
+            if (auto clip = findClipForID (*edit, clipID))
+                return AudioProxyGenerator::getPriorityForEditTime (*edit, clip->getEditTimeRange());
+
+        return std::numeric_limits<double>::max();
     }
 
 private:
     Engine& engine;
+    Edit::WeakRef edit;
     EditItemID clipID;
     std::unique_ptr<WaveCompManager::CompRenderContext> context;
 
@@ -111,6 +111,7 @@ RenderManager::Job::Ptr EditClip::getRenderJob (const AudioFile& destFile)
                                                   sourceFileReference.getSourceProjectItemID(),
                                                   true, getIsReversed());
     j->setName (TRANS("Creating Edit Clip") + ": " + getName());
+    j->setJobOwner (&edit);
 
     return j;
 }
@@ -66,7 +66,18 @@ struct TransientDetectionJob  : public RenderManager::Job
     Array<double> getTimes() const                  { return transientTimes; }
 
 protected:
-    bool setUpRender() override                     { return reader != nullptr && totalNumSamples > 0; }
+    bool setUpRender() override
+    {
+        if (reader == nullptr || totalNumSamples <= 0)
+            return false;
+
+        // The level can come from the file's onset envelope, which is measured in parallel and
+        // shared with the beat detection, otherwise it takes an extra pass over the file
+        if (auto envelope = engine.getAudioFileManager().onsetEnvelopes.getEnvelope (file, this))
+            setNormaliseLevel (envelope->getChannelRange (0));
+
+        return true;
+    }
 
     bool completeRender() override
     {
@@ -120,11 +131,9 @@ protected:
 
         if (findingNormaliseLevel && numSamplesRead >= totalNumSamples)
         {
-            const float peak = jmax (std::abs (fileMinMax.getStart()), std::abs (fileMinMax.getEnd()));
-            normaliseScale = peak > 0.0f ? 1.0f / peak : 1.0f;
+            setNormaliseLevel (fileMinMax);
             reader->setReadPosition (0);
             numSamplesRead = 0;
-            findingNormaliseLevel = false;
         }
 
         return ! findingNormaliseLevel && numSamplesRead >= totalNumSamples;
@@ -160,6 +169,7 @@ private:
         // N.B. The argumnet to the Job constructor is the proxy file to use
         // Don't send the audio file here or it will get deleted!
         jassert (proxy.isNull());
+        setJobClass (BackgroundJobClass::analysis);
 
         if (reader != nullptr)
             sampleRate = reader->getSampleRate();
@@ -170,6 +180,13 @@ private:
         envelopeFollower[2].setCoefficients (1.0, 0.002f);
     }
 
+    void setNormaliseLevel (Range<float> minMax)
+    {
+        const float peak = jmax (std::abs (minMax.getStart()), std::abs (minMax.getEnd()));
+        normaliseScale = peak > 0.0f ? 1.0f / peak : 1.0f;
+        findingNormaliseLevel = false;
+    }
+
     void processNextNormaliseBuffer (const juce::AudioBuffer<float>& buffer)
     {
         fileMinMax = fileMinMax.getUnionWith (FloatVectorOperations::findMinAndMax (buffer.getReadPointer (0), buffer.getNumSamples()));
@@ -534,6 +534,7 @@ RenderManager::Job::Ptr WaveAudioClip::getRenderJob (const AudioFile& destFile)
     {
         auto j = clipEffects->createRenderJob (AudioFile (*destFile.engine, destFile.getFile()), AudioFile (*destFile.engine, getOriginalFile()));
         j->setName (TRANS("Rendering Clip Effects") + ": " + getName());
+        j->setJobOwner (&edit);
         return j;
     }
 
@@ -541,6 +542,7 @@ RenderManager::Job::Ptr WaveAudioClip::getRenderJob (const AudioFile& destFile)
     {
         auto j = ReverseRenderJob::getOrCreateRenderJob (edit.engine, getOriginalFile(), destFile.getFile());
         j->setName (TRANS("Reversing") + ": " + getName());
+        j->setJobOwner (&edit);
         return j;
     }
 
@@ -548,6 +550,7 @@ RenderManager::Job::Ptr WaveAudioClip::getRenderJob (const AudioFile& destFile)
     {
         auto j = WarpTimeRenderJob::getOrCreateRenderJob (*this, getOriginalFile(), destFile.getFile());
         j->setName (TRANS("Warping") + ": " + getName());
+        j->setJobOwner (&edit);
         return j;
     }
 
@@ -0,0 +1,591 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+namespace BinaryEditFileHelpers
+{
+    static const char magic[] = { 'T', 'E', 'D', 'B' };
+
+    enum ChildEncoding
+    {
+        genericChildren = 0,
+        packedChildren  = 1
+    };
+
+    static constexpr int minNumChildrenToPack = 8;
+
+    /** Packed values are read back as ints if they're whole numbers, otherwise doubles. */
+    inline var createPackedValue (double d)
+    {
+        if (d == std::floor (d) && std::abs (d) < 2147483647.0)
+            return var ((int) d);
+
+        return var (d);
+    }
+
+    /** Returns true if the value can be stored as a number and still read back as the same string. */
+    inline bool getPackableValue (const var& v, double& result)
+    {
+        if (v.isString())
+        {
+            auto s = v.toString();
+
+            if (s.isEmpty() || ! s.containsOnly ("0123456789.-+eE"))
+                return false;
+
+            result = s.getDoubleValue();
+        }
+        else if (v.isInt() || v.isInt64() || v.isDouble())
+        {
+            result = static_cast<double> (v);
+        }
+        else
+        {
+            return false;
+        }
+
+        return createPackedValue (result).toString() == v.toString();
+    }
+
+    //==============================================================================
+    struct Writer
+    {
+        Writer (const ValueTree& rootToWrite)
+        {
+            addIdentifiers (rootToWrite);
+        }
+
+        void addIdentifiers (const ValueTree& v)
+        {
+            addIdentifier (v.getType());
+
+            for (int i = 0; i < v.getNumProperties(); ++i)
+                addIdentifier (v.getPropertyName (i));
+
+            for (const auto& c : v)
+                addIdentifiers (c);
+        }
+
+        void addIdentifier (const Identifier& i)
+        {
+            if (! indexes.contains (i.toString()))
+            {
+                indexes.set (i.toString(), strings.size());
+                strings.add (i.toString());
+            }
+        }
+
+        int getIndex (const Identifier& i) const
+        {
+            jassert (indexes.contains (i.toString()));
+            return indexes[i.toString()];
+        }
+
+        bool writeStringTable (OutputStream& os) const
+        {
+            bool ok = os.writeCompressedInt (strings.size());
+
+            for (auto& s : strings)
+                ok = ok && os.writeString (s);
+
+            return ok;
+        }
+
+        bool writeProperties (const ValueTree& v, OutputStream& os) const
+        {
+            bool ok = os.writeCompressedInt (v.getNumProperties());
+
+            for (int i = 0; i < v.getNumProperties(); ++i)
+            {
+                auto name = v.getPropertyName (i);
+                ok = ok && os.writeCompressedInt (getIndex (name));
+                var::writeToStream (v.getProperty (name), os);
+            }
+
+            return ok;
+        }
+
+        bool writeNode (const ValueTree& v, OutputStream& os) const
+        {
+            bool ok = os.writeCompressedInt (getIndex (v.getType()))
+                        && writeProperties (v, os)
+                        && os.writeCompressedInt (v.getNumChildren());
+
+            if (v.getNumChildren() == 0)
+                return ok;
+
+            if (canPackChildren (v))
+                return ok && os.writeByte ((char) packedChildren) && writePackedChildren (v, os);
+
+            ok = ok && os.writeByte ((char) genericChildren);
+
+            for (const auto& c : v)
+                ok = ok && writeNode (c, os);
+
+            return ok;
+        }
+
+        static bool canPackChildren (const ValueTree& v)
+        {
+            if (v.getNumChildren() < minNumChildrenToPack)
+                return false;
+
+            auto first = v.getChild (0);
+            const int numProperties = first.getNumProperties();
+
+            for (const auto& c : v)
+            {
+                if (! c.hasType (first.getType())
+                     || c.getNumChildren() > 0
+                     || c.getNumProperties() != numProperties)
+                    return false;
+
+                for (int i = 0; i < numProperties; ++i)
+                {
+                    auto name = first.getPropertyName (i);
+                    double d;
+
+                    if (c.getPropertyName (i) != name || ! getPackableValue (c.getProperty (name), d))
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool writePackedChildren (const ValueTree& v, OutputStream& os) const
+        {
+            auto first = v.getChild (0);
+            const int numProperties = first.getNumProperties();
+
+            bool ok = os.writeCompressedInt (getIndex (first.getType()))
+                        && os.writeCompressedInt (numProperties);
+
+            for (int i = 0; i < numProperties; ++i)
+            {
+                auto name = first.getPropertyName (i);
+                ok = ok && os.writeCompressedInt (getIndex (name));
+
+                for (const auto& c : v)
+                {
+                    double d = 0.0;
+                    getPackableValue (c.getProperty (name), d);
+                    ok = ok && os.writeDouble (d);
+                }
+            }
+
+            return ok;
+        }
+
+        HashMap<String, int> indexes;
+        StringArray strings;
+    };
+}
+
+//==============================================================================
+BinaryEditFile::BinaryEditFile (const File& f)
+    : mappedFile (std::make_unique<MemoryMappedFile> (f, MemoryMappedFile::readOnly))
+{
+    if (mappedFile->getData() != nullptr)
+        parseHeader (mappedFile->getData(), mappedFile->getSize());
+}
+
+BinaryEditFile::BinaryEditFile (const void* data, size_t numBytes)
+{
+    if (data != nullptr)
+        parseHeader (data, numBytes);
+}
+
+BinaryEditFile::~BinaryEditFile()
+{
+}
+
+void BinaryEditFile::parseHeader (const void* data, size_t numBytes)
+{
+    using namespace BinaryEditFileHelpers;
+
+    if (numBytes < sizeof (magic) + 4 || memcmp (data, magic, sizeof (magic)) != 0)
+        return;
+
+    MemoryInputStream in (data, numBytes, false);
+    in.skipNextBytes ((int64) sizeof (magic));
+
+    version = in.readInt();
+
+    if (version < 1 || version > currentVersion)
+        return;
+
+    const int numStrings = in.readCompressedInt();
+
+    if (numStrings <= 0)
+        return;
+
+    for (int i = 0; i < numStrings; ++i)
+    {
+        auto s = in.readString();
+
+        if (s.isEmpty())
+            return;
+
+        identifiers.add (Identifier (s));
+    }
+
+    const int rootType = in.readCompressedInt();
+
+    if (! isPositiveAndBelow (rootType, identifiers.size()))
+        return;
+
+    root = ValueTree (identifiers.getReference (rootType));
+
+    if (! readProperties (in, root))
+        return;
+
+    const int numSubtrees = in.readCompressedInt();
+
+    if (numSubtrees < 0)
+        return;
+
+    for (int i = 0; i < numSubtrees; ++i)
+    {
+        SubtreeInfo info;
+        info.typeIndex = in.readCompressedInt();
+        info.offset = in.readInt64();
+        info.numBytes = in.readInt64();
+
+        if (! isPositiveAndBelow (info.typeIndex, identifiers.size()) || info.offset < 0 || info.numBytes < 0)
+            return;
+
+        subtrees.push_back (info);
+    }
+
+    dataSection = static_cast<const char*> (data) + in.getPosition();
+    dataSectionSize = numBytes - (size_t) in.getPosition();
+
+    for (auto& info : subtrees)
+        if ((size_t) (info.offset + info.numBytes) > dataSectionSize)
+            return;
+
+    valid = true;
+}
+
+ValueTree BinaryEditFile::readRoot() const
+{
+    return root.createCopy();
+}
+
+Identifier BinaryEditFile::getSubtreeType (int index) const
+{
+    if (isPositiveAndBelow (index, getNumSubtrees()))
+        return identifiers[subtrees[(size_t) index].typeIndex];
+
+    return {};
+}
+
+ValueTree BinaryEditFile::readSubtree (int index) const
+{
+    if (! (valid && isPositiveAndBelow (index, getNumSubtrees())))
+        return {};
+
+    auto& info = subtrees[(size_t) index];
+    MemoryInputStream in (dataSection + info.offset, (size_t) info.numBytes, false);
+
+    return readNode (in);
+}
+
+ValueTree BinaryEditFile::readAll() const
+{
+    if (! valid)
+        return {};
+
+    auto v = readRoot();
+
+    for (int i = 0; i < getNumSubtrees(); ++i)
+    {
+        auto subtree = readSubtree (i);
+
+        if (! subtree.isValid())
+            return {};
+
+        v.appendChild (subtree, nullptr);
+    }
+
+    return v;
+}
+
+//==============================================================================
+ValueTree BinaryEditFile::readNode (MemoryInputStream& in) const
+{
+    using namespace BinaryEditFileHelpers;
+
+    const int typeIndex = in.readCompressedInt();
+
+    if (! isPositiveAndBelow (typeIndex, identifiers.size()))
+        return {};
+
+    ValueTree v (identifiers.getReference (typeIndex));
+
+    if (! readProperties (in, v))
+        return {};
+
+    const int numChildren = in.readCompressedInt();
+
+    if (numChildren <= 0)
+        return v;
+
+    if (in.readByte() == (char) packedChildren)
+    {
+        if (! readPackedChildren (in, v, numChildren))
+            return {};
+
+        return v;
+    }
+
+    for (int i = 0; i < numChildren; ++i)
+    {
+        auto child = readNode (in);
+
+        if (! child.isValid())
+            return {};
+
+        v.appendChild (child, nullptr);
+    }
+
+    return v;
+}
+
+bool BinaryEditFile::readProperties (MemoryInputStream& in, ValueTree& v) const
+{
+    const int numProperties = in.readCompressedInt();
+
+    if (numProperties < 0)
+        return false;
+
+    for (int i = 0; i < numProperties; ++i)
+    {
+        const int nameIndex = in.readCompressedInt();
+
+        if (! isPositiveAndBelow (nameIndex, identifiers.size()))
+            return false;
+
+        v.setProperty (identifiers.getReference (nameIndex), var::readFromStream (in), nullptr);
+    }
+
+    return true;
+}
+
+bool BinaryEditFile::readPackedChildren (MemoryInputStream& in, ValueTree& v, int numChildren) const
+{
+    using namespace BinaryEditFileHelpers;
+
+    const int typeIndex = in.readCompressedInt();
+    const int numProperties = in.readCompressedInt();
+
+    if (! isPositiveAndBelow (typeIndex, identifiers.size()) || numProperties < 0
+         || in.getNumBytesRemaining() < (int64) numChildren * numProperties * (int64) sizeof (double))
+        return false;
+
+    std::vector<ValueTree> children;
+    children.reserve ((size_t) numChildren);
+
+    for (int i = 0; i < numChildren; ++i)
+        children.emplace_back (identifiers.getReference (typeIndex));
+
+    for (int p = 0; p < numProperties; ++p)
+    {
+        const int nameIndex = in.readCompressedInt();
+
+        if (! isPositiveAndBelow (nameIndex, identifiers.size()))
+            return false;
+
+        auto& name = identifiers.getReference (nameIndex);
+
+        for (auto& c : children)
+            c.setProperty (name, createPackedValue (in.readDouble()), nullptr);
+    }
+
+    for (auto& c : children)
+        v.appendChild (c, nullptr);
+
+    return true;
+}
+
+//==============================================================================
+bool BinaryEditFile::write (const ValueTree& v, OutputStream& os)
+{
+    using namespace BinaryEditFileHelpers;
+    jassert (v.isValid());
+
+    if (! v.isValid())
+        return false;
+
+    CRASH_TRACER
+    Writer writer (v);
+
+    // Encode the subtrees first so we know their offsets for the index
+    MemoryOutputStream data;
+    std::vector<SubtreeInfo> index;
+    bool ok = true;
+
+    for (const auto& c : v)
+    {
+        SubtreeInfo info;
+        info.typeIndex = writer.getIndex (c.getType());
+        info.offset = data.getPosition();
+        ok = ok && writer.writeNode (c, data);
+        info.numBytes = data.getPosition() - info.offset;
+        index.push_back (info);
+    }
+
+    ok = ok && os.write (magic, sizeof (magic))
+            && os.writeInt (currentVersion)
+            && writer.writeStringTable (os)
+            && os.writeCompressedInt (writer.getIndex (v.getType()))
+            && writer.writeProperties (v, os)
+            && os.writeCompressedInt ((int) index.size());
+
+    for (auto& info : index)
+        ok = ok && os.writeCompressedInt (info.typeIndex)
+                && os.writeInt64 (info.offset)
+                && os.writeInt64 (info.numBytes);
+
+    return ok && os.write (data.getData(), data.getDataSize());
+}
+
+bool BinaryEditFile::isBinaryEditFile (const File& f)
+{
+    FileInputStream is (f);
+    char header[sizeof (BinaryEditFileHelpers::magic)] = {};
+
+    return is.openedOk()
+            && is.read (header, (int) sizeof (header)) == (int) sizeof (header)
+            && memcmp (header, BinaryEditFileHelpers::magic, sizeof (header)) == 0;
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class BinaryEditFileTests   : public juce::UnitTest
+{
+public:
+    BinaryEditFileTests()
+        : juce::UnitTest ("BinaryEditFile", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        beginTest ("XML round-trip equivalence");
+        {
+            auto original = createTestTree();
+            auto xml = std::unique_ptr<XmlElement> (original.createXml());
+            auto fromXml = ValueTree::fromXml (*xml);
+
+            auto decoded = writeAndRead (fromXml);
+            expect (decoded.isEquivalentTo (fromXml));
+            expectEquals (decoded.toXmlString(), fromXml.toXmlString());
+        }
+
+        beginTest ("Typed values round-trip");
+        {
+            auto original = createTestTree();
+            auto decoded = writeAndRead (original);
+            expect (decoded.isEquivalentTo (original));
+        }
+
+        beginTest ("Lazy subtree access");
+        {
+            auto original = createTestTree();
+            MemoryOutputStream os;
+            expect (BinaryEditFile::write (original, os));
+
+            BinaryEditFile file (os.getData(), os.getDataSize());
+            expect (file.isValid());
+            expectEquals (file.getVersion(), BinaryEditFile::currentVersion);
+            expectEquals (file.getNumSubtrees(), original.getNumChildren());
+            expect (file.readRoot().getNumChildren() == 0);
+
+            for (int i = original.getNumChildren(); --i >= 0;)
+            {
+                expect (file.getSubtreeType (i) == original.getChild (i).getType());
+                expect (file.readSubtree (i).isEquivalentTo (original.getChild (i)));
+            }
+        }
+
+        beginTest ("Values that don't survive packing");
+        {
+            ValueTree seq (IDs::SEQUENCE);
+
+            for (int i = 0; i < 20; ++i)
+                seq.appendChild (ValueTree (IDs::NOTE, { { IDs::p, String (i) + ".0" }, { IDs::b, i } }), nullptr);
+
+            ValueTree edit (IDs::EDIT);
+            edit.appendChild (seq, nullptr);
+            expectEquals (writeAndRead (edit).toXmlString(), edit.toXmlString());
+        }
+
+        beginTest ("Invalid data");
+        {
+            const char garbage[] = "TEDBgarbage";
+            expect (! BinaryEditFile (garbage, sizeof (garbage)).isValid());
+            expect (! BinaryEditFile (nullptr, 0).isValid());
+        }
+    }
+
+    static ValueTree writeAndRead (const ValueTree& v)
+    {
+        MemoryOutputStream os;
+        BinaryEditFile::write (v, os);
+
+        return BinaryEditFile (os.getData(), os.getDataSize()).readAll();
+    }
+
+    static ValueTree createTestTree()
+    {
+        Random r (42);
+        ValueTree edit (IDs::EDIT, { { IDs::appVersion, "Test" } });
+
+        for (int t = 0; t < 4; ++t)
+        {
+            ValueTree track (IDs::TRACK, { { IDs::name, "Track " + String (t + 1) } });
+            ValueTree clip (IDs::MIDICLIP, { { IDs::start, 0.0 }, { IDs::length, 16.25 } });
+            ValueTree seq (IDs::SEQUENCE, { { IDs::ver, 1 } });
+
+            for (int n = 0; n < 500; ++n)
+                seq.appendChild (ValueTree (IDs::NOTE, { { IDs::p, r.nextInt (128) },
+                                                         { IDs::b, n * 0.25 },
+                                                         { IDs::l, r.nextDouble() },
+                                                         { IDs::v, 100 },
+                                                         { IDs::c, 0 } }), nullptr);
+
+            ValueTree curve (IDs::AUTOMATIONCURVE, { { IDs::paramID, "volume" } });
+
+            for (int p = 0; p < 300; ++p)
+                curve.appendChild (ValueTree (IDs::POINT, { { IDs::t, p / 10.0 },
+                                                            { IDs::v, r.nextFloat() },
+                                                            { IDs::c, -0.5 } }), nullptr);
+
+            clip.appendChild (seq, nullptr);
+            track.appendChild (clip, nullptr);
+            track.appendChild (curve, nullptr);
+            edit.appendChild (track, nullptr);
+        }
+
+        edit.appendChild (ValueTree (IDs::MASTERVOLUME), nullptr);
+
+        return edit;
+    }
+};
+
+static BinaryEditFileTests binaryEditFileTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
+} // namespace tracktion_engine
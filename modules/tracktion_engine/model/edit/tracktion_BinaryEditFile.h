@@ -0,0 +1,95 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+/**
+    A versioned binary container for Edit state that can be memory-mapped and
+    read a subtree at a time.
+
+    All the type and property names are interned in a string table at the start
+    of the file, followed by an index of the root's child subtrees so these can
+    be read individually without parsing the rest of the file.
+    Runs of identical leaf children with only numeric properties (e.g. MIDI notes
+    and automation points) are stored as packed columns of values.
+
+    Reading a file back gives a tree equivalent to the one written, including
+    XML-loaded trees where the numeric properties are held as strings.
+*/
+class BinaryEditFile
+{
+public:
+    /** Memory-maps a binary Edit file. Check isValid() to see if it could be read. */
+    BinaryEditFile (const juce::File&);
+
+    /** Reads a binary Edit from a block of data. The data must outlive this object. */
+    BinaryEditFile (const void* data, size_t numBytes);
+
+    ~BinaryEditFile();
+
+    //==============================================================================
+    /** Returns true if the header and subtree index could be read. */
+    bool isValid() const noexcept                       { return valid; }
+
+    /** Returns the format version the file was written with. */
+    int getVersion() const noexcept                     { return version; }
+
+    /** Returns a copy of the root node with its properties but none of its children. */
+    juce::ValueTree readRoot() const;
+
+    /** Returns the number of the root's children stored in the index. */
+    int getNumSubtrees() const noexcept                 { return (int) subtrees.size(); }
+
+    /** Returns the type of one of the root's children without decoding it. */
+    juce::Identifier getSubtreeType (int index) const;
+
+    /** Decodes one of the root's children. */
+    juce::ValueTree readSubtree (int index) const;
+
+    /** Decodes the whole tree. */
+    juce::ValueTree readAll() const;
+
+    //==============================================================================
+    /** Writes a tree in the binary format. */
+    static bool write (const juce::ValueTree&, juce::OutputStream&);
+
+    /** Returns true if the file starts with the binary Edit header. */
+    static bool isBinaryEditFile (const juce::File&);
+
+    /** The version written by write(). */
+    static constexpr int currentVersion = 1;
+
+private:
+    struct SubtreeInfo
+    {
+        int typeIndex = 0;
+        juce::int64 offset = 0, numBytes = 0;
+    };
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    const char* dataSection = nullptr;
+    size_t dataSectionSize = 0;
+    juce::Array<juce::Identifier> identifiers;
+    std::vector<SubtreeInfo> subtrees;
+    juce::ValueTree root;
+    int version = 0;
+    bool valid = false;
+
+    void parseHeader (const void* data, size_t numBytes);
+    juce::ValueTree readNode (juce::MemoryInputStream&) const;
+    bool readProperties (juce::MemoryInputStream&, juce::ValueTree&) const;
+    bool readPackedChildren (juce::MemoryInputStream&, juce::ValueTree&, int numChildren) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BinaryEditFile)
+};
+
+} // namespace tracktion_engine
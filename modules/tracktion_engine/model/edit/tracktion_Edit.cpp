@@ -121,7 +121,7 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
             {
                 if (i == IDs::frozenIndividually || i == IDs::compGroup)
                 {
-                    restart();
+                    restart (v);
                 }
                 else if (i == IDs::frozen)
                 {
@@ -129,7 +129,7 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
                 }
                 else if (i == IDs::process)
                 {
-                    restart();
+                    restart (v);
                 }
                 else if (i == IDs::mute || i == IDs::solo || i == IDs::soloIsolate)
                 {
@@ -141,7 +141,7 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
             {
                 if (i == IDs::start || i == IDs::length || i == IDs::offset)
                 {
-                    clipMovedOrAdded (v);
+                    clipMovedOrAdded (v, v);
                 }
                 else if (i == IDs::linkID)
                 {
@@ -160,32 +160,32 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
                          || i == IDs::currentTake || i == IDs::sequence || i == IDs::repeatSequence
                          || i == IDs::loopedSequenceType || i == IDs::grooveStrength)
                 {
-                    restart();
+                    restart (v);
                 }
             }
             else if (v.hasType (IDs::COMPSECTION))
             {
-                restart();
+                restart (v);
             }
             else if (v.hasType (IDs::WARPMARKER))
             {
                 if (i == IDs::sourceTime || i == IDs::warpTime)
-                    restart();
+                    restart (v);
             }
             else if (v.hasType (IDs::QUANTISATION))
             {
                 if (i == IDs::type || i == IDs::amount)
-                    restart();
+                    restart (v);
             }
             else if (v.hasType (IDs::NOTE) || v.hasType (IDs::CONTROL) || v.hasType (IDs::SYSEX))
             {
                 if (i != IDs::c)
-                    restart();
+                    restart (v);
             }
             else if (MidiExpression::isExpression (v.getType()))
             {
                 if (i == IDs::b || i == IDs::v)
-                    restart();
+                    restart (v);
             }
             else if (v.hasType (IDs::CHANNEL))
             {
@@ -193,31 +193,31 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
                     || i == IDs::velocities || i == IDs::gates || i == IDs::probabilities 
                      || i == IDs::note || i == IDs::velocity || i == IDs::groove
                      || i == IDs::grooveStrength)
-                    restart();
+                    restart (v);
             }
             else if (v.hasType (IDs::PATTERN))
             {
                 if (i == IDs::noteLength || i == IDs::numNotes)
-                    restart();
+                    restart (v);
             }
             else if (v.hasType (IDs::SEQUENCE))
             {
                 if (i == IDs::channelNumber)
-                    restart();
+                    restart (v);
             }
             else if (v.hasType (IDs::GROOVE))
             {
                 if (i == IDs::current)
-                    restart();
+                    restart (v);
             }
             else if (v.hasType (IDs::TAKES))
             {
                 if (i == IDs::currentTake)
-                    restart();
+                    restart (v);
             }
             else if (v.hasType (IDs::SIDECHAINCONNECTION))
             {
-                restart();
+                restart (v);
             }
             else if (v.hasType (IDs::CLICKTRACK))
             {
@@ -231,19 +231,19 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
             }
             else if (v.hasType (IDs::TEMPO) || v.hasType (IDs::TIMESIG))
             {
-                restart();
+                restart (v);
                 edit.invalidateStoredLength();
             }
             else if (v.hasType (IDs::PLUGIN))
             {
                 if (i == IDs::outputDevice || i == IDs::manualAdjustMs || i == IDs::sidechainSourceID || i == IDs::ignoreVca)
-                    restart();
+                    restart (v);
             }
             else if (v.hasType (IDs::MASTERVOLUME))
             {
                 if (i == IDs::fadeIn || i == IDs::fadeOut
                      || i == IDs::fadeInType || i == IDs::fadeOutType)
-                    restart();
+                    restart (v);
             }
         }
     }
@@ -281,11 +281,11 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
              || p.hasType (IDs::LOOPINFO)
              || p.hasType (IDs::PATTERN))
         {
-            restart();
+            restart (p);
         }
         else if (Clip::isClipState (c))
         {
-            clipMovedOrAdded (c);
+            clipMovedOrAdded (c, p);
             linkedClipsChanged();
         }
         else if (TrackList::isTrack (c))
@@ -295,27 +295,27 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
         }
         else if (c.hasType (IDs::WARPMARKER))
         {
-            restart();
+            restart (p);
         }
         else if (p.hasType (IDs::TRACKCOMP))
         {
-            restart();
+            restart (p);
         }
         else if (p.hasType (IDs::TEMPOSEQUENCE))
         {
-            restart();
+            restart (p);
             edit.invalidateStoredLength();
         }
         else if (p.hasType (IDs::NOTE))
         {
-            restart();
+            restart (p);
         }
     }
 
     void valueTreeChildOrderChanged (juce::ValueTree&, int, int) override {}
     void valueTreeParentChanged (juce::ValueTree&) override {}
 
-    void clipMovedOrAdded (const juce::ValueTree& v)
+    void clipMovedOrAdded (const juce::ValueTree& v, const juce::ValueTree& changedState)
     {
         edit.invalidateStoredLength();
 
@@ -324,7 +324,7 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
              || v.hasType (IDs::STEPCLIP)
              || v.hasType (IDs::EDITCLIP)
              || v.hasType (IDs::CHORDCLIP))
-            restart();
+            restart (changedState);
     }
 
     void restart()
@@ -332,6 +332,11 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
         edit.restartPlayback();
     }
 
+    void restart (const juce::ValueTree& changedState)
+    {
+        edit.restartPlaybackForChange (changedState);
+    }
+
     void updateTrackStatusesAsync()
     {
         if (trackStatusUpdater == nullptr)
@@ -484,6 +489,7 @@ Edit::Edit (Options options)
       instanceId (getNextInstanceId()),
       editProjectItemID (options.editProjectItemID),
       loadContext (options.loadContext),
+      deferPluginInstantiation (options.loadPluginsInParallel),
       editRole (options.role)
 {
     CRASH_TRACER
@@ -690,6 +696,7 @@ void Edit::initialise()
     initialiseAuxBusses();
     initialiseAudioDevices();
     loadTracks();
+    initialisePluginsInParallel();
 
     if (loadContext != nullptr)
         loadContext->progress = 1.0f;
@@ -1027,12 +1034,38 @@ bool Edit::hasChangedSinceSaved() const
 
 void Edit::restartPlayback()
 {
+    playbackGraphChanges.everythingChanged = true;
+    shouldRestartPlayback = true;
+
+    if (! isTimerRunning())
+        startTimer (1);
+}
+
+void Edit::restartPlaybackForChange (const juce::ValueTree& changedState)
+{
+    // Only changes inside a single audio track can be limited to that track,
+    // anything else could affect the nodes of any other track
+    auto trackState = changedState;
+
+    while (trackState.isValid() && ! TrackList::isTrack (trackState))
+        trackState = trackState.getParent();
+
+    if (trackState.hasType (IDs::TRACK))
+        playbackGraphChanges.changedTracks.addIfNotAlreadyThere (EditItemID::fromID (trackState));
+    else
+        playbackGraphChanges.everythingChanged = true;
+
     shouldRestartPlayback = true;
 
     if (! isTimerRunning())
         startTimer (1);
 }
 
+Edit::PlaybackGraphChanges Edit::takePlaybackGraphChanges()
+{
+    return std::exchange (playbackGraphChanges, {});
+}
+
 EditPlaybackContext* Edit::getCurrentPlaybackContext() const
 {
     return transportControl->getCurrentPlaybackContext();
@@ -1263,6 +1296,10 @@ void Edit::updateMuteSoloStatuses()
         return true;
     });
 
+    // Plugins that were deferred whilst their track was muted are needed now it's been unmuted
+    if (! isLoading())
+        initialiseDeferredPlugins();
+
     auto& ecm = engine.getExternalControllerManager();
 
     if (ecm.isAttachedToEdit (this))
@@ -2054,6 +2091,53 @@ void Edit::initialiseAllPlugins()
         p->initialiseFully();
 }
 
+void Edit::initialisePluginsInParallel()
+{
+    if (! deferPluginInstantiation)
+        return;
+
+    CRASH_TRACER
+    deferPluginInstantiation = false;
+
+    // This is called from the constructor so nothing is created here. The plugins are started
+    // once the Edit has been created and those on muted or frozen tracks are left until needed
+    for (auto p : pluginCache->getPlugins())
+    {
+        if (auto ep = dynamic_cast<ExternalPlugin*> (p.get()))
+        {
+            ep->deferInitialisation();
+
+            if (ep->isInitialisationDeferred() && ep->isOnInaudibleTrack())
+                reportPluginLoadTime (*ep, 0.0, true);
+        }
+    }
+
+    juce::MessageManager::callAsync ([ref = getWeakRef()]
+                                     {
+                                         if (ref != nullptr)
+                                             ref->initialiseDeferredPlugins();
+                                     });
+}
+
+void Edit::initialiseDeferredPlugins()
+{
+    CRASH_TRACER
+    juce::Array<ExternalPlugin*> pluginsToLoad;
+
+    for (auto p : pluginCache->getPlugins())
+        if (auto ep = dynamic_cast<ExternalPlugin*> (p.get()))
+            if (ep->isInitialisationDeferred() && ! ep->isOnInaudibleTrack())
+                pluginsToLoad.add (ep);
+
+    ExternalPlugin::initialisePluginsConcurrently (pluginsToLoad);
+}
+
+void Edit::reportPluginLoadTime (Plugin& p, double seconds, bool wasDeferred)
+{
+    if (loadContext != nullptr)
+        loadContext->addPluginLoadTime ({ p.itemID, p.getName(), seconds, wasDeferred });
+}
+
 //==============================================================================
 InputDeviceInstance* Edit::getCurrentInstanceForInputDevice (InputDevice* d) const
 {
@@ -52,6 +52,35 @@ public:
         std::atomic<float> progress  { 0.0f };
         std::atomic<bool> completed  { false };
         std::atomic<bool> shouldExit { false };
+
+        /** Describes how long a plugin took to load. */
+        struct PluginLoadTime
+        {
+            EditItemID pluginID;
+            juce::String name;
+            double seconds = 0.0;   /**< The time taken to create and restore the plugin. Plugins that are
+                                         loaded asynchronously with Options::loadPluginsInParallel are
+                                         created after loading has finished so aren't reported. */
+            bool deferred = false;  /**< True if loading was deferred as the plugin was on a muted or frozen track. */
+        };
+
+        /** Returns the load times of the plugins that have been loaded so far. */
+        std::vector<PluginLoadTime> getPluginLoadTimes() const
+        {
+            const juce::ScopedLock sl (pluginLoadTimesLock);
+            return pluginLoadTimes;
+        }
+
+        /** @internal */
+        void addPluginLoadTime (PluginLoadTime t)
+        {
+            const juce::ScopedLock sl (pluginLoadTimesLock);
+            pluginLoadTimes.push_back (std::move (t));
+        }
+
+    private:
+        juce::CriticalSection pluginLoadTimesLock;
+        std::vector<PluginLoadTime> pluginLoadTimes;
     };
 
     //==============================================================================
@@ -65,6 +94,10 @@ public:
         EditRole role = forEditing;                                         /**< An optional role to open the Edit with. */
         LoadContext* loadContext = nullptr;                                 /**< An optional context to be monitor for loading status. */
         int numUndoLevelsToStore = Edit::getDefaultNumUndoLevels();         /**< The number of undo levels to use. */
+        bool loadPluginsInParallel = false;                                 /**< If true, external plugin instances are created concurrently and
+                                                                                 asynchronously after the Edit has been created, so they'll be bypassed
+                                                                                 until they're ready. Plugins on muted or frozen tracks are deferred until
+                                                                                 their tracks can be heard. */
 
         std::function<juce::File()> editFileRetriever;                      /**< An optional editFileRetriever to use. */
         std::function<juce::File (const juce::String&)> filePathResolver;   /**< An optional filePathResolver to use. */
@@ -136,6 +169,15 @@ public:
     /** Returns true if the Edit's not yet fully loaded */
     bool isLoading() const                                              { return isLoadInProgress; }
 
+    /** Returns true if external plugins should hold off creating their instances as
+        the Edit will create them concurrently once it has been created.
+        @see Options::loadPluginsInParallel
+    */
+    bool shouldDeferPluginInstantiation() const noexcept                { return deferPluginInstantiation; }
+
+    /** @internal Called by plugins during loading so their timings can be added to the LoadContext. */
+    void reportPluginLoadTime (Plugin&, double seconds, bool wasDeferred);
+
     static std::unique_ptr<Edit> createEditForPreviewingFile (Engine&, const juce::File&, const Edit* editToMatch,
                                                               bool tryToMatchTempo, bool tryToMatchPitch, bool* couldMatchTempo,
                                                               juce::ValueTree midiPreviewPlugin,
@@ -219,6 +261,26 @@ public:
     /** use this to tell the play engine to rebuild the audio graph and restart. */
     void restartPlayback();
 
+    /** Like restartPlayback(), but if the change is inside a single track, the
+        nodes of the other tracks can be reused when the graph is rebuilt.
+    */
+    void restartPlaybackForChange (const juce::ValueTree& changedState);
+
+    /** Describes what has changed since the playback graph was last built.
+        If only some tracks have changed, the nodes for the others may be reused.
+        @see EngineBehaviour::shouldReuseUnchangedTrackNodes
+    */
+    struct PlaybackGraphChanges
+    {
+        juce::Array<EditItemID> changedTracks;
+        bool everythingChanged = false;     /**< Set by changes that aren't limited to a single track. */
+    };
+
+    /** Returns the changes since this was last called and resets them.
+        This is called by the EditPlaybackContext when it rebuilds its graph.
+    */
+    PlaybackGraphChanges takePlaybackGraphChanges();
+
     //==============================================================================
     TrackList& getTrackList()                                   { return *trackList; }
 
@@ -527,11 +589,13 @@ private:
     std::atomic<bool> isLoadInProgress { true };
     std::atomic<int> performingRenderCount { 0 };
     bool shouldRestartPlayback = false;
+    PlaybackGraphChanges playbackGraphChanges;
     bool blinkBright = false;
     bool lowLatencyMonitoring = false;
     bool hasChanged = false;
     bool ignoreLeftViewLimit;
     LoadContext* loadContext = nullptr;
+    bool deferPluginInstantiation = false;
     juce::UndoManager undoManager;
     int numUndoTransactionInhibitors = 0;
     mutable juce::File tempDirectory;
@@ -581,6 +645,8 @@ private:
     void initialiseRacks();
     void initialiseAuxBusses();
     void initialiseMasterPlugins();
+    void initialisePluginsInParallel();
+    void initialiseDeferredPlugins();
     void initialiseMetadata();
     void initialiseControllerMappings();
     void initialiseAutomap();
@@ -25,10 +25,16 @@ struct ThreadedEditFileWriter   : private Thread
 
     void writeTreeToFile (ValueTree&& v, const File& f)
     {
-        TRACKTION_ASSERT_MESSAGE_THREAD
-        pending.add (std::pair<ValueTree, File> (v, f));
-        waiter.signal();
-        startThread();
+        addJob ([v, f] { EditJournal::writeSnapshot (v, f); });
+    }
+
+    void appendToJournal (MemoryBlock&& record, const File& f)
+    {
+        addJob ([record = std::move (record), f]
+                {
+                    EditJournal::appendChangeRecord (record, f);
+                    EditJournal::compactIfNeeded (f);
+                });
     }
 
     void flushAllFiles()
@@ -47,20 +53,22 @@ private:
         while (! threadShouldExit())
         {
             while (! pending.isEmpty())
-                writeToFile (pending.removeAndReturn (0));
+                pending.removeAndReturn (0)();
 
             waiter.wait (1000);
         }
     }
 
-    void writeToFile (std::pair<ValueTree, File> item)
+    void addJob (std::function<void()> job)
     {
-        item.second.deleteFile();
-        FileOutputStream os (item.second);
-        item.first.writeToStream (os);
+        TRACKTION_ASSERT_MESSAGE_THREAD
+        pending.add (std::move (job));
+        waiter.signal();
+        startThread();
     }
 
-    juce::Array<std::pair<ValueTree, File>, CriticalSection> pending;
+    // Jobs are run in order so journal records always follow the snapshot they apply to
+    juce::Array<std::function<void()>, CriticalSection> pending;
     WaitableEvent waiter;
 };
 
@@ -81,7 +89,10 @@ struct SharedEditFileDataCache
 
             // If we managed to shutdown cleanly (i.e. without crashing) then delete the temp file
             if (auto item = edit.engine.getProjectManager().getProjectItem (edit))
-                EditFileOperations::getTempVersionOfEditFile (item->getSourceFile()).deleteFile();
+            {
+                auto tempFile = EditFileOperations::getTempVersionOfEditFile (item->getSourceFile());
+                EditJournal::deleteSnapshot (tempFile);
+            }
         }
 
         void refresh()
@@ -92,6 +103,7 @@ struct SharedEditFileDataCache
         Edit& edit;
         Time timeOfLastSave { Time::getCurrentTime() };
         EditSnapshot::Ptr editSnapshot { EditSnapshot::getEditSnapshot (edit.engine, edit.getProjectItemID()) };
+        EditJournal journal { edit.state };
     };
 
     SharedEditFileDataCache() = default;
@@ -146,6 +158,27 @@ struct EditFileOperations::SharedDataPimpl
         editFileWriter->writeTreeToFile (std::move (v), f);
     }
 
+    void writeChangesToDisk (Edit& edit, const File& f)
+    {
+        auto& journal = data->journal;
+
+        // The journal is relative to the temp file so anything else just gets a full snapshot,
+        // leaving the changes to be written to the temp file next time
+        if (f != EditFileOperations::getTempVersionOfEditFile (edit.editFileRetriever()))
+        {
+            writeValueTreeToDisk (edit.state.createCopy(), f);
+        }
+        else if (journal.needsFullSnapshot (f))
+        {
+            journal.snapshotTaken (f);
+            writeValueTreeToDisk (edit.state.createCopy(), f);
+        }
+        else if (journal.hasChanges())
+        {
+            editFileWriter->appendToJournal (journal.createChangeRecord(), f);
+        }
+    }
+
     SharedResourcePointer<SharedEditFileDataCache> cache;
     std::shared_ptr<SharedEditFileDataCache::Data> data;
     SharedResourcePointer<ThreadedEditFileWriter> editFileWriter;
@@ -187,17 +220,37 @@ bool EditFileOperations::writeToFile (const File& file, bool writeQuickBinaryVer
     {
         if (writeQuickBinaryVersion)
         {
-            sharedDataPimpl->writeValueTreeToDisk (edit.state.createCopy(), file);
+            sharedDataPimpl->writeChangesToDisk (edit, file);
         }
         else
         {
             edit.flushState();
 
+            auto& journal = sharedDataPimpl->data->journal;
+            const bool isTempFile = file == getTempVersionFile();
+
             if (editSnapshot != nullptr)
                 editSnapshot->setState (edit.state, edit.getLength());
 
-            if (auto xml = std::unique_ptr<XmlElement> (edit.state.createXml()))
-                ok = xml->writeTo (file);
+            if (edit.engine.getEngineBehaviour().shouldSaveEditsAsBinary())
+                ok = EditJournal::writeSnapshot (edit.state, file);
+
+            if (ok)
+            {
+                // The temp file is now a snapshot so the next quick save only needs the changes
+                if (isTempFile)
+                    journal.snapshotTaken (file);
+            }
+            else
+            {
+                if (isTempFile)
+                    journal.invalidateSnapshot();
+
+                EditJournal::getJournalFile (file).deleteFile();
+
+                if (auto xml = std::unique_ptr<XmlElement> (edit.state.createXml()))
+                    ok = xml->writeTo (file);
+            }
 
             jassert (ok);
         }
@@ -249,6 +302,9 @@ bool EditFileOperations::save (bool warnOfFailure,
     if (! saveTempVersion (true))
         return editSaveError (edit, tempFile, warnOfFailure);
 
+    // The temp file is always moved or deleted from here on so the next temp save needs a new snapshot
+    sharedDataPimpl->data->journal.invalidateSnapshot();
+
     if (forceSaveEvenIfNotModified || edit.hasChangedSinceSaved())
     {
         // Updates the project list if showing
@@ -265,7 +321,7 @@ bool EditFileOperations::save (bool warnOfFailure,
 
             if (r != 1)
             {
-                tempFile.deleteFile();
+                EditJournal::deleteSnapshot (tempFile);
                 return r == 2;
             }
         }
@@ -273,13 +329,13 @@ bool EditFileOperations::save (bool warnOfFailure,
         if (editSnapshot != nullptr)
             editSnapshot->refreshCacheAndNotifyListeners();
 
-        if (! tempFile.moveFileTo (editFile))
+        if (! EditJournal::moveSnapshot (tempFile, editFile))
             return editSaveError (edit, editFile, warnOfFailure);
 
         edit.engine.getEngineBehaviour().editHasBeenSaved (edit, editFile);
     }
 
-    tempFile.deleteFile();
+    EditJournal::deleteSnapshot (tempFile);
 
     if (auto item = edit.engine.getProjectManager().getProjectItem (edit))
         item->setLength (edit.getLength());
@@ -346,7 +402,7 @@ bool EditFileOperations::saveAs (const File& f, bool forceOverwriteExisting)
                     const bool ok = save (true, true, false);
 
                     if (ok)
-                        oldTempFile.deleteFile();
+                        EditJournal::deleteSnapshot (oldTempFile);
 
                     edit.sendSourceFileUpdate();
                     return ok;
@@ -367,16 +423,19 @@ bool EditFileOperations::saveAs (const File& f, bool forceOverwriteExisting)
         if (! saveTempVersion (true))
             return editSaveError (edit, tempFile, true);
 
+        // The temp file is moved to the new file so the next temp save needs a new snapshot
+        sharedDataPimpl->data->journal.invalidateSnapshot();
+
         if (editSnapshot != nullptr)
             editSnapshot->refreshCacheAndNotifyListeners();
 
         if (f.existsAsFile())
             f.deleteFile();
 
-        if (! tempFile.moveFileTo (f))
+        if (! EditJournal::moveSnapshot (tempFile, f))
             return editSaveError (edit, f, true);
 
-        tempFile.deleteFile();
+        EditJournal::deleteSnapshot (tempFile);
 
         edit.resetChangedStatus();
         edit.engine.getEngineBehaviour().editHasBeenSaved (edit, f);
@@ -411,7 +470,9 @@ File EditFileOperations::getTempVersionFile() const
 
 void EditFileOperations::deleteTempVersion()
 {
-    getTempVersionFile().deleteFile();
+    sharedDataPimpl->editFileWriter->flushAllFiles();
+    sharedDataPimpl->data->journal.invalidateSnapshot();
+    EditJournal::deleteSnapshot (getTempVersionFile());
 }
 
 //==============================================================================
@@ -434,10 +495,16 @@ ValueTree loadEditFromFile (Engine& e, const File& f, ProjectItemID itemID)
     CRASH_TRACER
     ValueTree state;
 
-    if (auto xml = std::unique_ptr<XmlElement> (XmlDocument::parse (f)))
+    if (BinaryEditFile::isBinaryEditFile (f))
+        state = updateLegacyEdit (EditJournal::readSnapshot (f));
+
+    if (! state.isValid())
     {
-        updateLegacyEdit (*xml);
-        state = ValueTree::fromXml (*xml);
+        if (auto xml = std::unique_ptr<XmlElement> (XmlDocument::parse (f)))
+        {
+            updateLegacyEdit (*xml);
+            state = ValueTree::fromXml (*xml);
+        }
     }
 
     if (! state.isValid())
@@ -464,4 +531,73 @@ ValueTree createEmptyEdit (Engine& e)
     return loadEditFromFile (e, {}, ProjectItemID::createNewID (0));
 }
 
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class EditFileOperationsTests   : public juce::UnitTest
+{
+public:
+    EditFileOperationsTests()
+        : juce::UnitTest ("EditFileOperations", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+        auto edit = Edit::createSingleTrackEdit (engine);
+        edit->ensureNumberOfAudioTracks (3);
+        getAudioTracks (*edit)[2]->setName ("Saved Track");
+
+        beginTest ("Saved Edits use the chosen format");
+        {
+            TemporaryFile tf (editFileSuffix);
+            const auto f = tf.getFile();
+
+            expect (EditFileOperations (*edit).writeToFile (f, false));
+            expect (BinaryEditFile::isBinaryEditFile (f) == engine.getEngineBehaviour().shouldSaveEditsAsBinary());
+            expectLoadedTracksMatch (engine, f);
+        }
+
+        beginTest ("Binary Edits load");
+        {
+            TemporaryFile tf (editFileSuffix);
+            const auto f = tf.getFile();
+
+            expect (EditJournal::writeSnapshot (edit->state, f));
+            expect (BinaryEditFile::isBinaryEditFile (f));
+            expectLoadedTracksMatch (engine, f);
+        }
+
+        beginTest ("XML Edits still load");
+        {
+            TemporaryFile tf (editFileSuffix);
+            const auto f = tf.getFile();
+
+            if (auto xml = std::unique_ptr<XmlElement> (edit->state.createXml()))
+                expect (xml->writeTo (f));
+
+            expect (! BinaryEditFile::isBinaryEditFile (f));
+            expectLoadedTracksMatch (engine, f);
+        }
+    }
+
+private:
+    void expectLoadedTracksMatch (Engine& engine, const File& f)
+    {
+        auto state = loadEditFromFile (engine, f, ProjectItemID::createNewID (0));
+        Array<ValueTree> tracks;
+
+        for (auto v : state)
+            if (v.hasType (IDs::TRACK))
+                tracks.add (v);
+
+        expectEquals (tracks.size(), 3);
+        expectEquals (tracks[2][IDs::name].toString(), String ("Saved Track"));
+    }
+};
+
+static EditFileOperationsTests editFileOperationsTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
 }
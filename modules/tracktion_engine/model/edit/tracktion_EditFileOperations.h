@@ -32,6 +32,11 @@ public:
     bool saveTempVersion (bool forceSaveEvenIfUnchanged);
     void deleteTempVersion();
     juce::File getTempVersionFile() const;
+
+    /** Returns the file that temp versions of an Edit are saved to.
+        Changes are journaled next to this so to recover it after a crash, use
+        EditJournal::moveSnapshot() rather than just moving the file.
+    */
     static juce::File getTempVersionOfEditFile (const juce::File&);
     static void updateEditFiles();
 
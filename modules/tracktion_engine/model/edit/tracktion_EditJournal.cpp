@@ -0,0 +1,673 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+namespace EditJournalHelpers
+{
+    enum Operation
+    {
+        rootProperties  = 1,
+        insertChild     = 2,
+        removeChild     = 3,
+        moveChild       = 4,
+        replaceChild    = 5,
+        replaceTree     = 6,
+        setProperties   = 7
+    };
+
+    static constexpr juce::int64 minSizeToCompact = 1024 * 1024;
+
+    // Past this many changed trees, their parents get written instead to keep marking changes fast
+    static constexpr int maxNumChangedProperties = 1024;
+
+    static void writePath (juce::OutputStream& out, const juce::Array<int>& path)
+    {
+        out.writeCompressedInt (path.size());
+
+        for (auto i : path)
+            out.writeCompressedInt (i);
+    }
+
+    static juce::ValueTree readPath (juce::InputStream& in, juce::ValueTree root)
+    {
+        const int depth = in.readCompressedInt();
+
+        if (depth <= 0)
+            return {};
+
+        for (int i = 0; i < depth && root.isValid(); ++i)
+            root = root.getChild (in.readCompressedInt());
+
+        return root;
+    }
+
+    static void writeProperties (juce::OutputStream& out, const juce::ValueTree& v)
+    {
+        out.writeCompressedInt (v.getNumProperties());
+
+        for (int i = 0; i < v.getNumProperties(); ++i)
+        {
+            auto name = v.getPropertyName (i);
+            out.writeString (name.toString());
+            v.getProperty (name).writeToStream (out);
+        }
+    }
+
+    static bool readProperties (juce::InputStream& in, juce::ValueTree& v)
+    {
+        v.removeAllProperties (nullptr);
+        const int numProperties = in.readCompressedInt();
+
+        for (int i = 0; i < numProperties; ++i)
+        {
+            auto name = in.readString();
+            auto value = juce::var::readFromStream (in);
+
+            if (name.isEmpty())
+                return false;
+
+            v.setProperty (juce::Identifier (name), value, nullptr);
+        }
+
+        return true;
+    }
+}
+
+//==============================================================================
+EditJournal::EditJournal (const ValueTree& editState)
+    : state (editState)
+{
+    state.addListener (this);
+}
+
+EditJournal::~EditJournal()
+{
+    state.removeListener (this);
+}
+
+bool EditJournal::hasChanges() const noexcept
+{
+    return rootPropertiesChanged
+            || structuralChanges.getDataSize() > 0
+            || ! changedTrees.isEmpty()
+            || ! changedProperties.isEmpty();
+}
+
+void EditJournal::snapshotTaken (const File& snapshotFile)
+{
+    clearChanges();
+    lastSnapshotFile = snapshotFile;
+}
+
+void EditJournal::invalidateSnapshot()
+{
+    clearChanges();
+    lastSnapshotFile = File();
+}
+
+void EditJournal::clearChanges()
+{
+    structuralChanges.reset();
+    changedTrees.clearQuick();
+    changedProperties.clearQuick();
+    lastChangedProperties = {};
+    rootPropertiesChanged = false;
+}
+
+MemoryBlock EditJournal::createChangeRecord()
+{
+    using namespace EditJournalHelpers;
+    CRASH_TRACER
+    jassert (lastSnapshotFile != File());
+
+    MemoryOutputStream out;
+    out.write (structuralChanges.getData(), structuralChanges.getDataSize());
+
+    if (rootPropertiesChanged)
+    {
+        out.writeByte ((char) rootProperties);
+        writeProperties (out, state);
+    }
+
+    // The paths are found now, after any structural changes at the root have been applied
+    Array<int> path;
+
+    for (auto& v : changedTrees)
+    {
+        if (! getPathToChange (v, path, false))
+            continue;
+
+        out.writeByte ((char) replaceTree);
+        writePath (out, path);
+        v.writeToStream (out);
+    }
+
+    for (auto& v : changedProperties)
+    {
+        if (! getPathToChange (v, path, true))
+            continue;
+
+        out.writeByte ((char) setProperties);
+        writePath (out, path);
+        writeProperties (out, v);
+    }
+
+    clearChanges();
+
+    return out.getMemoryBlock();
+}
+
+//==============================================================================
+bool EditJournal::getPathToChange (ValueTree v, Array<int>& path, bool includeThisTree) const
+{
+    path.clearQuick();
+
+    if (includeThisTree && changedTrees.contains (v))
+        return false;
+
+    for (;;)
+    {
+        auto parent = v.getParent();
+
+        if (! parent.isValid())
+            return false;
+
+        path.insert (0, parent.indexOf (v));
+
+        if (parent == state)
+            return true;
+
+        // This will be written with the tree it's in
+        if (changedTrees.contains (parent))
+            return false;
+
+        v = parent;
+    }
+}
+
+void EditJournal::markTreeChanged (const ValueTree& v)
+{
+    changedTrees.addIfNotAlreadyThere (v);
+}
+
+void EditJournal::markPropertiesChanged (const ValueTree& v)
+{
+    using namespace EditJournalHelpers;
+
+    if (v == lastChangedProperties)
+        return;
+
+    lastChangedProperties = v;
+
+    if (changedProperties.size() < maxNumChangedProperties)
+    {
+        changedProperties.addIfNotAlreadyThere (v);
+        return;
+    }
+
+    auto parent = v.getParent();
+    markTreeChanged (parent.isValid() && parent != state ? parent : v);
+}
+
+void EditJournal::valueTreePropertyChanged (ValueTree& v, const Identifier&)
+{
+    if (v == state)
+        rootPropertiesChanged = true;
+    else
+        markPropertiesChanged (v);
+}
+
+void EditJournal::valueTreeChildAdded (ValueTree& parent, ValueTree& child)
+{
+    using namespace EditJournalHelpers;
+
+    if (parent == state)
+    {
+        // The inserted tree gets filled in by the replace record for it
+        structuralChanges.writeByte ((char) insertChild);
+        structuralChanges.writeCompressedInt (state.indexOf (child));
+        structuralChanges.writeString (child.getType().toString());
+        markTreeChanged (child);
+    }
+    else
+    {
+        markTreeChanged (parent);
+    }
+}
+
+void EditJournal::valueTreeChildRemoved (ValueTree& parent, ValueTree&, int index)
+{
+    using namespace EditJournalHelpers;
+
+    if (parent == state)
+    {
+        structuralChanges.writeByte ((char) removeChild);
+        structuralChanges.writeCompressedInt (index);
+    }
+    else
+    {
+        markTreeChanged (parent);
+    }
+}
+
+void EditJournal::valueTreeChildOrderChanged (ValueTree& parent, int oldIndex, int newIndex)
+{
+    using namespace EditJournalHelpers;
+
+    if (parent == state)
+    {
+        structuralChanges.writeByte ((char) moveChild);
+        structuralChanges.writeCompressedInt (oldIndex);
+        structuralChanges.writeCompressedInt (newIndex);
+    }
+    else
+    {
+        markTreeChanged (parent);
+    }
+}
+
+void EditJournal::valueTreeRedirected (ValueTree&)
+{
+    invalidateSnapshot();
+}
+
+//==============================================================================
+File EditJournal::getJournalFile (const File& snapshotFile)
+{
+    return snapshotFile != File() ? snapshotFile.getSiblingFile (snapshotFile.getFileName() + ".journal")
+                                  : File();
+}
+
+bool EditJournal::writeSnapshot (const ValueTree& v, const File& snapshotFile)
+{
+    CRASH_TRACER
+
+    // Write to a separate file first so the old snapshot and journal are still usable if this fails
+    TemporaryFile tempFile (snapshotFile);
+
+    {
+        FileOutputStream os (tempFile.getFile());
+
+        if (! (os.openedOk() && BinaryEditFile::write (v, os)))
+            return false;
+
+        os.flush();
+
+        if (! os.getStatus().wasOk())
+            return false;
+    }
+
+    if (! tempFile.overwriteTargetFileWithTemporary())
+        return false;
+
+    getJournalFile (snapshotFile).deleteFile();
+
+    return true;
+}
+
+bool EditJournal::moveSnapshot (const File& sourceFile, const File& destFile)
+{
+    auto sourceJournal = getJournalFile (sourceFile);
+    auto destJournal = getJournalFile (destFile);
+
+    if (! destJournal.deleteFile())
+        return false;
+
+    if (! sourceFile.moveFileTo (destFile))
+        return false;
+
+    return ! sourceJournal.existsAsFile() || sourceJournal.moveFileTo (destJournal);
+}
+
+bool EditJournal::deleteSnapshot (const File& snapshotFile)
+{
+    const bool journalDeleted = getJournalFile (snapshotFile).deleteFile();
+    return snapshotFile.deleteFile() && journalDeleted;
+}
+
+bool EditJournal::appendChangeRecord (const MemoryBlock& record, const File& snapshotFile)
+{
+    CRASH_TRACER
+
+    if (record.getSize() == 0)
+        return true;
+
+    FileOutputStream os (getJournalFile (snapshotFile));
+
+    if (! os.openedOk())
+        return false;
+
+    // Each record is prefixed with its size so a partially written one can be ignored
+    const bool ok = os.writeInt ((int) record.getSize())
+                     && os.write (record.getData(), record.getSize());
+    os.flush();
+
+    return ok && os.getStatus().wasOk();
+}
+
+bool EditJournal::applyChangeRecord (ValueTree& root, const void* data, size_t numBytes)
+{
+    using namespace EditJournalHelpers;
+    MemoryInputStream in (data, numBytes, false);
+
+    while (! in.isExhausted())
+    {
+        switch (in.readByte())
+        {
+            case rootProperties:
+            {
+                if (! readProperties (in, root))
+                    return false;
+
+                break;
+            }
+
+            case insertChild:
+            {
+                const int index = in.readCompressedInt();
+                auto type = in.readString();
+
+                if (type.isEmpty() || ! isPositiveAndNotGreaterThan (index, root.getNumChildren()))
+                    return false;
+
+                root.addChild (ValueTree (Identifier (type)), index, nullptr);
+                break;
+            }
+
+            case removeChild:
+            {
+                const int index = in.readCompressedInt();
+
+                if (! isPositiveAndBelow (index, root.getNumChildren()))
+                    return false;
+
+                root.removeChild (index, nullptr);
+                break;
+            }
+
+            case moveChild:
+            {
+                const int oldIndex = in.readCompressedInt();
+                const int newIndex = in.readCompressedInt();
+
+                if (! (isPositiveAndBelow (oldIndex, root.getNumChildren())
+                        && isPositiveAndBelow (newIndex, root.getNumChildren())))
+                    return false;
+
+                root.moveChild (oldIndex, newIndex, nullptr);
+                break;
+            }
+
+            case replaceChild:
+            {
+                const int index = in.readCompressedInt();
+                auto v = ValueTree::readFromStream (in);
+
+                if (! v.isValid() || ! isPositiveAndBelow (index, root.getNumChildren()))
+                    return false;
+
+                root.removeChild (index, nullptr);
+                root.addChild (v, index, nullptr);
+                break;
+            }
+
+            case replaceTree:
+            {
+                auto target = readPath (in, root);
+                auto v = ValueTree::readFromStream (in);
+                auto parent = target.getParent();
+
+                if (! (v.isValid() && parent.isValid()))
+                    return false;
+
+                const int index = parent.indexOf (target);
+                parent.removeChild (index, nullptr);
+                parent.addChild (v, index, nullptr);
+                break;
+            }
+
+            case setProperties:
+            {
+                auto target = readPath (in, root);
+
+                if (! (target.isValid() && readProperties (in, target)))
+                    return false;
+
+                break;
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+ValueTree EditJournal::readSnapshot (const File& snapshotFile)
+{
+    CRASH_TRACER
+    BinaryEditFile snapshot (snapshotFile);
+
+    if (! snapshot.isValid())
+        return {};
+
+    // A subtree that can't be decoded fails the whole load, as leaving it out would lose it
+    // for good the next time the Edit is saved
+    auto v = snapshot.readRoot();
+
+    for (int i = 0; i < snapshot.getNumSubtrees(); ++i)
+    {
+        auto subtree = snapshot.readSubtree (i);
+
+        if (! subtree.isValid())
+        {
+            TRACKTION_LOG_ERROR ("Unable to read " + snapshot.getSubtreeType (i).toString()
+                                   + " from: " + snapshotFile.getFullPathName());
+            return {};
+        }
+
+        v.appendChild (subtree, nullptr);
+    }
+
+    FileInputStream in (getJournalFile (snapshotFile));
+
+    if (v.isValid() && in.openedOk())
+    {
+        MemoryBlock record;
+
+        while (! in.isExhausted())
+        {
+            const int size = in.readInt();
+
+            if (size <= 0 || size > in.getNumBytesRemaining())
+                break;
+
+            record.setSize ((size_t) size);
+
+            if (in.read (record.getData(), size) != size
+                 || ! applyChangeRecord (v, record.getData(), record.getSize()))
+                break;
+        }
+    }
+
+    return v;
+}
+
+bool EditJournal::compactIfNeeded (const File& snapshotFile)
+{
+    auto journalFile = getJournalFile (snapshotFile);
+    auto journalSize = journalFile.getSize();
+
+    if (journalSize < jmax (EditJournalHelpers::minSizeToCompact, snapshotFile.getSize()))
+        return true;
+
+    CRASH_TRACER
+    auto v = readSnapshot (snapshotFile);
+
+    if (! v.isValid())
+        return false;
+
+    // Write to a separate file first so the old snapshot and journal are still usable if this fails
+    TemporaryFile tempFile (snapshotFile);
+
+    {
+        FileOutputStream os (tempFile.getFile());
+
+        if (! (os.openedOk() && BinaryEditFile::write (v, os)))
+            return false;
+    }
+
+    if (! tempFile.overwriteTargetFileWithTemporary())
+        return false;
+
+    return journalFile.deleteFile();
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class EditJournalTests  : public juce::UnitTest
+{
+public:
+    EditJournalTests()
+        : juce::UnitTest ("EditJournal", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        beginTest ("Change records");
+        {
+            auto state = createTestTree();
+            EditJournal journal (state);
+            const File snapshotFile ("/snapshot.tmp"), otherFile ("/other.tmp");
+            expect (journal.needsFullSnapshot (snapshotFile));
+
+            auto snapshot = state.createCopy();
+            journal.snapshotTaken (snapshotFile);
+            expect (! journal.needsFullSnapshot (snapshotFile));
+            expect (journal.needsFullSnapshot (otherFile));
+            expect (! journal.hasChanges());
+
+            state.getChild (1).getChild (0).setProperty (IDs::name, "Changed", nullptr);
+            state.setProperty (IDs::appVersion, "Test 2", nullptr);
+            expect (journal.hasChanges());
+            expectAppliedRecordMatches (journal, state, snapshot);
+
+            state.moveChild (0, 2, nullptr);
+            state.removeChild (1, nullptr);
+            state.addChild (createTrack (42), 1, nullptr);
+            state.getChild (1).getChild (0).setProperty (IDs::start, 1.5, nullptr);
+            state.addChild (createTrack (43), -1, nullptr);
+            state.getChild (0).removeAllChildren (nullptr);
+            expectAppliedRecordMatches (journal, state, snapshot);
+
+            expect (journal.createChangeRecord().getSize() == 0);
+        }
+
+        beginTest ("Records only contain what changed");
+        {
+            auto state = createTestTree();
+            auto track = state.getChild (2);
+
+            for (int i = 0; i < 100; ++i)
+                track.appendChild (ValueTree (IDs::MIDICLIP, { { IDs::start, (double) i }, { IDs::length, 1.0 } }), nullptr);
+
+            EditJournal journal (state);
+            journal.snapshotTaken (File ("/snapshot.tmp"));
+            auto snapshot = state.createCopy();
+
+            track.getChild (50).setProperty (IDs::start, 100.0, nullptr);
+            auto record = journal.createChangeRecord();
+            expect (record.getSize() < 100, "A property change should only write that tree's properties");
+            expect (EditJournal::applyChangeRecord (snapshot, record.getData(), record.getSize()));
+            expect (snapshot.isEquivalentTo (state));
+
+            track.getChild (10).appendChild (ValueTree (IDs::NOTE, { { IDs::p, 60 } }), nullptr);
+            track.getChild (20).setProperty (IDs::length, 2.0, nullptr);
+            track.getChild (10).getChild (0).setProperty (IDs::p, 61, nullptr);
+            track.moveChild (0, 5, nullptr);
+            expectAppliedRecordMatches (journal, state, snapshot);
+        }
+
+        beginTest ("Moving snapshots");
+        {
+            auto state = createTestTree();
+            EditJournal journal (state);
+            TemporaryFile source (".snapshot"), dest (".snapshot");
+
+            expect (writeSnapshot (state, source.getFile()));
+            journal.snapshotTaken (source.getFile());
+            state.getChild (0).setProperty (IDs::name, "Journaled", nullptr);
+            expect (appendChangeRecord (journal.createChangeRecord(), source.getFile()));
+
+            // A stale journal at the destination mustn't be applied to the moved snapshot
+            {
+                auto otherState = createTestTree();
+                EditJournal otherJournal (otherState);
+                otherJournal.snapshotTaken (dest.getFile());
+                otherState.setProperty (IDs::appVersion, "Stale", nullptr);
+                expect (appendChangeRecord (otherJournal.createChangeRecord(), dest.getFile()));
+            }
+
+            expect (moveSnapshot (source.getFile(), dest.getFile()));
+            expect (! source.getFile().existsAsFile());
+            expect (! getJournalFile (source.getFile()).existsAsFile());
+            expect (readSnapshot (dest.getFile()).isEquivalentTo (state));
+
+            expect (deleteSnapshot (dest.getFile()));
+            expect (! getJournalFile (dest.getFile()).existsAsFile());
+        }
+
+        beginTest ("Invalid records");
+        {
+            auto state = createTestTree();
+            const char badIndex[] = { 3, 1, 100 };
+            const char badOp[] = { 42 };
+
+            expect (! EditJournal::applyChangeRecord (state, badIndex, sizeof (badIndex)));
+            expect (! EditJournal::applyChangeRecord (state, badOp, sizeof (badOp)));
+        }
+    }
+
+    void expectAppliedRecordMatches (EditJournal& journal, const ValueTree& state, ValueTree& snapshot)
+    {
+        auto record = journal.createChangeRecord();
+        expect (! journal.hasChanges());
+        expect (EditJournal::applyChangeRecord (snapshot, record.getData(), record.getSize()));
+        expect (snapshot.isEquivalentTo (state));
+    }
+
+    static ValueTree createTrack (int index)
+    {
+        ValueTree track (IDs::TRACK, { { IDs::name, "Track " + String (index) } });
+        track.appendChild (ValueTree (IDs::MIDICLIP, { { IDs::start, 0.0 }, { IDs::length, 4.0 } }), nullptr);
+
+        return track;
+    }
+
+    static ValueTree createTestTree()
+    {
+        ValueTree edit (IDs::EDIT, { { IDs::appVersion, "Test" } });
+
+        for (int i = 0; i < 4; ++i)
+            edit.appendChild (createTrack (i), nullptr);
+
+        return edit;
+    }
+};
+
+static EditJournalTests editJournalTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
+} // namespace tracktion_engine
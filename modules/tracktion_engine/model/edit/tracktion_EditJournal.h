@@ -0,0 +1,122 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+/**
+    Tracks which parts of an Edit have changed so that a temporary save only needs
+    to write those rather than the whole Edit. Each change is recorded at the
+    deepest level it affects, so e.g. moving a clip only writes that clip's
+    properties rather than its whole track.
+
+    The changes are turned into records which get appended to a journal file
+    next to a BinaryEditFile snapshot. When the journal grows too large it gets
+    compacted back into a new snapshot.
+
+    This is used by EditFileOperations::saveTempVersion() so you shouldn't
+    normally need to use it directly.
+*/
+class EditJournal   : private juce::ValueTree::Listener
+{
+public:
+    /** Starts watching an Edit's state. */
+    EditJournal (const juce::ValueTree& editState);
+
+    /** Destructor. */
+    ~EditJournal() override;
+
+    //==============================================================================
+    /** Returns true if there's no snapshot in the given file that the changes can be
+        applied to, either because one has never been written there, e.g. after the Edit
+        has been saved somewhere else, or the tree was redirected.
+    */
+    bool needsFullSnapshot (const juce::File& snapshotFile) const   { return lastSnapshotFile == juce::File() || snapshotFile != lastSnapshotFile; }
+
+    /** Returns true if anything has changed since the last snapshot or change record. */
+    bool hasChanges() const noexcept;
+
+    /** Call this when a full snapshot of the state has been written to a file.
+        This clears the list of changes so the next record is relative to the snapshot.
+        Snapshots written to any other file mustn't call this, as the changes still need
+        writing to this one.
+    */
+    void snapshotTaken (const juce::File& snapshotFile);
+
+    /** Call this when the snapshot has been overwritten or deleted so the next
+        save will be a full snapshot.
+    */
+    void invalidateSnapshot();
+
+    /** Creates a record of all the changes since the last snapshot or record,
+        copying only the trees and properties that have changed, and clears the list of changes.
+    */
+    juce::MemoryBlock createChangeRecord();
+
+    //==============================================================================
+    /** Returns the journal file used for a given snapshot file. */
+    static juce::File getJournalFile (const juce::File& snapshotFile);
+
+    /** Writes a snapshot and deletes any existing journal for it. */
+    static bool writeSnapshot (const juce::ValueTree&, const juce::File& snapshotFile);
+
+    /** Moves a snapshot file along with its journal, replacing any journal the
+        destination already had. Use this rather than moving the file directly,
+        e.g. when recovering a temp save, so none of the changes are lost.
+    */
+    static bool moveSnapshot (const juce::File& sourceFile, const juce::File& destFile);
+
+    /** Deletes a snapshot file along with its journal. */
+    static bool deleteSnapshot (const juce::File& snapshotFile);
+
+    /** Appends a record created by createChangeRecord() to the journal for a snapshot. */
+    static bool appendChangeRecord (const juce::MemoryBlock&, const juce::File& snapshotFile);
+
+    /** Applies a record created by createChangeRecord() to a tree.
+        Returns false if the record couldn't be applied to it.
+    */
+    static bool applyChangeRecord (juce::ValueTree&, const void* data, size_t numBytes);
+
+    /** Reads a snapshot and applies any of the records in its journal.
+        Returns an invalid tree if any part of the snapshot can't be decoded.
+    */
+    static juce::ValueTree readSnapshot (const juce::File& snapshotFile);
+
+    /** If the journal has grown larger than the snapshot, this re-writes the
+        snapshot with all the journaled changes applied and deletes the journal.
+    */
+    static bool compactIfNeeded (const juce::File& snapshotFile);
+
+private:
+    //==============================================================================
+    juce::ValueTree state;
+    juce::File lastSnapshotFile;
+    juce::MemoryOutputStream structuralChanges;
+    juce::Array<juce::ValueTree> changedTrees, changedProperties;
+    juce::ValueTree lastChangedProperties;
+    bool rootPropertiesChanged = false;
+
+    void clearChanges();
+    void markTreeChanged (const juce::ValueTree&);
+    void markPropertiesChanged (const juce::ValueTree&);
+    bool getPathToChange (juce::ValueTree, juce::Array<int>& path, bool skipIfTreeChanged) const;
+
+    void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
+    void valueTreeChildAdded (juce::ValueTree&, juce::ValueTree&) override;
+    void valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree&, int) override;
+    void valueTreeChildOrderChanged (juce::ValueTree&, int, int) override;
+    void valueTreeParentChanged (juce::ValueTree&) override {}
+    void valueTreeRedirected (juce::ValueTree&) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EditJournal)
+};
+
+} // namespace tracktion_engine
@@ -221,7 +221,8 @@ void EditSnapshot::refreshFromProjectItem (ProjectItem::Ptr pi)
         return;
 
     sourceFile = pi->getSourceFile();
-    auto newState = loadValueTree (sourceFile, true);
+    auto newState = BinaryEditFile::isBinaryEditFile (sourceFile) ? EditJournal::readSnapshot (sourceFile)
+                                                                  : loadValueTree (sourceFile, true);
 
     if (! newState.hasType (IDs::EDIT))
         return;
@@ -197,6 +197,11 @@ bool TracktionArchiveFile::extractFile (int index, const File& destDirectory, Fi
         if (r == 0)  return false;
     }
 
+    return extractEntry (index, destFile);
+}
+
+bool TracktionArchiveFile::extractEntry (int index, const File& destFile) const
+{
     if (destFile.isDirectory()
          || ! destFile.hasWriteAccess()
          || ! destFile.deleteFile()
@@ -236,22 +241,74 @@ bool TracktionArchiveFile::extractFile (int index, const File& destDirectory, Fi
     return true;
 }
 
+bool TracktionArchiveFile::extractEntries (const Array<int>& indexes, const Array<File>& destFiles,
+                                           Array<File>& filesCreated, ThreadPoolJob* jobToCheck,
+                                           std::function<void (float)> progressCallback) const
+{
+    jassert (indexes.size() == destFiles.size());
+
+    // Each entry is independent so these can all be decoded at once
+    ThreadPool pool (jlimit (1, 8, SystemStats::getNumCpus()));
+    std::atomic<int> numJobsRemaining { indexes.size() }, numFinished { 0 };
+    std::atomic<bool> ok { true }, shouldStop { false };
+    std::vector<char> extracted ((size_t) indexes.size(), 0);
+    WaitableEvent jobsFinished;
+
+    for (int i = 0; i < indexes.size(); ++i)
+    {
+        pool.addJob ([this, index = indexes[i], destFile = destFiles[i], wasExtracted = &extracted[(size_t) i],
+                      &numJobsRemaining, &numFinished, &ok, &shouldStop, &jobsFinished]
+                     {
+                         FloatVectorOperations::disableDenormalisedNumberSupport();
+
+                         if (! shouldStop)
+                         {
+                             if (extractEntry (index, destFile))
+                                 *wasExtracted = 1;
+                             else
+                                 ok = false;
+                         }
+
+                         ++numFinished;
+
+                         if (--numJobsRemaining == 0)
+                             jobsFinished.signal();
+                     });
+    }
+
+    while (numJobsRemaining.load() > 0)
+    {
+        jobsFinished.wait (50);
+
+        if (jobToCheck != nullptr && jobToCheck->shouldExit())
+            shouldStop = true;
+
+        if (progressCallback)
+            progressCallback (numFinished.load() / (float) std::max (1, indexes.size()));
+    }
+
+    for (int i = 0; i < destFiles.size(); ++i)
+        if (extracted[(size_t) i] != 0)
+            filesCreated.add (destFiles[i]);
+
+    return ok && ! shouldStop;
+}
+
 bool TracktionArchiveFile::extractAll (const File& destDirectory, Array<File>& filesCreated)
 {
     if (! destDirectory.createDirectory())
         return false;
 
+    Array<int> indexes;
+    Array<File> destFiles;
+
     for (int i = 0; i < entries.size(); ++i)
     {
-        File fileCreated;
-
-        if (! extractFile (i, destDirectory, fileCreated, false))
-            return false;
-
-        filesCreated.add (fileCreated);
+        indexes.add (i);
+        destFiles.add (destDirectory.getChildFile (getOriginalFileName (i)));
     }
 
-    return true;
+    return extractEntries (indexes, destFiles, filesCreated, nullptr, {});
 }
 
 //==============================================================================
@@ -268,6 +325,7 @@ public:
           warnAboutOverwrite (warnAboutOverwrite_),
           filesCreated (filesCreated_)
     {
+        setJobClass (BackgroundJobClass::exporting);
         wasAborted = false;
     }
 
@@ -279,29 +337,47 @@ public:
         if (! destDir.createDirectory())
             return jobHasFinished;
 
+        // Any questions about overwriting files have to be asked first, one at a time..
+        Array<int> indexes;
+        Array<File> destFiles;
+
         for (int i = 0; i < archive.getNumFiles(); ++i)
         {
-            if (shouldExit())
+            auto destFile = destDir.getChildFile (archive.getOriginalFileName (i));
+
+            if (warnAboutOverwrite && destFile.existsAsFile())
             {
-                wasAborted = true;
+                File fileCreated;
 
-                for (auto& f : filesCreated)
-                    f.deleteFile();
+                if (! archive.extractFile (i, destDir, fileCreated, true))
+                    return jobHasFinished;
 
-                break;
+                filesCreated.add (fileCreated);
+            }
+            else
+            {
+                indexes.add (i);
+                destFiles.add (destFile);
             }
+        }
 
-            progress = i / (float) archive.getNumFiles();
+        // ..and then everything else can be unpacked in parallel
+        const bool extractedAll = archive.extractEntries (indexes, destFiles, filesCreated, this,
+                                                         [this] (float p) { progress = p; });
 
-            File fileCreated;
+        if (shouldExit())
+        {
+            wasAborted = true;
 
-            if (! archive.extractFile (i, destDir, fileCreated, warnAboutOverwrite))
-                return jobHasFinished;
+            for (auto& f : filesCreated)
+                f.deleteFile();
 
-            if (fileCreated.exists())
-                filesCreated.add (fileCreated);
+            return jobHasFinished;
         }
 
+        if (! extractedAll)
+            return jobHasFinished;
+
         ok = true;
         return jobHasFinished;
     }
@@ -315,7 +391,7 @@ public:
     File destDir;
     bool ok = false;
     bool& wasAborted;
-    float progress = 0;
+    std::atomic<float> progress { 0.0f };
     bool warnAboutOverwrite = false;
     Array<File>& filesCreated;
 };
@@ -346,163 +422,280 @@ bool TracktionArchiveFile::addFile (const File& f, const File& rootDirectory, Co
 
 bool TracktionArchiveFile::addFile (const File& f, const String& filenameToUse, CompressionType compression)
 {
-    // don't risk using ogg or flac on small audio files
-    if (compression != CompressionType::none && f.getSize() <= 16 * 1024)
-        compression = CompressionType::zip;
-
     FileInputStream in (f);
-    bool ok = false;
 
-    if (in.openedOk())
+    if (! in.openedOk())
+        return false;
+
+    FileOutputStream out (file);
+
+    if (! openForAppending (out, f))
+        return false;
+
+    std::unique_ptr<IndexEntry> entry (new IndexEntry());
+
+    if (! writeEntryData (f, in, filenameToUse, compression, out, *entry))
+    {
+        needToWriteIndex = true;
+        return false;
+    }
+
+    return finishEntry (out, std::move (entry), f);
+}
+
+StringArray TracktionArchiveFile::addFiles (const Array<FileToAdd>& filesToAdd, ThreadPoolJob* jobToCheck,
+                                            std::function<void (float)> progressCallback)
+{
+    CRASH_TRACER
+    StringArray failedFiles;
+
+    // Each file is compressed into its own temporary segment in parallel, and then these
+    // are copied into the archive in order as they finish
+    struct Segment
+    {
+        Segment (const FileToAdd& f, const File& archiveFile)  : source (f), temp (archiveFile) {}
+
+        const FileToAdd source;
+        TemporaryFile temp;
+        IndexEntry entry;
+        bool ok = false;
+        WaitableEvent finished { true };
+    };
+
+    OwnedArray<Segment> segments;
+    std::atomic<bool> shouldStop { false };
+
+    for (auto& f : filesToAdd)
+        segments.add (new Segment (f, file));
+
     {
+        ThreadPool pool (jlimit (1, 8, SystemStats::getNumCpus()));
+
+        for (auto segment : segments)
+        {
+            pool.addJob ([this, segment, &shouldStop]
+                         {
+                             FloatVectorOperations::disableDenormalisedNumberSupport();
+
+                             if (! shouldStop)
+                             {
+                                 FileInputStream in (segment->source.file);
+                                 FileOutputStream out (segment->temp.getFile());
+
+                                 if (in.openedOk() && out.openedOk())
+                                 {
+                                     segment->ok = writeEntryData (segment->source.file, in, segment->source.filenameToUse,
+                                                                   segment->source.compression, out, segment->entry);
+                                     out.flush();
+                                     segment->ok = segment->ok && ! out.getStatus().failed();
+                                 }
+                             }
+
+                             segment->finished.signal();
+                         });
+        }
+
         FileOutputStream out (file);
 
-        if (out.openedOk())
+        for (int i = 0; i < segments.size(); ++i)
         {
-            if (! valid)
-            {
-                out.setPosition (0);
-                out.writeInt (getMagicNumber());
-                out.writeInt (int (indexOffset));
-                valid = true;
-            }
+            auto segment = segments.getUnchecked (i);
 
-            auto initialPosition = out.getPosition();
+            while (! segment->finished.wait (50))
+                if (jobToCheck != nullptr && jobToCheck->shouldExit())
+                    shouldStop = true;
 
-            out.setPosition (indexOffset);
-            jassert (indexOffset < 2147483648);
+            if (shouldStop)
+                break;
 
-            if (indexOffset >= 2147483648)
+            const auto& source = segment->source.file;
+            FileInputStream in (segment->temp.getFile());
+
+            if (segment->ok && in.openedOk() && openForAppending (out, source))
             {
-                TRACKTION_LOG_ERROR ("Archive too large when archiving file: " + f.getFileName());
-                return false;
+                std::unique_ptr<IndexEntry> entry (new IndexEntry());
+                entry->originalName = segment->entry.originalName;
+                entry->storedName = segment->entry.storedName;
+                out.writeFromInputStream (in, -1);
+
+                if (! finishEntry (out, std::move (entry), source))
+                    failedFiles.add (source.getFileName());
+            }
+            else
+            {
+                failedFiles.add (source.getFileName());
             }
 
-            auto filenameRoot = filenameToUse.substring (0, filenameToUse.lastIndexOfChar ('.'));
+            segment->temp.deleteTemporaryFile();
 
-            std::unique_ptr<IndexEntry> entry (new IndexEntry());
-            entry->offset = indexOffset;
-            entry->length = 0;
-            entry->originalName = filenameToUse;
-            entry->storedName = filenameToUse;
+            if (progressCallback)
+                progressCallback ((i + 1) / (float) segments.size());
+        }
 
-            switch (compression)
-            {
-                case CompressionType::none:
-                {
-                    out.writeFromInputStream (in, -1);
-                    break;
-                }
+        // Let any jobs that are still running finish before the pool's deleted
+        shouldStop = true;
 
-                case CompressionType::zip:
-                {
-                    entry->storedName = filenameRoot + ".gz";
+        for (auto segment : segments)
+            segment->finished.wait();
+    }
 
-                    GZIPCompressorOutputStream deflater (&out, 9, false);
-                    deflater.writeFromInputStream (in, -1);
-                    break;
-                }
+    return failedFiles;
+}
 
-                case CompressionType::lossless:
-                {
-                    AudioFile af (engine, f);
+bool TracktionArchiveFile::openForAppending (FileOutputStream& out, const File& source)
+{
+    if (! out.openedOk())
+        return false;
 
-                    if (af.isOggFile() || af.isMp3File() || af.isFlacFile())
-                    {
-                        out.writeFromInputStream (in, -1); // no point re-compressing these
-                    }
-                    else
-                    {
-                        if (af.getBitsPerSample() > 24)
-                        {
-                            // FLAC can't do higher than 24 bits so just have to zip it instead..
-                            entry->storedName = filenameRoot + ".gz";
-
-                            GZIPCompressorOutputStream deflater (&out, 9, false);
-                            deflater.writeFromInputStream (in, -1);
-                        }
-                        else
-                        {
-                            entry->storedName = filenameRoot + ".flac";
-
-                            if (! AudioFileUtils::convertToFormat<FlacAudioFormat> (engine, f, out, 0, StringPairArray()))
-                            {
-                                needToWriteIndex = true;
-                                TRACKTION_LOG_ERROR ("Failed to add file to archive flac: " + f.getFileName());
-                                return false;
-                            }
-                        }
-                    }
+    if (! valid)
+    {
+        out.setPosition (0);
+        out.writeInt (getMagicNumber());
+        out.writeInt (int (indexOffset));
+        valid = true;
+    }
 
-                    break;
-                }
+    jassert (indexOffset < 2147483648);
 
-                case CompressionType::lossyGoodQuality:
-                case CompressionType::lossyMediumQuality:
-                case CompressionType::lossyLowQuality:
-                {
-                    entry->storedName = filenameRoot + ".ogg";
-                    entry->originalName = entry->storedName;  // oggs get extracted as oggs, not named back to how they were
+    if (indexOffset >= 2147483648)
+    {
+        TRACKTION_LOG_ERROR ("Archive too large when archiving file: " + source.getFileName());
+        return false;
+    }
 
-                    auto quality = getOggQuality (compression);
-                    AudioFile af (engine, f);
+    // New entries overwrite the old index, which gets written again after them by flush()
+    out.setPosition (indexOffset);
+    return true;
+}
 
-                    if (! isWorthConvertingToOgg (af, quality))
-                    {
-                        FileInputStream fin (af.getFile());
+bool TracktionArchiveFile::finishEntry (FileOutputStream& out, std::unique_ptr<IndexEntry> entry, const File& source)
+{
+    out.flush();
 
-                        if (! fin.openedOk())
-                        {
-                            needToWriteIndex = true;
-                            TRACKTION_LOG_ERROR ("Failed to add file to archive: " + f.getFileName());
-                            return false;
-                        }
+    jassert (out.getPosition() > indexOffset);
 
-                        out.writeFromInputStream (fin, -1);
-                    }
-                    else if (! AudioFileUtils::convertToFormat<OggVorbisAudioFormat> (engine, f, out, quality, StringPairArray()))
-                    {
-                        needToWriteIndex = true;
-                        TRACKTION_LOG_ERROR ("Failed to add file to archive ogg: " + f.getFileName());
-                        return false;
-                    }
+    entry->offset = indexOffset;
+    entry->length = jmax (int64 (0), out.getPosition() - indexOffset);
+    needToWriteIndex = true;
 
-                    break;
-                }
+    jassert (indexOffset + entry->length < 2147483648);
+
+    if (indexOffset + entry->length >= 2147483648)
+    {
+        out.setPosition (indexOffset);
+        out.truncate();
+        TRACKTION_LOG_ERROR ("Archive too large when archiving file: " + source.getFileName());
+        return false;
+    }
+
+    indexOffset += entry->length;
+    entries.add (entry.release());
+    return true;
+}
+
+bool TracktionArchiveFile::writeEntryData (const File& f, InputStream& in, const String& filenameToUse,
+                                           CompressionType compression, OutputStream& out, IndexEntry& entry) const
+{
+    // don't risk using ogg or flac on small audio files
+    if (compression != CompressionType::none && compression != CompressionType::zipFast && f.getSize() <= 16 * 1024)
+        compression = CompressionType::zip;
+
+    auto filenameRoot = filenameToUse.substring (0, filenameToUse.lastIndexOfChar ('.'));
+
+    entry.originalName = filenameToUse;
+    entry.storedName = filenameToUse;
+
+    switch (compression)
+    {
+        case CompressionType::none:
+        {
+            out.writeFromInputStream (in, -1);
+            break;
+        }
+
+        case CompressionType::zip:
+        case CompressionType::zipFast:
+        {
+            entry.storedName = filenameRoot + ".gz";
+
+            GZIPCompressorOutputStream deflater (&out, compression == CompressionType::zipFast ? 1 : 9, false);
+            deflater.writeFromInputStream (in, -1);
+            break;
+        }
+
+        case CompressionType::lossless:
+        {
+            AudioFile af (engine, f);
 
-                default:
+            if (af.isOggFile() || af.isMp3File() || af.isFlacFile())
+            {
+                out.writeFromInputStream (in, -1); // no point re-compressing these
+            }
+            else
+            {
+                if (af.getBitsPerSample() > 24)
                 {
-                    TRACKTION_LOG_ERROR ("Unknown compression type when archiving file: " + f.getFileName());
-                    jassertfalse;
-                    break;
+                    // FLAC can't do higher than 24 bits so just have to zip it instead..
+                    entry.storedName = filenameRoot + ".gz";
+
+                    GZIPCompressorOutputStream deflater (&out, 9, false);
+                    deflater.writeFromInputStream (in, -1);
+                }
+                else
+                {
+                    entry.storedName = filenameRoot + ".flac";
+
+                    if (! AudioFileUtils::convertToFormat<FlacAudioFormat> (engine, f, out, 0, StringPairArray()))
+                    {
+                        TRACKTION_LOG_ERROR ("Failed to add file to archive flac: " + f.getFileName());
+                        return false;
+                    }
                 }
             }
 
-            out.flush();
+            break;
+        }
+
+        case CompressionType::lossyGoodQuality:
+        case CompressionType::lossyMediumQuality:
+        case CompressionType::lossyLowQuality:
+        {
+            entry.storedName = filenameRoot + ".ogg";
+            entry.originalName = entry.storedName;  // oggs get extracted as oggs, not named back to how they were
 
-            jassert (out.getPosition() > indexOffset);
+            auto quality = getOggQuality (compression);
+            AudioFile af (engine, f);
 
-            entry->length = jmax (int64 (0), out.getPosition() - indexOffset);
+            if (! isWorthConvertingToOgg (af, quality))
+            {
+                FileInputStream fin (af.getFile());
 
-            jassert (indexOffset + entry->length < 2147483648);
+                if (! fin.openedOk())
+                {
+                    TRACKTION_LOG_ERROR ("Failed to add file to archive: " + f.getFileName());
+                    return false;
+                }
 
-            if (indexOffset + entry->length >= 2147483648)
+                out.writeFromInputStream (fin, -1);
+            }
+            else if (! AudioFileUtils::convertToFormat<OggVorbisAudioFormat> (engine, f, out, quality, StringPairArray()))
             {
-                out.setPosition (initialPosition);
-                out.truncate();
-                TRACKTION_LOG_ERROR ("Archive too large when archiving file: " + f.getFileName());
+                TRACKTION_LOG_ERROR ("Failed to add file to archive ogg: " + f.getFileName());
                 return false;
             }
 
-            indexOffset += entry->length;
-            needToWriteIndex = true;
-            ok = true;
+            break;
+        }
 
-            entries.add (entry.release());
+        default:
+        {
+            TRACKTION_LOG_ERROR ("Unknown compression type when archiving file: " + f.getFileName());
+            jassertfalse;
+            break;
         }
     }
 
-    return ok;
+    return true;
 }
 
 void TracktionArchiveFile::addFileInfo (const String& filename, const String& itemName, const String& itemValue)
@@ -527,4 +720,149 @@ int TracktionArchiveFile::getOggQuality (CompressionType c)
     return numOptions / 5;
 }
 
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class ArchiveFileTests  : public juce::UnitTest
+{
+public:
+    ArchiveFileTests()
+        : juce::UnitTest ("TracktionArchiveFile", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+        using CT = TracktionArchiveFile::CompressionType;
+
+        TemporaryFile sourceDir, destDir, archiveFile (archiveFileSuffix);
+        sourceDir.getFile().createDirectory();
+
+        // These aren't in alphabetical order so it's clear the archive keeps the order given
+        const int numAudioSamples = 44100;
+        auto text = String::repeatedString ("Some text to compress. ", 2000);
+
+        struct TestFile { const char* name; CT compression; bool isAudio; };
+        const TestFile testFiles[] =
+        {
+            { "c_zipped.txt",       CT::zip,                false },
+            { "a_lossless.wav",     CT::lossless,           true },
+            { "e_uncompressed.txt", CT::none,               false },
+            { "b_lossy.wav",        CT::lossyMediumQuality, true },
+            { "d_zipped_fast.txt",  CT::zipFast,            false }
+        };
+
+        Array<TracktionArchiveFile::FileToAdd> filesToAdd;
+
+        for (auto& tf : testFiles)
+        {
+            auto f = sourceDir.getFile().getChildFile (tf.name);
+            expect (tf.isAudio ? writeTestWav (f, numAudioSamples) : f.replaceWithText (text));
+            filesToAdd.add ({ f, tf.name, tf.compression });
+        }
+
+        beginTest ("Adding files with mixed compression");
+        {
+            TracktionArchiveFile archive (engine, archiveFile.getFile());
+            expect (archive.addFiles (filesToAdd).isEmpty());
+        }
+
+        beginTest ("Entries keep their order");
+        {
+            TracktionArchiveFile archive (engine, archiveFile.getFile());
+            expect (archive.isValidArchive());
+            expectEquals (archive.getNumFiles(), numElementsInArray (testFiles));
+
+            for (int i = 0; i < archive.getNumFiles(); ++i)
+                expectEquals (archive.getOriginalFileName (i), String (testFiles[i].name));
+        }
+
+        beginTest ("Extracting everything");
+        {
+            TracktionArchiveFile archive (engine, archiveFile.getFile());
+            Array<File> filesCreated;
+
+            expect (archive.extractAll (destDir.getFile(), filesCreated));
+            expectEquals (filesCreated.size(), numElementsInArray (testFiles));
+
+            for (int i = 0; i < filesCreated.size(); ++i)
+                expectEquals (filesCreated[i].getFileName(), String (testFiles[i].name));
+
+            for (auto& tf : testFiles)
+            {
+                auto extracted = destDir.getFile().getChildFile (tf.name);
+                expect (extracted.existsAsFile());
+
+                if (! tf.isAudio)
+                {
+                    expectEquals (extracted.loadFileAsString(), text);
+                }
+                else
+                {
+                    std::unique_ptr<AudioFormatReader> reader (AudioFileUtils::createReaderFor (engine, extracted));
+                    expect (reader != nullptr);
+
+                    if (reader == nullptr)
+                        continue;
+
+                    expectEquals (reader->sampleRate, 44100.0);
+
+                    if (tf.compression == CT::lossless)
+                    {
+                        expectEquals (reader->lengthInSamples, (int64) numAudioSamples);
+
+                        AudioBuffer<float> buffer (1, numAudioSamples);
+                        reader->read (&buffer, 0, numAudioSamples, 0, true, false);
+
+                        float maxError = 0.0f;
+
+                        for (int i = 0; i < numAudioSamples; ++i)
+                            maxError = jmax (maxError, std::abs (buffer.getSample (0, i) - getTestSample (i)));
+
+                        expectLessThan (maxError, 0.0001f);
+                    }
+                    else
+                    {
+                        // The lossy codec can pad the end, but it shouldn't lose anything
+                        expectGreaterOrEqual (reader->lengthInSamples, (int64) numAudioSamples);
+                    }
+                }
+            }
+        }
+
+        destDir.getFile().deleteRecursively();
+        sourceDir.getFile().deleteRecursively();
+    }
+
+    static float getTestSample (int i)
+    {
+        return 0.5f * (float) std::sin (i * MathConstants<double>::twoPi * 440.0 / 44100.0);
+    }
+
+    static bool writeTestWav (const File& f, int numSamples)
+    {
+        AudioBuffer<float> buffer (1, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample (0, i, getTestSample (i));
+
+        std::unique_ptr<FileOutputStream> out (f.createOutputStream());
+
+        if (out == nullptr)
+            return false;
+
+        std::unique_ptr<AudioFormatWriter> writer (WavAudioFormat().createWriterFor (out.get(), 44100.0, 1, 16, {}, 0));
+
+        if (writer == nullptr)
+            return false;
+
+        out.release();
+        return writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+    }
+};
+
+static ArchiveFileTests archiveFileTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
 }
@@ -30,7 +30,8 @@ public:
         lossless                = 2,
         lossyGoodQuality        = 3,
         lossyMediumQuality      = 4,
-        lossyLowQuality         = 5
+        lossyLowQuality         = 5,
+        zipFast                 = 6     // zip using the fastest level, for when speed matters more than size
     };
 
     int getNumFiles() const;
@@ -43,6 +44,10 @@ public:
 
     bool extractFile (int index, const juce::File& destDirectory,
                       juce::File& fileCreated, bool askBeforeOverwriting);
+
+    /** Extracts every entry, decoding them in parallel. A failed entry doesn't stop
+        the others being extracted, but false is returned and it's left out of filesCreated.
+    */
     bool extractAll (const juce::File& destDirectory,
                      juce::Array<juce::File>& filesCreated);
     bool extractAllAsTask (const juce::File& destDirectory,
@@ -53,6 +58,22 @@ public:
     bool addFile (const juce::File&, const juce::File& rootDirectory, CompressionType);
     bool addFile (const juce::File&, const juce::String& filenameToUse, CompressionType);
 
+    /** A file to add with addFiles(). */
+    struct FileToAdd
+    {
+        juce::File file;
+        juce::String filenameToUse;
+        CompressionType compression = CompressionType::zip;
+    };
+
+    /** Adds a set of files, compressing them on several threads at once.
+        The files are still stored in the order given. If a job is supplied and it
+        should exit, this stops after the file it's currently adding.
+        @returns the names of any files that couldn't be added
+    */
+    juce::StringArray addFiles (const juce::Array<FileToAdd>&, juce::ThreadPoolJob* jobToCheck = nullptr,
+                                std::function<void (float)> progressCallback = {});
+
     void addFileInfo (const juce::String& filename,
                       const juce::String& itemName,
                       const juce::String& itemValue);
@@ -90,6 +111,18 @@ private:
     juce::OwnedArray<IndexEntry> entries;
     void readIndex();
 
+    bool openForAppending (juce::FileOutputStream&, const juce::File& source);
+    bool finishEntry (juce::FileOutputStream&, std::unique_ptr<IndexEntry>, const juce::File& source);
+    bool writeEntryData (const juce::File&, juce::InputStream&, const juce::String& filenameToUse,
+                         CompressionType, juce::OutputStream&, IndexEntry&) const;
+
+    bool extractEntry (int index, const juce::File& destFile) const;
+    bool extractEntries (const juce::Array<int>& indexes, const juce::Array<juce::File>& destFiles,
+                         juce::Array<juce::File>& filesCreated, juce::ThreadPoolJob*,
+                         std::function<void (float)> progressCallback) const;
+
+    friend class ExtractionTask;
+
     static int getOggQuality (CompressionType);
     static int getMagicNumber();
 
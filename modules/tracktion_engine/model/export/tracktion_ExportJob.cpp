@@ -39,6 +39,9 @@ ExportJob::ExportJob (Edit* edit_,
 {
     jassert (srcProject != nullptr);
     jassert (newProject != nullptr);
+
+    setJobClass (BackgroundJobClass::exporting);
+    setJobOwner (edit);
 }
 
 ExportJob::~ExportJob()
@@ -278,23 +281,23 @@ void ExportJob::createArchiveFromTempFiles()
 
         destDir.findChildFiles (filesForDeletion, File::findFiles, true);
 
-        for (int i = 0; i < filesForDeletion.size(); ++i)
-        {
-            progress = 0.5f + 0.5f * i / filesForDeletion.size();
+        Array<TracktionArchiveFile::FileToAdd> filesToAdd;
 
-            if (shouldExit())
-                break;
-
-            auto compression = TracktionArchiveFile::CompressionType::zip;
-            const File f (filesForDeletion[i]);
+        for (auto& f : filesForDeletion)
+        {
+            TracktionArchiveFile::FileToAdd fileToAdd;
+            fileToAdd.file = f;
+            fileToAdd.filenameToUse = f.getRelativePathFrom (destDir).replaceCharacter ('\\', '/');
 
             if (AudioFile (srcProject->engine, f).isValid())
-                compression = compressionType;
+                fileToAdd.compression = compressionType;
 
-            if (! archive->addFile (f, destDir, compression))
-                failedFiles.add (f.getFileName());
+            filesToAdd.add (fileToAdd);
         }
 
+        failedFiles.addArray (archive->addFiles (filesToAdd, this,
+                                                 [this] (float p) { progress = 0.5f + 0.5f * p; }));
+
         filesForDeletion.clear();
         filesForDeletion.add (destDir);
     }
@@ -15,6 +15,7 @@ RenderManager::Job::Job (Engine& e, const AudioFile& proxyToUse)
     : ThreadPoolJobWithProgress ("Render Job"),
       engine (e), proxy (proxyToUse)
 {
+    setJobClass (BackgroundJobClass::render);
     selfReference = this;
 
     // Adds us to the active jobs list which will start us running asynchronously to avoid
@@ -261,7 +262,7 @@ void RenderManager::removeJobInternal (Job* j) noexcept
 
 void RenderManager::addJobToPool (Job* j) noexcept
 {
-    engine.getBackgroundJobs().addJob (j, false);
+    engine.getBackgroundJobs().addJob (j, false, j->getJobsToWaitFor());
 }
 
 void RenderManager::deleteJob (Job* j)
@@ -88,6 +88,11 @@ public:
          */
         virtual bool completeRender() = 0;
 
+        /** Subclasses can return other jobs that must finish before this one is started,
+            e.g. the renders of a file it reads from.
+         */
+        virtual juce::Array<ThreadPoolJobWithProgress*> getJobsToWaitFor()   { return {}; }
+
     protected:
         //==============================================================================
         Job (Engine&, const AudioFile& proxy); // don't instantiate directly!
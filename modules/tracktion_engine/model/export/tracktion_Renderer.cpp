@@ -107,6 +107,7 @@ Renderer::RenderTask::RenderTask (const String& taskDescription, const Renderer:
    : ThreadPoolJobWithProgress (taskDescription),
      params (rp), node (n), progress (progressInternal)
 {
+    setJobClass (BackgroundJobClass::exporting);
 }
 
 Renderer::RenderTask::RenderTask (const String& taskDescription, const Renderer::Parameters& rp, AudioNode* n,
@@ -114,6 +115,7 @@ Renderer::RenderTask::RenderTask (const String& taskDescription, const Renderer:
    : ThreadPoolJobWithProgress (taskDescription),
      params (rp), node (n), progress (progressToUpdate), sourceToUpdate (source)
 {
+    setJobClass (BackgroundJobClass::exporting);
 }
 
 Renderer::RenderTask::~RenderTask()
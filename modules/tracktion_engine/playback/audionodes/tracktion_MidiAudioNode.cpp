@@ -11,6 +11,111 @@
 namespace tracktion_engine
 {
 
+MidiSequenceSeekIndex::MidiSequenceSeekIndex (const MidiMessageSequence& seq, Range<int> chans)
+    : sequence (seq), channels (chans)
+{
+    const int numEvents = sequence.getNumEvents();
+    const int numChannels = channels.getLength() + 1;
+
+    eventTimes.reserve ((size_t) numEvents);
+    noteEndTimes.reserve ((size_t) numEvents);
+    checkpoints.reserve ((size_t) (numChannels * (numEvents / eventsPerCheckpoint + 1)));
+    currentState.resize ((size_t) numChannels);
+
+    for (auto& c : currentState)
+    {
+        std::fill (std::begin (c.controllers), std::end (c.controllers), (int8) -1);
+        c.program = -1;
+        c.pitchWheel = -1;
+    }
+
+    double maxNoteEndTime = std::numeric_limits<double>::lowest();
+
+    for (int i = 0; i < numEvents; ++i)
+    {
+        if (i % eventsPerCheckpoint == 0)
+            checkpoints.insert (checkpoints.end(), currentState.begin(), currentState.end());
+
+        auto meh = sequence.getEventPointer (i);
+        auto& m = meh->message;
+
+        if (m.isNoteOn())
+        {
+            channelsWithNotes |= (1 << m.getChannel());
+
+            if (meh->noteOffObject != nullptr)
+                maxNoteEndTime = jmax (maxNoteEndTime, meh->noteOffObject->message.getTimeStamp());
+        }
+
+        eventTimes.push_back (m.getTimeStamp());
+        noteEndTimes.push_back (maxNoteEndTime);
+        applyEvent (currentState.data(), m);
+    }
+
+    if (numEvents % eventsPerCheckpoint == 0)
+        checkpoints.insert (checkpoints.end(), currentState.begin(), currentState.end());
+}
+
+void MidiSequenceSeekIndex::applyEvent (ChannelState* states, const MidiMessage& m) const noexcept
+{
+    auto channel = m.getChannel();
+
+    if (channel < channels.getStart() || channel > channels.getEnd())
+        return;
+
+    auto& state = states[channel - channels.getStart()];
+
+    if (m.isController())
+        state.controllers[m.getControllerNumber() & 127] = (int8) m.getControllerValue();
+    else if (m.isProgramChange())
+        state.program = (int8) m.getProgramChangeNumber();
+    else if (m.isPitchWheel())
+        state.pitchWheel = (int16) m.getPitchWheelValue();
+}
+
+int MidiSequenceSeekIndex::getIndexOfFirstEventAtOrAfter (double time) const noexcept
+{
+    return (int) (std::lower_bound (eventTimes.begin(), eventTimes.end(), time) - eventTimes.begin());
+}
+
+void MidiSequenceSeekIndex::addControllerUpdatesForTime (double time, MidiMessageArray& buffer,
+                                                         MidiMessageArray::MPESourceID sourceID)
+{
+    const auto endIndex = (int) (std::upper_bound (eventTimes.begin(), eventTimes.end(), time) - eventTimes.begin());
+    const auto checkpoint = endIndex / eventsPerCheckpoint;
+    const auto numChannels = currentState.size();
+
+    std::copy_n (checkpoints.begin() + (std::ptrdiff_t) (checkpoint * numChannels), numChannels, currentState.begin());
+
+    for (int i = checkpoint * eventsPerCheckpoint; i < endIndex; ++i)
+        applyEvent (currentState.data(), sequence.getEventPointer (i)->message);
+
+    for (int channel = channels.getStart(); channel <= channels.getEnd(); ++channel)
+    {
+        auto& state = currentState[(size_t) (channel - channels.getStart())];
+
+        for (int controller = 0; controller < 128; ++controller)
+            if (state.controllers[controller] >= 0)
+                buffer.addMidiMessage (MidiMessage::controllerEvent (channel, controller, state.controllers[controller]), sourceID);
+
+        if (state.program >= 0)
+            buffer.addMidiMessage (MidiMessage::programChange (channel, state.program), sourceID);
+
+        if (state.pitchWheel >= 0)
+            buffer.addMidiMessage (MidiMessage::pitchWheel (channel, state.pitchWheel), sourceID);
+    }
+}
+
+int MidiSequenceSeekIndex::getIndexOfFirstNoteSoundingAfter (double time, int endIndex) const noexcept
+{
+    // noteEndTimes holds the latest note-off of all the notes up to each event so it only
+    // ever increases, and none of the notes before the first one ending after the time can
+    // still be playing
+    auto end = noteEndTimes.begin() + endIndex;
+    return (int) (std::upper_bound (noteEndTimes.begin(), end, time) - noteEndTimes.begin());
+}
+
+//==============================================================================
 MidiAudioNode::MidiAudioNode (MidiMessageSequence sequence,
                               Range<int> chans,
                               EditTimeRange editPos,
@@ -32,6 +137,7 @@ MidiAudioNode::MidiAudioNode (MidiMessageSequence sequence,
 
     ms.push_back (std::move (sequence));
     ms[0].updateMatchedPairs();
+    createSeekIndexes();
 }
 
 MidiAudioNode::MidiAudioNode (std::vector<juce::MidiMessageSequence> sequences,
@@ -56,6 +162,14 @@ MidiAudioNode::MidiAudioNode (std::vector<juce::MidiMessageSequence> sequences,
 
     for (auto& m : ms)
         m.updateMatchedPairs();
+
+    createSeekIndexes();
+}
+
+void MidiAudioNode::createSeekIndexes()
+{
+    for (auto& m : ms)
+        seekIndexes.push_back (std::make_unique<MidiSequenceSeekIndex> (m, channelNumbers));
 }
 
 void MidiAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange editTime)
@@ -69,21 +183,21 @@ void MidiAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange e
             if (mute != wasMute)
             {
                 wasMute = mute;
-                createNoteOffs (*rc.bufferForMidiMessages, ms[currentSequence], localTime.getStart(), rc.midiBufferOffset, rc.playhead.isPlaying());
+                createNoteOffs (*rc.bufferForMidiMessages, currentSequence, localTime.getStart(), rc.midiBufferOffset, rc.playhead.isPlaying());
             }
 
             return;
         }
 
+        auto numEvents = ms[currentSequence].getNumEvents();
+
         if ((! rc.isContiguousWithPreviousBlock()) || localTime.getStart() <= 0.00001 || shouldCreateMessagesForTime)
         {
             createMessagesForTime (localTime.getStart(), *rc.bufferForMidiMessages, rc.midiBufferOffset);
             shouldCreateMessagesForTime = false;
+            currentIndex = seekIndexes[currentSequence]->getIndexOfFirstEventAtOrAfter (localTime.getStart());
         }
-
-        auto numEvents = ms[currentSequence].getNumEvents();
-
-        if (numEvents != 0)
+        else if (numEvents != 0)
         {
             currentIndex = jlimit (0, numEvents - 1, currentIndex);
 
@@ -127,7 +241,7 @@ void MidiAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange e
 
         if (rc.isLastBlockOfLoop())
         {
-            createNoteOffs (*rc.bufferForMidiMessages, ms[currentSequence], localTime.getEnd(), rc.midiBufferOffset + localTime.getLength(), rc.playhead.isPlaying());
+            createNoteOffs (*rc.bufferForMidiMessages, currentSequence, localTime.getEnd(), rc.midiBufferOffset + localTime.getLength(), rc.playhead.isPlaying());
 
             currentSequence++;
             if (currentSequence >= ms.size())
@@ -154,31 +268,21 @@ void MidiAudioNode::createMessagesForTime (double time, MidiMessageArray& buffer
     }
     else
     {
-        {
-            juce::Array<juce::MidiMessage> controllerMessages;
-
-            for (int i = channelNumbers.getStart(); i <= channelNumbers.getEnd(); ++i)
-                ms[currentSequence].createControllerUpdatesForTime (i, time, controllerMessages);
-
-            if (! controllerMessages.isEmpty())
-                for (auto& m : controllerMessages)
-                    buffer.addMidiMessage (m, midiSourceID);
-        }
+        auto& seekIndex = *seekIndexes[currentSequence];
+        seekIndex.addControllerUpdatesForTime (time, buffer, midiSourceID);
 
         if (! mute)
         {
             auto volScale = dbToGain (volumeDb);
+            auto endIndex = seekIndex.getIndexOfFirstEventAtOrAfter (time);
 
-            for (int i = 0; i < ms[currentSequence].getNumEvents(); ++i)
+            for (int i = seekIndex.getIndexOfFirstNoteSoundingAfter (time + 0.0001, endIndex); i < endIndex; ++i)
             {
                 if (auto meh = ms[currentSequence].getEventPointer (i))
                 {
                     if (meh->noteOffObject != nullptr
                         && meh->message.isNoteOn())
                     {
-                        if (meh->message.getTimeStamp() >= time)
-                            break;
-
                         // don't play very short notes or ones that have already finished
                         if (meh->noteOffObject->message.getTimeStamp() > time + 0.0001)
                         {
@@ -195,28 +299,22 @@ void MidiAudioNode::createMessagesForTime (double time, MidiMessageArray& buffer
     }
 }
 
-void MidiAudioNode::createNoteOffs (MidiMessageArray& destination, const MidiMessageSequence& source,
+void MidiAudioNode::createNoteOffs (MidiMessageArray& destination, size_t sequenceIndex,
                                     double time, double midiTimeOffset, bool isPlaying)
 {
-    int activeChannels = 0;
+    auto& source = ms[sequenceIndex];
+    auto& seekIndex = *seekIndexes[sequenceIndex];
+    const int activeChannels = seekIndex.getChannelsWithNotes();
+    const int endIndex = seekIndex.getIndexOfFirstEventAtOrAfter (time);
 
-    for (int i = 0; i < source.getNumEvents(); ++i)
+    for (int i = seekIndex.getIndexOfFirstNoteSoundingAfter (time, endIndex); i < endIndex; ++i)
     {
         if (auto meh = source.getEventPointer (i))
         {
-            if (meh->message.isNoteOn())
-            {
-                activeChannels |= (1 << meh->message.getChannel());
-
-                if (meh->message.getTimeStamp() < time
-                     && meh->noteOffObject != nullptr
-                     && meh->noteOffObject->message.getTimeStamp() > time)
-                    destination.addMidiMessage (meh->noteOffObject->message, midiTimeOffset, midiSourceID);
-            }
-        }
-        else
-        {
-            break;
+            if (meh->message.isNoteOn()
+                 && meh->noteOffObject != nullptr
+                 && meh->noteOffObject->message.getTimeStamp() > time)
+                destination.addMidiMessage (meh->noteOffObject->message, midiTimeOffset, midiSourceID);
         }
     }
 
@@ -292,4 +390,118 @@ MidiAudioNode* getClipIfPresentInNode (AudioNode* node, Clip& c)
     return existingNode;
 }
 
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class MidiSequenceSeekIndexTests  : public juce::UnitTest
+{
+public:
+    MidiSequenceSeekIndexTests()
+        : juce::UnitTest ("MidiSequenceSeekIndex", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        beginTest ("Seeking matches scanning the sequence");
+        {
+            auto& r = getRandom();
+            const Range<int> channels (1, 2);
+            auto sequence = createRandomSequence (r, 2000);
+            MidiSequenceSeekIndex index (sequence, channels);
+
+            for (int i = 0; i < 200; ++i)
+            {
+                auto time = r.nextDouble() * 110.0;
+
+                MidiMessageArray fromIndex;
+                index.addControllerUpdatesForTime (time, fromIndex, MidiMessageArray::notMPE);
+
+                Array<MidiMessage> fromSequence;
+
+                for (int chan = channels.getStart(); chan <= channels.getEnd(); ++chan)
+                    sequence.createControllerUpdatesForTime (chan, time, fromSequence);
+
+                expectEquals (fromIndex.size(), fromSequence.size());
+
+                for (auto& m : fromSequence)
+                    expect (containsMessage (fromIndex, m));
+
+                auto endIndex = index.getIndexOfFirstEventAtOrAfter (time);
+                expectEquals (endIndex, sequence.getNextIndexAtTime (time));
+                expectEquals (getNumNotesSounding (sequence, time, index.getIndexOfFirstNoteSoundingAfter (time, endIndex), endIndex),
+                              getNumNotesSounding (sequence, time, 0, endIndex));
+            }
+        }
+
+        beginTest ("Empty sequence");
+        {
+            MidiMessageSequence sequence;
+            MidiSequenceSeekIndex index (sequence, { 1, 16 });
+            MidiMessageArray messages;
+            index.addControllerUpdatesForTime (1.0, messages, MidiMessageArray::notMPE);
+
+            expect (messages.isEmpty());
+            expectEquals (index.getIndexOfFirstEventAtOrAfter (1.0), 0);
+            expectEquals (index.getChannelsWithNotes(), 0);
+        }
+    }
+
+    static MidiMessageSequence createRandomSequence (Random& r, int numEvents)
+    {
+        MidiMessageSequence sequence;
+
+        for (int i = 0; i < numEvents; ++i)
+        {
+            auto time = r.nextDouble() * 100.0;
+            auto channel = r.nextInt ({ 1, 4 });
+
+            switch (r.nextInt (4))
+            {
+                case 0:     sequence.addEvent (MidiMessage::controllerEvent (channel, r.nextInt ({ 16, 24 }), r.nextInt (128)), time); break;
+                case 1:     sequence.addEvent (MidiMessage::programChange (channel, r.nextInt (128)), time); break;
+                case 2:     sequence.addEvent (MidiMessage::pitchWheel (channel, r.nextInt (16384)), time); break;
+                default:
+                {
+                    auto note = r.nextInt ({ 36, 96 });
+                    sequence.addEvent (MidiMessage::noteOn (channel, note, (uint8) 100), time);
+                    sequence.addEvent (MidiMessage::noteOff (channel, note), time + r.nextDouble() * 10.0);
+                    break;
+                }
+            }
+        }
+
+        sequence.sort();
+        sequence.updateMatchedPairs();
+
+        return sequence;
+    }
+
+    static bool containsMessage (const MidiMessageArray& messages, const MidiMessage& m)
+    {
+        for (auto& other : messages)
+            if (other.getRawDataSize() == m.getRawDataSize()
+                 && std::memcmp (other.getRawData(), m.getRawData(), (size_t) m.getRawDataSize()) == 0)
+                return true;
+
+        return false;
+    }
+
+    static int getNumNotesSounding (const MidiMessageSequence& sequence, double time, int startIndex, int endIndex)
+    {
+        int num = 0;
+
+        for (int i = startIndex; i < endIndex; ++i)
+            if (auto meh = sequence.getEventPointer (i))
+                if (meh->message.isNoteOn() && meh->noteOffObject != nullptr
+                     && meh->noteOffObject->message.getTimeStamp() > time)
+                    ++num;
+
+        return num;
+    }
+};
+
+static MidiSequenceSeekIndexTests midiSequenceSeekIndexTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
 }
@@ -11,6 +11,61 @@
 namespace tracktion_engine
 {
 
+/** An index of a MidiMessageSequence that lets a player jump to any time without
+    scanning the sequence from the start.
+
+    Event times are held in a flat array for binary searching and the controller,
+    program and pitch-wheel state of the indexed channels is checkpointed every
+    few hundred events, so a seek only has to replay the events since the nearest
+    checkpoint. None of the lookups allocate so they can be used on the audio thread.
+
+    The sequence must have had updateMatchedPairs() called and mustn't change
+    while the index is in use.
+*/
+class MidiSequenceSeekIndex
+{
+public:
+    MidiSequenceSeekIndex (const juce::MidiMessageSequence&, juce::Range<int> midiChannelNumbers);
+
+    /** Returns the index of the first event at or after a time. */
+    int getIndexOfFirstEventAtOrAfter (double time) const noexcept;
+
+    /** Adds the last controller, program-change and pitch-wheel messages at or before
+        a time for each of the indexed channels, with a timestamp of 0.
+        This gives the same state as MidiMessageSequence::createControllerUpdatesForTime().
+    */
+    void addControllerUpdatesForTime (double time, MidiMessageArray&, MidiMessageArray::MPESourceID);
+
+    /** Returns the index of the earliest note-on before endIndex whose note-off is after a time.
+        All the notes still sounding at that time will be between here and endIndex.
+    */
+    int getIndexOfFirstNoteSoundingAfter (double time, int endIndex) const noexcept;
+
+    /** Returns a bit-mask of the channels with any note-ons in the sequence. */
+    int getChannelsWithNotes() const noexcept           { return channelsWithNotes; }
+
+private:
+    struct ChannelState
+    {
+        juce::int8 controllers[128];
+        juce::int8 program;
+        juce::int16 pitchWheel;
+    };
+
+    static constexpr int eventsPerCheckpoint = 256;
+
+    const juce::MidiMessageSequence& sequence;
+    juce::Range<int> channels;
+    std::vector<double> eventTimes, noteEndTimes;
+    std::vector<ChannelState> checkpoints, currentState;
+    int channelsWithNotes = 0;
+
+    void applyEvent (ChannelState*, const juce::MidiMessage&) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (MidiSequenceSeekIndex)
+};
+
+//==============================================================================
 /** An AudioNode that plays MIDI data from a MidiMessageSequence,
     at a specific MIDI channel
 */
@@ -46,6 +101,7 @@ public:
 
 private:
     std::vector<juce::MidiMessageSequence> ms;
+    std::vector<std::unique_ptr<MidiSequenceSeekIndex>> seekIndexes;
     size_t currentSequence = 0;
     int currentIndex = 0;
     EditTimeRange editSection;
@@ -58,8 +114,9 @@ private:
 
     //==============================================================================
     void createMessagesForTime (double time, MidiMessageArray&, double midiTimeOffset);
-    void createNoteOffs (MidiMessageArray& destination, const juce::MidiMessageSequence& source,
+    void createNoteOffs (MidiMessageArray& destination, size_t sequenceIndex,
                          double time, double midiTimeOffset, bool isPlaying);
+    void createSeekIndexes();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiAudioNode)
 };
@@ -262,6 +262,19 @@ void MixerAudioNode::addInput (AudioNode* inputNode)
     }
 }
 
+bool MixerAudioNode::releaseInput (AudioNode* inputNode)
+{
+    auto index = inputs.indexOf (inputNode);
+
+    if (index < 0)
+        return false;
+
+    // Leaves an empty slot rather than removing it so this doesn't reallocate, as it's
+    // called on the audio thread once the mixer has been taken out of the graph
+    inputs.set (index, nullptr, false);
+    return true;
+}
+
 void MixerAudioNode::clear()
 {
     inputs.clearQuick (true);
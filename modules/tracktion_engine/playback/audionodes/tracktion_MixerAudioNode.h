@@ -25,6 +25,12 @@ public:
     */
     void addInput (AudioNode*);
 
+    /** Takes an input node out without deleting it, leaving an empty slot.
+        This is only for mixers that are no longer being played.
+        Returns false if the node isn't one of this node's inputs.
+    */
+    bool releaseInput (AudioNode*);
+
     /** deletes all the input nodes */
     void clear();
 
@@ -58,23 +58,48 @@ int64 WaveAudioNode::editTimeToFileSample (double editTime) const noexcept
 
 struct WaveAudioNode::PerChannelState
 {
-    PerChannelState()    { resampler.reset(); }
-
-    juce::LagrangeInterpolator resampler;
+    SincResampler resampler;
     float lastSample = 0;
+
+    /** Crossfades from the last sample of the previous block to avoid clicks after a jump. */
+    void fadeFromLastSample (float* dest, int numSamples, int fadeLength) const noexcept
+    {
+        fadeLength = std::min (fadeLength, numSamples);
+
+        for (int i = 0; i < fadeLength; ++i)
+        {
+            auto alpha = i / (float) fadeLength;
+            dest[i] = alpha * dest[i] + lastSample * (1.0f - alpha);
+        }
+    }
 };
 
+void WaveAudioNode::setResamplingQuality (Engine& e, SincResampler::Quality quality)
+{
+    e.getPropertyStorage().setProperty (SettingID::resamplingQuality, (int) quality);
+}
+
+SincResampler::Quality WaveAudioNode::getResamplingQuality (Engine& e)
+{
+    auto quality = (int) e.getPropertyStorage().getProperty (SettingID::resamplingQuality, (int) SincResampler::Quality::medium);
+    return (SincResampler::Quality) jlimit ((int) SincResampler::Quality::low, (int) SincResampler::Quality::high, quality);
+}
+
 void WaveAudioNode::prepareAudioNodeToPlay (const PlaybackInitialisationInfo& info)
 {
-    reader = audioFile.engine->getAudioFileManager().cache.createReader (audioFile);
+    auto& afm = audioFile.engine->getAudioFileManager();
+    reader = afm.cache.createReader (audioFile);
+    afm.analysisPipeline.setPriority (audioFile, AudioAnalysisPipeline::playingPriority);
     outputSampleRate = info.sampleRate;
-    updateFileSampleRate();
+    resamplingQuality = getResamplingQuality (*audioFile.engine);
 
     channelState.clear();
 
     if (reader != nullptr)
         for (int i = std::max (channelsToUse.size(), reader->getNumChannels()); --i >= 0;)
             channelState.add (new PerChannelState());
+
+    updateFileSampleRate();
 }
 
 bool WaveAudioNode::isReadyToRender()
@@ -110,6 +135,14 @@ bool WaveAudioNode::updateFileSampleRate()
                 reader->setLoopRange (Range<int64> ((int64) (loopSection.getStart() * audioFileSampleRate),
                                                     (int64) (loopSection.getEnd()   * audioFileSampleRate)));
 
+            const double nominalRatio = originalSpeedRatio * audioFileSampleRate / outputSampleRate;
+            canBypassResampling = nominalRatio == 1.0;
+
+            // Even if the rates match, the resampler's needed for blocks where the playback
+            // speed is being adjusted, e.g. to sync to Ableton Link
+            for (auto state : channelState)
+                state->resampler.prepare (resamplingQuality, nominalRatio);
+
             return true;
         }
     }
@@ -124,7 +157,10 @@ void WaveAudioNode::releaseAudioNodeResources()
 
 void WaveAudioNode::renderOver (const AudioRenderContext& rc)
 {
-    callRenderAdding (rc);
+    rc.clearMidiBuffer();
+
+    OverwritingRenderer target { *this };
+    invokeSplitRender (rc, target);
 }
 
 void WaveAudioNode::renderAdding (const AudioRenderContext& rc)
@@ -133,63 +169,237 @@ void WaveAudioNode::renderAdding (const AudioRenderContext& rc)
 }
 
 void WaveAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange editTime)
+{
+    renderSection (rc, editTime, false);
+}
+
+void WaveAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange editTime, bool overwriteDestination)
 {
     // keep a local copy, because releaseAudioNodeResources may remove the reader halfway through..
     const auto localReader = reader;
 
     rc.sanityCheck();
 
-    if (rc.destBuffer == nullptr
-         || rc.bufferNumSamples == 0
-         || localReader == nullptr
-         || editTime.getStart() >= editPosition.getEnd())
+    if (rc.destBuffer == nullptr || rc.bufferNumSamples == 0)
+        return;
+
+    if (localReader == nullptr
+         || editTime.getStart() >= editPosition.getEnd()
+         || channelState.isEmpty())
+    {
+        if (overwriteDestination)
+            rc.clearAudioBuffer();
+
         return;
+    }
 
     SCOPED_REALTIME_CHECK
 
     if (audioFileSampleRate == 0.0 && ! updateFileSampleRate())
+    {
+        if (overwriteDestination)
+            rc.clearAudioBuffer();
+
         return;
+    }
 
-    const auto fileStart       = editTimeToFileSample (editTime.getStart());
-    const auto fileEnd         = editTimeToFileSample (editTime.getEnd());
-    const auto numFileSamples  = (int) (fileEnd - fileStart);
+    float gains[2];
+
+    // For stereo, use the pan, otherwise ignore it
+    if (rc.destBuffer->getNumChannels() == 2)
+        clipLevel.getLeftAndRightGains (gains[0], gains[1]);
+    else
+        gains[0] = gains[1] = clipLevel.getGainIncludingMute();
+
+    if (rc.playhead.isUserDragging())
+    {
+        gains[0] *= 0.4f;
+        gains[1] *= 0.4f;
+    }
+
+    // The samples can only be used as they are if the block covers exactly as many of them
+    if (canBypassResampling
+         && editTimeToFileSample (editTime.getEnd()) - editTimeToFileSample (editTime.getStart()) == rc.bufferNumSamples)
+    {
+        renderUnresampled (rc, editTime, *localReader, gains, overwriteDestination);
+        resamplerNeedsPriming = true;
+    }
+    else
+    {
+        if (overwriteDestination)
+            rc.clearAudioBuffer();
+
+        renderResampled (rc, editTime, *localReader, gains);
+    }
+}
+
+static int getReadTimeoutMs (const AudioRenderContext& rc)
+{
+    return rc.isRendering ? 5000 : 3;
+}
+
+static bool needsFadeFromLastBlock (const AudioRenderContext& rc)
+{
+    return ! rc.isContiguousWithPreviousBlock() && ! rc.isFirstBlockOfLoop();
+}
+
+/** Returns the length of fade needed from the last block after a read. */
+static int getFadeLength (const AudioRenderContext& rc, bool readOk)
+{
+    if (! readOk)
+        return std::min (rc.bufferNumSamples, 40);
+
+    if (needsFadeFromLastBlock (rc))
+        return std::min (rc.bufferNumSamples, rc.playhead.isUserDragging() ? 40 : 10);
 
-    localReader->setReadPosition (fileStart);
+    return 0;
+}
+
+/** Reads a block of samples, returning the length of fade needed from the last block. */
+static int readFileSamples (const AudioRenderContext& rc, AudioFileCache::Reader& reader,
+                            AudioBuffer<float>& dest, int startSample, int numSamples,
+                            const AudioChannelSet& channelsToUse, const float* gains = nullptr)
+{
+    SCOPED_REALTIME_CHECK
 
-    AudioScratchBuffer fileData (rc.destBufferChannels.size(), numFileSamples + 2);
+    const bool ok = reader.readSamples (numSamples, dest, rc.destBufferChannels, startSample, channelsToUse,
+                                        gains != nullptr ? gains[0] : 1.0f,
+                                        gains != nullptr ? gains[1] : 1.0f,
+                                        false, getReadTimeoutMs (rc));
 
-    int lastSampleFadeLength = 0;
+    if (! ok)
+        dest.clear (startSample, numSamples);
+
+    return getFadeLength (rc, ok);
+}
+
+void WaveAudioNode::renderUnresampled (const AudioRenderContext& rc, EditTimeRange editTime,
+                                       AudioFileCache::Reader& localReader,
+                                       const float* gains, bool overwriteDestination)
+{
+    // The file and output rates match so the samples can be used as they are, with the
+    // reader applying the clip's gain as it converts them into the destination
+    const int numSamples = rc.bufferNumSamples;
+    auto numDestChannels = std::min (rc.destBuffer->getNumChannels(), rc.destBufferChannels.size());
+    localReader.setReadPosition (editTimeToFileSample (editTime.getStart()));
 
+    if (overwriteDestination)
     {
-        SCOPED_REALTIME_CHECK
+        const int fadeLength = readFileSamples (rc, localReader, *rc.destBuffer, rc.bufferStartSample,
+                                                numSamples, channelsToUse, gains);
 
-        if (localReader->readSamples (numFileSamples + 2, fileData.buffer, rc.destBufferChannels, 0,
-                                      channelsToUse,
-                                      rc.isRendering ? 5000 : 3))
+        for (int channel = 0; channel < rc.destBuffer->getNumChannels(); ++channel)
         {
-            if (! rc.isContiguousWithPreviousBlock() && ! rc.isFirstBlockOfLoop())
-                lastSampleFadeLength = std::min (rc.bufferNumSamples, rc.playhead.isUserDragging() ? 40 : 10);
+            if (channel < numDestChannels && channel < channelState.size())
+            {
+                const auto dest = rc.destBuffer->getWritePointer (channel, rc.bufferStartSample);
+                auto& state = *channelState.getUnchecked (channel);
+
+                state.fadeFromLastSample (dest, numSamples, fadeLength);
+                state.lastSample = dest[numSamples - 1];
+            }
+            else
+            {
+                rc.destBuffer->clear (channel, rc.bufferStartSample, numSamples);
+            }
         }
-        else
+
+        return;
+    }
+
+    bool readOk = false;
+
+    if (! needsFadeFromLastBlock (rc))
+    {
+        // Without a fade the file can be added straight into the destination, so the last
+        // values are kept to work out how much was added to each channel
+        static constexpr int maxNumChannelsToTrack = 32;
+        float lastDestSamples[maxNumChannelsToTrack] = {};
+        const int numChannelsToTrack = std::min (numDestChannels, maxNumChannelsToTrack);
+
+        for (int channel = 0; channel < numChannelsToTrack; ++channel)
+            lastDestSamples[channel] = rc.destBuffer->getSample (channel, rc.bufferStartSample + numSamples - 1);
+
+        readOk = localReader.readSamples (numSamples, *rc.destBuffer, rc.destBufferChannels, rc.bufferStartSample,
+                                          channelsToUse, gains[0], gains[1], true, getReadTimeoutMs (rc));
+
+        if (readOk)
         {
-            lastSampleFadeLength = std::min (rc.bufferNumSamples, 40);
-            fileData.buffer.clear();
+            for (int channel = 0; channel < numDestChannels; ++channel)
+            {
+                if (channel < channelState.size())
+                {
+                    const auto lastSample = rc.destBuffer->getSample (channel, rc.bufferStartSample + numSamples - 1);
+                    channelState.getUnchecked (channel)->lastSample = channel < numChannelsToTrack ? lastSample - lastDestSamples[channel]
+                                                                                                   : lastSample;
+                }
+                else
+                {
+                    rc.destBuffer->clear (channel, rc.bufferStartSample, numSamples);
+                }
+            }
+
+            return;
         }
     }
 
-    float gains[2];
+    // Otherwise it's read into a scratch buffer so the fade can be applied before adding it.
+    // If the direct read failed the destination's unchanged, and this just fades to silence
+    AudioScratchBuffer fileData (rc.destBufferChannels.size(), numSamples);
+    int fadeLength;
 
-    // For stereo, use the pan, otherwise ignore it
-    if (rc.destBuffer->getNumChannels() == 2)
-        clipLevel.getLeftAndRightGains (gains[0], gains[1]);
+    if (needsFadeFromLastBlock (rc))
+    {
+        fadeLength = readFileSamples (rc, localReader, fileData.buffer, 0, numSamples, channelsToUse, gains);
+    }
     else
-        gains[0] = gains[1] = clipLevel.getGainIncludingMute();
+    {
+        fileData.buffer.clear();
+        fadeLength = getFadeLength (rc, readOk);
+    }
 
-    if (rc.playhead.isUserDragging())
+    for (int channel = 0; channel < numDestChannels; ++channel)
     {
-        gains[0] *= 0.4f;
-        gains[1] *= 0.4f;
+        if (channel < channelState.size())
+        {
+            const auto src = fileData.buffer.getWritePointer (channel);
+            const auto dest = rc.destBuffer->getWritePointer (channel, rc.bufferStartSample);
+            auto& state = *channelState.getUnchecked (channel);
+
+            state.fadeFromLastSample (src, numSamples, fadeLength);
+            FloatVectorOperations::add (dest, src, numSamples);
+            state.lastSample = src[numSamples - 1];
+        }
+        else
+        {
+            rc.destBuffer->clear (channel, rc.bufferStartSample, numSamples);
+        }
     }
+}
+
+void WaveAudioNode::renderResampled (const AudioRenderContext& rc, EditTimeRange editTime,
+                                     AudioFileCache::Reader& localReader, const float* gains)
+{
+    const auto fileStart       = editTimeToFileSample (editTime.getStart());
+    const auto fileEnd         = editTimeToFileSample (editTime.getEnd());
+    const auto numFileSamples  = (int) (fileEnd - fileStart);
+
+    // The resampler's output lags its input, so read that far ahead. After a jump its
+    // history is refilled from the samples before the block so the output lines up
+    auto& firstResampler = channelState.getUnchecked (0)->resampler;
+
+    if (! firstResampler.isPrepared())
+        return;
+
+    // The resampler's history is also out of date if the last block bypassed it
+    const bool needsPriming = resamplerNeedsPriming || ! rc.isContiguousWithPreviousBlock();
+    resamplerNeedsPriming = false;
+    const int numPrimingSamples = needsPriming ? firstResampler.getNumPrimingSamples() : 0;
+    localReader.setReadPosition (fileStart + firstResampler.getLatencySamples() - numPrimingSamples);
+
+    AudioScratchBuffer fileData (rc.destBufferChannels.size(), numPrimingSamples + numFileSamples + 2);
+    const int fadeLength = readFileSamples (rc, localReader, fileData.buffer, 0,
+                                            fileData.buffer.getNumSamples(), channelsToUse);
 
     auto ratio = numFileSamples / (double) rc.bufferNumSamples;
 
@@ -204,19 +414,16 @@ void WaveAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange e
             {
                 const auto src = fileData.buffer.getReadPointer (channel);
                 const auto dest = rc.destBuffer->getWritePointer (channel, rc.bufferStartSample);
-
                 auto& state = *channelState.getUnchecked (channel);
-                state.resampler.processAdding (ratio, src, dest, rc.bufferNumSamples, gains[channel & 1]);
 
-                if (lastSampleFadeLength > 0)
+                if (needsPriming)
                 {
-                    for (int i = 0; i < lastSampleFadeLength; ++i)
-                    {
-                        auto alpha = i / (float) lastSampleFadeLength;
-                        dest[i] = alpha * dest[i] + state.lastSample * (1.0f - alpha);
-                    }
+                    state.resampler.reset();
+                    state.resampler.prime (src, numPrimingSamples);
                 }
 
+                state.resampler.processAdding (ratio, src + numPrimingSamples, dest, rc.bufferNumSamples, gains[channel & 1]);
+                state.fadeFromLastSample (dest, rc.bufferNumSamples, fadeLength);
                 state.lastSample = dest[rc.bufferNumSamples - 1];
             }
             else
@@ -78,6 +78,15 @@ public:
 
     void renderSection (const AudioRenderContext&, EditTimeRange editTime);
 
+    //==============================================================================
+    /** Sets the quality of the resampler used when a file's sample rate or playback
+        speed doesn't match the output. This takes effect the next time playback is prepared.
+    */
+    static void setResamplingQuality (Engine&, SincResampler::Quality);
+
+    /** Returns the quality of resampler to use. @see setResamplingQuality */
+    static SincResampler::Quality getResamplingQuality (Engine&);
+
 private:
     //==============================================================================
     EditTimeRange editPosition, loopSection;
@@ -89,13 +98,28 @@ private:
     double audioFileSampleRate = 0;
     const juce::AudioChannelSet channelsToUse;
     AudioFileCache::Reader::Ptr reader;
+    SincResampler::Quality resamplingQuality = SincResampler::Quality::medium;
+    bool canBypassResampling = false, resamplerNeedsPriming = true;
 
     struct PerChannelState;
     juce::OwnedArray<PerChannelState> channelState;
 
+    /** Used by renderOver to write the file straight into the destination. */
+    struct OverwritingRenderer
+    {
+        WaveAudioNode& owner;
+        void renderSection (const AudioRenderContext& rc, EditTimeRange editTime)   { owner.renderSection (rc, editTime, true); }
+    };
+
     juce::int64 editTimeToFileSample (double) const noexcept;
     bool updateFileSampleRate();
 
+    void renderSection (const AudioRenderContext&, EditTimeRange editTime, bool overwriteDestination);
+    void renderUnresampled (const AudioRenderContext&, EditTimeRange editTime, AudioFileCache::Reader&,
+                            const float* gains, bool overwriteDestination);
+    void renderResampled (const AudioRenderContext&, EditTimeRange editTime, AudioFileCache::Reader&,
+                          const float* gains);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveAudioNode)
 };
 
@@ -460,11 +460,15 @@ template<typename NodePlayerType>
 class RackNodePlayer
 {
 public:
-    /** Creates an RackNodePlayer to process an Node with input. */
+    /** Creates an RackNodePlayer to process an Node with input.
+        Any additional arguments are passed on to the NodePlayerType's constructor.
+    */
+    template<typename... NodePlayerArgs>
     RackNodePlayer (std::unique_ptr<tracktion_graph::Node> nodeToProcess,
                     std::shared_ptr<InputProvider> inputProviderToUse,
-                    bool overrideInputProvider)
-        : nodePlayer (std::move (nodeToProcess)),
+                    bool overrideInputProvider,
+                    NodePlayerArgs&&... nodePlayerArgs)
+        : nodePlayer (std::move (nodeToProcess), std::forward<NodePlayerArgs> (nodePlayerArgs)...),
           inputProvider (std::move (inputProviderToUse)),
           overrideInputs (overrideInputProvider)
     {
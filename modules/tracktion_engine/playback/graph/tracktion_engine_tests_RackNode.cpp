@@ -34,6 +34,9 @@ public:
         
         runAllTests<tracktion_graph::NodePlayer>();
         runAllTests<tracktion_graph::MultiThreadedNodePlayer>();
+
+        for (auto setup : test_utilities::getTestSetups (*this))
+            runMultiThreadedRackTests (setup);
     }
     
     template<typename NodePlayerType>
@@ -621,6 +624,77 @@ private:
             edit->getTempDirectory (false).deleteRecursively();
         }
     }
+
+    void runMultiThreadedRackTests (test_utilities::TestSetup testSetup)
+    {
+        auto& engine = *tracktion_engine::Engine::getEngines()[0];
+
+        beginTest ("Multi-threaded Rack matches single-threaded");
+        {
+            auto edit = Edit::createSingleTrackEdit (engine);
+
+            // Four sines at different frequencies, each fed from the inputs so they can run in parallel
+            auto createRack = [&]
+            {
+                auto rack = edit->getRackList().addNewRack();
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    Plugin::Ptr plugin = edit->getPluginCache().createNewPlugin (ToneGeneratorPlugin::xmlTypeName, {});
+                    auto toneGen = dynamic_cast<ToneGeneratorPlugin*> (plugin.get());
+                    toneGen->levelParam->setParameter (0.25f, dontSendNotification);
+                    toneGen->frequencyParam->setParameter (220.0f * (i + 1), dontSendNotification);
+
+                    rack->addPlugin (plugin, {}, false);
+
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        rack->addConnection ({}, c, plugin->itemID, c);
+                        rack->addConnection (plugin->itemID, c, {}, c);
+                    }
+                }
+
+                return rack;
+            };
+
+            auto render = [&] (RackType& rack, auto createPlayer)
+            {
+                auto inputProvider = std::make_shared<InputProvider>();
+                auto rackNode = RackNodeBuilder::createRackNode (rack, testSetup.sampleRate, testSetup.blockSize, inputProvider);
+                test_utilities::expectUniqueNodeIDs (*this, *rackNode, true);
+
+                return createTestContext (createPlayer (std::move (rackNode), inputProvider), testSetup, 2, 1.0);
+            };
+
+            auto singleThreaded = render (*createRack(), [] (std::unique_ptr<Node> node, std::shared_ptr<InputProvider> inputProvider)
+                                          {
+                                              return std::make_unique<RackNodePlayer<NodePlayer>> (std::move (node), inputProvider, true);
+                                          });
+
+            auto threadPool = std::make_shared<MultiThreadedNodePlayer::ThreadPool> ((size_t) 3);
+            auto multiThreaded = render (*createRack(), [threadPool] (std::unique_ptr<Node> node, std::shared_ptr<InputProvider> inputProvider)
+                                         {
+                                             return std::make_unique<RackNodePlayer<MultiThreadedNodePlayer>> (std::move (node), inputProvider, true, threadPool);
+                                         });
+
+            auto& expected = singleThreaded->buffer;
+            auto& actual = multiThreaded->buffer;
+            expectEquals (actual.getNumChannels(), expected.getNumChannels());
+            expectEquals (actual.getNumSamples(), expected.getNumSamples());
+            expect (expected.getMagnitude (0, expected.getNumSamples()) > 0.5f);
+
+            float maxDifference = 0.0f;
+
+            for (int c = 0; c < jmin (actual.getNumChannels(), expected.getNumChannels()); ++c)
+                for (int i = 0; i < jmin (actual.getNumSamples(), expected.getNumSamples()); ++i)
+                    maxDifference = jmax (maxDifference, std::abs (actual.getSample (c, i) - expected.getSample (c, i)));
+
+            expectWithinAbsoluteError (maxDifference, 0.0f, 0.0001f);
+
+            engine.getAudioFileManager().releaseAllFiles();
+            edit->getTempDirectory (false).deleteRecursively();
+        }
+    }
 };
 
 static RackAudioNodeTests rackAudioNodeTests;
@@ -1170,6 +1170,10 @@ void DeviceManager::audioDeviceAboutToStart (AudioIODevice* device)
 
     reloadAllContextDevices();
 
+    // The true-peak and LUFS modes need to know the rate they're measuring at
+    for (auto wi : waveInputs)
+        wi->levelMeasurer.setSampleRate (currentSampleRate);
+
     const ScopedLock sl (contextLock);
 
     for (auto c : activeContexts)
@@ -13,6 +13,388 @@ namespace tracktion_engine
 
 std::function<AudioNode*(AudioNode*)> EditPlaybackContext::insertOptionalLastStageNode = [] (AudioNode* input)    { return input; };
 
+//==============================================================================
+/** Wraps the node of an unchanged track from the current graph so it can be added
+    to a new graph without being re-created or re-prepared.
+    The node is only taken out of the old graph when the new one is swapped in.
+*/
+class ReusedTrackAudioNode  : public AudioNode
+{
+public:
+    ReusedTrackAudioNode (MixerAudioNode& oldParentNode, AudioNode& oldInputNode,
+                          AudioNode& trackNodeToUse, AudioNodeProperties props)
+        : oldParent (&oldParentNode), oldInput (&oldInputNode),
+          trackNode (trackNodeToUse), properties (props)
+    {
+    }
+
+    /** Takes ownership of the track node from the old graph.
+        This is called on the audio thread when the new graph is installed so doesn't delete
+        anything. If the node was reused last time, this returns the old wrapper, which the
+        caller must delete later.
+    */
+    AudioNode* takeNodeFromOldGraph()
+    {
+        if (oldParent == nullptr)
+            return {};
+
+        AudioNode* nodeToDelete = nullptr;
+
+        if (oldParent->releaseInput (oldInput))
+        {
+            if (oldInput != &trackNode)
+            {
+                auto oldWrapper = static_cast<ReusedTrackAudioNode*> (oldInput);
+                ownedNode = std::move (oldWrapper->ownedNode);
+                nodeToDelete = oldWrapper;
+            }
+            else
+            {
+                ownedNode.reset (oldInput);
+            }
+        }
+        else
+        {
+            jassertfalse;
+        }
+
+        oldParent = nullptr;
+        oldInput = nullptr;
+        return nodeToDelete;
+    }
+
+    void getAudioNodeProperties (AudioNodeProperties& info) override                { info = properties; }
+    void visitNodes (const VisitorFn& v) override                                   { v (*this); trackNode.visitNodes (v); }
+    bool purgeSubNodes (bool, bool) override                                        { return true; }
+
+    // The node is still prepared from when it was added to the previous graph
+    void prepareAudioNodeToPlay (const PlaybackInitialisationInfo&) override        {}
+    void releaseAudioNodeResources() override                                       { trackNode.releaseAudioNodeResources(); }
+
+    void prepareForNextBlock (const AudioRenderContext& rc) override                { trackNode.prepareForNextBlock (rc); }
+    bool isReadyToRender() override                                                 { return trackNode.isReadyToRender(); }
+    void renderOver (const AudioRenderContext& rc) override                         { trackNode.renderOver (rc); }
+    void renderAdding (const AudioRenderContext& rc) override                       { trackNode.renderAdding (rc); }
+
+private:
+    MixerAudioNode* oldParent;
+    AudioNode* oldInput;
+    AudioNode& trackNode;
+    std::unique_ptr<AudioNode> ownedNode;
+    const AudioNodeProperties properties;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReusedTrackAudioNode)
+};
+
+//==============================================================================
+/** Remembers where each track's node is in the current graph so that when the graph
+    is rebuilt, the nodes of the tracks that haven't changed can be moved in to it.
+*/
+struct EditPlaybackContext::TrackNodeCache
+{
+    struct Entry
+    {
+        const OutputDeviceInstance* output;
+        EditItemID trackID;
+        MixerAudioNode* parent;
+        AudioNode* input;       // The node added to the parent, possibly a ReusedTrackAudioNode
+        AudioNode* trackNode;
+        AudioNodeProperties properties;
+        bool isSidechainSource;  // Whether the node includes a SidechainSendAudioNode
+    };
+
+    void beginRebuild (Edit& edit, bool addAntiDenormalisationNoise)
+    {
+        auto& dm = edit.engine.getDeviceManager();
+        auto changes = edit.takePlaybackGraphChanges();
+
+        // A rebuild that no change was recorded for has been asked for by something
+        // outside the Edit, e.g. a device, so could affect any track
+        canReuseNodes = edit.engine.getEngineBehaviour().shouldReuseUnchangedTrackNodes()
+                         && ! changes.everythingChanged
+                         && ! changes.changedTracks.isEmpty()
+                         && sampleRate == dm.getSampleRate()
+                         && blockSize == dm.getBlockSize()
+                         && lastAddAntiDenormalisationNoise == addAntiDenormalisationNoise;
+
+        changedTracks.swapWith (changes.changedTracks);
+        sampleRate = dm.getSampleRate();
+        blockSize = dm.getBlockSize();
+        lastAddAntiDenormalisationNoise = addAntiDenormalisationNoise;
+
+        if (! canReuseNodes)
+            entries.clear();
+
+        newEntries.clear();
+        reusedNodes.clear();
+        numTracksCreated = 0;
+        numTracksReused = 0;
+    }
+
+    AudioNode* createNodeForTrack (AudioTrack& track, OutputDeviceInstance& output,
+                                   MixerAudioNode& parent, const CreateAudioNodeParams& cnp)
+    {
+        if (! canBeReused (track, output.context))
+        {
+            ++numTracksCreated;
+            return track.createAudioNode (cnp);
+        }
+
+        // A track only gets a sidechain send if another track's plugin uses it as a source,
+        // which can change without anything on this track changing
+        const bool isSidechainSource = track.isSidechainSource();
+
+        if (canReuseNodes && ! changedTracks.contains (track.itemID))
+        {
+            for (auto& e : entries)
+            {
+                if (e.output == &output && e.trackID == track.itemID && e.isSidechainSource == isSidechainSource)
+                {
+                    auto node = new ReusedTrackAudioNode (*e.parent, *e.input, *e.trackNode, e.properties);
+                    reusedNodes.push_back (node);
+                    newEntries.push_back ({ &output, track.itemID, &parent, node, e.trackNode, e.properties, isSidechainSource });
+                    ++numTracksReused;
+                    return node;
+                }
+            }
+        }
+
+        auto node = track.createAudioNode (cnp);
+        ++numTracksCreated;
+
+        if (node != nullptr && ! containsNodesThatReferToOtherTracks (*node))
+            newEntries.push_back ({ &output, track.itemID, &parent, node, node, {}, isSidechainSource });
+
+        return node;
+    }
+
+    /** Removes anything from the new graph that got purged and caches the properties
+        of the newly created nodes. This must be called before the graph is used.
+    */
+    void newGraphPrepared (const Array<AudioNode*>& rootNodes)
+    {
+        std::unordered_set<AudioNode*> liveNodes;
+
+        for (auto root : rootNodes)
+            if (root != nullptr)
+                root->visitNodes ([&] (AudioNode& n) { liveNodes.insert (&n); });
+
+        auto isLive = [&] (AudioNode* n) { return liveNodes.find (n) != liveNodes.end(); };
+
+        newEntries.erase (std::remove_if (newEntries.begin(), newEntries.end(),
+                                          [&] (const Entry& e) { return ! (isLive (e.parent) && isLive (e.input)); }),
+                          newEntries.end());
+
+        reusedNodes.erase (std::remove_if (reusedNodes.begin(), reusedNodes.end(),
+                                           [&] (ReusedTrackAudioNode* n) { return ! isLive (n); }),
+                           reusedNodes.end());
+
+        for (auto& e : newEntries)
+        {
+            if (e.input == e.trackNode)
+            {
+                e.properties = { false, false, 0 };
+                e.trackNode->getAudioNodeProperties (e.properties);
+            }
+        }
+    }
+
+    int getNumReusedNodes() const noexcept      { return (int) reusedNodes.size(); }
+
+    /** Moves the reused nodes out of the old graph, adding any that are no longer needed to
+        the list to delete. This is called when the new graph is installed, usually on the
+        audio thread, so the list must already have space for them.
+    */
+    void newGraphSwappedIn (std::vector<AudioNode*>& nodesToDelete)
+    {
+        for (auto n : reusedNodes)
+            if (auto oldWrapper = n->takeNodeFromOldGraph())
+                nodesToDelete.push_back (oldWrapper);
+
+        reusedNodes.clear();
+        entries.swap (newEntries);
+        newEntries.clear();
+    }
+
+    int numTracksCreated = 0, numTracksReused = 0;
+
+    void clear()
+    {
+        jassert (reusedNodes.empty());
+        entries.clear();
+        newEntries.clear();
+    }
+
+private:
+    std::vector<Entry> entries, newEntries;
+    std::vector<ReusedTrackAudioNode*> reusedNodes;
+    Array<EditItemID> changedTracks;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    bool lastAddAntiDenormalisationNoise = false, canReuseNodes = false;
+
+    /** Tracks fed by other tracks or inputs contain nodes that depend on those
+        rather than just the track's own state so can't be reused.
+    */
+    static bool canBeReused (AudioTrack& track, EditPlaybackContext& context)
+    {
+        for (auto t : getAudioTracks (track.edit))
+            if (t != &track && t->getOutput().outputsToDestTrack (track))
+                return false;
+
+        for (auto t : getTracksOfType<FolderTrack> (track.edit, true))
+            if (t->getOutput() != nullptr && t->getOutput()->outputsToDestTrack (track))
+                return false;
+
+        for (auto in : context.getAllInputs())
+            if (in->isOnTargetTrack (track))
+                return false;
+
+        return true;
+    }
+
+    /** Sidechains and aux sends hold on to parts of other tracks' graphs when they are
+        prepared so must be re-created whenever the graph is.
+    */
+    static bool containsNodesThatReferToOtherTracks (AudioNode& node)
+    {
+        bool found = false;
+
+        node.visitNodes ([&] (AudioNode& n)
+                         {
+                             if (dynamic_cast<SidechainReceiveAudioNode*> (&n) != nullptr
+                                  || dynamic_cast<AuxSendPlugin*> (n.getPlugin().get()) != nullptr)
+                                 found = true;
+                         });
+
+        return found;
+    }
+};
+
+//==============================================================================
+/** A graph that has been built and prepared, waiting to be swapped in to the outputs. */
+struct EditPlaybackContext::PreparedGraph
+{
+    ~PreparedGraph()
+    {
+        // The old nodes are only deleted once they've all been removed from the graph,
+        // because there could be interdependencies between them, e.g. aux sends
+        for (auto n : nodes)
+            delete n;
+
+        for (auto n : removedNodes)
+            delete n;
+    }
+
+    std::vector<AudioNode*> nodes;          // One for each MIDI then wave output
+    std::vector<AudioNode*> removedNodes;   // The nodes this replaced, once it's been installed
+    TempoSequence::TempoSections previousTempoSections, tempoSections;
+    bool hasTempoChanged = false;
+    std::atomic<bool> isInstalled { false };
+};
+
+//==============================================================================
+/** Hands newly built graphs to the audio thread, which swaps them in at the start of its
+    next block so the old graph keeps playing until then, and deletes the graphs they
+    replaced on the message thread once that's happened.
+    If the audio isn't running, graphs are swapped in straight away.
+*/
+struct EditPlaybackContext::GraphPublisher  : private Timer
+{
+    GraphPublisher (EditPlaybackContext& c)  : context (c) {}
+
+    ~GraphPublisher() override
+    {
+        finishPublishing();
+        publishedGraphs.clear();
+    }
+
+    void publish (std::unique_ptr<PreparedGraph> graph)
+    {
+        TRACKTION_ASSERT_MESSAGE_THREAD
+        jassert (pendingGraph == nullptr);
+
+        auto g = publishedGraphs.add (graph.release());
+
+        if (isAudioRunning())
+        {
+            pendingGraph = g;
+            startTimer (20);
+        }
+        else
+        {
+            {
+                const ScopedLock sl (context.edit.engine.getDeviceManager().deviceManager.getAudioCallbackLock());
+                context.installGraph (*g);
+            }
+
+            deleteInstalledGraphs();
+        }
+    }
+
+    /** Makes sure the last graph published is the one being played.
+        This must be called before anything that the audio thread uses when it installs a
+        graph is changed, e.g. before another graph is built.
+    */
+    void finishPublishing()
+    {
+        TRACKTION_ASSERT_MESSAGE_THREAD
+
+        {
+            // The audio thread only installs graphs while it holds this lock, so once we've got
+            // it, any graph it has taken is installed and we can install one it hasn't got to
+            const ScopedLock sl (context.edit.engine.getDeviceManager().deviceManager.getAudioCallbackLock());
+
+            if (auto g = pendingGraph.exchange (nullptr))
+                context.installGraph (*g);
+        }
+
+        deleteInstalledGraphs();
+    }
+
+    /** Called on the audio thread at the start of each block, while it holds the audio callback lock. */
+    void installPendingGraph() noexcept
+    {
+        lastCallbackTime = Time::getMillisecondCounter();
+
+        if (pendingGraph.load (std::memory_order_relaxed) == nullptr)
+            return;
+
+        if (auto g = pendingGraph.exchange (nullptr))
+            context.installGraph (*g);
+    }
+
+private:
+    EditPlaybackContext& context;
+    OwnedArray<PreparedGraph> publishedGraphs;
+    std::atomic<PreparedGraph*> pendingGraph { nullptr };
+    std::atomic<uint32> lastCallbackTime { 0 };
+
+    bool isAudioRunning() const
+    {
+        // If there hasn't been a callback for a while, the graph could be left waiting
+        const auto lastTime = lastCallbackTime.load();
+        return lastTime != 0 && Time::getMillisecondCounter() - lastTime < 200;
+    }
+
+    void deleteInstalledGraphs()
+    {
+        for (int i = publishedGraphs.size(); --i >= 0;)
+            if (publishedGraphs.getUnchecked (i)->isInstalled)
+                publishedGraphs.remove (i);
+
+        if (publishedGraphs.isEmpty())
+            stopTimer();
+    }
+
+    void timerCallback() override
+    {
+        deleteInstalledGraphs();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphPublisher)
+};
+
 //==============================================================================
 EditPlaybackContext::ScopedDeviceListReleaser::ScopedDeviceListReleaser (EditPlaybackContext& e, bool reallocate)
     : owner (e), shouldReallocate (reallocate)
@@ -161,6 +543,9 @@ void EditPlaybackContext::clearNodes()
 
     priorityBooster = nullptr;
 
+    if (graphPublisher != nullptr)
+        graphPublisher->finishPublishing();
+
     // mustn't delete any of the nodes until all have been removed from
     // the graph, because there could be interdependencies between some
     // of them, e.g. aux sends
@@ -172,6 +557,9 @@ void EditPlaybackContext::clearNodes()
     for (auto wo : waveOutputs)
         removedNodes.add (wo->replaceAudioNode (nullptr));
 
+    if (trackNodeCache != nullptr)
+        trackNodeCache->clear();
+
     removedNodes.clear();
     isAllocated = false;
 }
@@ -220,7 +608,8 @@ static void prepareNodesToPlay (Engine& engine, const Array<AudioNode*>& allNode
 
 static AudioNode* createPlaybackAudioNode (Edit& edit, OutputDeviceInstance& deviceInstance,
                                            std::function<AudioNode*(AudioNode*)> insertOptionalLastStageNode,
-                                           bool addAntiDenormalisationNoise)
+                                           bool addAntiDenormalisationNoise,
+                                           EditPlaybackContext::TrackNodeCache& trackNodeCache)
 {
     CRASH_TRACER
     OutputDevice& device = deviceInstance.owner;
@@ -288,7 +677,7 @@ static AudioNode* createPlaybackAudioNode (Edit& edit, OutputDeviceInstance& dev
                 if (mixer == nullptr)
                     mixer = new MixerAudioNode (shouldUse64Bit, shouldUseMultiCPU);
 
-                mixer->addInput (t->createAudioNode (cnp));
+                mixer->addInput (trackNodeCache.createNodeForTrack (*t, deviceInstance, *mixer, cnp));
             }
         }
     }
@@ -384,49 +773,79 @@ void EditPlaybackContext::createAudioNodes (double startTime, bool addAntiDenorm
     CRASH_TRACER
 
     isAllocated = true;
+    auto buildStartTime = Time::getMillisecondCounterHiRes();
+
+    if (graphPublisher == nullptr)
+        graphPublisher = std::make_unique<GraphPublisher> (*this);
+
+    // The previous graph must be playing before its nodes can be reused
+    graphPublisher->finishPublishing();
+
+    if (trackNodeCache == nullptr)
+        trackNodeCache = std::make_unique<TrackNodeCache>();
+
+    trackNodeCache->beginRebuild (edit, addAntiDenormalisationNoise);
 
     Array<AudioNode*> allNodes;
 
     for (auto mo : midiOutputs)
         allNodes.add (prepareNode (createPlaybackAudioNode (edit, *mo, insertOptionalLastStageNode,
-                                                            addAntiDenormalisationNoise), true));
+                                                            addAntiDenormalisationNoise, *trackNodeCache), true));
 
     for (auto wo : waveOutputs)
         allNodes.add (prepareNode (createPlaybackAudioNode (edit, *wo, insertOptionalLastStageNode,
-                                                            addAntiDenormalisationNoise), false));
+                                                            addAntiDenormalisationNoise, *trackNodeCache), false));
 
+    trackNodeCache->newGraphPrepared (allNodes);
+    auto preparationStartTime = Time::getMillisecondCounterHiRes();
     prepareNodesToPlay (edit.engine, allNodes, startTime, playhead);
+    auto publicationStartTime = Time::getMillisecondCounterHiRes();
 
-    const auto& tempoSections = edit.tempoSequence.getTempoSections();
-    const bool hasTempoChanged = tempoSections.getChangeCount() != lastTempoSections.getChangeCount();
+    auto graph = std::make_unique<PreparedGraph>();
+    graph->nodes.assign (allNodes.begin(), allNodes.end());
+    graph->removedNodes.reserve ((size_t) (allNodes.size() + trackNodeCache->getNumReusedNodes()));
 
-    // mustn't delete any of the nodes until all have been removed from
-    // the graph, because there could be interdependencies between some
-    // of them, e.g. aux sends
-    OwnedArray<AudioNode> removedNodes;
-    removedNodes.ensureStorageAllocated (1024);
+    const auto& tempoSections = edit.tempoSequence.getTempoSections();
+    graph->hasTempoChanged = tempoSections.getChangeCount() != lastTempoSections.getChangeCount();
 
+    if (graph->hasTempoChanged)
     {
-        int i = 0;
-        ScopedLock sl (edit.engine.getDeviceManager().deviceManager.getAudioCallbackLock());
+        graph->previousTempoSections = lastTempoSections;
+        graph->tempoSections = tempoSections;
+        lastTempoSections = tempoSections;
+    }
 
-        for (auto mo : midiOutputs)
-            removedNodes.add (mo->replaceAudioNode (std::unique_ptr<AudioNode> (allNodes.getUnchecked (i++))));
+    graphPublisher->publish (std::move (graph));
 
-        for (auto wo : waveOutputs)
-            removedNodes.add (wo->replaceAudioNode (std::unique_ptr<AudioNode> (allNodes.getUnchecked (i++))));
+    lastGraphBuildStats.creationMs = preparationStartTime - buildStartTime;
+    lastGraphBuildStats.preparationMs = publicationStartTime - preparationStartTime;
+    lastGraphBuildStats.publicationMs = Time::getMillisecondCounterHiRes() - publicationStartTime;
+    lastGraphBuildStats.numTracksCreated = trackNodeCache->numTracksCreated;
+    lastGraphBuildStats.numTracksReused = trackNodeCache->numTracksReused;
+    ++lastGraphBuildStats.numBuilds;
+}
 
-        if (hasTempoChanged && lastTempoSections.size() > 0)
-        {
-            auto lastBeats = lastTempoSections.timeToBeats (playhead.getPosition());
-            auto lastPositionRemapped = tempoSections.beatsToTime (lastBeats);
+void EditPlaybackContext::installGraph (PreparedGraph& graph)
+{
+    jassert (graph.nodes.size() == (size_t) (midiOutputs.size() + waveOutputs.size()));
+    size_t i = 0;
 
-            playhead.overridePosition (lastPositionRemapped);
-        }
+    for (auto mo : midiOutputs)
+        graph.removedNodes.push_back (mo->replaceAudioNode (std::unique_ptr<AudioNode> (graph.nodes[i++])));
+
+    for (auto wo : waveOutputs)
+        graph.removedNodes.push_back (wo->replaceAudioNode (std::unique_ptr<AudioNode> (graph.nodes[i++])));
+
+    graph.nodes.clear();
+    trackNodeCache->newGraphSwappedIn (graph.removedNodes);
+
+    if (graph.hasTempoChanged && graph.previousTempoSections.size() > 0)
+    {
+        auto lastBeats = graph.previousTempoSections.timeToBeats (playhead.getPosition());
+        playhead.overridePosition (graph.tempoSections.beatsToTime (lastBeats));
     }
 
-    if (hasTempoChanged)
-        lastTempoSections = tempoSections;
+    graph.isInstalled = true;
 }
 
 void EditPlaybackContext::createPlayAudioNodes (double startTime)
@@ -509,6 +928,7 @@ void EditPlaybackContext::prepareOutputDevices (double start)
     int blockSize = dm.getBlockSize();
 
     start = playhead.streamTimeToSourceTime (start);
+    masterLevels.setSampleRate (sampleRate);
 
     for (auto wo : waveOutputs)
         wo->prepareToPlay (sampleRate, blockSize);
@@ -624,6 +1044,9 @@ void EditPlaybackContext::fillNextAudioBlock (EditTimeRange streamTime, float**
 {
     CRASH_TRACER
 
+    if (graphPublisher != nullptr)
+        graphPublisher->installPendingGraph();
+
     if (edit.isRendering())
         return;
 
@@ -770,4 +1193,121 @@ EditPlaybackContext::RealtimePriorityDisabler::~RealtimePriorityDisabler()
 
 #endif
 
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class EditPlaybackContextTests  : public juce::UnitTest
+{
+public:
+    EditPlaybackContextTests()
+        : juce::UnitTest ("EditPlaybackContext", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        HostedAudioDeviceInterface::Parameters params;
+        params.sampleRate = 44100.0;
+        params.blockSize = 256;
+        params.inputChannels = 0;
+        params.fixedBlockSize = true;
+
+        auto& engine = *Engine::getEngines()[0];
+        auto& deviceManager = engine.getDeviceManager();
+        auto& audioIO = deviceManager.getHostedAudioDeviceInterface();
+        audioIO.initialise (params);
+        audioIO.prepareToPlay (params.sampleRate, params.blockSize);
+
+        beginTest ("Reusing the nodes of unchanged tracks");
+        {
+            auto sourceFile = createSineFile (params.sampleRate);
+            const int numTracks = 4;
+
+            auto edit = Edit::createSingleTrackEdit (engine);
+            edit->ensureNumberOfAudioTracks (numTracks);
+            Clip::Array clips;
+
+            for (auto t : getAudioTracks (*edit))
+                clips.add (t->insertWaveClip ("Sine", sourceFile->getFile(), { { 0.0, 1.0 }, 0.0 }, false).get());
+
+            expectEquals (clips.size(), numTracks);
+
+            auto& transport = edit->getTransport();
+            transport.freePlaybackContext();
+            transport.ensureContextAllocated();
+            auto context = transport.getCurrentPlaybackContext();
+            expect (context != nullptr);
+
+            if (context != nullptr)
+            {
+                expectEquals (context->getLastGraphBuildStats().numTracksReused, 0);
+
+                // Moving a clip should only re-create the nodes for its own track
+                clips.getFirst()->setStart (0.5, false, true);
+                context->createPlayAudioNodes (0.0);
+
+                auto stats = context->getLastGraphBuildStats();
+                expectEquals (stats.numTracksCreated, 1);
+                expectEquals (stats.numTracksReused, numTracks - 1);
+
+                // Without any recorded changes, everything has to be re-created
+                context->createPlayAudioNodes (0.0);
+
+                stats = context->getLastGraphBuildStats();
+                expectEquals (stats.numTracksCreated, numTracks);
+                expectEquals (stats.numTracksReused, 0);
+
+                // Using a track as a sidechain source only changes the receiving track's state
+                // but the source track also needs a new node with a sidechain send
+                auto tracks = getAudioTracks (*edit);
+
+                if (auto volumePlugin = tracks.getLast()->getVolumePlugin())
+                {
+                    volumePlugin->setSidechainSourceID (tracks.getFirst()->itemID);
+                    context->createPlayAudioNodes (0.0);
+
+                    stats = context->getLastGraphBuildStats();
+                    expectEquals (stats.numTracksCreated, 2);
+                    expectEquals (stats.numTracksReused, numTracks - 2);
+                }
+            }
+
+            clips.clear();
+            edit.reset();
+            engine.getAudioFileManager().releaseAllFiles();
+        }
+
+        deviceManager.closeDevices();
+        deviceManager.removeHostedAudioDeviceInterface();
+        deviceManager.deviceManager.closeAudioDevice();
+    }
+
+private:
+    static std::unique_ptr<TemporaryFile> createSineFile (double sampleRate)
+    {
+        AudioBuffer<float> buffer (1, (int) sampleRate);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample (0, i, (float) (0.5 * std::sin (MathConstants<double>::twoPi * 440.0 * i / sampleRate)));
+
+        WavAudioFormat format;
+        auto f = std::make_unique<TemporaryFile> (format.getFileExtensions()[0]);
+
+        if (auto fileStream = f->getFile().createOutputStream())
+        {
+            if (auto writer = std::unique_ptr<AudioFormatWriter> (format.createWriterFor (fileStream.get(), sampleRate, 1, 16, {}, 0)))
+            {
+                fileStream.release();
+                writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+            }
+        }
+
+        return f;
+    }
+};
+
+static EditPlaybackContextTests editPlaybackContextTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
 }
@@ -42,6 +42,26 @@ public:
     juce::Array<InputDeviceInstance*> getAllInputs();
     InputDeviceInstance* getInputFor (InputDevice*) const;
 
+    //==============================================================================
+    /** Describes how long the last rebuild of the playback graph took. */
+    struct GraphBuildStats
+    {
+        double creationMs = 0.0;        /**< Creating the nodes for all the outputs. */
+        double preparationMs = 0.0;     /**< Preparing the new nodes and initialising plugins. */
+        double publicationMs = 0.0;     /**< Handing the new graph to the audio thread, which swaps it in at its next block. */
+        int numTracksCreated = 0;       /**< The number of tracks whose nodes were created from scratch. */
+        int numTracksReused = 0;        /**< The number of tracks whose nodes were moved from the previous graph. */
+        int numBuilds = 0;              /**< The number of times the graph has been built by this context. */
+
+        double getTotalMs() const noexcept      { return creationMs + preparationMs + publicationMs; }
+    };
+
+    /** Returns the timings of the last graph rebuild.
+        These are all spent on the message thread so can be used to find Edits that
+        will stall the UI whenever they change.
+    */
+    GraphBuildStats getLastGraphBuildStats() const noexcept     { return lastGraphBuildStats; }
+
     Edit& edit;
     TransportControl& transport;
     PlayHead playhead;
@@ -75,6 +95,13 @@ public:
         Engine& engine;
     };
 
+    /** @internal */
+    struct TrackNodeCache;
+    /** @internal */
+    struct PreparedGraph;
+    /** @internal */
+    struct GraphPublisher;
+
 private:
     bool isAllocated = false;
 
@@ -93,11 +120,15 @@ private:
     juce::OwnedArray<MidiOutputDeviceInstance> midiOutputs;
 
     TempoSequence::TempoSections lastTempoSections;
+    std::unique_ptr<TrackNodeCache> trackNodeCache;
+    GraphBuildStats lastGraphBuildStats;
+    std::unique_ptr<GraphPublisher> graphPublisher;
 
     void releaseDeviceList();
     void rebuildDeviceList();
 
     void createAudioNodes (double startTime, bool addAntiDenormalisationNoise);
+    void installGraph (PreparedGraph&);
     void prepareOutputDevices (double start);
     void startRecording (double start, double punchIn);
     void startPlaying (double start);
@@ -41,8 +41,304 @@ static void getSumAndDiff (const AudioBuffer<FloatType>& buffer,
     }
 }
 
+//==============================================================================
+static float getRMSLevel (const float* data, int numSamples) noexcept
+{
+    if (numSamples <= 0)
+        return 0.0f;
+
+    // Several accumulators so the compiler can vectorise this
+    float sums[4] = {};
+    int i = 0;
+
+    for (; i + 4 <= numSamples; i += 4)
+        for (int j = 0; j < 4; ++j)
+            sums[j] += data[i + j] * data[i + j];
+
+    for (; i < numSamples; ++i)
+        sums[0] += data[i] * data[i];
+
+    return std::sqrt ((sums[0] + sums[1] + sums[2] + sums[3]) / (float) numSamples);
+}
+
+//==============================================================================
+/** The state needed for the true-peak and LUFS modes.
+    This is only used by the audio thread apart from the loudness histogram.
+*/
+struct LevelMeasurer::Loudness
+{
+    Loudness()
+    {
+        prepare (44100.0);
+    }
+
+    std::atomic<double> requestedSampleRate { 44100.0 };
+    std::atomic<bool> needsReset { false };
+
+    /** Call at the start of each block to pick up any changes from the message thread. */
+    void update() noexcept
+    {
+        if (requestedSampleRate.load() != sampleRate)
+            prepare (requestedSampleRate.load());
+        else if (needsReset.exchange (false))
+            reset();
+    }
+
+    //==============================================================================
+    float processTruePeak (int channel, const float* input, int numSamples) noexcept
+    {
+        float scratch[numTruePeakTaps - 1 + chunkSize];
+        float interpolated[chunkSize];
+        auto history = truePeakHistory[channel];
+        float peak = 0.0f;
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int num = jmin (chunkSize, numSamples - done);
+            std::copy (history, history + numTruePeakTaps - 1, scratch);
+            std::copy (input + done, input + done + num, scratch + numTruePeakTaps - 1);
+
+            // Each tap is applied to the whole chunk at once, so there's no serial sum per sample
+            for (auto& phase : truePeakCoefficients)
+            {
+                FloatVectorOperations::multiply (interpolated, scratch, phase[0], num);
+
+                for (int t = 1; t < numTruePeakTaps; ++t)
+                    FloatVectorOperations::addWithMultiply (interpolated, scratch + t, phase[t], num);
+
+                auto range = FloatVectorOperations::findMinAndMax (interpolated, num);
+                peak = jmax (peak, -range.getStart(), range.getEnd());
+            }
+
+            std::copy (scratch + num, scratch + num + numTruePeakTaps - 1, history);
+            done += num;
+        }
+
+        return peak;
+    }
+
+    void processLoudness (const AudioBuffer<float>& buffer, int start, int numSamples, int numChannels) noexcept
+    {
+        float squares[chunkSize];
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int num = jmin (chunkSize, numSamples - done);
+            std::fill_n (squares, num, 0.0f);
+
+            for (int chan = 0; chan < numChannels; ++chan)
+            {
+                auto src = buffer.getReadPointer (chan, start + done);
+                auto& f = filterState[chan];
+
+                for (int i = 0; i < num; ++i)
+                {
+                    // Two-stage K-weighting filter, in transposed direct form II
+                    auto x = (double) src[i];
+                    auto y1 = shelf.b0 * x + f.z[0];
+                    f.z[0] = shelf.b1 * x - shelf.a1 * y1 + f.z[1];
+                    f.z[1] = shelf.b2 * x - shelf.a2 * y1;
+
+                    auto y2 = highPass.b0 * y1 + f.z[2];
+                    f.z[2] = highPass.b1 * y1 - highPass.a1 * y2 + f.z[3];
+                    f.z[3] = highPass.b2 * y1 - highPass.a2 * y2;
+
+                    squares[i] += (float) (y2 * y2);
+                }
+            }
+
+            for (int i = 0; i < num; ++i)
+            {
+                subBlockSum += squares[i];
+
+                if (++numSamplesInSubBlock >= samplesPerSubBlock)
+                    addSubBlock();
+            }
+
+            done += num;
+        }
+    }
+
+    float getMomentaryLoudness() const noexcept     { return momentaryLoudness; }
+    float getShortTermLoudness() const noexcept     { return shortTermLoudness; }
+
+    float getIntegratedLoudness() const noexcept
+    {
+        // The absolute gate is applied as blocks are added so this just needs the relative one
+        auto relativeGate = getLoudnessOfBins (-70.0f) - 10.0f;
+        return relativeGate > -80.0f ? getLoudnessOfBins (relativeGate) : -100.0f;
+    }
+
+private:
+    struct Coefficients { double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0; };
+    struct FilterState  { double z[4] = {}; };
+
+    static constexpr int chunkSize = 256;
+    static constexpr int numTruePeakTaps = 12;
+    static constexpr int numSubBlocksShortTerm = 30, numSubBlocksMomentary = 4;
+    static constexpr float histogramMin = -70.0f, histogramMax = 5.0f, histogramStep = 0.1f;
+    static constexpr int numHistogramBins = (int) ((histogramMax - histogramMin) / histogramStep);
+
+    // The 4x oversampling interpolation filter from ITU-R BS.1770-4 Annex 2
+    static constexpr float truePeakCoefficients[4][numTruePeakTaps] =
+    {
+        {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f, -0.0594482421875f,  0.1373291015625f,
+           0.9721679687500f, -0.1022949218750f,  0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+        { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f, -0.1665039062500f,  0.4650878906250f,
+           0.7797851562500f, -0.2003173828125f,  0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+        { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f, -0.2003173828125f,  0.7797851562500f,
+           0.4650878906250f, -0.1665039062500f,  0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+        { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f, -0.1022949218750f,  0.9721679687500f,
+           0.1373291015625f, -0.0594482421875f,  0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f }
+    };
+
+    double sampleRate = 0.0;
+    Coefficients shelf, highPass;
+    FilterState filterState[Client::maxNumChannels];
+    float truePeakHistory[Client::maxNumChannels][numTruePeakTaps - 1];
+
+    int samplesPerSubBlock = 4410, numSamplesInSubBlock = 0, numSubBlocks = 0;
+    float subBlockSum = 0.0f;
+    float subBlockPowers[numSubBlocksShortTerm];
+    std::atomic<float> momentaryLoudness { -100.0f }, shortTermLoudness { -100.0f };
+    std::atomic<juce::uint32> histogram[numHistogramBins];
+
+    static float powerToLoudness (double power) noexcept    { return power > 0.0 ? (float) (-0.691 + 10.0 * std::log10 (power)) : -100.0f; }
+    static double loudnessToPower (float lufs) noexcept     { return std::pow (10.0, (lufs + 0.691) / 10.0); }
+
+    void prepare (double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        samplesPerSubBlock = jmax (1, roundToInt (sampleRate * 0.1));
+
+        // These are the K-weighting filters from ITU-R BS.1770, re-calculated for the sample rate
+        {
+            const double f0 = 1681.974450955533, gain = 3.999843853973347, q = 0.7071752369554196;
+            const double k = std::tan (MathConstants<double>::pi * f0 / sampleRate);
+            const double vh = std::pow (10.0, gain / 20.0);
+            const double vb = std::pow (vh, 0.4996667741545416);
+            const double a0 = 1.0 + k / q + k * k;
+
+            shelf = { (vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0,
+                      2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0 };
+        }
+
+        {
+            const double f0 = 38.13547087602444, q = 0.5003270373238773;
+            const double k = std::tan (MathConstants<double>::pi * f0 / sampleRate);
+            const double a0 = 1.0 + k / q + k * k;
+
+            highPass = { 1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0 };
+        }
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& f : filterState)
+            f = {};
+
+        for (auto& h : truePeakHistory)
+            std::fill (std::begin (h), std::end (h), 0.0f);
+
+        numSamplesInSubBlock = 0;
+        numSubBlocks = 0;
+        subBlockSum = 0.0f;
+        momentaryLoudness = -100.0f;
+        shortTermLoudness = -100.0f;
+
+        for (auto& bin : histogram)
+            bin = 0;
+    }
+
+    void addSubBlock() noexcept
+    {
+        subBlockPowers[numSubBlocks % numSubBlocksShortTerm] = subBlockSum / (float) samplesPerSubBlock;
+        ++numSubBlocks;
+        subBlockSum = 0.0f;
+        numSamplesInSubBlock = 0;
+
+        auto getMeanPower = [this] (int numToUse)
+        {
+            numToUse = jmin (numToUse, numSubBlocks);
+            double total = 0.0;
+
+            for (int i = 1; i <= numToUse; ++i)
+                total += subBlockPowers[(numSubBlocks - i) % numSubBlocksShortTerm];
+
+            return total / numToUse;
+        };
+
+        momentaryLoudness = powerToLoudness (getMeanPower (numSubBlocksMomentary));
+        shortTermLoudness = powerToLoudness (getMeanPower (numSubBlocksShortTerm));
+
+        // Each 400ms block, overlapping by 75%, counts towards the integrated loudness
+        if (numSubBlocks >= numSubBlocksMomentary && momentaryLoudness > histogramMin)
+        {
+            auto bin = jlimit (0, numHistogramBins - 1, (int) ((momentaryLoudness - histogramMin) / histogramStep));
+            histogram[bin].fetch_add (1, std::memory_order_relaxed);
+        }
+    }
+
+    float getLoudnessOfBins (float gate) const noexcept
+    {
+        double totalPower = 0.0;
+        juce::uint64 numBlocks = 0;
+
+        for (int i = 0; i < numHistogramBins; ++i)
+        {
+            auto binLoudness = histogramMin + (i + 0.5f) * histogramStep;
+
+            if (binLoudness >= gate)
+            {
+                auto num = histogram[i].load (std::memory_order_relaxed);
+                totalPower += num * loudnessToPower (binLoudness);
+                numBlocks += num;
+            }
+        }
+
+        return numBlocks > 0 ? powerToLoudness (totalPower / (double) numBlocks) : -100.0f;
+    }
+};
+
+constexpr float LevelMeasurer::Loudness::truePeakCoefficients[4][LevelMeasurer::Loudness::numTruePeakTaps];
+
+//==============================================================================
+void LevelMeasurer::LevelHistory::push (juce::uint32 time, const float* dB, int numChannels) noexcept
+{
+    auto index = numBlocksWritten.load (std::memory_order_relaxed);
+    auto& block = blocks[index % numBlocks];
+    block.time.store (time, std::memory_order_relaxed);
+
+    for (int i = 0; i < Client::maxNumChannels; ++i)
+        block.dB[i].store (i < numChannels ? dB[i] : -100.0f, std::memory_order_relaxed);
+
+    numBlocksWritten.store (index + 1, std::memory_order_release);
+}
+
+DbTimePair LevelMeasurer::LevelHistory::getMaxSince (juce::uint64& readPosition, int channel) const noexcept
+{
+    auto numWritten = numBlocksWritten.load (std::memory_order_acquire);
+    DbTimePair result;
+
+    // If the client hasn't looked for a while, only the most recent blocks are still available
+    for (auto i = jmax (readPosition, numWritten > (juce::uint64) numBlocks ? numWritten - numBlocks : 0); i < numWritten; ++i)
+    {
+        auto& block = blocks[i % numBlocks];
+        auto dB = block.dB[channel].load (std::memory_order_relaxed);
+
+        if (dB >= result.dB)
+            result = { block.time.load (std::memory_order_relaxed), dB };
+    }
+
+    readPosition = numWritten;
+    return result;
+}
+
 //==============================================================================
 LevelMeasurer::LevelMeasurer()
+    : loudness (std::make_unique<Loudness>())
 {
     clear();
 }
@@ -50,163 +346,115 @@ LevelMeasurer::LevelMeasurer()
 LevelMeasurer::~LevelMeasurer()
 {
     TRACKTION_ASSERT_MESSAGE_THREAD
+
+    const ScopedLock sl (clientsMutex);
+
+    for (auto c : clients)
+        c->measurer = nullptr;
 }
 
 //==============================================================================
 void LevelMeasurer::Client::reset() noexcept
 {
-    juce::SpinLock::ScopedLockType sl (mutex);
-    for (auto& l : audioLevels)
-        l = {};
+    if (measurer != nullptr)
+    {
+        for (auto& pos : audioReadPositions)
+            pos = measurer->audioHistory.numBlocksWritten;
 
-    for (auto& o : overload)
-        o = false;
+        midiReadPosition = measurer->midiHistory.numBlocksWritten;
+    }
 
-    midiLevels = {};
     clearOverload = true;
 }
 
 bool LevelMeasurer::Client::getAndClearOverload() noexcept
 {
-    juce::SpinLock::ScopedLockType sl (mutex);
-    auto result = clearOverload;
-    clearOverload = false;
-    return result;
+    return clearOverload.exchange (false);
 }
 
 DbTimePair LevelMeasurer::Client::getAndClearMidiLevel() noexcept
 {
-    juce::SpinLock::ScopedLockType sl (mutex);
-    auto result = midiLevels;
-    midiLevels.dB = -100.0f;
-    return result;
+    if (measurer == nullptr)
+        return {};
+
+    return measurer->midiHistory.getMaxSince (midiReadPosition, 0);
 }
 
 DbTimePair LevelMeasurer::Client::getAndClearAudioLevel (int chan) noexcept
 {
-    juce::SpinLock::ScopedLockType sl (mutex);
     jassert (chan >= 0 && chan < maxNumChannels);
-    auto result = audioLevels[chan];
-    audioLevels[chan].dB = -100.0f;
-    return result;
-}
-
-void LevelMeasurer::Client::setNumChannelsUsed (int numChannels) noexcept
-{
-    juce::SpinLock::ScopedLockType sl (mutex);
-    numChannelsUsed = numChannels;
-}
 
-void LevelMeasurer::Client::setOverload (int channel, bool hasOverloaded) noexcept
-{
-    juce::SpinLock::ScopedLockType sl (mutex);
-    overload[channel] = hasOverloaded;
-}
+    if (measurer == nullptr)
+        return {};
 
-void LevelMeasurer::Client::setClearOverload (bool clear) noexcept
-{
-    juce::SpinLock::ScopedLockType sl (mutex);
-    clearOverload = clear;
+    return measurer->audioHistory.getMaxSince (audioReadPositions[chan], chan);
 }
 
-void LevelMeasurer::Client::updateAudioLevel (int channel, DbTimePair newAudioLevel) noexcept
+//==============================================================================
+void LevelMeasurer::pushAudioLevels (const float* levels, int numChannels, bool levelsAreInDecibels) noexcept
 {
-    juce::SpinLock::ScopedLockType sl (mutex);
+    float dB[Client::maxNumChannels];
 
-    if (newAudioLevel.dB >= audioLevels[channel].dB)
-        audioLevels[channel] = newAudioLevel;
-}
+    for (int i = 0; i < numChannels; ++i)
+        dB[i] = levelsAreInDecibels ? levels[i] : gainToDb (levels[i]);
 
-void LevelMeasurer::Client::updateMidiLevel (DbTimePair newMidiLevel) noexcept
-{
-    if (midiLevels.dB >= midiLevels.dB)
-        midiLevels = newMidiLevel;
+    numActiveChannels = numChannels;
+    audioHistory.push (Time::getApproximateMillisecondCounter(), dB, numChannels);
 }
 
-
-//==============================================================================
 void LevelMeasurer::processBuffer (juce::AudioBuffer<float>& buffer, int start, int numSamples)
 {
-    const ScopedLock sl (clientsMutex);
-
-    if (clients.isEmpty())
+    // Nothing can read the levels, so don't waste time measuring them
+    if (numClients.load (std::memory_order_relaxed) == 0)
         return;
 
     float newLevel[Client::maxNumChannels] = {};
     auto numChans = jmin ((int) Client::maxNumChannels, buffer.getNumChannels());
-    auto now = Time::getApproximateMillisecondCounter();
 
-    if (mode == LevelMeasurer::peakMode)
+    switch (mode.load())
     {
-        // peak mode
-        for (int i = numChans; --i >= 0;)
-        {
-            auto gain = buffer.getMagnitude (i, start, numSamples);
-            newLevel[i] = gain;
-            bool overloaded = gain > 0.999f;
-            auto newDB = gainToDb (gain);
-
-            for (auto c : clients)
-            {
-                c->updateAudioLevel (i, { now, newDB });
-
-                if (overloaded)
-                    c->setOverload (i, true);
-
-                c->setNumChannelsUsed (numChans);
-            }
-        }
-    }
-    else if (mode == LevelMeasurer::RMSMode)
-    {
-        // rms mode
-        for (int i = numChans; --i >= 0;)
-        {
-            auto gain = buffer.getRMSLevel (i, start, numSamples);
-            newLevel[i] = gain;
-            bool overloaded = gain > 0.999f;
-            auto newDB = gainToDb (gain);
-
-            for (auto c : clients)
-            {
-                c->updateAudioLevel (i, { now, newDB });
-
-                if (overloaded)
-                    c->setOverload (i, true);
-
-                c->setNumChannelsUsed (numChans);
-            }
-        }
-    }
-    else
-    {
-        // sum + diff
-        float sum, diff;
-        getSumAndDiff (buffer, sum, diff, start, numSamples);
-        newLevel[0] = sum;
-        newLevel[1] = diff;
-
-        auto sumDB  = gainToDb (sum);
-        auto diffDB = gainToDb (diff);
-
-        for (auto c : clients)
-        {
-            c->updateAudioLevel (0, { now, sumDB });
-            c->updateAudioLevel (1, { now, diffDB });
-
-            if (sum  > 0.999f) c->setOverload (0, true);
-            if (diff > 0.999f) c->setOverload (1, true);
-
-            c->setNumChannelsUsed (2);
-        }
+        case peakMode:
+            for (int i = numChans; --i >= 0;)
+                newLevel[i] = buffer.getMagnitude (i, start, numSamples);
+
+            pushAudioLevels (newLevel, numChans, false);
+            break;
+
+        case RMSMode:
+            for (int i = numChans; --i >= 0;)
+                newLevel[i] = getRMSLevel (buffer.getReadPointer (i, start), numSamples);
+
+            pushAudioLevels (newLevel, numChans, false);
+            break;
+
+        case truePeakMode:
+            loudness->update();
+
+            for (int i = numChans; --i >= 0;)
+                newLevel[i] = loudness->processTruePeak (i, buffer.getReadPointer (i, start), numSamples);
+
+            pushAudioLevels (newLevel, numChans, false);
+            break;
+
+        case LUFSMode:
+            loudness->update();
+            loudness->processLoudness (buffer, start, numSamples, numChans);
+            newLevel[0] = loudness->getMomentaryLoudness();
+            newLevel[1] = loudness->getShortTermLoudness();
+            pushAudioLevels (newLevel, 2, true);
+            break;
+
+        case sumDiffMode:
+        default:
+            getSumAndDiff (buffer, newLevel[0], newLevel[1], start, numSamples);
+            pushAudioLevels (newLevel, 2, false);
+            break;
     }
 }
 
 void LevelMeasurer::processMidi (MidiMessageArray& midiBuffer, const float*)
 {
-    const ScopedLock sl (clientsMutex);
-
-    if (clients.isEmpty() || ! showMidi)
+    if (! showMidi)
         return;
 
     float max = 0.0f;
@@ -215,23 +463,16 @@ void LevelMeasurer::processMidi (MidiMessageArray& midiBuffer, const float*)
         if (m.isNoteOn())
             max = jmax (max, m.getFloatVelocity());
 
-    auto now = Time::getApproximateMillisecondCounter();
-
-    for (auto c : clients)
-        c->updateMidiLevel ({ now, gainToDb (max) });
+    processMidiLevel (max);
 }
 
 void LevelMeasurer::processMidiLevel (float level)
 {
-    const ScopedLock sl (clientsMutex);
-
-    if (clients.isEmpty() || ! showMidi)
+    if (! showMidi || numClients.load (std::memory_order_relaxed) == 0)
         return;
 
-    auto now = Time::getApproximateMillisecondCounter();
-
-    for (auto c : clients)
-        c->updateMidiLevel ({ now, gainToDb (level) });
+    const float dB = gainToDb (level);
+    midiHistory.push (Time::getApproximateMillisecondCounter(), &dB, 1);
 }
 
 void LevelMeasurer::clearOverload()
@@ -239,7 +480,7 @@ void LevelMeasurer::clearOverload()
     const ScopedLock sl (clientsMutex);
 
     for (auto c : clients)
-        c->setClearOverload (true);
+        c->clearOverload = true;
 }
 
 void LevelMeasurer::clear()
@@ -249,27 +490,44 @@ void LevelMeasurer::clear()
     for (auto c : clients)
         c->reset();
 
+    loudness->needsReset = true;
     levelCache = -100.0f;
     numActiveChannels = 1;
 }
 
+void LevelMeasurer::setSampleRate (double newSampleRate)
+{
+    if (newSampleRate > 0.0)
+        loudness->requestedSampleRate = newSampleRate;
+}
+
 void LevelMeasurer::setMode (LevelMeasurer::Mode m)
 {
     clear();
     mode = m;
 }
 
+float LevelMeasurer::getIntegratedLoudness() const
+{
+    return loudness->getIntegratedLoudness();
+}
+
 void LevelMeasurer::addClient (Client& c)
 {
     const ScopedLock sl (clientsMutex);
     jassert (! clients.contains (&c));
     clients.add (&c);
+    numClients = clients.size();
+    c.measurer = this;
+    c.reset();
 }
 
 void LevelMeasurer::removeClient (Client& c)
 {
     const ScopedLock sl (clientsMutex);
     clients.removeFirstMatchingValue (&c);
+    numClients = clients.size();
+    c.measurer = nullptr;
 }
 
 void LevelMeasurer::setShowMidi (bool show)
@@ -320,7 +578,10 @@ void LevelMeasuringAudioNode::prepareAudioNodeToPlay (const PlaybackInitialisati
     input->prepareAudioNodeToPlay (info);
 
     if (levelMeasurer != nullptr)
+    {
         levelMeasurer->setSize (2, info.blockSizeSamples);
+        levelMeasurer->setSampleRate (info.sampleRate);
+    }
 }
 
 void LevelMeasuringAudioNode::prepareForNextBlock (const AudioRenderContext& rc)
@@ -344,4 +605,78 @@ void LevelMeasuringAudioNode::renderAdding (const AudioRenderContext& rc)
     callRenderOver (rc);
 }
 
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class LevelMeasurerTests  : public juce::UnitTest
+{
+public:
+    LevelMeasurerTests()
+        : juce::UnitTest ("LevelMeasurer", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        const double sampleRate = 48000.0;
+
+        beginTest ("True-peak");
+        {
+            // A quarter sample rate sine with all its samples 45 degrees away from the peaks
+            auto buffer = createSine (sampleRate, sampleRate / 4.0, 0.5f, MathConstants<double>::pi / 4.0, 4800);
+            auto samplePeak = gainToDb (buffer.getMagnitude (0, 0, buffer.getNumSamples()));
+
+            LevelMeasurer measurer;
+            LevelMeasurer::Client client;
+            measurer.addClient (client);
+            measurer.setSampleRate (sampleRate);
+            measurer.setMode (LevelMeasurer::truePeakMode);
+
+            // Ignore the start so the filter's response to the onset isn't measured
+            measurer.processBuffer (buffer, 0, 480);
+            client.reset();
+            measurer.processBuffer (buffer, 480, buffer.getNumSamples() - 480);
+
+            expectWithinAbsoluteError (samplePeak, gainToDb (0.5f) - 3.01f, 0.1f);
+            expectWithinAbsoluteError (client.getAndClearAudioLevel (0).dB, gainToDb (0.5f), 0.5f);
+
+            measurer.removeClient (client);
+        }
+
+        beginTest ("LUFS");
+        {
+            // A 997Hz sine at -20dBFS in one channel should read -23 LUFS
+            auto buffer = createSine (sampleRate, 997.0, 0.1f, 0.0, (int) sampleRate * 3);
+
+            LevelMeasurer measurer;
+            LevelMeasurer::Client client;
+            measurer.addClient (client);
+            measurer.setSampleRate (sampleRate);
+            measurer.setMode (LevelMeasurer::LUFSMode);
+
+            for (int i = 0; i < buffer.getNumSamples(); i += 512)
+                measurer.processBuffer (buffer, i, jmin (512, buffer.getNumSamples() - i));
+
+            expectWithinAbsoluteError (client.getAndClearAudioLevel (0).dB, -23.01f, 0.1f);
+            expectWithinAbsoluteError (client.getAndClearAudioLevel (1).dB, -23.01f, 0.1f);
+            expectWithinAbsoluteError (measurer.getIntegratedLoudness(), -23.01f, 0.1f);
+
+            measurer.removeClient (client);
+        }
+    }
+
+    static AudioBuffer<float> createSine (double sampleRate, double frequency, float gain, double phase, int numSamples)
+    {
+        AudioBuffer<float> buffer (1, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample (0, i, gain * (float) std::sin (phase + MathConstants<double>::twoPi * frequency * i / sampleRate));
+
+        return buffer;
+    }
+};
+
+static LevelMeasurerTests levelMeasurerTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
 }
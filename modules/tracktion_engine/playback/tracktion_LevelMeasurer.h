@@ -21,6 +21,10 @@ struct DbTimePair
 /**
     Monitors the levels of buffers that are passed in, and keeps peak values,
     overloads, etc., for display in a level meter component.
+
+    The audio thread writes the levels for each block into a short history held
+    by the measurer without taking any locks. Each Client keeps its own position
+    in that history and polls it for the maximum level since it last looked.
 */
 class LevelMeasurer
 {
@@ -37,12 +41,19 @@ public:
     void clear();
     void clearOverload();
 
+    /** Sets the sample rate of the buffers being measured.
+        This is needed by the true-peak and LUFS modes.
+    */
+    void setSampleRate (double);
+
     //==============================================================================
     enum Mode
     {
         peakMode     = 0,
         RMSMode      = 1,
-        sumDiffMode  = 2
+        sumDiffMode  = 2,
+        truePeakMode = 3,   /**< The 4x oversampled peak level of each channel as described in ITU-R BS.1770. */
+        LUFSMode     = 4    /**< EBU R128 loudness, with the momentary level in channel 0 and short-term in channel 1. */
     };
 
     void setMode (Mode);
@@ -52,6 +63,11 @@ public:
 
     int getNumActiveChannels() const noexcept           { return numActiveChannels; }
 
+    /** Returns the gated integrated loudness in LUFS since the measurer was last
+        cleared, or -100 if nothing has been measured. This is only measured in LUFSMode.
+    */
+    float getIntegratedLoudness() const;
+
     //==============================================================================
     struct Client
     {
@@ -64,22 +80,13 @@ public:
 
         static constexpr auto maxNumChannels = 8;
 
-        /** @internal */
-        void setNumChannelsUsed (int) noexcept;
-        void setOverload (int channel, bool hasOverloaded) noexcept;
-        void setClearOverload (bool) noexcept;
-
-        void updateAudioLevel (int channel, DbTimePair) noexcept;
-        void updateMidiLevel (DbTimePair) noexcept;
-
     private:
-        DbTimePair audioLevels[maxNumChannels];
-        bool overload[maxNumChannels];
-        DbTimePair midiLevels;
-        int numChannelsUsed = 0;
-        bool clearOverload = true;
+        friend class LevelMeasurer;
 
-        juce::SpinLock mutex;
+        LevelMeasurer* measurer = nullptr;
+        juce::uint64 audioReadPositions[maxNumChannels] = {};
+        juce::uint64 midiReadPosition = 0;
+        std::atomic<bool> clearOverload { true };
     };
 
     //==============================================================================
@@ -90,13 +97,40 @@ public:
     float getLevelCache() const noexcept                { return levelCache; }
 
 private:
-    Mode mode = peakMode;
-    int numActiveChannels = 1;
-    bool showMidi = false;
-    float levelCache = -100.0f;
+    //==============================================================================
+    /** The levels of the most recent blocks, written by the audio thread and read by clients. */
+    struct LevelHistory
+    {
+        static constexpr int numBlocks = 256;
+
+        struct Block
+        {
+            std::atomic<juce::uint32> time { 0 };
+            std::atomic<float> dB[Client::maxNumChannels];
+        };
+
+        Block blocks[numBlocks];
+        std::atomic<juce::uint64> numBlocksWritten { 0 };
+
+        void push (juce::uint32 time, const float* dB, int numChannels) noexcept;
+        DbTimePair getMaxSince (juce::uint64& readPosition, int channel) const noexcept;
+    };
+
+    struct Loudness;
+
+    std::atomic<Mode> mode { peakMode };
+    std::atomic<int> numActiveChannels { 1 };
+    std::atomic<bool> showMidi { false };
+    std::atomic<float> levelCache { -100.0f };
+
+    LevelHistory audioHistory, midiHistory;
+    std::unique_ptr<Loudness> loudness;
 
     juce::Array<Client*> clients;
     juce::CriticalSection clientsMutex;
+    std::atomic<int> numClients { 0 };
+
+    void pushAudioLevels (const float* gains, int numChannels, bool levelsAreInDecibels) noexcept;
 
     JUCE_DECLARE_WEAK_REFERENCEABLE(LevelMeasurer)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeasurer)
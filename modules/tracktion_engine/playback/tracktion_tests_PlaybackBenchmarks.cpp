@@ -0,0 +1,339 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+#if TRACKTION_UNIT_TESTS
+
+//==============================================================================
+//==============================================================================
+/**
+    Generates Edits resembling real sessions and measures how long it takes to build
+    their playback graph, play them through the audio callback and render them offline.
+    Each result is logged as a single line of JSON so they can be collected and compared
+    between runs. These are in their own category so aren't run with the other tests.
+*/
+class EditPlaybackBenchmarks    : public juce::UnitTest
+{
+public:
+    EditPlaybackBenchmarks()
+        : juce::UnitTest ("EditPlaybackBenchmarks", "Tracktion:Benchmarks") {}
+
+    //==============================================================================
+    /** Describes an Edit to generate. The same options will always generate the same Edit. */
+    struct SessionOptions
+    {
+        juce::String name;
+        int numAudioTracks = 8;
+        int numMidiTracks = 2;
+        int numRackTracks = 1;      /**< The number of tracks to add a rack of effects to. */
+        int numAuxBusses = 1;       /**< Every track sends to one of these, each with a return track. */
+        bool automate = true;       /**< Adds volume and pan automation to every track. */
+        double lengthSeconds = 16.0;
+        juce::int64 seed = 1;
+    };
+
+    //==============================================================================
+    void runTest() override
+    {
+        HostedAudioDeviceInterface::Parameters params;
+        params.sampleRate = 44100.0;
+        params.blockSize = 256;
+        params.inputChannels = 2;
+        params.fixedBlockSize = true;
+
+        auto& engine = *Engine::getEngines()[0];
+        auto& audioIO = engine.getDeviceManager().getHostedAudioDeviceInterface();
+        audioIO.initialise (params);
+        audioIO.prepareToPlay (params.sampleRate, params.blockSize);
+
+        auto sourceFile = createSourceFile (params.sampleRate);
+
+        for (auto options : getSessionOptions())
+        {
+            beginTest (options.name);
+            runBenchmark (engine, options, sourceFile->getFile(), params);
+        }
+
+        auto& deviceManager = engine.getDeviceManager();
+        deviceManager.closeDevices();
+        deviceManager.removeHostedAudioDeviceInterface();
+        deviceManager.deviceManager.closeAudioDevice();
+    }
+
+private:
+    //==============================================================================
+    static std::vector<SessionOptions> getSessionOptions()
+    {
+        return { { "small",  8,  2,  1,  1 },
+                 { "medium", 32, 8,  4,  2 },
+                 { "large",  64, 16, 16, 4 } };
+    }
+
+    void runBenchmark (Engine& engine, const SessionOptions& options, const File& sourceFile,
+                       const HostedAudioDeviceInterface::Parameters& params)
+    {
+        const int numBlocks = 2000;
+        constexpr int numWarmUpBlocks = 16;
+
+        auto edit = createSession (engine, options, sourceFile);
+        auto& transport = edit->getTransport();
+        transport.setLoopRange ({ 0.0, options.lengthSeconds });
+        transport.looping = true;
+
+        DynamicObject::Ptr result (new DynamicObject());
+        result->setProperty ("benchmark", options.name);
+        result->setProperty ("numTracks", getAllTracks (*edit).size());
+        result->setProperty ("sampleRate", params.sampleRate);
+        result->setProperty ("blockSize", params.blockSize);
+        result->setProperty ("numBlocks", numBlocks);
+
+        // Graph construction, first from scratch then rebuilt after a clip on one track has
+        // moved, which can reuse the nodes of all the other tracks
+        {
+            transport.freePlaybackContext();
+            transport.ensureContextAllocated();
+            auto context = transport.getCurrentPlaybackContext();
+            expect (context != nullptr);
+
+            if (context == nullptr)
+                return;
+
+            auto firstBuild = context->getLastGraphBuildStats();
+
+            if (auto clip = getAudioTracks (*edit).getFirst()->getClips().getFirst())
+                clip->setStart (clip->getPosition().getStart() + 0.1, false, true);
+
+            context->createPlayAudioNodes (0.0);
+            auto rebuild = context->getLastGraphBuildStats();
+            expect (rebuild.numTracksReused > 0, "No track nodes were reused");
+
+            result->setProperty ("graphBuildMs", firstBuild.getTotalMs());
+            result->setProperty ("graphCreationMs", firstBuild.creationMs);
+            result->setProperty ("graphPreparationMs", firstBuild.preparationMs);
+            result->setProperty ("graphRebuildMs", rebuild.getTotalMs());
+            result->setProperty ("graphRebuildTracksReused", rebuild.numTracksReused);
+            result->setProperty ("graphRebuildTracksCreated", rebuild.numTracksCreated);
+        }
+
+        // Steady state audio callbacks
+        {
+            auto& audioIO = engine.getDeviceManager().getHostedAudioDeviceInterface();
+            AudioBuffer<float> buffer (params.outputChannels, params.blockSize);
+            MidiBuffer midi;
+            std::vector<double> blockTimes ((size_t) numBlocks);
+            int64 totalTicks = 0;
+
+            transport.play (false);
+
+            for (int i = -numWarmUpBlocks; i < numBlocks; ++i)
+            {
+                buffer.clear();
+                midi.clear();
+
+                const auto startTicks = Time::getHighResolutionTicks();
+                audioIO.processBlock (buffer, midi);
+                const auto ticksTaken = Time::getHighResolutionTicks() - startTicks;
+
+                if (i >= 0)
+                {
+                    blockTimes[(size_t) i] = Time::highResolutionTicksToSeconds (ticksTaken) * 1.0e6;
+                    totalTicks += ticksTaken;
+                }
+            }
+
+            expect (transport.isPlaying());
+            transport.stop (false, true);
+
+            std::sort (blockTimes.begin(), blockTimes.end());
+
+            auto getPercentile = [&] (double percentile)
+            {
+                return blockTimes[std::min (blockTimes.size() - 1, (size_t) (percentile * blockTimes.size()))];
+            };
+
+            const double secondsTaken = Time::highResolutionTicksToSeconds (totalTicks);
+            const double secondsProcessed = numBlocks * params.blockSize / params.sampleRate;
+
+            result->setProperty ("blockMicrosecondsP50", getPercentile (0.5));
+            result->setProperty ("blockMicrosecondsP99", getPercentile (0.99));
+            result->setProperty ("blockMicrosecondsMax", blockTimes.back());
+            result->setProperty ("playbackRealTimeFactor", secondsTaken > 0.0 ? secondsProcessed / secondsTaken : 0.0);
+        }
+
+        // Offline rendering of the whole Edit
+        {
+            BigInteger tracksToDo;
+            tracksToDo.setRange (0, getAllTracks (*edit).size(), true);
+
+            const auto startTicks = Time::getHighResolutionTicks();
+            auto stats = Renderer::measureStatistics ("Benchmark", *edit, { 0.0, options.lengthSeconds },
+                                                      tracksToDo, params.blockSize);
+            const double secondsTaken = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+
+            expect (stats.peak > 0.0f, "Rendered Edit is silent");
+            result->setProperty ("renderRealTimeFactor", secondsTaken > 0.0 ? options.lengthSeconds / secondsTaken : 0.0);
+        }
+
+        result->setProperty ("peakMemoryMB", getPeakMemoryMB());
+        logMessage (JSON::toString (var (result.get()), true));
+
+        edit.reset();
+        engine.getAudioFileManager().releaseAllFiles();
+    }
+
+    //==============================================================================
+    static std::unique_ptr<Edit> createSession (Engine& engine, const SessionOptions& options, const File& sourceFile)
+    {
+        Random random (options.seed);
+
+        auto edit = Edit::createSingleTrackEdit (engine);
+        edit->ensureNumberOfAudioTracks (options.numAudioTracks + options.numMidiTracks + options.numAuxBusses);
+        auto tracks = getAudioTracks (*edit);
+
+        const AudioFile sourceAudioFile (engine, sourceFile);
+        const double sourceLength = sourceAudioFile.getLength();
+
+        for (int i = 0; i < options.numAudioTracks; ++i)
+        {
+            auto track = tracks.getUnchecked (i);
+
+            for (double start = random.nextDouble() * 0.5; start < options.lengthSeconds; start += sourceLength)
+                track->insertWaveClip ("Loop", sourceFile, { { start, std::min (start + sourceLength, options.lengthSeconds) } }, false);
+        }
+
+        for (int i = 0; i < options.numMidiTracks; ++i)
+        {
+            auto track = tracks.getUnchecked (options.numAudioTracks + i);
+            track->pluginList.insertPlugin (edit->getPluginCache().createNewPlugin (FourOscPlugin::xmlTypeName, {}), 0, nullptr);
+
+            if (auto clip = track->insertMIDIClip ({ 0.0, options.lengthSeconds }, nullptr))
+            {
+                auto& sequence = clip->getSequence();
+                const double numBeats = edit->tempoSequence.timeToBeats (options.lengthSeconds);
+
+                for (double beat = 0.0; beat < numBeats; beat += 0.5)
+                    for (int note = random.nextInt ({ 1, 4 }); --note >= 0;)
+                        sequence.addNote (36 + random.nextInt (48), beat, 0.25 + random.nextInt (4) * 0.25,
+                                          64 + random.nextInt (64), 0, nullptr);
+            }
+        }
+
+        for (int i = 0; i < options.numRackTracks; ++i)
+        {
+            Plugin::Array plugins;
+            plugins.add (edit->getPluginCache().createNewPlugin (EqualiserPlugin::xmlTypeName, {}));
+            plugins.add (edit->getPluginCache().createNewPlugin (CompressorPlugin::xmlTypeName, {}));
+            plugins.add (edit->getPluginCache().createNewPlugin (DelayPlugin::xmlTypeName, {}));
+
+            if (auto rack = RackType::createTypeToWrapPlugins (plugins, *edit))
+            {
+                auto track = tracks.getUnchecked ((i * 3) % (options.numAudioTracks + options.numMidiTracks));
+                track->pluginList.insertPlugin (RackInstance::create (*rack), track->pluginList.indexOf (track->getVolumePlugin()));
+            }
+        }
+
+        for (int bus = 0; bus < options.numAuxBusses; ++bus)
+        {
+            auto track = tracks.getUnchecked (options.numAudioTracks + options.numMidiTracks + bus);
+            auto reverb = edit->getPluginCache().createNewPlugin (ReverbPlugin::xmlTypeName, {});
+            auto auxReturn = edit->getPluginCache().createNewPlugin (AuxReturnPlugin::xmlTypeName, {});
+            auxReturn->state.setProperty (IDs::busNum, bus, nullptr);
+
+            track->pluginList.insertPlugin (reverb, 0, nullptr);
+            track->pluginList.insertPlugin (auxReturn, 0, nullptr);
+        }
+
+        for (int i = 0; i < options.numAudioTracks + options.numMidiTracks; ++i)
+        {
+            auto track = tracks.getUnchecked (i);
+
+            if (options.numAuxBusses > 0)
+            {
+                auto auxSend = edit->getPluginCache().createNewPlugin (AuxSendPlugin::xmlTypeName, {});
+                auxSend->state.setProperty (IDs::busNum, i % options.numAuxBusses, nullptr);
+                track->pluginList.insertPlugin (auxSend, track->pluginList.indexOf (track->getVolumePlugin()), nullptr);
+            }
+
+            if (options.automate)
+            {
+                if (auto volume = track->getVolumePlugin())
+                {
+                    for (double time = 0.0; time < options.lengthSeconds; time += 0.5)
+                    {
+                        volume->volParam->getCurve().addPoint (time, decibelsToVolumeFaderPosition (-12.0f + random.nextFloat() * 12.0f), 0.0f);
+                        volume->panParam->getCurve().addPoint (time, random.nextFloat() * 2.0f - 1.0f, 0.0f);
+                    }
+                }
+            }
+        }
+
+        return edit;
+    }
+
+    /** Creates a few seconds of a stereo chord to use for the audio clips. */
+    static std::unique_ptr<TemporaryFile> createSourceFile (double sampleRate)
+    {
+        AudioBuffer<float> buffer (2, (int) sampleRate * 4);
+
+        for (int c = 0; c < buffer.getNumChannels(); ++c)
+        {
+            auto samples = buffer.getWritePointer (c);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                const double time = i / sampleRate;
+                samples[i] = (float) (0.2 * std::sin (MathConstants<double>::twoPi * 220.0 * time)
+                                       + 0.15 * std::sin (MathConstants<double>::twoPi * (277.18 + c) * time)
+                                       + 0.1 * std::sin (MathConstants<double>::twoPi * 329.63 * time));
+            }
+        }
+
+        WavAudioFormat format;
+        auto f = std::make_unique<TemporaryFile> (format.getFileExtensions()[0]);
+
+        if (auto fileStream = f->getFile().createOutputStream())
+        {
+            if (auto writer = std::unique_ptr<AudioFormatWriter> (format.createWriterFor (fileStream.get(), sampleRate, 2, 24, {}, 0)))
+            {
+                fileStream.release();
+                writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+            }
+        }
+
+        return f;
+    }
+
+    /** Returns the largest the process's resident memory has been, or -1 if this isn't available. */
+    static double getPeakMemoryMB()
+    {
+       #if JUCE_LINUX || JUCE_MAC
+        struct rusage usage;
+
+        if (getrusage (RUSAGE_SELF, &usage) == 0)
+        {
+           #if JUCE_MAC
+            return usage.ru_maxrss / (1024.0 * 1024.0);     // bytes on macOS
+           #else
+            return usage.ru_maxrss / 1024.0;                // kilobytes on Linux
+           #endif
+        }
+       #endif
+
+        return -1.0;
+    }
+};
+
+static EditPlaybackBenchmarks editPlaybackBenchmarks;
+
+#endif // TRACKTION_UNIT_TESTS
+
+}
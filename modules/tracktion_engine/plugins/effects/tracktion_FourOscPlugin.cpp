@@ -282,8 +282,16 @@ class FourOscVoice : public MPESynthesiserVoice
 public:
     FourOscVoice (FourOscPlugin& s) : synth (s)
     {
-        for (auto p : synth.getAutomatableParameters())
-            smoothers[p] = {};
+        smoothers.resize ((size_t) synth.getNumParamIndexes());
+        setMaximumBlockSize (synth.getMaximumBlockSize());
+    }
+
+    void setMaximumBlockSize (int numSamples)
+    {
+        renderBuffer.setSize (2, numSamples, false, false, true);
+
+        for (auto& o : oscillators)
+            o.setMaximumBlockSize (numSamples);
     }
 
     void noteStarted() override
@@ -386,8 +394,8 @@ public:
             activeNote.reset (newRate, paramValue (synth.legato) / 1000.0f);
             filterFrequencySmoother.reset (newRate, 0.05f);
 
-            for (auto& itr : smoothers)
-                itr.second.reset (newRate, 0.01f);
+            for (auto& sm : smoothers)
+                sm.reset (newRate, 0.01f);
         }
     }
 
@@ -412,7 +420,7 @@ public:
         if (numSamples > renderBuffer.getNumSamples())
             renderBuffer.setSize (2, numSamples, false, false, true);
 
-        renderBuffer.clear();
+        renderBuffer.clear (0, numSamples);
 
         // Run oscillators
         for (auto& o : oscillators)
@@ -421,7 +429,7 @@ public:
         // Apply velocity
         float velocityGain = velocityToGain (currentlyPlayingNote.noteOnVelocity.asUnsignedFloat(), paramValue (synth.ampVelocity) / 100.0f);
         velocityGain = jlimit (0.0f, 1.0f, velocityGain);
-        renderBuffer.applyGain (velocityGain);
+        renderBuffer.applyGain (0, numSamples, velocityGain);
 
         // Apply filter
         if (synth.filterTypeValue != 0)
@@ -469,8 +477,8 @@ public:
             }
         }
 
-        for (auto& itr : smoothers)
-            itr.second.process (numSamples);
+        for (auto& sm : smoothers)
+            sm.process (numSamples);
     }
 
     void applyEnvelopeToBuffer (ADSR& adsr, AudioSampleBuffer& buffer, int startSample, int numSamples)
@@ -683,31 +691,35 @@ public:
     void noteKeyStateChanged() override     {}
 
 private:
-    float paramValue (AutomatableParameter::Ptr param)
+    float paramValue (const AutomatableParameter::Ptr& param)
     {
         jassert (param != nullptr);
         if (param == nullptr)
             return 0.0f;
 
-        auto smoothItr = smoothers.find (param.get());
-        if (smoothItr == smoothers.end())
+        const auto paramIndex = FourOscPlugin::getParamIndex (*param);
+
+        if (paramIndex < 0)
             return param->getCurrentValue();
 
-        auto modItr = synth.modMatrix.find (param.get());
-        if (modItr == synth.modMatrix.end() || ! modItr->second.isModulated())
+        auto index = (size_t) paramIndex;
+        auto& smoother = smoothers[index];
+        auto modAssign = synth.modAssigns[index];
+
+        if (modAssign == nullptr || ! modAssign->isModulated())
         {
-            smoothItr->second.setValue (param->getCurrentNormalisedValue());
+            smoother.setValue (param->getCurrentNormalisedValue());
 
             if (snapAllValues)
-                smoothItr->second.snapToValue();
+                smoother.snapToValue();
 
-            return param->valueRange.convertFrom0to1 (smoothItr->second.getCurrentValue());
+            return param->valueRange.convertFrom0to1 (smoother.getCurrentValue());
         }
         else
         {
             float val = param->getCurrentNormalisedValue();
 
-            auto& mod = modItr->second;
+            auto& mod = *modAssign;
 
             for (int i = mod.firstModIndex; i < numElementsInArray (mod.depths) && i <= mod.lastModIndex; i++)
             {
@@ -718,12 +730,12 @@ private:
 
             val = jlimit (0.0f, 1.0f, val);
 
-            smoothItr->second.setValue (val);
+            smoother.setValue (val);
 
             if (snapAllValues)
-                smoothItr->second.snapToValue();
+                smoother.snapToValue();
 
-            return param->valueRange.convertFrom0to1 (smoothItr->second.getCurrentValue());
+            return param->valueRange.convertFrom0to1 (smoother.getCurrentValue());
         }
     }
 
@@ -744,7 +756,7 @@ private:
 
     float currentModValue[FourOscPlugin::numModSources] = {0};
 
-    std::map<AutomatableParameter*, ValueSmoother<float>> smoothers;
+    std::vector<ValueSmoother<float>> smoothers;
 };
 
 //==============================================================================
@@ -1038,8 +1050,20 @@ FourOscPlugin::FourOscPlugin (PluginCreationInfo info)  : Plugin (info)
     for (auto e : modEnvParams)
         e->attach();
 
+    // Lay the mod assignments out by parameter index so the voices can find them
+    // without walking a map for each value
+    modAssigns.resize ((size_t) getNumAutomatableParameters(), nullptr);
+
     for (auto p : getAutomatableParameters())
-        smoothers[p] = {};
+    {
+        auto itr = modMatrix.find (p);
+        const auto index = getParamIndex (*p);
+
+        if (itr != modMatrix.end() && index >= 0)
+            modAssigns[(size_t) index] = &itr->second;
+    }
+
+    smoothers.resize (modAssigns.size());
 
     // Setup text functions
     setupTextFunctions();
@@ -1112,7 +1136,8 @@ const char* FourOscPlugin::xmlTypeName = "4osc";
 
 AutomatableParameter* FourOscPlugin::addParam (const juce::String& paramID, const juce::String& name, juce::NormalisableRange<float> valueRange, juce::String label)
 {
-    auto p = Plugin::addParam (paramID, name, valueRange);
+    auto p = new IndexedParameter (paramID, name, *this, valueRange, getNumAutomatableParameters());
+    addAutomatableParameter (*p);
 
     if (label.isNotEmpty())
         labels[paramID] = label;
@@ -1414,16 +1439,26 @@ void FourOscPlugin::initialise (const PlaybackInitialisationInfo& info)
 {
     setCurrentPlaybackSampleRate (info.sampleRate);
 
+    levelMeasurer.setSampleRate (info.sampleRate);
     reverb.setSampleRate (info.sampleRate);
     delay->setSampleRate (info.sampleRate);
     chorus->setSampleRate (info.sampleRate);
 
+    {
+        juce::ScopedLock sl (voicesLock);
+        maxBlockSize = info.blockSizeSamples;
+
+        for (auto v : voices)
+            if (auto fov = dynamic_cast<FourOscVoice*> (v))
+                fov->setMaximumBlockSize (maxBlockSize);
+    }
+
     reverb.reset();
     delay->reset();
     chorus->reset();
 
-    for (auto& itr : smoothers)
-        itr.second.reset (info.sampleRate, 0.01f);
+    for (auto& sm : smoothers)
+        sm.reset (info.sampleRate, 0.01f);
 }
 
 void FourOscPlugin::deinitialise()
@@ -1505,8 +1540,8 @@ void FourOscPlugin::applyToBuffer (AudioSampleBuffer& buffer, MidiBuffer& midi)
     renderNextBlock (buffer, midi, 0, buffer.getNumSamples());
     applyEffects (buffer);
 
-    for (auto& itr : smoothers)
-        itr.second.process (buffer.getNumSamples());
+    for (auto& sm : smoothers)
+        sm.process (buffer.getNumSamples());
 }
 
 void FourOscPlugin::applyEffects (AudioSampleBuffer& buffer)
@@ -1765,19 +1800,20 @@ void FourOscPlugin::clearModulation (ModSource src, AutomatableParameter::Ptr pa
     jassertfalse;
 }
 
-float FourOscPlugin::paramValue (AutomatableParameter::Ptr param)
+float FourOscPlugin::paramValue (const AutomatableParameter::Ptr& param)
 {
     jassert (param != nullptr);
     if (param == nullptr)
         return 0.0f;
 
-    auto smoothItr = smoothers.find (param.get());
-    if (smoothItr == smoothers.end())
+    const auto index = getParamIndex (*param);
+
+    if (index < 0)
         return param->getCurrentValue();
 
-    float val = param->getCurrentNormalisedValue();
-    smoothItr->second.setValue (val);
-    return param->valueRange.convertFrom0to1 (smoothItr->second.getCurrentValue());
+    auto& smoother = smoothers[(size_t) index];
+    smoother.setValue (param->getCurrentNormalisedValue());
+    return param->valueRange.convertFrom0to1 (smoother.getCurrentValue());
 }
 
 }
@@ -198,6 +198,7 @@ public:
     void restorePluginStateFromValueTree (const juce::ValueTree&) override;
 
     float getCurrentTempo()                             { return currentTempo; }
+    int getMaximumBlockSize() const                     { return maxBlockSize; }
 
 private:
     std::unordered_map<juce::String, juce::String> labels;
@@ -367,6 +368,37 @@ public:
     std::unordered_map<AutomatableParameter*, ModAssign> modMatrix;
     float controllerValues[128] = {0};
 
+    /** All of this plugin's parameters are created as one of these so they know
+        their slot in the flat smoother and modulation arrays.
+    */
+    struct IndexedParameter  : public AutomatableParameter
+    {
+        IndexedParameter (const juce::String& paramID, const juce::String& name, FourOscPlugin& owner,
+                          juce::NormalisableRange<float> valueRange, int index)
+            : AutomatableParameter (paramID, name, owner, valueRange), paramIndex (index)
+        {
+        }
+
+        const int paramIndex;
+    };
+
+    /** Returns the slot used to index the flat smoother and modulation arrays for one of
+        this plugin's parameters, or -1 if it isn't an IndexedParameter.
+    */
+    static int getParamIndex (const AutomatableParameter& param) noexcept
+    {
+        if (auto indexed = dynamic_cast<const IndexedParameter*> (&param))
+            return indexed->paramIndex;
+
+        jassertfalse;
+        return -1;
+    }
+
+    int getNumParamIndexes() const                      { return (int) modAssigns.size(); }
+
+    /** The mod matrix entries laid out by parameter index, nullptr for unmodulatable params. */
+    std::vector<ModAssign*> modAssigns;
+
     float getLevel (int channel);
 
 private:
@@ -387,16 +419,17 @@ private:
     void applyToBuffer (juce::AudioSampleBuffer& buffer, juce::MidiBuffer& midi);
     void updateParams (juce::AudioSampleBuffer& buffer);
     void applyEffects (juce::AudioSampleBuffer& buffer);
-    float paramValue (AutomatableParameter::Ptr param);
+    float paramValue (const AutomatableParameter::Ptr& param);
 
     TempoSequencePosition currentPos {edit.tempoSequence};
     juce::Reverb reverb;
     std::unique_ptr<FODelay> delay;
     std::unique_ptr<FOChorus> chorus;
-    std::unordered_map<AutomatableParameter*, ValueSmoother<float>> smoothers;
+    std::vector<ValueSmoother<float>> smoothers;
 
     bool flushingState = false;
     float currentTempo = 0.0f;
+    int maxBlockSize = 512;
     LevelMeasurer levelMeasurer;
     DbTimePair levels[2];
 
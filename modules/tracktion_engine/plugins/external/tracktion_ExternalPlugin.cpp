@@ -473,7 +473,10 @@ ExternalPlugin::ExternalPlugin (PluginCreationInfo info)  : Plugin (info)
     desc.manufacturerName = state[IDs::manufacturer];
     identiferString = desc.createIdentifierString();
 
-    initialiseFully();
+    // When an Edit is loading its plugins in parallel it'll initialise us
+    // asynchronously once it has been created
+    if (! edit.shouldDeferPluginInstantiation())
+        initialiseFully();
 }
 
 ValueTree ExternalPlugin::create (Engine& e, const PluginDescription& desc)
@@ -500,12 +503,94 @@ void ExternalPlugin::initialiseFully()
     {
         CRASH_TRACER_PLUGIN (getDebugName());
         fullyInitialised = true;
+        initialisationDeferred = false;
 
+        const StopwatchTimer timer;
         doFullInitialisation();
-        restorePluginStateFromValueTree (state);
-        buildParameterList();
-        restoreChannelLayout (*this);
+        restoreStateAfterInstantiation();
+
+        if (edit.isLoading())
+            edit.reportPluginLoadTime (*this, timer.getSeconds(), false);
+    }
+}
+
+void ExternalPlugin::initialisePluginsConcurrently (const juce::Array<ExternalPlugin*>& plugins)
+{
+    CRASH_TRACER
+
+    for (auto p : plugins)
+        if (p != nullptr)
+            p->initialiseAsync();
+}
+
+void ExternalPlugin::initialiseAsync()
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    if (fullyInitialised)
+        return;
+
+    CRASH_TRACER_PLUGIN (getDebugName());
+    fullyInitialised = true;
+    initialisationDeferred = false;
+
+    auto description = findDescriptionToInstantiate();
+
+    if (description == nullptr)
+    {
+        restoreStateAfterInstantiation();
+        return;
+    }
+
+    auto& pm = engine.getPluginManager();
+    auto& dm = engine.getDeviceManager();
+
+    auto callback = [ref = Plugin::WeakRef (this)] (std::unique_ptr<AudioPluginInstance> instance, const String& error)
+    {
+        if (auto ep = dynamic_cast<ExternalPlugin*> (ref.get()))
+            ep->asyncInstanceCreated (std::move (instance), error);
+    };
+
+    if (engine.getEngineBehaviour().canCreatePluginInstanceOffMessageThread (*description))
+        pm.createPluginInstanceInBackground (*description, dm.getSampleRate(), dm.getBlockSize(), std::move (callback));
+    else
+        pm.createPluginInstanceAsync (*description, dm.getSampleRate(), dm.getBlockSize(), std::move (callback));
+}
+
+void ExternalPlugin::asyncInstanceCreated (std::unique_ptr<AudioPluginInstance> instance, const String& error)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    CRASH_TRACER_PLUGIN (getDebugName());
+
+    // A forced reinitialise may have created a new instance in the meantime
+    if (pluginInstance != nullptr)
+        return;
+
+    {
+        const ScopedLock sl (lock);
+        setPluginInstance (std::move (instance));
     }
+
+    pluginInstanceCreated (error);
+    restoreStateAfterInstantiation();
+
+    if (pluginInstance != nullptr)
+        edit.restartPlaybackForChange (state);
+}
+
+bool ExternalPlugin::isOnInaudibleTrack() const
+{
+    if (auto t = getOwnerTrack())
+        return (t->isMuted (true) && ! t->processAudioNodesWhileMuted()) || t->isFrozen (Track::anyFreeze);
+
+    return false;
+}
+
+void ExternalPlugin::restoreStateAfterInstantiation()
+{
+    restorePluginStateFromValueTree (state);
+    buildParameterList();
+    restoreChannelLayout (*this);
 }
 
 void ExternalPlugin::forceFullReinitialise()
@@ -727,6 +812,23 @@ void ExternalPlugin::processingChanged()
 }
 
 void ExternalPlugin::doFullInitialisation()
+{
+    if (auto foundDesc = findDescriptionToInstantiate())
+    {
+        CRASH_TRACER_PLUGIN (getDebugName());
+        String error;
+
+        callBlocking ([this, &error, &foundDesc]
+        {
+            CRASH_TRACER_PLUGIN (getDebugName());
+            error = createPluginInstance (*foundDesc);
+        });
+
+        pluginInstanceCreated (error);
+    }
+}
+
+std::unique_ptr<PluginDescription> ExternalPlugin::findDescriptionToInstantiate()
 {
     if (auto foundDesc = findMatchingPlugin())
     {
@@ -734,37 +836,30 @@ void ExternalPlugin::doFullInitialisation()
         identiferString = desc.createIdentifierString();
         updateDebugName();
 
-        if (processing && pluginInstance == nullptr && edit.shouldLoadPlugins())
-        {
-            if (isDisabled())
-                return;
-
-            CRASH_TRACER_PLUGIN (getDebugName());
-            String error;
+        if (processing && pluginInstance == nullptr && edit.shouldLoadPlugins() && ! isDisabled())
+            return foundDesc;
+    }
 
-            callBlocking ([this, &error, &foundDesc]
-            {
-                CRASH_TRACER_PLUGIN (getDebugName());
-                error = createPluginInstance (*foundDesc);
-            });
+    return {};
+}
 
-            if (pluginInstance != nullptr)
-            {
-               #if JUCE_PLUGINHOST_VST
-                if (auto xml = juce::VSTPluginFormat::getVSTXML (pluginInstance.get()))
-                    vstXML.reset (VSTXML::createFor (*xml));
+void ExternalPlugin::pluginInstanceCreated (const String& error)
+{
+    if (pluginInstance != nullptr)
+    {
+       #if JUCE_PLUGINHOST_VST
+        if (auto xml = juce::VSTPluginFormat::getVSTXML (pluginInstance.get()))
+            vstXML.reset (VSTXML::createFor (*xml));
 
-                juce::VSTPluginFormat::setExtraFunctions (pluginInstance.get(), new ExtraVSTCallbacks (edit));
-               #endif
+        juce::VSTPluginFormat::setExtraFunctions (pluginInstance.get(), new ExtraVSTCallbacks (edit));
+       #endif
 
-                pluginInstance->setPlayHead (playhead.get());
-                supportsMPE = pluginInstance->supportsMPE();
-            }
-            else
-            {
-                TRACKTION_LOG_ERROR (error);
-            }
-        }
+        pluginInstance->setPlayHead (playhead.get());
+        supportsMPE = pluginInstance->supportsMPE();
+    }
+    else
+    {
+        TRACKTION_LOG_ERROR (error);
     }
 }
 
@@ -1040,6 +1135,10 @@ void ExternalPlugin::initialise (const PlaybackInitialisationInfo& info)
         pluginInstance->setPlayHead (nullptr);
         playhead = std::make_unique<PluginPlayHead> (*this);
         pluginInstance->setPlayHead (playhead.get());
+
+        numInputChannelsToProcess = pluginInstance->getTotalNumInputChannels();
+        numChannelsToProcess = jmax (1, numInputChannelsToProcess, pluginInstance->getTotalNumOutputChannels());
+        remappedChannels.calloc ((size_t) numChannelsToProcess);
     }
     else
     {
@@ -1050,6 +1149,13 @@ void ExternalPlugin::initialise (const PlaybackInitialisationInfo& info)
     }
 }
 
+void ExternalPlugin::initialiseWithoutStopping (const PlaybackInitialisationInfo& info)
+{
+    // An instance that was created asynchronously may not have been prepared yet
+    if (pluginInstance != nullptr && ! isInstancePrepared)
+        initialise (info);
+}
+
 void ExternalPlugin::deinitialise()
 {
     if (pluginInstance != nullptr)
@@ -1181,11 +1287,11 @@ void ExternalPlugin::prepareIncomingMidiMessages (MidiMessageArray& incoming, in
 
 void ExternalPlugin::applyToBuffer (const AudioRenderContext& fc)
 {
-    if (pluginInstance != nullptr && isEnabled())
+    // An instance created asynchronously isn't prepared until the graph is rebuilt
+    if (pluginInstance != nullptr && isInstancePrepared && isEnabled())
     {
         CRASH_TRACER_PLUGIN (getDebugName());
         const ScopedLock sl (lock);
-        jassert (isInstancePrepared);
 
         if (playhead != nullptr)
             playhead->setCurrentContext (&fc);
@@ -1200,57 +1306,10 @@ void ExternalPlugin::applyToBuffer (const AudioRenderContext& fc)
             auto destNumChans = fc.destBuffer->getNumChannels();
             jassert (destNumChans > 0);
 
-            auto numInputChannels = pluginInstance->getTotalNumInputChannels();
-            auto numOutputChannels = pluginInstance->getTotalNumOutputChannels();
-            auto numChansToProcess = jmax (1, numInputChannels, numOutputChannels);
-
-            if (destNumChans == numChansToProcess)
-            {
+            if (destNumChans == numChannelsToProcess)
                 processPluginBlock (fc);
-            }
             else
-            {
-                AudioScratchBuffer asb (numChansToProcess, fc.bufferNumSamples);
-                auto& buffer = asb.buffer;
-
-                // Copy or existing channel or clear data
-                for (int i = 0; i < numChansToProcess; ++i)
-                {
-                    if (i < destNumChans)
-                        buffer.copyFrom (i, 0, *fc.destBuffer, i, fc.bufferStartSample, fc.bufferNumSamples);
-                    else
-                        buffer.clear (i, 0, fc.bufferNumSamples);
-                }
-
-                if (destNumChans == 1 && numInputChannels == 2)
-                {
-                    // If we're getting a mono in and need stereo, dupe the channel..
-                    buffer.copyFrom (1, 0, buffer, 0, 0, fc.bufferNumSamples);
-                }
-                else if (destNumChans == 2 && numInputChannels == 1)
-                {
-                    // If we're getting a stereo in and need mono, average the input..
-                    buffer.addFrom (0, 0, *fc.destBuffer, 1, fc.bufferStartSample, fc.bufferNumSamples);
-                    buffer.applyGain (0, 0, fc.bufferNumSamples, 0.5f);
-                }
-
-                AudioRenderContext fc2 (fc);
-                fc2.destBuffer = &asb.buffer;
-                fc2.bufferStartSample = 0;
-
-                processPluginBlock (fc2);
-
-                // Copy sample data back clearing unprocessed channels
-                for (int i = 0; i < destNumChans; ++i)
-                {
-                    if (i < numChansToProcess)
-                        fc.destBuffer->copyFrom (i, fc.bufferStartSample, buffer, i, 0, fc.bufferNumSamples);
-                    else if (i < 2 && numChansToProcess > 0) // convert mono output to stereo for next plugin
-                        fc.destBuffer->copyFrom (i, fc.bufferStartSample, buffer, 0, 0, fc.bufferNumSamples);
-                    else
-                        fc.destBuffer->clear (i, fc.bufferStartSample, fc.bufferNumSamples);
-                }
-            }
+                processPluginBlockWithRemappedChannels (fc);
         }
         else
         {
@@ -1278,6 +1337,71 @@ void ExternalPlugin::applyToBuffer (const AudioRenderContext& fc)
     }
 }
 
+void ExternalPlugin::processPluginBlockWithRemappedChannels (const AudioRenderContext& fc)
+{
+    auto& dest = *fc.destBuffer;
+    const int destNumChans = dest.getNumChannels();
+    const int start = fc.bufferStartSample;
+    const int numSamples = fc.bufferNumSamples;
+
+    AudioRenderContext fc2 (fc);
+    fc2.bufferStartSample = 0;
+
+    // The plugin processes the destination's channels in place so only the channels
+    // the destination doesn't have need a scratch buffer
+    if (destNumChans > numChannelsToProcess)
+    {
+        if (destNumChans == 2 && numInputChannelsToProcess == 1)
+        {
+            // If we're getting a stereo in and need mono, average the input..
+            auto left = dest.getWritePointer (0, start);
+            auto right = dest.getReadPointer (1, start);
+
+            for (int i = 0; i < numSamples; ++i)
+                left[i] = (left[i] + right[i]) * 0.5f;
+        }
+
+        juce::AudioBuffer<float> buffer (dest.getArrayOfWritePointers(), numChannelsToProcess, start, numSamples);
+        fc2.destBuffer = &buffer;
+        processPluginBlock (fc2);
+
+        // Convert a mono output to stereo for the next plugin and clear any unprocessed channels
+        for (int i = numChannelsToProcess; i < destNumChans; ++i)
+        {
+            if (i < 2)
+                dest.copyFrom (i, start, dest, 0, start, numSamples);
+            else
+                dest.clear (i, start, numSamples);
+        }
+    }
+    else
+    {
+        AudioScratchBuffer extraChannels (numChannelsToProcess - destNumChans, numSamples);
+
+        for (int i = 0; i < numChannelsToProcess; ++i)
+        {
+            if (i < destNumChans)
+            {
+                remappedChannels[i] = dest.getWritePointer (i, start);
+            }
+            else
+            {
+                remappedChannels[i] = extraChannels.buffer.getWritePointer (i - destNumChans);
+
+                // If we're getting a mono in and need stereo, dupe the channel..
+                if (i == 1 && destNumChans == 1 && numInputChannelsToProcess == 2)
+                    FloatVectorOperations::copy (remappedChannels[i], remappedChannels[0], numSamples);
+                else
+                    FloatVectorOperations::clear (remappedChannels[i], numSamples);
+            }
+        }
+
+        juce::AudioBuffer<float> buffer (remappedChannels, numChannelsToProcess, numSamples);
+        fc2.destBuffer = &buffer;
+        processPluginBlock (fc2);
+    }
+}
+
 void ExternalPlugin::processPluginBlock (const AudioRenderContext& fc)
 {
     juce::AudioBuffer<float> asb (fc.destBuffer->getArrayOfWritePointers(), fc.destBuffer->getNumChannels(),
@@ -1553,15 +1677,21 @@ String ExternalPlugin::createPluginInstance (const PluginDescription& descriptio
     auto& dm = engine.getDeviceManager();
 
     String error;
-    pluginInstance = engine.getPluginManager().createPluginInstance (description, dm.getSampleRate(), dm.getBlockSize(), error);
+    setPluginInstance (engine.getPluginManager().createPluginInstance (description, dm.getSampleRate(), dm.getBlockSize(), error));
+
+    return error;
+}
+
+void ExternalPlugin::setPluginInstance (std::unique_ptr<AudioPluginInstance> newInstance)
+{
+    jassert (! pluginInstance); // This should have already been deleted!
+    pluginInstance = std::move (newInstance);
 
     if (pluginInstance != nullptr)
     {
         pluginInstance->enableAllBuses();
         processorChangedManager = std::make_unique<ProcessorChangedManager> (*this);
     }
-
-    return error;
 }
 
 void ExternalPlugin::deletePluginInstance()
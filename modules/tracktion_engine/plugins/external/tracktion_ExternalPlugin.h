@@ -31,6 +31,36 @@ public:
     void initialiseFully() override;
     void forceFullReinitialise();
 
+    /** Starts initialising a set of plugins, creating their instances concurrently.
+        This doesn't block: each plugin is set up on the message thread once its instance is ready.
+        @see initialiseAsync
+    */
+    static void initialisePluginsConcurrently (const juce::Array<ExternalPlugin*>&);
+
+    /** Starts the full initialisation without blocking.
+        Instances that EngineBehaviour::canCreatePluginInstanceOffMessageThread allows are
+        created on a background thread and the rest with PluginManager::createPluginInstanceAsync.
+        Once the instance is ready its state is restored and playback is restarted so it gets
+        added to the graph. Until then the plugin passes its input straight through.
+    */
+    void initialiseAsync();
+
+    /** Stops this plugin being fully initialised until it's first needed for playback.
+        This is used whilst loading an Edit that loads its plugins in parallel.
+    */
+    void deferInitialisation() noexcept             { initialisationDeferred = ! fullyInitialised; }
+
+    /** Returns true if the plugin's instance will be created the first time it's needed. */
+    bool isInitialisationDeferred() const noexcept  { return initialisationDeferred; }
+
+    /** Returns true if the plugin is on a muted or frozen track, so a deferred
+        initialisation can wait until the track can be heard again.
+    */
+    bool isOnInaudibleTrack() const;
+
+    /** Returns true if the plugin has been through its full initialisation. */
+    bool isFullyInitialised() const noexcept        { return fullyInitialised; }
+
     static const char* xmlTypeName;
 
     void flushPluginStateToValueTree() override;
@@ -41,6 +71,7 @@ public:
     void updateFromMirroredPluginIfNeeded (Plugin&) override;
 
     void initialise (const PlaybackInitialisationInfo&) override;
+    void initialiseWithoutStopping (const PlaybackInitialisationInfo&) override;
     void deinitialise() override;
     void reset() override;
     void setEnabled (bool enabled) override;
@@ -124,6 +155,8 @@ private:
     std::unique_ptr<VSTXML> vstXML;
     int latencySamples = 0;
     double latencySeconds = 0;
+    int numInputChannelsToProcess = 0, numChannelsToProcess = 1;
+    juce::HeapBlock<float*> remappedChannels;
     bool isInstancePrepared = false;
 
     juce::MidiBuffer midiBuffer;
@@ -134,7 +167,7 @@ private:
     class PluginPlayHead;
     std::unique_ptr<PluginPlayHead> playhead;
 
-    bool fullyInitialised = false, supportsMPE = false, isFlushingLayoutToState = false;
+    bool fullyInitialised = false, initialisationDeferred = false, supportsMPE = false, isFlushingLayoutToState = false;
 
     struct MPEChannelRemapper;
     std::unique_ptr<MPEChannelRemapper> mpeRemapper;
@@ -145,6 +178,8 @@ private:
 
     //==============================================================================
     juce::String createPluginInstance (const juce::PluginDescription&);
+    void setPluginInstance (std::unique_ptr<juce::AudioPluginInstance>);
+    void asyncInstanceCreated (std::unique_ptr<juce::AudioPluginInstance>, const juce::String& error);
     void deletePluginInstance();
 
     //==============================================================================
@@ -153,10 +188,14 @@ private:
 
     //==============================================================================
     void doFullInitialisation();
+    std::unique_ptr<juce::PluginDescription> findDescriptionToInstantiate();
+    void pluginInstanceCreated (const juce::String& error);
+    void restoreStateAfterInstantiation();
     void buildParameterList();
     void refreshParameterValues();
     void updateDebugName();
     void processPluginBlock (const AudioRenderContext&);
+    void processPluginBlockWithRemappedChannels (const AudioRenderContext&);
 
     std::unique_ptr<juce::PluginDescription> findMatchingPlugin() const;
     std::unique_ptr<juce::PluginDescription> findDescForUID (int uid) const;
@@ -35,6 +35,7 @@ const char* LevelMeterPlugin::xmlTypeName = "level";
 void LevelMeterPlugin::initialise (const PlaybackInitialisationInfo& info)
 {
     measurer.clear();
+    measurer.setSampleRate (info.sampleRate);
     initialiseWithoutStopping (info);
 }
 
@@ -515,7 +515,7 @@ struct RackType::RenderContext
                   bool isRendering)
     {
        #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
-        if (processor)
+        if (processor || multiThreadedProcessor)
         {
             processExperiemntal (playhead, playheadOutputTime,
                                  outputBuffer, inputBuffer,
@@ -548,6 +548,7 @@ private:
    #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
     std::shared_ptr<InputProvider> inputProvider;
     std::unique_ptr<RackNodePlayer<NodePlayer>> processor;
+    std::unique_ptr<RackNodePlayer<tracktion_graph::MultiThreadedNodePlayer>> multiThreadedProcessor;
    #endif
 
    #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
@@ -557,6 +558,7 @@ private:
             || type.numActiveInstances.load() == 0)
         {
             processor.reset();
+            multiThreadedProcessor.reset();
             inputProvider.reset();
            return;
         }
@@ -565,9 +567,62 @@ private:
         auto rackNode = RackNodeBuilder::createRackNode (type, type.sampleRate, type.blockSize, inputProvider);
         jassert (tracktion_graph::test_utilities::areNodeIDsUnique (*rackNode, true));
 
-        processor = std::make_unique<RackNodePlayer<NodePlayer>> (std::move (rackNode), inputProvider, false);
-        processor->prepareToPlay (type.sampleRate, type.blockSize);
-        latencySeconds = processor->getLatencySamples() / type.sampleRate;
+        // Latency is compensated for by the graph itself so the same nodes can be used with either player
+        const auto numThreads = getNumThreadsToUse (type);
+
+        if (numThreads > 0)
+        {
+            multiThreadedProcessor = std::make_unique<RackNodePlayer<tracktion_graph::MultiThreadedNodePlayer>> (std::move (rackNode), inputProvider,
+                                                                                                                  false, getSharedThreadPool (type.edit.engine));
+            multiThreadedProcessor->prepareToPlay (type.sampleRate, type.blockSize);
+            latencySeconds = multiThreadedProcessor->getLatencySamples() / type.sampleRate;
+        }
+        else
+        {
+            processor = std::make_unique<RackNodePlayer<NodePlayer>> (std::move (rackNode), inputProvider, false);
+            processor->prepareToPlay (type.sampleRate, type.blockSize);
+            latencySeconds = processor->getLatencySamples() / type.sampleRate;
+        }
+    }
+
+    /** All the multi-threaded racks share one set of workers rather than each starting their
+        own, so the number of threads stays within the number of CPUs used for audio.
+    */
+    static std::shared_ptr<tracktion_graph::MultiThreadedNodePlayer::ThreadPool> getSharedThreadPool (Engine& engine)
+    {
+        static juce::CriticalSection lock;
+        static std::weak_ptr<tracktion_graph::MultiThreadedNodePlayer::ThreadPool> sharedPool;
+
+        const juce::ScopedLock sl (lock);
+        auto pool = sharedPool.lock();
+
+        if (pool == nullptr)
+        {
+            const int numCPUs = engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio();
+            pool = std::make_shared<tracktion_graph::MultiThreadedNodePlayer::ThreadPool> ((size_t) juce::jmax (1, numCPUs - 1));
+            sharedPool = pool;
+        }
+
+        return pool;
+    }
+
+    /** Returns the number of worker threads to use for a rack, which will be 0 unless
+        there are several chains fed directly from the rack's inputs that can run in parallel.
+    */
+    static int getNumThreadsToUse (RackType& type)
+    {
+        if (! RackType::isMultiThreadedGraphProcessingEnabled())
+            return 0;
+
+        juce::Array<EditItemID> itemsFedFromInputs;
+
+        for (auto conn : type.connectionList->objects)
+            if (conn->sourceID->isInvalid() && ! conn->destID->isInvalid())
+                itemsFedFromInputs.addIfNotAlreadyThere (conn->destID.get());
+
+        const int numCPUs = type.edit.engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio();
+
+        return juce::jmin (itemsFedFromInputs.size(), numCPUs) - 1;
     }
    #endif
 
@@ -632,7 +687,11 @@ private:
         //TODO: This probably should be the master stream time
         auto streamSampleRange = juce::Range<int64_t>::withStartAndLength (0, inputBuffer.getNumSamples());
         juce::dsp::AudioBlock<float> outputBlock (outputBuffer);
-        processor->process ({ streamSampleRange, { outputBlock, midiOut } }, playhead, playheadOutputTime);
+
+        if (multiThreadedProcessor)
+            multiThreadedProcessor->process ({ streamSampleRange, { outputBlock, midiOut } }, playhead, playheadOutputTime);
+        else
+            processor->process ({ streamSampleRange, { outputBlock, midiOut } }, playhead, playheadOutputTime);
     }
    #endif
 };
@@ -2126,6 +2185,12 @@ ModifierList& RackType::getModifierList() const noexcept
          static bool enabled = false;
          return enabled;
      }
+
+     bool& getMultiThreadedGraphProcessingFlag()
+     {
+         static bool enabled = false;
+         return enabled;
+     }
  }
 
  void RackType::enableExperimentalGraphProcessing (bool enable)
@@ -2142,6 +2207,16 @@ ModifierList& RackType::getModifierList() const noexcept
     #endif
  }
 
+ void RackType::enableMultiThreadedGraphProcessing (bool enable)
+ {
+     getMultiThreadedGraphProcessingFlag() = enable;
+ }
+
+ bool RackType::isMultiThreadedGraphProcessingEnabled()
+ {
+     return isExperimentalGraphProcessingEnabled() && getMultiThreadedGraphProcessingFlag();
+ }
+
 //==============================================================================
 struct RackTypeList::ValueTreeList  : public ValueTreeObjectList<RackType>
 {
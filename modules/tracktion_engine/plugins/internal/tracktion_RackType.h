@@ -160,6 +160,14 @@ public:
     static void enableExperimentalGraphProcessing (bool);
     static bool isExperimentalGraphProcessingEnabled();
 
+    /** When experimental graph processing is enabled, this lets racks with several
+        independent chains fed from their inputs process those chains on multiple threads.
+        All the racks share one set of threads, limited by EngineBehaviour::getNumberOfCPUsToUseForAudio().
+        N.B. This is for development only and this method will be removed in the future.
+    */
+    static void enableMultiThreadedGraphProcessing (bool);
+    static bool isMultiThreadedGraphProcessingEnabled();
+
 private:
     struct PluginInfo
     {
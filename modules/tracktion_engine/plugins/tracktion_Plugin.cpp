@@ -707,10 +707,24 @@ void Plugin::valueTreeParentChanged (juce::ValueTree& v)
 }
 
 //==============================================================================
+/** Plugins may have been left uninitialised when the Edit loaded, so this is called whenever
+    something is about to play one. Graphs can be built on any thread so rather than waiting,
+    the plugin is bypassed and playback is restarted once its instance is ready.
+    Plugins on muted or frozen tracks are left until the track can be heard.
+*/
+static void initialiseIfDeferred (Plugin& p)
+{
+    if (auto ep = dynamic_cast<ExternalPlugin*> (&p))
+        if (ep->isInitialisationDeferred() && ! ep->isOnInaudibleTrack())
+            juce::MessageManager::callAsync ([ptr = ExternalPlugin::Ptr (ep)] { ptr->initialiseAsync(); });
+}
+
 AudioNode* Plugin::createAudioNode (AudioNode* input, bool applyAntiDenormalisationNoise)
 {
     jassert (input != nullptr);
 
+    initialiseIfDeferred (*this);
+
     if (isDisabled())
         return input;
 
@@ -753,6 +767,9 @@ void Plugin::reset()
 //==============================================================================
 void Plugin::baseClassInitialise (const PlaybackInitialisationInfo& info)
 {
+    // The tracktion_graph nodes, including racks, don't go through createAudioNode
+    initialiseIfDeferred (*this);
+
     const bool sampleRateOrBlockSizeChanged = (sampleRate != info.sampleRate) || (blockSizeSamples != info.blockSizeSamples);
     bool isUpdatingWithoutStopping = false;
     sampleRate = info.sampleRate;
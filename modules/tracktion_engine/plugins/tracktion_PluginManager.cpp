@@ -297,9 +297,177 @@ bool PluginManager::startChildProcessPluginScan (const String& commandLine)
 }
 
 //==============================================================================
+/** Remembers the plugins found in each file so that files which haven't changed
+    since they were last scanned don't need to be loaded again.
+    Entries are keyed on the file and a hash of its contents.
+*/
+struct PluginScanCache
+{
+    PluginScanCache (Engine& e)
+        : cacheFile (e.getPropertyStorage().getAppCacheFolder().getChildFile ("PluginScanCache.xml"))
+    {
+        if (auto xml = std::unique_ptr<XmlElement> (XmlDocument::parse (cacheFile)))
+            forEachXmlChildElementWithTagName (*xml, entry, "ENTRY")
+                entries[entry->getStringAttribute ("key")] = std::make_unique<XmlElement> (*entry);
+    }
+
+    /** Returns a hash of a plugin file or bundle, or an empty string if it isn't a file.
+        To avoid reading the whole of every binary, this uses the size, start and end of
+        each file, which will change whenever the code does.
+    */
+    static String createContentHash (const String& fileOrIdentifier)
+    {
+        if (! File::isAbsolutePath (fileOrIdentifier))
+            return {};
+
+        File f (fileOrIdentifier);
+        uint64 hash = 14695981039346656037ull;
+
+        if (f.existsAsFile())
+        {
+            hashFile (hash, f);
+        }
+        else if (f.isDirectory())
+        {
+            auto files = f.findChildFiles (File::findFiles, true);
+            files.sort();
+
+            for (auto& child : files)
+            {
+                hashBytes (hash, child.getRelativePathFrom (f).toRawUTF8(), child.getRelativePathFrom (f).getNumBytesAsUTF8());
+                hashFile (hash, child);
+            }
+        }
+        else
+        {
+            return {};
+        }
+
+        return String::toHexString ((int64) hash);
+    }
+
+    bool getCachedResults (const AudioPluginFormat& format, const String& fileOrIdentifier,
+                           const String& hash, OwnedArray<PluginDescription>& result)
+    {
+        if (hash.isEmpty())
+            return false;
+
+        const ScopedLock sl (lock);
+        auto found = entries.find (getKey (format, fileOrIdentifier));
+
+        if (found == entries.end() || found->second->getStringAttribute ("hash") != hash)
+            return false;
+
+        forEachXmlChildElement (*found->second, e)
+        {
+            auto desc = std::make_unique<PluginDescription>();
+
+            if (desc->loadFromXml (*e))
+            {
+                desc->lastInfoUpdateTime = Time::getCurrentTime();
+                result.add (desc.release());
+            }
+        }
+
+        TRACKTION_LOG ("Using cached scan of: " + fileOrIdentifier);
+        return true;
+    }
+
+    void addResults (const AudioPluginFormat& format, const String& fileOrIdentifier, const String& hash,
+                     const OwnedArray<PluginDescription>& result, int firstNewResult)
+    {
+        if (hash.isEmpty())
+            return;
+
+        auto key = getKey (format, fileOrIdentifier);
+        auto entry = std::make_unique<XmlElement> ("ENTRY");
+        entry->setAttribute ("key", key);
+        entry->setAttribute ("hash", hash);
+
+        for (int i = firstNewResult; i < result.size(); ++i)
+            entry->addChildElement (result.getUnchecked (i)->createXml().release());
+
+        const ScopedLock sl (lock);
+        entries[key] = std::move (entry);
+        needsSaving = true;
+    }
+
+    void saveIfNeeded()
+    {
+        XmlElement xml ("PLUGINSCANCACHE");
+
+        {
+            const ScopedLock sl (lock);
+
+            if (! needsSaving)
+                return;
+
+            for (auto& entry : entries)
+                xml.addChildElement (new XmlElement (*entry.second));
+
+            needsSaving = false;
+        }
+
+        if (! xml.writeTo (cacheFile))
+            TRACKTION_LOG_ERROR ("Failed to write plugin scan cache");
+    }
+
+private:
+    const File cacheFile;
+    CriticalSection lock;
+    std::map<String, std::unique_ptr<XmlElement>> entries;
+    bool needsSaving = false;
+
+    static String getKey (const AudioPluginFormat& format, const String& fileOrIdentifier)
+    {
+        return format.getName() + "|" + fileOrIdentifier;
+    }
+
+    static void hashBytes (uint64& hash, const void* data, size_t numBytes) noexcept
+    {
+        auto bytes = static_cast<const uint8*> (data);
+
+        for (size_t i = 0; i < numBytes; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+
+    static void hashFile (uint64& hash, const File& f)
+    {
+        constexpr int64 bytesToHashAtEachEnd = 64 * 1024;
+        const auto size = f.getSize();
+        hashBytes (hash, &size, sizeof (size));
+
+        FileInputStream in (f);
+
+        if (! in.openedOk())
+            return;
+
+        HeapBlock<char> buffer (bytesToHashAtEachEnd);
+
+        auto hashSection = [&] (int64 start)
+        {
+            if (in.setPosition (start))
+                hashBytes (hash, buffer, (size_t) jmax (0, in.read (buffer, (int) bytesToHashAtEachEnd)));
+        };
+
+        hashSection (0);
+
+        if (size > bytesToHashAtEachEnd)
+            hashSection (jmax (bytesToHashAtEachEnd, size - bytesToHashAtEachEnd));
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginScanCache)
+};
+
+//==============================================================================
+/** Scans plugins in child processes.
+    This can be called from several of the KnownPluginList's scanning threads at once,
+    in which case each one gets its own child process so a crash only affects the
+    plugin that caused it.
+*/
 struct CustomScanner  : public KnownPluginList::CustomScanner
 {
-    CustomScanner (Engine& e) : engine (e) {}
+    CustomScanner (Engine& e) : engine (e), scanCache (e) {}
 
     bool findPluginTypesFor (AudioPluginFormat& format,
                              OwnedArray<PluginDescription>& result,
@@ -310,36 +478,22 @@ struct CustomScanner  : public KnownPluginList::CustomScanner
         if (engine.getPluginManager().usesSeparateProcessForScanning()
              && shouldUseSeparateProcessToScan (format))
         {
-            if (masterProcess != nullptr && masterProcess->crashed)
-                masterProcess = nullptr;
+            auto hash = PluginScanCache::createContentHash (fileOrIdentifier);
 
-            if (masterProcess == nullptr)
-                masterProcess = std::make_unique<PluginScanMasterProcess> (engine);
+            if (scanCache.getCachedResults (format, fileOrIdentifier, hash, result))
+                return true;
+
+            auto masterProcess = takeMasterProcess();
 
             if (masterProcess->ensureSlaveIsLaunched())
             {
-                auto requestID = Random().nextInt();
+                const int numResultsBefore = result.size();
 
-                if (! shouldExit()
-                     && masterProcess->sendScanRequest (format, fileOrIdentifier, requestID)
-                     && ! shouldExit())
+                if (scanInChildProcess (masterProcess, format, result, fileOrIdentifier))
                 {
-                    if (masterProcess->waitForReply (requestID, fileOrIdentifier, result, *this))
-                        return true;
-
-                    // if there's a crash, give it a second chance with a fresh child process,
-                    // in case the real culprit was whatever plugin preceded this one.
-                    if (masterProcess->crashed && ! shouldExit())
-                    {
-                        masterProcess = nullptr;
-                        masterProcess = std::make_unique<PluginScanMasterProcess> (engine);
-
-                        return masterProcess->ensureSlaveIsLaunched()
-                                 && ! shouldExit()
-                                 && masterProcess->sendScanRequest (format, fileOrIdentifier, requestID)
-                                 && ! shouldExit()
-                                 && masterProcess->waitForReply (requestID, fileOrIdentifier, result, *this);
-                    }
+                    scanCache.addResults (format, fileOrIdentifier, hash, result, numResultsBefore);
+                    returnMasterProcess (std::move (masterProcess));
+                    return true;
                 }
 
                 return false;
@@ -347,7 +501,6 @@ struct CustomScanner  : public KnownPluginList::CustomScanner
 
             // panic! Can't run the slave for some reason, so just do it here..
             TRACKTION_LOG_ERROR ("Falling back to scanning in main process..");
-            masterProcess.reset();
         }
 
         format.findAllTypesForFile (result, fileOrIdentifier);
@@ -366,14 +519,77 @@ struct CustomScanner  : public KnownPluginList::CustomScanner
     void scanFinished() override
     {
         TRACKTION_LOG ("----- Ended Plugin Scan");
-        masterProcess.reset();
+        scanCache.saveIfNeeded();
+
+        {
+            const ScopedLock sl (processLock);
+            idleProcesses.clear();
+        }
 
         if (auto callback = engine.getPluginManager().scanCompletedCallback)
             callback();
     }
 
     Engine& engine;
-    std::unique_ptr<PluginScanMasterProcess> masterProcess;
+
+private:
+    PluginScanCache scanCache;
+    CriticalSection processLock;
+    std::vector<std::unique_ptr<PluginScanMasterProcess>> idleProcesses;
+
+    bool scanInChildProcess (std::unique_ptr<PluginScanMasterProcess>& masterProcess, AudioPluginFormat& format,
+                             OwnedArray<PluginDescription>& result, const String& fileOrIdentifier)
+    {
+        auto requestID = Random().nextInt();
+
+        if (shouldExit()
+             || ! masterProcess->sendScanRequest (format, fileOrIdentifier, requestID)
+             || shouldExit())
+            return false;
+
+        if (masterProcess->waitForReply (requestID, fileOrIdentifier, result, *this))
+            return true;
+
+        // if there's a crash, give it a second chance with a fresh child process,
+        // in case the real culprit was whatever plugin this process scanned before
+        if (masterProcess->crashed && ! shouldExit())
+        {
+            masterProcess = std::make_unique<PluginScanMasterProcess> (engine);
+
+            return masterProcess->ensureSlaveIsLaunched()
+                     && ! shouldExit()
+                     && masterProcess->sendScanRequest (format, fileOrIdentifier, requestID)
+                     && ! shouldExit()
+                     && masterProcess->waitForReply (requestID, fileOrIdentifier, result, *this);
+        }
+
+        return false;
+    }
+
+    std::unique_ptr<PluginScanMasterProcess> takeMasterProcess()
+    {
+        {
+            const ScopedLock sl (processLock);
+
+            if (! idleProcesses.empty())
+            {
+                auto p = std::move (idleProcesses.back());
+                idleProcesses.pop_back();
+                return p;
+            }
+        }
+
+        return std::make_unique<PluginScanMasterProcess> (engine);
+    }
+
+    void returnMasterProcess (std::unique_ptr<PluginScanMasterProcess> p)
+    {
+        if (p->crashed)
+            return;
+
+        const ScopedLock sl (processLock);
+        idleProcesses.push_back (std::move (p));
+    }
 };
 
 //==============================================================================
@@ -398,6 +614,16 @@ PluginManager::PluginManager (Engine& e)
                            {
                                return std::unique_ptr<AudioPluginInstance> (pluginFormatManager.createPluginInstance (description, rate, blockSize, errorMessage));
                            };
+
+    createPluginInstanceAsync = [this] (const PluginDescription& description, double rate, int blockSize,
+                                        std::function<void (std::unique_ptr<AudioPluginInstance>, const String&)> callback)
+                                {
+                                    pluginFormatManager.createPluginInstanceAsync (description, rate, blockSize,
+                                                                                   [callback] (AudioPluginInstance* instance, const String& error)
+                                                                                   {
+                                                                                       callback (std::unique_ptr<AudioPluginInstance> (instance), error);
+                                                                                   });
+                                };
 }
 
 void PluginManager::initialise()
@@ -443,9 +669,34 @@ void PluginManager::initialise()
 PluginManager::~PluginManager()
 {
     knownPluginList.removeChangeListener (this);
+
+    if (instanceCreationPool != nullptr)
+        instanceCreationPool->removeAllJobs (true, 10000);
+
     cleanUpDanglingPlugins();
 }
 
+void PluginManager::createPluginInstanceInBackground (const PluginDescription& description, double rate, int blockSize,
+                                                      std::function<void (std::unique_ptr<AudioPluginInstance>, const String&)> callback)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    jassert (callback != nullptr);
+
+    if (instanceCreationPool == nullptr)
+        instanceCreationPool = std::make_unique<ThreadPool> (jlimit (1, 8, SystemStats::getNumCpus()));
+
+    instanceCreationPool->addJob ([this, description, rate, blockSize, callback]
+                                  {
+                                      String error;
+                                      auto instance = std::make_shared<std::unique_ptr<AudioPluginInstance>> (createPluginInstance (description, rate, blockSize, error));
+
+                                      MessageManager::callAsync ([callback, instance, error]
+                                                                 {
+                                                                     callback (std::move (*instance), error);
+                                                                 });
+                                  });
+}
+
 #if TRACKTION_AIR_WINDOWS
 void PluginManager::initialiseAirWindows()
 {
@@ -743,8 +994,13 @@ void PluginManager::setDoubleClickToOpenWindows (bool b)
 
 int PluginManager::getNumberOfThreadsForScanning()
 {
+    // Each scanning thread uses its own child process so by default use all the CPUs,
+    // but plugins scanned in this process often aren't safe to load concurrently
+    const int defaultNumThreads = usesSeparateProcessForScanning() ? SystemStats::getNumCpus() : 1;
+
     return jlimit (1, SystemStats::getNumCpus(),
-                   static_cast<int> (engine.getPropertyStorage().getProperty (SettingID::numThreadsForPluginScanning, 1)));
+                   static_cast<int> (engine.getPropertyStorage().getProperty (SettingID::numThreadsForPluginScanning,
+                                                                              defaultNumThreads)));
 }
 
 void PluginManager::setNumberOfThreadsForScanning (int numThreads)
@@ -81,6 +81,23 @@ public:
                                                               double rate, int blockSize,
                                                               juce::String& errorMessage)> createPluginInstance;
 
+    /** Callback that is used to create plugin instances asynchronously, e.g. when an Edit loads
+        its plugins in parallel. The callback must be called on the message thread once the
+        instance has been created, or with an error message if it failed.
+        By default this uses the pluginFormatManager's asynchronous creation, which lets formats
+        that support it create their instances without blocking the message thread.
+    */
+    std::function<void (const juce::PluginDescription&, double rate, int blockSize,
+                        std::function<void (std::unique_ptr<juce::AudioPluginInstance>, const juce::String&)>)> createPluginInstanceAsync;
+
+    /** Creates a plugin instance on a background thread using the createPluginInstance callback.
+        The callback is called on the message thread once the instance has been created, or
+        with an error message if it failed. Only use this for plugins that
+        EngineBehaviour::canCreatePluginInstanceOffMessageThread allows.
+    */
+    void createPluginInstanceInBackground (const juce::PluginDescription&, double rate, int blockSize,
+                                           std::function<void (std::unique_ptr<juce::AudioPluginInstance>, const juce::String&)>);
+
     /** Callback that is used to determine if a plugin should use fine-grain automation or not. */
     std::function<bool (Plugin&)> canUseFineGrainAutomation;
 
@@ -94,6 +111,8 @@ private:
     juce::OwnedArray<BuiltInType> builtInTypes;
     bool initialised = false;
 
+    std::unique_ptr<juce::ThreadPool> instanceCreationPool;
+
     Plugin::Ptr createPlugin (Edit&, const juce::ValueTree&, bool isNew);
 
     void changeListenerCallback (juce::ChangeBroadcaster*) override;
@@ -33,29 +33,14 @@ struct BeatDetect
         double blockEnergy = 0;
 
         for (int chan = numChans; --chan >= 0;)
-        {
-            const float* const c = inputs[chan];
-
-            for (int i = 0; i < blockSize; ++i)
-                blockEnergy += c[i] * c[i];
-        }
+            blockEnergy += getSumOfSquares (inputs[chan], blockSize);
 
         pushEnergy (blockEnergy);
     }
 
-    int getBlockSize()                      { return blockSize; }
-    int getNumBeats()                       { return beatBlocks.size(); }
-    juce::int64 getBeat (int idx) const     { return beatBlocks[idx] * blockSize; }
-
-private:
-    enum { historyLength = 43 };
-    double energy [historyLength];
-    int curBlock = 0;
-    int lastBlock = -2;
-    int blockSize = 0;
-    juce::Array<int> beatBlocks;
-    double sensitivity = 0;
-
+    /** Adds the energy of the next block, if it's already been measured elsewhere.
+        @see OnsetEnvelope
+    */
     void pushEnergy (double e)
     {
         if (curBlock < historyLength)
@@ -82,6 +67,19 @@ private:
         }
     }
 
+    int getBlockSize()                      { return blockSize; }
+    int getNumBeats()                       { return beatBlocks.size(); }
+    juce::int64 getBeat (int idx) const     { return beatBlocks[idx] * blockSize; }
+
+private:
+    enum { historyLength = 43 };
+    double energy [historyLength];
+    int curBlock = 0;
+    int lastBlock = -2;
+    int blockSize = 0;
+    juce::Array<int> beatBlocks;
+    double sensitivity = 0;
+
     void addBlock (int i)
     {
         if (i - 1 != lastBlock)
@@ -326,6 +326,7 @@ namespace tracktion_engine
 #include "utilities/tracktion_CurveEditor.h"
 #include "utilities/tracktion_Envelope.h"
 #include "utilities/tracktion_Oscillators.h"
+#include "utilities/tracktion_SincResampler.h"
 
 #include "project/tracktion_ProjectItemID.h"
 
@@ -388,6 +389,8 @@ namespace tracktion_engine
 #include "plugins/effects/tracktion_Equaliser.h"
 
 #include "model/edit/tracktion_EditSnapshot.h"
+#include "model/edit/tracktion_BinaryEditFile.h"
+#include "model/edit/tracktion_EditJournal.h"
 #include "model/edit/tracktion_EditFileOperations.h"
 #include "model/edit/tracktion_EditInsertPoint.h"
 #include "model/tracks/tracktion_TrackItem.h"
@@ -414,6 +417,9 @@ namespace tracktion_engine
 #include "model/edit/tracktion_EditUtilities.h"
 
 #include "audio_files/tracktion_AudioFileCache.h"
+#include "audio_files/tracktion_AudioAnalysisPipeline.h"
+#include "audio_files/tracktion_OnsetEnvelope.h"
+#include "audio_files/tracktion_PeakPyramid.h"
 #include "audio_files/tracktion_Thumbnail.h"
 #include "audio_files/tracktion_SmartThumbnail.h"
 #include "audio_files/tracktion_AudioProxyGenerator.h"
@@ -33,6 +33,9 @@ extern "C"
 #include "audio_files/formats/tracktion_LAMEManager.cpp"
 
 #include "audio_files/tracktion_Thumbnail.cpp"
+#include "audio_files/tracktion_AudioAnalysisPipeline.cpp"
+#include "audio_files/tracktion_OnsetEnvelope.cpp"
+#include "audio_files/tracktion_PeakPyramid.cpp"
 #include "audio_files/tracktion_AudioFileCache.cpp"
 #include "audio_files/tracktion_AudioFile.cpp"
 #include "audio_files/tracktion_AudioFileUtils.cpp"
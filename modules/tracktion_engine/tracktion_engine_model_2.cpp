@@ -40,6 +40,8 @@ using namespace juce;
 #include "model/edit/tracktion_TimecodeDisplayFormat.cpp"
 #include "model/edit/tracktion_TimeSigSetting.cpp"
 #include "model/edit/tracktion_EditSnapshot.cpp"
+#include "model/edit/tracktion_BinaryEditFile.cpp"
+#include "model/edit/tracktion_EditJournal.cpp"
 #include "model/edit/tracktion_EditFileOperations.cpp"
 #include "model/edit/tracktion_EditInsertPoint.cpp"
 
@@ -48,6 +48,10 @@ extern "C"
 
 #include <thread>
 
+#if TRACKTION_UNIT_TESTS && (JUCE_LINUX || JUCE_MAC)
+ #include <sys/resource.h>
+#endif
+
 using namespace juce;
 
 #include "playback/tracktion_DeviceManager.cpp"
@@ -56,6 +60,7 @@ using namespace juce;
 #include "playback/tracktion_LevelMeasurer.cpp"
 #include "playback/tracktion_MidiNoteDispatcher.cpp"
 #include "playback/tracktion_tests_TransportControl.cpp"
+#include "playback/tracktion_tests_PlaybackBenchmarks.cpp"
 #include "playback/tracktion_TransportControl.cpp"
 #include "playback/tracktion_AbletonLink.cpp"
 
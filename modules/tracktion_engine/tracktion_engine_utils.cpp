@@ -61,6 +61,7 @@ using namespace juce;
 
 #include "utilities/tracktion_AppFunctions.cpp"
 #include "utilities/tracktion_AudioUtilities.cpp"
+#include "utilities/tracktion_BackgroundJobs.cpp"
 #include "utilities/tracktion_ConstrainedCachedValue.cpp"
 #include "utilities/tracktion_CrashTracer.cpp"
 #include "utilities/tracktion_CurveEditor.cpp"
@@ -69,6 +70,7 @@ using namespace juce;
 #include "utilities/tracktion_FileUtilities.cpp"
 #include "utilities/tracktion_Oscillators.cpp"
 #include "utilities/tracktion_PropertyStorage.cpp"
+#include "utilities/tracktion_SincResampler.cpp"
 #include "utilities/tracktion_UIBehaviour.cpp"
 #include "utilities/tracktion_TemporaryFileManager.cpp"
 #include "utilities/tracktion_Engine.cpp"
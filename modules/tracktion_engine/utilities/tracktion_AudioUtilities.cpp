@@ -228,6 +228,28 @@ float getAudioDataMagnitude (const float* data, int num)
                  std::abs (range.getEnd()));
 }
 
+float getSumOfSquares (const float* data, int num) noexcept
+{
+    // Separate sums so the compiler can vectorise this loop
+    float sums[4] = {};
+    int i = 0;
+
+    for (; i + 4 <= num; i += 4)
+    {
+        sums[0] += data[i] * data[i];
+        sums[1] += data[i + 1] * data[i + 1];
+        sums[2] += data[i + 2] * data[i + 2];
+        sums[3] += data[i + 3] * data[i + 3];
+    }
+
+    float sumSquares = sums[0] + sums[1] + sums[2] + sums[3];
+
+    for (; i < num; ++i)
+        sumSquares += data[i] * data[i];
+
+    return sumSquares;
+}
+
 //==============================================================================
 void getGainsFromVolumeFaderPositionAndPan (float volSliderPos, float pan, const PanLaw panLaw,
                                             float& leftGain, float& rightGain) noexcept
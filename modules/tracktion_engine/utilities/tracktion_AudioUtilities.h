@@ -36,6 +36,7 @@ void zeroDenormalisedValuesIfNeeded (juce::AudioBuffer<float>&) noexcept;
 
 bool isAudioDataAlmostSilent (const float* data, int num);
 float getAudioDataMagnitude (const float* data, int num);
+float getSumOfSquares (const float* data, int num) noexcept;
 
 void convertIntsToFloats (juce::AudioBuffer<float>&);
 void convertFloatsToInts (juce::AudioBuffer<float>&);
@@ -0,0 +1,369 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+BackgroundJobManager::JobClass::JobClass (int numThreads, int threadPriority)
+    : pool (numThreads), maxNumRunning (numThreads)
+{
+    pool.setThreadPriorities (threadPriority);
+}
+
+//==============================================================================
+BackgroundJobManager::BackgroundJobManager()
+{
+    const int numCpus = SystemStats::getNumCpus();
+
+    // These must be added in the order of BackgroundJobClass
+    jobClasses.add (new JobClass (jlimit (1, 4, numCpus / 2), 6));    // playback
+    jobClasses.add (new JobClass (jlimit (1, 4, numCpus / 2), 5));    // render
+    jobClasses.add (new JobClass (jlimit (1, 2, numCpus / 4), 4));    // analysis
+    jobClasses.add (new JobClass (jlimit (1, 2, numCpus / 4), 3));    // exporting
+    jobClasses.add (new JobClass (4, 5));                              // general
+}
+
+BackgroundJobManager::~BackgroundJobManager()
+{
+    stopTimer();
+    removeAllWaitingJobs();
+
+    for (auto c : jobClasses)
+        c->pool.removeAllJobs (true, 30000);
+}
+
+void BackgroundJobManager::addJob (ThreadPoolJobWithProgress* job, bool takeOwnership,
+                                   const Array<ThreadPoolJobWithProgress*>& jobsToWaitFor)
+{
+    if (job == nullptr)
+        return;
+
+    job->setManager (*this);
+
+    {
+        const ScopedLock sl (jobsLock);
+        jassert (! isScheduled (job));
+
+        auto s = new ScheduledJob();
+        s->job = job;
+        s->isOwned = takeOwnership;
+        s->timeQueued = Time::getMillisecondCounter();
+
+        // Anything that's already finished or was never added can't hold this up
+        for (auto j : jobsToWaitFor)
+            if (j != job && isScheduled (j))
+                s->jobsToWaitFor.addIfNotAlreadyThere (j);
+
+        jobClasses.getUnchecked ((int) job->getJobClass())->scheduledJobs.add (s);
+    }
+
+    startWaitingJobs();
+}
+
+void BackgroundJobManager::removeJob (ThreadPoolJobWithProgress* job, bool interruptIfRunning, int timeOutMilliseconds)
+{
+    std::unique_ptr<ThreadPoolJobWithProgress> waitingJobToDelete;
+    ThreadPool* poolToRemoveFrom = &getPool();
+
+    {
+        const ScopedLock sl (jobsLock);
+
+        for (auto c : jobClasses)
+        {
+            for (auto s : c->scheduledJobs)
+            {
+                if (s->job != job)
+                    continue;
+
+                if (s->isRunning)
+                {
+                    poolToRemoveFrom = &c->pool;
+                }
+                else
+                {
+                    if (s->isOwned)
+                        waitingJobToDelete.reset (job);
+
+                    forgetScheduledJob (job);
+                    poolToRemoveFrom = nullptr;
+                }
+
+                break;
+            }
+        }
+    }
+
+    // A job that hasn't been started can just be deleted, as the pool would do
+    if (poolToRemoveFrom != nullptr)
+        poolToRemoveFrom->removeJob (job, interruptIfRunning, timeOutMilliseconds);
+
+    waitingJobToDelete.reset();
+    startWaitingJobs();
+}
+
+void BackgroundJobManager::stopAndDeleteAllRunningJobs()
+{
+    removeAllWaitingJobs();
+
+    for (auto c : jobClasses)
+    {
+        // Call this twice as the first call may only stop (and not delete) running jobs
+        c->pool.removeAllJobs (true, 30000);
+        c->pool.removeAllJobs (true, 5000);
+        jassert (c->pool.getNumJobs() == 0);
+    }
+
+    const ScopedLock sl (jobsLock);
+
+    for (auto c : jobClasses)
+        c->scheduledJobs.clear();
+}
+
+BackgroundJobManager::ClassStats BackgroundJobManager::getClassStats (BackgroundJobClass jobClass) const
+{
+    const ScopedLock sl (jobsLock);
+    auto& c = *jobClasses.getUnchecked ((int) jobClass);
+    const auto now = Time::getMillisecondCounter();
+
+    ClassStats stats;
+    stats.maxNumRunning = c.maxNumRunning;
+
+    if (c.numStarted > 0)
+        stats.averageWaitSeconds = c.totalWaitSeconds / c.numStarted;
+
+    for (auto s : c.scheduledJobs)
+    {
+        if (s->isRunning)
+        {
+            ++stats.numRunning;
+        }
+        else
+        {
+            ++stats.numWaiting;
+            stats.longestWaitSeconds = jmax (stats.longestWaitSeconds, (now - s->timeQueued) / 1000.0);
+        }
+    }
+
+    return stats;
+}
+
+//==============================================================================
+bool BackgroundJobManager::isScheduled (ThreadPoolJobWithProgress* job) const
+{
+    const ScopedLock sl (jobsLock);
+
+    for (auto c : jobClasses)
+        for (auto s : c->scheduledJobs)
+            if (s->job == job)
+                return true;
+
+    return false;
+}
+
+bool BackgroundJobManager::hasScheduledJobs() const
+{
+    const ScopedLock sl (jobsLock);
+
+    for (auto c : jobClasses)
+        if (! c->scheduledJobs.isEmpty())
+            return true;
+
+    return false;
+}
+
+void BackgroundJobManager::forgetScheduledJob (ThreadPoolJobWithProgress* job)
+{
+    const ScopedLock sl (jobsLock);
+
+    for (auto c : jobClasses)
+    {
+        for (int i = c->scheduledJobs.size(); --i >= 0;)
+        {
+            auto s = c->scheduledJobs.getUnchecked (i);
+
+            if (s->job == job)
+                c->scheduledJobs.remove (i);
+            else
+                s->jobsToWaitFor.removeFirstMatchingValue (job);
+        }
+    }
+}
+
+void BackgroundJobManager::startWaitingJobs()
+{
+    const ScopedLock sl (jobsLock);
+
+    // Jobs that were added without ownership stay alive once they've finished, so
+    // the only way to know they're done is that their pool has let go of them
+    Array<ThreadPoolJobWithProgress*> finishedJobs;
+
+    for (auto c : jobClasses)
+        for (auto s : c->scheduledJobs)
+            if (s->isRunning && ! c->pool.contains (s->job))
+                finishedJobs.add (s->job);
+
+    for (auto j : finishedJobs)
+        forgetScheduledJob (j);
+
+    const auto now = Time::getMillisecondCounter();
+
+    for (auto c : jobClasses)
+    {
+        auto getNumRunning = [c] (const void* owner, bool anyOwner)
+        {
+            int num = 0;
+
+            for (auto s : c->scheduledJobs)
+                if (s->isRunning && (anyOwner || s->job->getJobOwner() == owner))
+                    ++num;
+
+            return num;
+        };
+
+        while (getNumRunning (nullptr, true) < c->maxNumRunning)
+        {
+            // Take the oldest ready job from the owner with the fewest running, so one Edit
+            // with a long queue can't keep another's jobs waiting
+            ScheduledJob* next = nullptr;
+            int nextOwnerNumRunning = 0;
+
+            for (auto s : c->scheduledJobs)
+            {
+                if (s->isRunning || ! s->jobsToWaitFor.isEmpty())
+                    continue;
+
+                const int ownerNumRunning = getNumRunning (s->job->getJobOwner(), false);
+
+                if (next == nullptr || ownerNumRunning < nextOwnerNumRunning)
+                {
+                    next = s;
+                    nextOwnerNumRunning = ownerNumRunning;
+                }
+            }
+
+            if (next == nullptr)
+                break;
+
+            next->isRunning = true;
+            c->totalWaitSeconds += (now - next->timeQueued) / 1000.0;
+            ++c->numStarted;
+            c->pool.addJob (next->job, next->isOwned);
+        }
+    }
+}
+
+void BackgroundJobManager::removeAllWaitingJobs()
+{
+    OwnedArray<ThreadPoolJobWithProgress> jobsToDelete;
+
+    {
+        const ScopedLock sl (jobsLock);
+
+        for (auto c : jobClasses)
+        {
+            for (int i = c->scheduledJobs.size(); --i >= 0;)
+            {
+                auto s = c->scheduledJobs.getUnchecked (i);
+
+                if (s->isRunning)
+                    continue;
+
+                if (s->isOwned)
+                    jobsToDelete.add (s->job);
+
+                c->scheduledJobs.remove (i);
+            }
+        }
+    }
+
+    // Their destructors call back into the manager, so they're deleted once the lock's released
+    jobsToDelete.clear();
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class BackgroundJobManagerTests  : public juce::UnitTest
+{
+public:
+    BackgroundJobManagerTests()
+        : juce::UnitTest ("BackgroundJobManager", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        beginTest ("Dependencies");
+
+        BackgroundJobManager manager;
+        Array<int> order;
+        CriticalSection orderLock;
+        WaitableEvent secondDeleted;
+
+        // These are in different classes so only the dependency can stop them running together
+        auto first = new TestJob (order, orderLock, 1, nullptr);
+        first->setJobClass (BackgroundJobClass::render);
+        manager.addJob (first, true);
+
+        auto second = new TestJob (order, orderLock, 2, &secondDeleted);
+        second->setJobClass (BackgroundJobClass::analysis);
+        manager.addJob (second, true, { first });
+
+        expect (secondDeleted.wait (10000));
+
+        {
+            const ScopedLock sl (orderLock);
+            expect (order == Array<int> (1, 2));
+        }
+
+        auto stats = manager.getClassStats (BackgroundJobClass::analysis);
+        expectEquals (stats.numWaiting, 0);
+        expectEquals (stats.numRunning, 0);
+        expect (stats.averageWaitSeconds > 0.0);
+    }
+
+private:
+    struct TestJob  : public ThreadPoolJobWithProgress
+    {
+        TestJob (Array<int>& o, CriticalSection& l, int i, WaitableEvent* deleted)
+            : ThreadPoolJobWithProgress ("Test"), order (o), orderLock (l), index (i), onDeletion (deleted)
+        {
+        }
+
+        ~TestJob() override
+        {
+            prepareForJobDeletion();
+
+            if (onDeletion != nullptr)
+                onDeletion->signal();
+        }
+
+        float getCurrentTaskProgress() override     { return 0.0f; }
+
+        JobStatus runJob() override
+        {
+            Thread::sleep (50);
+
+            const ScopedLock sl (orderLock);
+            order.add (index);
+            return jobHasFinished;
+        }
+
+        Array<int>& order;
+        CriticalSection& orderLock;
+        const int index;
+        WaitableEvent* onDeletion;
+    };
+};
+
+static BackgroundJobManagerTests backgroundJobManagerTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
+} // namespace tracktion_engine
@@ -13,6 +13,19 @@ namespace tracktion_engine
 
 class BackgroundJobManager;
 
+//==============================================================================
+/** The kinds of job the BackgroundJobManager runs. Each has its own threads and limit,
+    so e.g. a long queue of exports can't hold up the proxies needed for playback.
+*/
+enum class BackgroundJobClass
+{
+    playback,   /**< Proxies and other files needed to play an Edit. These have the highest priority. */
+    render,     /**< Clip effects and other renders. */
+    analysis,   /**< Tempo and transient detection and similar. */
+    exporting,  /**< Exports, archives and other bulk jobs. These have the lowest priority. */
+    general     /**< Anything else. */
+};
+
 //==============================================================================
 class ThreadPoolJobWithProgress  : public juce::ThreadPoolJob
 {
@@ -33,51 +46,63 @@ public:
     */
     void prepareForJobDeletion();
 
+    /** Sets which of the manager's sets of threads this runs on. Call this before adding the job. */
+    void setJobClass (BackgroundJobClass c) noexcept    { jobClass = c; }
+    BackgroundJobClass getJobClass() const noexcept     { return jobClass; }
+
+    /** Sets what the job's being done for, usually an Edit. Waiting jobs are started so
+        that each owner gets a fair share of their class's threads.
+    */
+    void setJobOwner (const void* owner) noexcept       { jobOwner = owner; }
+    const void* getJobOwner() const noexcept            { return jobOwner; }
+
 private:
     BackgroundJobManager* manager = nullptr;
+    BackgroundJobClass jobClass = BackgroundJobClass::general;
+    const void* jobOwner = nullptr;
 };
 
 //==============================================================================
 /**
-    Manages a set of background tasks that can be run concurrently on a background thread.
-    This is essentially a wrapper around a ThreadPool which adds a listener interface so
-    you can create UI elements to represent the list.
+    Manages a set of background tasks that can be run concurrently on background threads.
+    This is essentially a wrapper around a set of ThreadPools which adds a listener interface
+    so you can create UI elements to represent the list.
+
+    Each BackgroundJobClass has its own pool, with a limited number of threads and a thread
+    priority. Jobs wait in a queue until a thread in their class is free and any jobs they
+    depend on have finished, and are then started oldest first, favouring owners with the
+    fewest jobs already running.
 */
 class BackgroundJobManager  : private juce::AsyncUpdater,
                               private juce::Timer
 {
 public:
-    BackgroundJobManager()
-        : pool (8)
-    {
-    }
+    BackgroundJobManager();
+    ~BackgroundJobManager() override;
 
-    ~BackgroundJobManager() override
-    {
-        pool.removeAllJobs (true, 30000);
-    }
+    /** Queues a job to run on its class's threads.
+        It won't be started until all of the jobsToWaitFor have finished or been removed.
+        Only jobs that have already been added are waited for.
+    */
+    void addJob (ThreadPoolJobWithProgress* job, bool takeOwnership,
+                 const juce::Array<ThreadPoolJobWithProgress*>& jobsToWaitFor = {});
 
-    void addJob (ThreadPoolJobWithProgress* job, bool takeOwnership)
-    {
-        if (job == nullptr)
-            return;
+    void removeJob (ThreadPoolJobWithProgress* job, bool interruptIfRunning, int timeOutMilliseconds);
 
-        job->setManager (*this);
-        pool.addJob (job, takeOwnership);
-    }
+    void stopAndDeleteAllRunningJobs();
 
-    void removeJob (ThreadPoolJobWithProgress* job, bool interruptIfRunning, int timeOutMilliseconds)
+    //==============================================================================
+    /** A snapshot of the jobs in one class. */
+    struct ClassStats
     {
-        pool.removeJob (job, interruptIfRunning, timeOutMilliseconds);
-    }
+        int numWaiting = 0;             /**< Including any waiting for other jobs to finish. */
+        int numRunning = 0;
+        int maxNumRunning = 0;
+        double averageWaitSeconds = 0;  /**< How long the jobs that have been started had to wait. */
+        double longestWaitSeconds = 0;  /**< How long the oldest waiting job has been queued. */
+    };
 
-    void stopAndDeleteAllRunningJobs()
-    {
-        // Call this twice as the first call may only stop (and not delete) running jobs
-        pool.removeAllJobs (true, 30000);
-        pool.removeAllJobs (true, 5000);
-        jassert (pool.getNumJobs() == 0);
-    }
+    ClassStats getClassStats (BackgroundJobClass) const;
 
     //==============================================================================
     struct JobInfo
@@ -118,7 +143,11 @@ public:
 
     int getNumJobs() const noexcept                 { const juce::ScopedLock sl (jobsLock); return jobs.size(); }
     float getTotalProgress() const noexcept         { return totalProgress; }
-    juce::ThreadPool& getPool() noexcept            { return pool; }
+
+    /** Returns the pool used for the general class. Jobs added to it directly don't go
+        through the queue, so they aren't limited or counted in its stats.
+    */
+    juce::ThreadPool& getPool() noexcept            { return jobClasses.getUnchecked ((int) BackgroundJobClass::general)->pool; }
 
     //==============================================================================
     class Listener
@@ -142,10 +171,29 @@ private:
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (JobInfoPair)
     };
 
+    struct ScheduledJob
+    {
+        ThreadPoolJobWithProgress* job;
+        bool isOwned, isRunning = false;
+        juce::Array<ThreadPoolJobWithProgress*> jobsToWaitFor;
+        juce::uint32 timeQueued;
+    };
+
+    struct JobClass
+    {
+        JobClass (int numThreads, int threadPriority);
+
+        juce::ThreadPool pool;
+        const int maxNumRunning;
+        juce::OwnedArray<ScheduledJob> scheduledJobs;   // in the order they were added
+        double totalWaitSeconds = 0;
+        int numStarted = 0;
+    };
+
     friend class ThreadPoolJobWithProgress;
     juce::OwnedArray<JobInfoPair> jobs;
     juce::CriticalSection jobsLock;
-    juce::ThreadPool pool;
+    juce::OwnedArray<JobClass> jobClasses;   // indexed by BackgroundJobClass
     juce::ListenerList<Listener> listeners;
     float totalProgress = 1.0f;
     int nextJobId = 0;
@@ -161,15 +209,26 @@ private:
 
     void removeJobInternal (ThreadPoolJobWithProgress& job)
     {
-        const juce::ScopedLock sl (jobsLock);
+        {
+            const juce::ScopedLock sl (jobsLock);
 
-        for (int i = jobs.size(); --i >= 0;)
-            if (&jobs.getUnchecked (i)->job == &job)
-                jobs.remove (i);
+            for (int i = jobs.size(); --i >= 0;)
+                if (&jobs.getUnchecked (i)->job == &job)
+                    jobs.remove (i);
+
+            forgetScheduledJob (&job);
+        }
 
+        startWaitingJobs();
         triggerAsyncUpdate();
     }
 
+    bool isScheduled (ThreadPoolJobWithProgress*) const;
+    bool hasScheduledJobs() const;
+    void forgetScheduledJob (ThreadPoolJobWithProgress*);
+    void startWaitingJobs();
+    void removeAllWaitingJobs();
+
     int getNextJobId() noexcept                     { return ++nextJobId &= 0xffffff; }
 
     void updateJobs()
@@ -207,12 +266,13 @@ private:
         jassert (totalProgress == totalProgress
                   && juce::isPositiveAndNotGreaterThan (totalProgress, 1.0f));
 
-        if (totalProgress >= 1.0f)
+        // Jobs that don't belong to their pool are only noticed finishing by this polling
+        if (totalProgress >= 1.0f && ! hasScheduledJobs())
             stopTimer();
     }
 
     void handleAsyncUpdate() override               { listeners.call (&Listener::backgroundJobsChanged); }
-    void timerCallback() override                   { updateJobs(); }
+    void timerCallback() override                   { startWaitingJobs(); updateJobs(); }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BackgroundJobManager)
 };
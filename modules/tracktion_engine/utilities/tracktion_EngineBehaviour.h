@@ -44,6 +44,16 @@ public:
     /** Gives plugins an opportunity to save custom data when the plugin state gets flushed. */
     virtual void saveCustomPluginProperties (juce::ValueTree&, juce::AudioPluginInstance&, juce::UndoManager*) {}
 
+    /** Should return true if the given plugin can be instantiated on a background thread.
+        This is used when an Edit is loading its plugins in parallel, any plugins that
+        return false will be created with PluginManager::createPluginInstanceAsync.
+        Most formats expect to be created on the message thread so this returns false by default.
+    */
+    virtual bool canCreatePluginInstanceOffMessageThread (const juce::PluginDescription&)
+    {
+        return false;
+    }
+
     /** Return true if your application supports scanning plugins out of process.
 
         If you want to support scanning out of process, the allowing should be added
@@ -84,6 +94,19 @@ public:
 
     virtual int getNumberOfCPUsToUseForAudio()                                      { return juce::jmax (1, juce::SystemStats::getNumCpus()); }
 
+    /** If this returns true, when the playback graph is rebuilt because some tracks
+        have changed, the nodes for the unchanged tracks are moved in to the new graph
+        rather than being re-created and re-prepared.
+    */
+    virtual bool shouldReuseUnchangedTrackNodes()                                   { return true; }
+
+    /** If this returns true, Edits are saved in the BinaryEditFile format, which is
+        much quicker to save and load, rather than as XML.
+        Only enable this if everything that reads your Edit files can load either format,
+        as older versions of the engine and other tools will only be able to read XML.
+    */
+    virtual bool shouldSaveEditsAsBinary()                                          { return false; }
+
     virtual bool areAudioClipsRemappedWhenTempoChanges()                            { return true; }
     virtual void setAudioClipsRemappedWhenTempoChanges (bool)                       {}
     virtual bool areAutoTempoClipsRemappedWhenTempoChanges()                        { return true; }
@@ -220,8 +220,15 @@ void MultiVoiceOscillator::setSampleRate (double sr)
         o->setSampleRate (sr);
 }
 
+void MultiVoiceOscillator::setMaximumBlockSize (int numSamples)
+{
+    voiceBuffer.setSize (1, numSamples, false, false, true);
+}
+
 void MultiVoiceOscillator::setWave (Oscillator::Waves w)
 {
+    wave = w;
+
     for (auto o : oscillators)
         o->setWave (w);
 }
@@ -263,6 +270,49 @@ void MultiVoiceOscillator::setSpread (float s)
 }
 
 void MultiVoiceOscillator::process (juce::AudioSampleBuffer& buffer, int startSample, int numSamples)
+{
+    if (wave == Oscillator::none)
+        return;
+
+    // Noise needs to be decorrelated between the channels so still has to be rendered per side
+    if (wave == Oscillator::noise)
+    {
+        processStereoPairs (buffer, startSample, numSamples);
+        return;
+    }
+
+    // The left and right oscillators of each voice share a phase and note so only
+    // render the left one and pan the result into both channels. Blocks longer than
+    // the one we were prepared for are done in pieces rather than reallocating
+    const int maxNumThisTime = voiceBuffer.getNumSamples();
+    const float base = note - detune / 2;
+    const float delta = voices > 1 ? detune / (voices - 1) : 0.0f;
+
+    for (int voiceIndex = 0; voiceIndex < voices; voiceIndex++)
+    {
+        const float localPan = voices == 1 ? pan
+                                           : jlimit (-1.0f, 1.0f, ((voiceIndex % 2 == 0) ? 1 : -1) * spread);
+
+        auto& o = *oscillators.getUnchecked (voiceIndex * 2);
+        o.setGain (gain / voices);
+        o.setNote (voices == 1 ? note : base + delta * voiceIndex);
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int numThisTime = jmin (maxNumThisTime, numSamples - done);
+
+            voiceBuffer.clear (0, 0, numThisTime);
+            o.process (voiceBuffer, 0, numThisTime);
+
+            buffer.addFrom (0, startSample + done, voiceBuffer, 0, 0, numThisTime, 1.0f - localPan);
+            buffer.addFrom (1, startSample + done, voiceBuffer, 0, 0, numThisTime, 1.0f + localPan);
+
+            done += numThisTime;
+        }
+    }
+}
+
+void MultiVoiceOscillator::processStereoPairs (juce::AudioSampleBuffer& buffer, int startSample, int numSamples)
 {
     if (voices == 1)
     {
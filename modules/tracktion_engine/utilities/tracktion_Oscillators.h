@@ -90,6 +90,7 @@ public:
 
     void start();
     void setSampleRate (double sr);
+    void setMaximumBlockSize (int numSamples);
     void setWave (Oscillator::Waves w);
     void setNote (float n);
     void setGain (float g);
@@ -103,8 +104,12 @@ public:
     void process (juce::AudioSampleBuffer& buffer, int startSample, int numSamples);
 
 private:
+    void processStereoPairs (juce::AudioSampleBuffer& buffer, int startSample, int numSamples);
+
     juce::OwnedArray<Oscillator> oscillators;
+    juce::AudioSampleBuffer voiceBuffer {1, 512};
 
+    Oscillator::Waves wave = Oscillator::sine;
     int voices = 1;
     float detune = 0, spread = 0, gain = 1.0f, note = 69.0f, pan = 0.0f;
 };
@@ -108,6 +108,7 @@ String PropertyStorage::settingToString (SettingID setting)
         case SettingID::renameClipRenamesSource:       return "renameClipRenamesSource";
         case SettingID::renameMode:                    return "renameMode";
         case SettingID::renderRecentFilesList:         return "renderRecentFilesList";
+        case SettingID::resamplingQuality:             return "resamplingQuality";
         case SettingID::safeRecord:                    return "safeRecord";
         case SettingID::resetCursorOnStop:             return "resetCursorOnStop";
         case SettingID::retrospectiveRecord:           return "retrospectiveRecord";
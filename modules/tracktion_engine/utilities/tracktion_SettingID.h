@@ -77,6 +77,7 @@ enum class SettingID
     renameClipRenamesSource,
     renameMode,
     renderRecentFilesList,
+    resamplingQuality,
     resetCursorOnStop,
     retrospectiveRecord,
     reWireEnabled,
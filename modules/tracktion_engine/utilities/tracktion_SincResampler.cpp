@@ -0,0 +1,278 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+/**
+    Holds a Kaiser-windowed sinc filter sampled at a number of fractional phases.
+    These are shared between all the resamplers using the same quality and cut-off.
+*/
+class SincResampler::FilterTable  : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<FilterTable>;
+
+    static Ptr getTable (Quality q, double nominalSpeedRatio)
+    {
+        // Quantise the cut-off so slightly different ratios share the same table
+        auto cutoff = std::round (getPassband (q) / std::max (1.0, nominalSpeedRatio) * 1000.0) / 1000.0;
+
+        static juce::CriticalSection lock;
+        static juce::ReferenceCountedArray<FilterTable> tableCache;
+        const juce::ScopedLock sl (lock);
+
+        for (auto table : tableCache)
+            if (table->quality == q && table->cutoff == cutoff)
+                return table;
+
+        Ptr table = new FilterTable (q, cutoff);
+        tableCache.add (table);
+        return table;
+    }
+
+    /** Returns the row of coefficients for a fractional position between 0 and numPhases. */
+    const float* getPhase (int phase) const noexcept        { return coefficients + phase * numTaps; }
+
+    const Quality quality;
+    const double cutoff;
+    const int numTaps, numPhases;
+
+private:
+    juce::HeapBlock<float> coefficients;
+
+    FilterTable (Quality q, double cutoffToUse)
+        : quality (q), cutoff (cutoffToUse),
+          numTaps (getNumTaps (q)), numPhases (getNumPhases (q))
+    {
+        const double beta = getKaiserBeta (q);
+        const double halfLength = numTaps / 2;
+        coefficients.calloc ((size_t) ((numPhases + 1) * numTaps));
+
+        // Row p is for an output sample p / numPhases of the way between taps
+        // (numTaps / 2 - 1) and (numTaps / 2), so the extra last row is the first
+        // shifted by one tap which keeps the interpolation between rows simple
+        for (int p = 0; p <= numPhases; ++p)
+        {
+            auto row = coefficients + p * numTaps;
+            double sum = 0.0;
+
+            for (int i = 0; i < numTaps; ++i)
+            {
+                const double x = i - (halfLength - 1.0) - p / (double) numPhases;
+                const double windowPos = x / halfLength;
+
+                if (std::abs (windowPos) >= 1.0)
+                    continue;
+
+                const double sinc = x == 0.0 ? 1.0 : std::sin (juce::MathConstants<double>::pi * cutoff * x)
+                                                        / (juce::MathConstants<double>::pi * cutoff * x);
+                const double window = besselI0 (beta * std::sqrt (1.0 - windowPos * windowPos)) / besselI0 (beta);
+                row[i] = (float) (sinc * window);
+                sum += row[i];
+            }
+
+            // Normalise each phase so DC passes through at unity gain
+            if (sum != 0.0)
+                juce::FloatVectorOperations::multiply (row, (float) (1.0 / sum), numTaps);
+        }
+    }
+
+    static int getNumTaps (Quality q)
+    {
+        switch (q)
+        {
+            case Quality::low:      return 8;
+            case Quality::medium:   return 16;
+            case Quality::high:     return 32;
+        }
+
+        return 16;
+    }
+
+    static int getNumPhases (Quality q)         { return q == Quality::high ? 512 : 256; }
+    static double getKaiserBeta (Quality q)     { return q == Quality::low ? 5.0 : (q == Quality::medium ? 7.0 : 9.0); }
+    static double getPassband (Quality q)       { return q == Quality::low ? 0.8 : (q == Quality::medium ? 0.9 : 0.95); }
+
+    static double besselI0 (double x)
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 32 && term > sum * 1.0e-12; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilterTable)
+};
+
+//==============================================================================
+void SincResampler::prepare (Quality q, double nominalSpeedRatio)
+{
+    auto newFilter = FilterTable::getTable (q, nominalSpeedRatio);
+
+    if (filter == nullptr || newFilter->numTaps != filter->numTaps)
+        history.calloc ((size_t) (2 * newFilter->numTaps));
+
+    filter = newFilter;
+    reset();
+}
+
+void SincResampler::reset() noexcept
+{
+    if (filter != nullptr)
+        juce::FloatVectorOperations::clear (history, 2 * filter->numTaps);
+
+    historyPos = 0;
+    subSamplePos = 1.0;
+}
+
+int SincResampler::getNumTaps() const noexcept
+{
+    return filter != nullptr ? filter->numTaps : 0;
+}
+
+void SincResampler::pushSample (float sample) noexcept
+{
+    // The history is stored twice so the latest numTaps samples are always contiguous
+    const int numTaps = filter->numTaps;
+    history[historyPos] = sample;
+    history[historyPos + numTaps] = sample;
+
+    if (++historyPos == numTaps)
+        historyPos = 0;
+}
+
+float SincResampler::getInterpolatedSample (double fraction) const noexcept
+{
+    const int numTaps = filter->numTaps;
+    const double phasePos = fraction * filter->numPhases;
+    const int phase = juce::jlimit (0, filter->numPhases - 1, (int) phasePos);
+    const float alpha = (float) (phasePos - phase);
+
+    const float* samples = history + historyPos;
+    const float* coeffs1 = filter->getPhase (phase);
+    const float* coeffs2 = filter->getPhase (phase + 1);
+
+    // Two straight dot products so these vectorise well
+    float sum1 = 0.0f, sum2 = 0.0f;
+
+    for (int i = 0; i < numTaps; ++i)
+        sum1 += samples[i] * coeffs1[i];
+
+    for (int i = 0; i < numTaps; ++i)
+        sum2 += samples[i] * coeffs2[i];
+
+    return sum1 + alpha * (sum2 - sum1);
+}
+
+void SincResampler::prime (const float* input, int numInputSamples) noexcept
+{
+    jassert (isPrepared());
+
+    for (int i = 0; i < numInputSamples; ++i)
+        pushSample (input[i]);
+}
+
+int SincResampler::processAdding (double speedRatio, const float* input, float* output,
+                                  int numOutputSamples, float gain) noexcept
+{
+    jassert (isPrepared());
+    int numUsed = 0;
+
+    for (int i = 0; i < numOutputSamples; ++i)
+    {
+        while (subSamplePos >= 1.0)
+        {
+            pushSample (input[numUsed++]);
+            subSamplePos -= 1.0;
+        }
+
+        output[i] += gain * getInterpolatedSample (subSamplePos);
+        subSamplePos += speedRatio;
+    }
+
+    return numUsed;
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class SincResamplerTests  : public juce::UnitTest
+{
+public:
+    SincResamplerTests()
+        : juce::UnitTest ("SincResampler", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        for (auto quality : { SincResampler::Quality::low, SincResampler::Quality::medium, SincResampler::Quality::high })
+        {
+            const double maxErrorDb = quality == SincResampler::Quality::low ? -40.0 : -60.0;
+
+            beginTest ("Unity ratio " + String ((int) quality));
+            expectLessThan (getErrorDb (quality, 1.0, 1000.0), maxErrorDb);
+
+            beginTest ("Upsampling " + String ((int) quality));
+            expectLessThan (getErrorDb (quality, 44100.0 / 48000.0, 1000.0), maxErrorDb);
+
+            beginTest ("Downsampling " + String ((int) quality));
+            expectLessThan (getErrorDb (quality, 96000.0 / 44100.0, 1000.0), maxErrorDb);
+        }
+    }
+
+    /** Resamples a sine to 44.1KHz and returns the RMS difference to the ideal output relative to the sine's level. */
+    static double getErrorDb (SincResampler::Quality quality, double ratio, double frequency)
+    {
+        const double inputRate = 44100.0 * ratio;
+        const int numOutputSamples = 4096, blockSize = 256;
+
+        SincResampler resampler;
+        resampler.prepare (quality, ratio);
+
+        // The input starts early enough to prime the resampler so the first output lines up with input sample 0
+        const int numPriming = resampler.getNumPrimingSamples();
+        const int firstInputSample = 1 - resampler.getLatencySamples();
+        std::vector<float> input ((size_t) (numOutputSamples * ratio + numPriming + 64));
+
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = (float) std::sin (MathConstants<double>::twoPi * frequency * ((int) i + firstInputSample) / inputRate);
+
+        resampler.prime (input.data(), numPriming);
+
+        std::vector<float> output ((size_t) numOutputSamples, 0.0f);
+        int inputPos = numPriming;
+
+        for (int start = 0; start < numOutputSamples; start += blockSize)
+            inputPos += resampler.processAdding (ratio, input.data() + inputPos, output.data() + start, blockSize, 1.0f);
+
+        double errorSquared = 0.0;
+
+        for (int i = 0; i < numOutputSamples; ++i)
+        {
+            const double error = output[(size_t) i] - std::sin (MathConstants<double>::twoPi * frequency * i / 44100.0);
+            errorSquared += error * error;
+        }
+
+        return Decibels::gainToDecibels (std::sqrt (errorSquared / numOutputSamples) * MathConstants<double>::sqrt2, -200.0);
+    }
+};
+
+static SincResamplerTests sincResamplerTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
+} // namespace tracktion_engine
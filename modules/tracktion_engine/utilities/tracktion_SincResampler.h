@@ -0,0 +1,84 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+/**
+    A streaming windowed-sinc resampler using a table of polyphase filters.
+
+    This works in the same way as juce::LagrangeInterpolator, consuming as many input
+    samples as it needs to produce the requested number of output samples, but with
+    a properly band-limited filter so it can be used for high quality sample-rate
+    conversion.
+
+    The output lags the input by getLatencySamples() input samples. To line the output
+    up with a given input position, either feed it from that many samples later or,
+    after a reset(), prime() it with the getNumPrimingSamples() before that position.
+*/
+class SincResampler
+{
+public:
+    /** The quality of the filter. Higher qualities use longer filters so cost more CPU. */
+    enum class Quality
+    {
+        low,        /**< 8 taps, for previewing or very large sessions. */
+        medium,     /**< 16 taps. */
+        high        /**< 32 taps, for final renders. */
+    };
+
+    SincResampler() = default;
+
+    /** Prepares the filter for a quality and the ratio of input to output samples it'll
+        mostly be used with. The ratio is used to lower the cut-off when downsampling.
+        This allocates so should be called before playback starts.
+    */
+    void prepare (Quality, double nominalSpeedRatio);
+
+    /** Returns true if prepare() has been called. */
+    bool isPrepared() const noexcept                { return filter != nullptr; }
+
+    /** Clears the filter's history. */
+    void reset() noexcept;
+
+    /** Pushes some input samples into the filter's history without producing any output. */
+    void prime (const float* input, int numInputSamples) noexcept;
+
+    /** Resamples the input, multiplying by a gain and adding the result to the output.
+        @returns the number of input samples that were used
+    */
+    int processAdding (double speedRatio, const float* input, float* output,
+                       int numOutputSamples, float gain) noexcept;
+
+    /** Returns the number of input samples each output sample is calculated from. */
+    int getNumTaps() const noexcept;
+
+    /** Returns the number of input samples the output lags the input by. */
+    int getLatencySamples() const noexcept          { return getNumTaps() / 2; }
+
+    /** Returns the number of samples to prime() with after a reset() so that the
+        next output sample lines up with the input sample after them.
+    */
+    int getNumPrimingSamples() const noexcept       { return getNumTaps() - 1; }
+
+private:
+    //==============================================================================
+    class FilterTable;
+    juce::ReferenceCountedObjectPtr<FilterTable> filter;
+    juce::HeapBlock<float> history;
+    int historyPos = 0;
+    double subSamplePos = 1.0;
+
+    void pushSample (float) noexcept;
+    float getInterpolatedSample (double fraction) const noexcept;
+};
+
+} // namespace tracktion_engine
@@ -146,6 +146,11 @@ public:
     */
     virtual juce::Array<Track*> getEditingTracks (Edit&)                            { return {}; }
 
+    /** Can return the section of an Edit that's currently visible on screen.
+        This is used to decide which proxies to render first.
+    */
+    virtual EditTimeRange getVisibleTimeRange (Edit&)                               { return {}; }
+
     //==============================================================================
     /** If your UI has the concept of edit groups, you should return an expanded list of
         selected items that includes all clips that should be edited with the selected
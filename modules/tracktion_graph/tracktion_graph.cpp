@@ -22,6 +22,8 @@
 //==============================================================================
 #include "tracktion_graph/tracktion_graph_tests_Utilities.h"
 #include "tracktion_graph/tracktion_graph_tests_TestNodes.h"
+#include "tracktion_graph/tracktion_graph_tests_Benchmarks.h"
 
 #include "tracktion_graph/tracktion_graph_tests_Node.cpp"
 #include "tracktion_graph/tracktion_graph_tests_NodeVisiting.cpp"
+#include "tracktion_graph/tracktion_graph_tests_Benchmarks.cpp"
@@ -11,6 +11,8 @@
 #pragma once
 
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <emmintrin.h>
 
 namespace tracktion_graph
@@ -18,12 +20,169 @@ namespace tracktion_graph
 
 /**
     Plays back a node with mutiple threads.
+    The threads can either belong to the player or come from a ThreadPool shared
+    between several players, so that lots of players running at once don't each
+    start their own threads and oversubscribe the CPU.
 */
 class MultiThreadedNodePlayer
 {
 public:
-    MultiThreadedNodePlayer (std::unique_ptr<Node> node)
-        : rootNode (std::move (node))
+    //==============================================================================
+    /**
+        A set of worker threads that help any players using it process their Nodes.
+        Workers spin for a short while after running out of Nodes to process and then
+        sleep until a player starts its next block.
+    */
+    class ThreadPool
+    {
+    public:
+        ThreadPool (size_t numThreadsToUse)
+        {
+            for (size_t i = 0; i < numThreadsToUse; ++i)
+                threads.emplace_back ([this] { processNextFreeNodeOrWait(); });
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock (wakeUpMutex);
+                threadsShouldExit = true;
+            }
+
+            wakeUpThreads.notify_all();
+
+            for (auto& t : threads)
+                t.join();
+        }
+
+        size_t getNumThreads() const
+        {
+            return threads.size();
+        }
+
+    private:
+        friend class MultiThreadedNodePlayer;
+        static constexpr size_t maxNumActivePlayers = 32;
+
+        std::vector<std::thread> threads;
+        std::atomic<MultiThreadedNodePlayer*> activePlayers[maxNumActivePlayers] {};
+        std::atomic<int> numThreadsUsingSlot[maxNumActivePlayers] {};
+        std::atomic<size_t> numSleepingThreads { 0 };
+        std::atomic<bool> threadsShouldExit { false };
+
+        std::mutex wakeUpMutex;
+        std::condition_variable wakeUpThreads;
+
+        /** Lets the workers start helping a player for the block it's processing.
+            Returns the slot the player was added to or -1 if there weren't any free.
+        */
+        int addActivePlayer (MultiThreadedNodePlayer& player, size_t numThreadsWanted)
+        {
+            for (size_t i = 0; i < maxNumActivePlayers; ++i)
+            {
+                MultiThreadedNodePlayer* expected = nullptr;
+
+                if (activePlayers[i].compare_exchange_strong (expected, &player))
+                {
+                    // Only wake as many sleeping threads as can be used, and skip the
+                    // notification altogether when they're all still spinning
+                    for (auto numToWake = std::min (numThreadsWanted, numSleepingThreads.load());
+                         numToWake > 0; --numToWake)
+                        wakeUpThreads.notify_one();
+
+                    return (int) i;
+                }
+            }
+
+            return -1;
+        }
+
+        /** Stops the workers helping a player, waiting for any still looking at it. */
+        void removeActivePlayer (int slot)
+        {
+            activePlayers[slot] = nullptr;
+
+            while (numThreadsUsingSlot[slot] > 0)
+                pause();
+        }
+
+        bool hasActivePlayers() const
+        {
+            for (auto& p : activePlayers)
+                if (p.load (std::memory_order_relaxed) != nullptr)
+                    return true;
+
+            return false;
+        }
+
+        bool processActivePlayers()
+        {
+            bool processedAny = false;
+
+            for (size_t i = 0; i < maxNumActivePlayers; ++i)
+            {
+                if (activePlayers[i].load (std::memory_order_relaxed) == nullptr)
+                    continue;
+
+                // The player can't finish its block while this is using its slot
+                ++numThreadsUsingSlot[i];
+
+                if (auto player = activePlayers[i].load())
+                    while (player->processNextFreeNode())
+                        processedAny = true;
+
+                --numThreadsUsingSlot[i];
+            }
+
+            return processedAny;
+        }
+
+        void processNextFreeNodeOrWait()
+        {
+            int numSpins = 0;
+
+            for (;;)
+            {
+                if (threadsShouldExit)
+                    return;
+
+                if (processActivePlayers())
+                {
+                    numSpins = 0;
+                }
+                else if (++numSpins < 1000)
+                {
+                    pause();
+                }
+                else
+                {
+                    // Players don't take the lock when they notify so a wake-up can be
+                    // missed, but they will still process any Nodes left themselves
+                    std::unique_lock<std::mutex> lock (wakeUpMutex);
+                    ++numSleepingThreads;
+                    wakeUpThreads.wait (lock, [this] { return threadsShouldExit || hasActivePlayers(); });
+                    --numSleepingThreads;
+                    numSpins = 0;
+                }
+            }
+        }
+    };
+
+    //==============================================================================
+    /** Creates a player for a Node which starts its own threads.
+        @param maxNumThreadsToUse   The most worker threads to use in addition to
+                                    the thread calling process()
+    */
+    MultiThreadedNodePlayer (std::unique_ptr<Node> node,
+                             size_t maxNumThreadsToUse = std::thread::hardware_concurrency())
+        : rootNode (std::move (node)), maxNumThreads (maxNumThreadsToUse)
+    {
+    }
+
+    /** Creates a player for a Node which uses the threads from a shared ThreadPool. */
+    MultiThreadedNodePlayer (std::unique_ptr<Node> node, std::shared_ptr<ThreadPool> sharedThreadPool)
+        : rootNode (std::move (node)), maxNumThreads (sharedThreadPool->getNumThreads()),
+          threadPool (std::move (sharedThreadPool)), ownsThreadPool (false)
     {
     }
     
@@ -36,6 +195,12 @@ public:
     {
         return *rootNode;
     }
+
+    /** Returns the number of worker threads that can help in addition to the thread calling process(). */
+    size_t getNumThreads() const
+    {
+        return threadPool != nullptr ? std::min (numThreadsWanted, threadPool->getNumThreads()) : 0;
+    }
     
     void setNode (std::unique_ptr<Node> newNode)
     {
@@ -74,9 +239,9 @@ public:
         for (auto node : allNodes)
             node->prepareForNextBlock();
 
-        // Then set the vector to be processed
-        // Threads are always running so will process as soon numNodesLeftToProcess is non-zero
+        // Then set the vector to be processed and let the threads know they can help
         numNodesLeftToProcess = allNodes.size();
+        const int slot = threadPool != nullptr ? threadPool->addActivePlayer (*this, numThreadsWanted) : -1;
         
         // Try to process Nodes until they're all processed
         for (;;)
@@ -89,6 +254,9 @@ public:
         while (! rootNode->hasProcessed())
             pause();
 
+        if (slot >= 0)
+            threadPool->removeActivePlayer (slot);
+
         auto output = rootNode->getProcessedOutput();
         pc.buffers.audio.copyFrom (output.audio);
         pc.buffers.midi.copyFrom (output.midi);
@@ -99,12 +267,15 @@ public:
 private:
     //==============================================================================
     std::unique_ptr<Node> rootNode;
-    std::vector<std::thread> threads;
     std::vector<Node*> allNodes;
     
     juce::Range<int64_t> streamSampleRange;
-    std::atomic<bool> threadsShouldExit { false };
     std::atomic<size_t> numNodesLeftToProcess { 0 };
+    const size_t maxNumThreads;
+    size_t numThreadsWanted = 0;
+
+    std::shared_ptr<ThreadPool> threadPool;
+    const bool ownsThreadPool = true;
 
     //==============================================================================
     double sampleRate = 44100.0;
@@ -113,12 +284,8 @@ private:
     //==============================================================================
     void clearThreads()
     {
-        threadsShouldExit = true;
-
-        for (auto& t : threads)
-            t.join();
-        
-        threads.clear();
+        if (ownsThreadPool)
+            threadPool.reset();
     }
     
     void createThreads()
@@ -129,13 +296,19 @@ private:
             if (node->isReadyToProcess())
                 ++numThreadsToUse;
         
-        numThreadsToUse = std::min (numThreadsToUse, (size_t) std::thread::hardware_concurrency()) - 1;
-             
-        for (size_t i = 0; i < numThreadsToUse; ++i)
-            threads.emplace_back ([this] { processNextFreeNodeOrWait(); });
+        numThreadsToUse = std::min ({ numThreadsToUse, maxNumThreads + 1, (size_t) std::thread::hardware_concurrency() });
+        numThreadsWanted = numThreadsToUse > 0 ? numThreadsToUse - 1 : 0;
+
+        if (ownsThreadPool)
+        {
+            threadPool.reset();
+
+            if (numThreadsWanted > 0)
+                threadPool = std::make_shared<ThreadPool> (numThreadsWanted);
+        }
     }
     
-    inline void pause()
+    static inline void pause()
     {
         _mm_pause();
         _mm_pause();
@@ -148,18 +321,6 @@ private:
     }
 
     //==============================================================================
-    void processNextFreeNodeOrWait()
-    {
-        for (;;)
-        {
-            if (threadsShouldExit)
-                return;
-            
-            if (! processNextFreeNode())
-                pause();
-        }
-    }
-
     bool processNextFreeNode()
     {
         size_t expectedNumNodesLeft = numNodesLeftToProcess;
@@ -0,0 +1,102 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_graph
+{
+
+using namespace benchmark_utilities;
+
+//==============================================================================
+//==============================================================================
+/**
+    Measures the NodePlayer and MultiThreadedNodePlayer with a range of generated graphs.
+    Each result is logged as a single line of JSON so they can be collected and compared
+    between runs. These are in their own category so aren't run with the other tests.
+*/
+class GraphBenchmarks : public juce::UnitTest
+{
+public:
+    GraphBenchmarks()
+        : juce::UnitTest ("GraphBenchmarks", "tracktion_graph:Benchmarks")
+    {
+    }
+
+    void runTest() override
+    {
+        const double sampleRate = 44100.0;
+        const int blockSize = 256;
+        const int numBlocks = 1000;
+
+        for (auto options : getGraphOptions())
+        {
+            const auto name = juce::String (getName (options.shape)) + "_" + juce::String (options.size)
+                                + "_work" + juce::String (options.workPerSample)
+                                + (options.maxLatencyNumSamples > 0 ? "_latency" : "");
+            beginTest (name);
+
+            {
+                WorkStats stats;
+                NodePlayer player (createBenchmarkGraph (options, stats));
+                player.prepareToPlay (sampleRate, blockSize);
+                logResult (runBenchmark (name, "NodePlayer", player, stats, 1, sampleRate, blockSize, numBlocks));
+            }
+
+            for (size_t maxNumThreads : getThreadCountsToTest())
+            {
+                WorkStats stats;
+                MultiThreadedNodePlayer player (createBenchmarkGraph (options, stats), maxNumThreads);
+                player.prepareToPlay (sampleRate, blockSize);
+                logResult (runBenchmark (name, "MultiThreadedNodePlayer", player, stats,
+                                         player.getNumThreads() + 1, sampleRate, blockSize, numBlocks));
+            }
+        }
+    }
+
+private:
+    static std::vector<GraphOptions> getGraphOptions()
+    {
+        std::vector<GraphOptions> options;
+
+        for (int workPerSample : { 0, 8 })
+        {
+            options.push_back ({ GraphShape::wideFan, 64, 2, workPerSample });
+            options.push_back ({ GraphShape::deepChain, 64, 2, workPerSample });
+            options.push_back ({ GraphShape::sendReturnMesh, 64, 2, workPerSample, 8 });
+            options.push_back ({ GraphShape::latencyTree, 5, 2, workPerSample, 0, 512 });
+        }
+
+        return options;
+    }
+
+    /** Returns the numbers of worker threads to measure the scaling with, up to the number of cores. */
+    static std::vector<size_t> getThreadCountsToTest()
+    {
+        std::vector<size_t> counts;
+        const size_t numCores = std::max (1u, std::thread::hardware_concurrency());
+
+        for (size_t numThreads = 1; numThreads < numCores; numThreads *= 2)
+            counts.push_back (numThreads);
+
+        counts.push_back (numCores - 1);
+        counts.erase (std::unique (counts.begin(), counts.end()), counts.end());
+
+        return counts;
+    }
+
+    void logResult (const BenchmarkResult& result)
+    {
+        expect (result.realTimeFactor > 0.0);
+        logMessage (result.toJSON());
+    }
+};
+
+static GraphBenchmarks graphBenchmarks;
+
+}
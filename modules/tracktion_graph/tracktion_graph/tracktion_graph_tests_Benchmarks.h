@@ -0,0 +1,327 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+namespace benchmark_utilities
+{
+    /** Accumulates the time spent doing synthetic work across all the threads processing a graph. */
+    struct WorkStats
+    {
+        std::atomic<juce::int64> busyTicks { 0 };
+    };
+
+    //==============================================================================
+    /**
+        Passes its input on after doing a configurable amount of synthetic work for
+        each sample, optionally reporting some latency so that the graph has to be
+        balanced with LatencyNodes.
+    */
+    class SyntheticWorkNode : public Node
+    {
+    public:
+        SyntheticWorkNode (std::unique_ptr<Node> inputNode, WorkStats& statsToUse,
+                           int workPerSampleToUse, int latencyNumSamplesToReport)
+            : input (std::move (inputNode)), stats (statsToUse),
+              workPerSample (workPerSampleToUse), latencyNumSamples (latencyNumSamplesToReport)
+        {
+        }
+
+        NodeProperties getNodeProperties() override
+        {
+            auto props = input->getNodeProperties();
+            props.latencyNumSamples += latencyNumSamples;
+
+            return props;
+        }
+
+        std::vector<Node*> getDirectInputNodes() override
+        {
+            return { input.get() };
+        }
+
+        bool isReadyToProcess() override
+        {
+            return input->hasProcessed();
+        }
+
+        void process (const ProcessContext& pc) override
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            auto inputBuffer = input->getProcessedOutput().audio;
+
+            const int numSamples = (int) pc.streamSampleRange.getLength();
+            const int numChannels = std::min ((int) inputBuffer.getNumChannels(), (int) pc.buffers.audio.getNumChannels());
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                const float* inputSamples = inputBuffer.getChannelPointer ((size_t) c);
+                float* outputSamples = pc.buffers.audio.getChannelPointer ((size_t) c);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    // A dependent chain of operations so this can't be optimised away or vectorised
+                    float value = inputSamples[i];
+
+                    for (int w = 0; w < workPerSample; ++w)
+                        value = value * 0.999f + std::sin (value) * 0.001f;
+
+                    outputSamples[i] = value;
+                }
+            }
+
+            pc.buffers.midi.mergeFrom (input->getProcessedOutput().midi);
+            stats.busyTicks += juce::Time::getHighResolutionTicks() - startTicks;
+        }
+
+    private:
+        std::unique_ptr<Node> input;
+        WorkStats& stats;
+        const int workPerSample, latencyNumSamples;
+    };
+
+    //==============================================================================
+    /** The shapes of graph that can be generated. */
+    enum class GraphShape
+    {
+        wideFan,            /**< Many parallel sources summed together. */
+        deepChain,          /**< A single source processed by a long chain of nodes. */
+        sendReturnMesh,     /**< Sources sending to a number of busses which are all summed together. */
+        latencyTree         /**< A binary tree of summed sources with random latencies to be balanced. */
+    };
+
+    static inline const char* getName (GraphShape shape)
+    {
+        switch (shape)
+        {
+            case GraphShape::wideFan:           return "wideFan";
+            case GraphShape::deepChain:         return "deepChain";
+            case GraphShape::sendReturnMesh:    return "sendReturnMesh";
+            case GraphShape::latencyTree:       return "latencyTree";
+        }
+
+        return "";
+    }
+
+    /** Describes a graph to generate. The same options will always generate the same graph. */
+    struct GraphOptions
+    {
+        GraphShape shape = GraphShape::wideFan;
+        int size = 32;                      /**< The number of sources, chain length or tree depth. */
+        int numChannels = 2;
+        int workPerSample = 8;              /**< The synthetic cost of each processing node. */
+        int numBusses = 4;                  /**< The number of busses in a sendReturnMesh. */
+        int maxLatencyNumSamples = 0;       /**< The maximum latency each processing node reports. */
+        juce::int64 seed = 1;
+    };
+
+    /** Generates a graph to benchmark, with its processing nodes adding their time to a WorkStats. */
+    static inline std::unique_ptr<Node> createBenchmarkGraph (const GraphOptions& options, WorkStats& stats)
+    {
+        juce::Random random (options.seed);
+
+        auto makeSource = [&]
+        {
+            return makeNode<SinNode> (random.nextFloat() * 1000.0f + 100.0f, options.numChannels);
+        };
+
+        auto makeWork = [&] (std::unique_ptr<Node> input)
+        {
+            const int latency = options.maxLatencyNumSamples > 0 ? random.nextInt (options.maxLatencyNumSamples + 1) : 0;
+            return makeNode<SyntheticWorkNode> (std::move (input), stats, options.workPerSample, latency);
+        };
+
+        switch (options.shape)
+        {
+            case GraphShape::wideFan:
+            {
+                std::vector<std::unique_ptr<Node>> sources;
+
+                for (int i = 0; i < options.size; ++i)
+                    sources.push_back (makeWork (makeSource()));
+
+                return makeNode<SummingNode> (std::move (sources));
+            }
+
+            case GraphShape::deepChain:
+            {
+                auto node = makeSource();
+
+                for (int i = 0; i < options.size; ++i)
+                    node = makeWork (std::move (node));
+
+                return node;
+            }
+
+            case GraphShape::sendReturnMesh:
+            {
+                std::vector<std::unique_ptr<Node>> tracks;
+
+                for (int i = 0; i < options.size; ++i)
+                    tracks.push_back (makeNode<SendNode> (makeWork (makeSource()), i % options.numBusses));
+
+                for (int bus = 0; bus < options.numBusses; ++bus)
+                    tracks.push_back (makeWork (makeNode<ReturnNode> (makeNode<SilentNode> (options.numChannels), bus)));
+
+                return makeNode<SummingNode> (std::move (tracks));
+            }
+
+            case GraphShape::latencyTree:
+            {
+                std::function<std::unique_ptr<Node> (int)> makeTree = [&] (int depth) -> std::unique_ptr<Node>
+                {
+                    if (depth <= 0)
+                        return makeWork (makeSource());
+
+                    std::vector<std::unique_ptr<Node>> children;
+                    children.push_back (makeTree (depth - 1));
+                    children.push_back (makeTree (depth - 1));
+
+                    return makeWork (makeNode<SummingNode> (std::move (children)));
+                };
+
+                return makeTree (options.size);
+            }
+        }
+
+        jassertfalse;
+        return {};
+    }
+
+    //==============================================================================
+    /** The results of a benchmark run. */
+    struct BenchmarkResult
+    {
+        juce::String name, playerName;
+        GraphOptions options;
+        size_t numNodes = 0, numThreads = 0;
+        double sampleRate = 0.0;
+        int blockSize = 0, numBlocks = 0;
+
+        double blockMicrosecondsP50 = 0.0, blockMicrosecondsP90 = 0.0,
+               blockMicrosecondsP99 = 0.0, blockMicrosecondsMax = 0.0;
+        double realTimeFactor = 0.0;        /**< The duration of audio processed for each second taken. */
+        double threadUtilisation = 0.0;     /**< The proportion of the processing threads' time spent doing synthetic work. */
+
+        /** Returns the results as a JSON object. */
+        juce::var toVar() const
+        {
+            auto o = new juce::DynamicObject();
+            o->setProperty ("benchmark", name);
+            o->setProperty ("player", playerName);
+            o->setProperty ("shape", getName (options.shape));
+            o->setProperty ("size", options.size);
+            o->setProperty ("numChannels", options.numChannels);
+            o->setProperty ("workPerSample", options.workPerSample);
+            o->setProperty ("maxLatencyNumSamples", options.maxLatencyNumSamples);
+            o->setProperty ("numNodes", (int) numNodes);
+            o->setProperty ("numThreads", (int) numThreads);
+            o->setProperty ("sampleRate", sampleRate);
+            o->setProperty ("blockSize", blockSize);
+            o->setProperty ("numBlocks", numBlocks);
+            o->setProperty ("blockMicrosecondsP50", blockMicrosecondsP50);
+            o->setProperty ("blockMicrosecondsP90", blockMicrosecondsP90);
+            o->setProperty ("blockMicrosecondsP99", blockMicrosecondsP99);
+            o->setProperty ("blockMicrosecondsMax", blockMicrosecondsMax);
+            o->setProperty ("realTimeFactor", realTimeFactor);
+            o->setProperty ("threadUtilisation", threadUtilisation);
+
+            return juce::var (o);
+        }
+
+        /** Returns the results as a single line of JSON. */
+        juce::String toJSON() const
+        {
+            return juce::JSON::toString (toVar(), true);
+        }
+    };
+
+    /** Processes a graph for a number of blocks, timing each one.
+        The first few blocks are used to warm up and aren't included in the results.
+        @param numThreads   The number of threads the player uses, including the calling thread
+    */
+    template<typename PlayerType>
+    static inline BenchmarkResult runBenchmark (const juce::String& name, const juce::String& playerName,
+                                                PlayerType& player, WorkStats& stats, size_t numThreads,
+                                                double sampleRate, int blockSize, int numBlocks)
+    {
+        BenchmarkResult result;
+        result.name = name;
+        result.playerName = playerName;
+        result.numNodes = getNodes (player.getNode(), VertexOrdering::postordering).size();
+        result.numThreads = numThreads;
+        result.sampleRate = sampleRate;
+        result.blockSize = blockSize;
+        result.numBlocks = numBlocks;
+
+        const int numChannels = std::max (1, player.getNode().getNodeProperties().numberOfChannels);
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        tracktion_engine::MidiMessageArray midi;
+        std::vector<double> blockTimes ((size_t) numBlocks);
+
+        constexpr int numWarmUpBlocks = 16;
+        int64_t samplePosition = 0;
+        juce::int64 totalTicks = 0;
+
+        for (int i = -numWarmUpBlocks; i < numBlocks; ++i)
+        {
+            if (i == 0)
+                stats.busyTicks = 0;
+
+            buffer.clear();
+            midi.clear();
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            player.process ({ juce::Range<int64_t>::withStartAndLength (samplePosition, (int64_t) blockSize),
+                              { { buffer }, midi } });
+            const auto ticksTaken = juce::Time::getHighResolutionTicks() - startTicks;
+            samplePosition += blockSize;
+
+            if (i >= 0)
+            {
+                blockTimes[(size_t) i] = juce::Time::highResolutionTicksToSeconds (ticksTaken) * 1.0e6;
+                totalTicks += ticksTaken;
+            }
+        }
+
+        if (numBlocks > 0)
+        {
+            std::sort (blockTimes.begin(), blockTimes.end());
+
+            auto getPercentile = [&] (double percentile)
+            {
+                return blockTimes[std::min (blockTimes.size() - 1, (size_t) (percentile * blockTimes.size()))];
+            };
+
+            result.blockMicrosecondsP50 = getPercentile (0.5);
+            result.blockMicrosecondsP90 = getPercentile (0.9);
+            result.blockMicrosecondsP99 = getPercentile (0.99);
+            result.blockMicrosecondsMax = blockTimes.back();
+
+            const double secondsTaken = juce::Time::highResolutionTicksToSeconds (totalTicks);
+            const double secondsProcessed = numBlocks * blockSize / sampleRate;
+
+            if (secondsTaken > 0.0)
+            {
+                result.realTimeFactor = secondsProcessed / secondsTaken;
+                result.threadUtilisation = juce::Time::highResolutionTicksToSeconds (stats.busyTicks.load())
+                                            / (secondsTaken * (double) std::max ((size_t) 1, numThreads));
+            }
+        }
+
+        return result;
+    }
+}
+
+}
@@ -23,6 +23,12 @@ call "%TESTS_DIR%/build_projucer.bat" || exit 1
 call :BuildExample "AudioNodeDev"
 if %ERRORLEVEL% neq 0 exit /b %ERRORLEVEL%
 
+call :BuildExample "GraphBenchmarks"
+if %ERRORLEVEL% neq 0 exit /b %ERRORLEVEL%
+
+call :BuildExample "EditPlaybackBenchmarks"
+if %ERRORLEVEL% neq 0 exit /b %ERRORLEVEL%
+
 call :BuildExample "TestRunner"
 if %ERRORLEVEL% neq 0 exit /b %ERRORLEVEL%
 